@@ -18,7 +18,10 @@
 #import "AylaDatapointBatchRequest.h"
 #import "AylaDatapointBatchResponse.h"
 #import "AylaDatapointBlob.h"
+#import "AylaDatapointOutbox.h"
+#import "AylaDatapointSink.h"
 #import "AylaDatum.h"
+#import "AylaDatumCache.h"
 #import "AylaDefines.h"
 #import "AylaDevice+Extensible.h"
 #import "AylaDevice.h"
@@ -36,10 +39,12 @@
 #import "AylaHTTPClient.h"
 #import "AylaLanSupportDevice.h"
 #import "AylaLoginManager.h"
+#import "AylaMetrics.h"
 #import "AylaNetworks+Utils.h"
 #import "AylaNetworks.h"
 #import "AylaObject.h"
 #import "AylaPlugin.h"
+#import "AylaPollPolicy.h"
 #import "AylaProfiler.h"
 #import "AylaProperty.h"
 #import "AylaPropertyTrigger.h"
@@ -56,6 +61,7 @@
 #import "AylaSystemSettings.h"
 #import "AylaSystemUtils.h"
 #import "AylaTimeZone.h"
+#import "AylaTracer.h"
 #import "AylaUser.h"
 #import "AylaChange.h"
 #import "AylaDeviceChange.h"
@@ -66,12 +72,14 @@
 #import "AylaConnectivity.h"
 #import "AylaConnectTask.h"
 #import "AylaGenericTask.h"
+#import "AylaHTTPDownloadDigest.h"
 #import "AylaHTTPError.h"
 #import "AylaHTTPTask.h"
 #import "AylaJsonError.h"
 #import "AylaLanError.h"
 #import "AylaRequestError.h"
 #import "AylaBLECandidate.h"
+#import "AylaBLEConnectionScheduler.h"
 #import "AylaBLEDevice+Internal.h"
 #import "AylaBLEDevice.h"
 #import "AylaBLEDeviceManager+Internal.h"
@@ -85,6 +93,7 @@
 #import "AylaLog.h"
 #import "AylaLogManager.h"
 #import "AylaLANOTADevice.h"
+#import "AylaLANOTAManager.h"
 #import "AylaOTAImageInfo.h"
 #import "AylaDatapointParams.h"
 #import "AylaNetworkInformation.h"
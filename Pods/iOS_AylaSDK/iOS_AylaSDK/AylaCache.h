@@ -41,6 +41,11 @@ typedef NS_ENUM(NSInteger, AylaCacheType) {
    *  Caches Nodes of a Gateway
    */
   AylaCacheTypeNode = 0x20,
+  /**
+   *  Caches fetched datapoint history of properties. Disabled by default,
+   *  enable it with `enable:`.
+   */
+  AylaCacheTypeDatapointHistory = 0x40,
   /**
    *  Represents all type of caches
    */
@@ -56,6 +61,18 @@ typedef NS_ENUM(NSInteger, AylaCacheType) {
  */
 @interface AylaCache : NSObject
 
+/**
+ * Datapoint history older than this many seconds is evicted from the
+ * `AylaCacheTypeDatapointHistory` cache. Defaults to 30 days.
+ */
+@property(nonatomic, assign) NSTimeInterval datapointHistoryMaxAge;
+
+/**
+ * Size budget of the `AylaCacheTypeDatapointHistory` cache in bytes. Least
+ * recently written property histories are evicted first. Defaults to 4 MB.
+ */
+@property(nonatomic, assign) unsigned long long datapointHistorySizeLimit;
+
 /**
  * Initializer for AylaCache. Must be provided the AylaSessionManager's session
  * name for the session
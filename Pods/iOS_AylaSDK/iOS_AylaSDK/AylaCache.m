@@ -5,22 +5,28 @@
 //
 
 #import "AylaCache.h"
+#import "AylaDatapointHistoryCache.h"
 #import "AylaLanConfig.h"
 #import "AylaLogManager.h"
+#import "AylaMetrics.h"
 #import "AylaNetworks.h"
 #import "AylaObject+Internal.h"
 #import "AylaSessionManager.h"
 #import "AylaSystemUtils.h"
 #import "NSData+AES256.h"
 #import <CommonCrypto/CommonDigest.h>
-#import <zlib.h>
+#import <Security/Security.h>
 
 @interface AylaCache () {
   int caches;
 }
 
 @property(nonatomic) NSString *sessionName;
+@property(nonatomic) AylaDatapointHistoryCache *historyCache;
 @property (strong, nonatomic) NSString *_testSessionAccessToken;
+
+/** Secret the lan configs are encrypted with, loaded from the keychain once */
+@property (nonatomic, copy) NSString *lanConfigSecret;
 @end
 
 @implementation AylaCache
@@ -37,15 +43,50 @@ NSString *const AylaCacheTypeGroupPrefix = @"group";
 static NSString *const AylaCacheDeviceFile = @"AylaDevicesArchiver.arch";
 static NSString *const AylaCacheSetupFile = @"newDeviceConnected.arch";
 static NSString *const AylaCacheGroupFile = @"group.arch";
+static NSString *const AylaCacheDatapointHistoryDirectory = @"datapointHistory";
+static NSString *const AylaCacheLanConfigSecretService = @"com.aylanetworks.cache.lanConfigSecret";
+
+/** Number of random bytes of the lan config secret, 32 characters once base64 encoded to fill an AES256 key */
+static const size_t AylaCacheLanConfigSecretLength = 24;
 
 - (instancetype)initWithSessionName:(NSString *)sessionName {
   if (self = [super init]) {
-    caches = 0xFF;
+    // Datapoint history is kept on disk across sessions, so apps have to opt in
+    caches = AylaCacheTypeAll & ~AylaCacheTypeDatapointHistory;
     self.sessionName = sessionName;
+    self.historyCache = [[AylaDatapointHistoryCache alloc]
+        initWithDirectoryPath:
+            [[AylaSystemUtils deviceArchivesPathForSession:sessionName]
+                stringByAppendingPathComponent:
+                    AylaCacheDatapointHistoryDirectory]];
   }
   return self;
 }
 
+- (NSTimeInterval)datapointHistoryMaxAge {
+  return self.historyCache.maxAge;
+}
+
+- (void)setDatapointHistoryMaxAge:(NSTimeInterval)datapointHistoryMaxAge {
+  self.historyCache.maxAge = datapointHistoryMaxAge;
+}
+
+- (unsigned long long)datapointHistorySizeLimit {
+  return self.historyCache.sizeLimit;
+}
+
+- (void)setDatapointHistorySizeLimit:
+    (unsigned long long)datapointHistorySizeLimit {
+  self.historyCache.sizeLimit = datapointHistorySizeLimit;
+}
+
+- (AylaDatapointHistoryCache *)datapointHistoryCache {
+  if (![self cachingEnabled:AylaCacheTypeDatapointHistory]) {
+    return nil;
+  }
+  return self.historyCache;
+}
+
 - (BOOL)cachingEnabled {
   return (caches != 0x00);
 }
@@ -79,6 +120,14 @@ static NSString *const AylaCacheGroupFile = @"group.arch";
 
   AylaLogI([AylaCache logTag], 0, @"%@ mask: %ld", NSStringFromSelector(_cmd),
            cachesToClear);
+  if ((cachesToClear & AylaCacheTypeDatapointHistory) != 0x00) {
+    [self.historyCache removeAll];
+  }
+  if ((cachesToClear & AylaCacheTypeLANConfig) != 0x00) {
+    // Lan configs cached from now on must not be readable with the secret of
+    // the user signed in before
+    [self deleteLanConfigSecret];
+  }
   while (fileObj = [en nextObject]) {
     BOOL shouldClearLANCache =
         ([fileObj rangeOfString:AylaCacheTypeLANConfigPrefix].location !=
@@ -158,7 +207,7 @@ static NSString *const AylaCacheGroupFile = @"group.arch";
 
 - (id)getData:(NSString *)key {
   if (key) {
-    return [self loadCache:key];
+    return [self loadCacheRecordingMetrics:key];
   }
   return nil;
 }
@@ -167,11 +216,22 @@ static NSString *const AylaCacheGroupFile = @"group.arch";
   NSString *id = [self getKey:cacheType uniqueId:uniqueId];
 
   if (id) {
-    return [self loadCache:id];
+    return [self loadCacheRecordingMetrics:id];
   }
   return nil;
 }
 
+/**
+ * Loads a cache entry and counts the lookup as a hit or a miss in the shared
+ * metrics.
+ */
+- (id)loadCacheRecordingMetrics:(NSString *)name {
+  id data = [self loadCache:name];
+  [[AylaMetrics sharedMetrics]
+      incrementCounter:data ? AylaMetricsCacheHits : AylaMetricsCacheMisses];
+  return data;
+}
+
 - (BOOL)save:(AylaCacheType)cacheType
     uniqueId:(NSString *)uniqueId
    andObject:(id)valueToCache {
@@ -380,20 +440,131 @@ static NSString *const AylaCacheGroupFile = @"group.arch";
     return nil;
   }
 
-  NSData *decryptedData = [encryptedData AES256DecryptWithKey:key];
   NSDictionary *jsonDictionary =
-      [NSJSONSerialization JSONObjectWithData:decryptedData
-                                      options:0
-                                        error:nil];
+      [self lanConfigJSONFromData:encryptedData withKey:key];
   if (jsonDictionary == nil) {
-    return nil;
+    // Entries saved by previous versions are encrypted with a key derived from
+    // the access token. Re-encrypt them with the secret once they are read.
+    NSString *legacyKey = [self legacyLanConfigKey];
+    jsonDictionary = legacyKey
+                         ? [self lanConfigJSONFromData:encryptedData
+                                               withKey:legacyKey]
+                         : nil;
+    if (jsonDictionary == nil) {
+      return nil;
+    }
+    AylaLanConfig *lanConfig =
+        [[AylaLanConfig alloc] initWithJSONDictionary:jsonDictionary error:nil];
+    if (lanConfig) {
+      AylaLogI([AylaCache logTag], 0, @"migrating %@", name);
+      [self saveLanConfig:lanConfig withName:name];
+    }
+    return lanConfig;
   }
 
   return
       [[AylaLanConfig alloc] initWithJSONDictionary:jsonDictionary error:nil];
 }
 
+- (NSDictionary *)lanConfigJSONFromData:(NSData *)encryptedData
+                                withKey:(NSString *)key {
+  NSData *decryptedData = [encryptedData AES256DecryptWithKey:key];
+  if (decryptedData == nil) {
+    return nil;
+  }
+  id jsonObject = [NSJSONSerialization JSONObjectWithData:decryptedData
+                                                  options:0
+                                                    error:nil];
+  return [jsonObject isKindOfClass:[NSDictionary class]] ? jsonObject : nil;
+}
+
+/**
+ * @return The key lan configs are encrypted with, a random secret stored in
+ * the keychain for the session. The secret is created the first time it is
+ * needed and kept in memory afterwards. Returns nil if the keychain can't be
+ * read, e.g. before the device is first unlocked.
+ */
 - (NSString *)lanConfigKey {
+  @synchronized(self) {
+    if (self.lanConfigSecret == nil) {
+      self.lanConfigSecret = [self loadOrCreateLanConfigSecret];
+    }
+    return self.lanConfigSecret;
+  }
+}
+
+- (NSString *)loadOrCreateLanConfigSecret {
+  NSMutableDictionary *query = [@{
+    (__bridge id)kSecClass : (__bridge id)kSecClassGenericPassword,
+    (__bridge id)kSecAttrService : AylaCacheLanConfigSecretService,
+    (__bridge id)kSecAttrAccount : _sessionName ?: @""
+  } mutableCopy];
+
+  NSMutableDictionary *copyQuery = [query mutableCopy];
+  copyQuery[(__bridge id)kSecReturnData] = @YES;
+  copyQuery[(__bridge id)kSecMatchLimit] = (__bridge id)kSecMatchLimitOne;
+  CFTypeRef result = NULL;
+  OSStatus status = SecItemCopyMatching(
+      (__bridge CFDictionaryRef)copyQuery, &result);
+  if (status == errSecSuccess) {
+    NSData *secretData = (__bridge_transfer NSData *)result;
+    return [[NSString alloc] initWithData:secretData
+                                 encoding:NSUTF8StringEncoding];
+  }
+  if (status != errSecItemNotFound) {
+    AylaLogE([AylaCache logTag], 0, @"failed to read lan config secret:%d",
+             (int)status);
+    return nil;
+  }
+
+  uint8_t randomBytes[AylaCacheLanConfigSecretLength];
+  if (SecRandomCopyBytes(kSecRandomDefault, sizeof(randomBytes),
+                         randomBytes) != 0) {
+    AylaLogE([AylaCache logTag], 0, @"failed to generate lan config secret");
+    return nil;
+  }
+  NSString *secret =
+      [[NSData dataWithBytes:randomBytes length:sizeof(randomBytes)]
+          base64EncodedStringWithOptions:0];
+
+  query[(__bridge id)kSecValueData] =
+      [secret dataUsingEncoding:NSUTF8StringEncoding];
+  query[(__bridge id)kSecAttrAccessible] =
+      (__bridge id)kSecAttrAccessibleAfterFirstUnlockThisDeviceOnly;
+  status = SecItemAdd((__bridge CFDictionaryRef)query, NULL);
+  if (status != errSecSuccess) {
+    AylaLogE([AylaCache logTag], 0, @"failed to save lan config secret:%d",
+             (int)status);
+    return nil;
+  }
+  return secret;
+}
+
+/**
+ * Removes the lan config secret from the keychain and memory, a new one is
+ * created the next time it is needed.
+ */
+- (void)deleteLanConfigSecret {
+  @synchronized(self) {
+    self.lanConfigSecret = nil;
+    NSDictionary *query = @{
+      (__bridge id)kSecClass : (__bridge id)kSecClassGenericPassword,
+      (__bridge id)kSecAttrService : AylaCacheLanConfigSecretService,
+      (__bridge id)kSecAttrAccount : _sessionName ?: @""
+    };
+    OSStatus status = SecItemDelete((__bridge CFDictionaryRef)query);
+    if (status != errSecSuccess && status != errSecItemNotFound) {
+      AylaLogE([AylaCache logTag], 0, @"failed to delete lan config secret:%d",
+               (int)status);
+    }
+  }
+}
+
+/**
+ * @return The key lan configs were encrypted with by previous versions, derived
+ * from the access token. Only used to migrate existing entries.
+ */
+- (NSString *)legacyLanConfigKey {
   // Get the session manager
   AylaSessionManager *sessionManager =
       [[AylaNetworks shared] getSessionManagerWithName:_sessionName];
@@ -55,6 +55,23 @@ static NSString *const attrNameEcho = @"echo";
     return self;
 }
 
+- (instancetype)initWithValue:(id)value
+                    createdAt:(NSDate *)createdAt
+                           id:(NSString *)id
+                     metadata:(NSDictionary *)metadata
+                   dataSource:(AylaDataSource)dataSource
+{
+    if (self = [super init]) {
+        _value = value;
+        _createdAt = createdAt;
+        _id = id;
+        _metadata = metadata;
+        _updatedAt = createdAt;
+        _dataSource = dataSource;
+    }
+    return self;
+}
+
 - (instancetype)initWithJSONDictionary:(NSDictionary *)dictionary
                                  error:(NSError *_Nullable __autoreleasing *_Nullable)error
 {
@@ -141,6 +158,11 @@ static NSString *const attrNameEcho = @"echo";
     return @{ NSStringFromSelector(@selector(value)) : self.value ?: [NSNull null] };
 }
 
+- (NSString *)historyIdentifier
+{
+    return [NSString stringWithFormat:@"%lld|%@", llround([self.createdAt timeIntervalSince1970] * 1000.), self.value];
+}
+
 - (NSString *)logTag
 {
     return @"Datapoint";
@@ -0,0 +1,118 @@
+//
+//  AylaDatapointOutbox.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDatapoint;
+@class AylaDatapointOutbox;
+
+/**
+ * Key of the `AylaQueuedDatapoint` in the user info of the error passed to the failure block of
+ * `-[AylaProperty createDatapoint:success:failure:]` when the datapoint has been queued in the outbox.
+ */
+FOUNDATION_EXPORT NSString *const AylaDatapointOutboxQueuedDatapointKey;
+
+/**
+ * A datapoint waiting in the outbox.
+ */
+@interface AylaQueuedDatapoint : NSObject
+
+/** DSN of the device */
+@property (nonatomic, strong, readonly) NSString *dsn;
+
+/** Name of the property */
+@property (nonatomic, strong, readonly) NSString *propertyName;
+
+/** Value of the datapoint */
+@property (nonatomic, strong, readonly) id value;
+
+/** Metadata of the datapoint */
+@property (nonatomic, strong, readonly, nullable) NSDictionary *metadata;
+
+/** Time the datapoint was queued at */
+@property (nonatomic, strong, readonly) NSDate *queuedAt;
+
+/** Time the datapoint expires at if it has not been created by then */
+@property (nonatomic, strong, readonly) NSDate *expiresAt;
+
+@end
+
+/**
+ * Outbox listener protocol. All methods are called on the main queue.
+ */
+@protocol AylaDatapointOutboxListener <NSObject>
+
+@optional
+/**
+ * Called when a datapoint has been queued. A datapoint queued for a property replaces the one queued before for it.
+ */
+- (void)datapointOutbox:(AylaDatapointOutbox *)outbox didQueueDatapoint:(AylaQueuedDatapoint *)queuedDatapoint;
+
+/**
+ * Called when a queued datapoint has been created.
+ */
+- (void)datapointOutbox:(AylaDatapointOutbox *)outbox
+         didSendDatapoint:(AylaQueuedDatapoint *)queuedDatapoint
+        createdDatapoint:(nullable AylaDatapoint *)createdDatapoint;
+
+/**
+ * Called when a queued datapoint has been dropped because it expired before it could be created.
+ */
+- (void)datapointOutbox:(AylaDatapointOutbox *)outbox didExpireDatapoint:(AylaQueuedDatapoint *)queuedDatapoint;
+
+/**
+ * Called when a queued datapoint has been dropped because it has been rejected, e.g. the property no longer exists.
+ */
+- (void)datapointOutbox:(AylaDatapointOutbox *)outbox
+    didFailToSendDatapoint:(AylaQueuedDatapoint *)queuedDatapoint
+                     error:(NSError *)error;
+
+@end
+
+/**
+ * Durable queue of datapoint writes which could not be delivered, enabled with
+ * `-[AylaSystemSettings datapointOutboxEnabled]`.
+ *
+ * When `createDatapoint:` fails because the cloud service can't be reached, the datapoint is queued and the failure
+ * block gets an error holding it under `AylaDatapointOutboxQueuedDatapointKey`. Datapoints are coalesced per property,
+ * only the latest one is kept, and persisted so they survive app restarts. They are replayed as soon as a path is
+ * available: over LAN for devices with an active LAN session, in one `createDatapointBatch:` request otherwise.
+ * Datapoints of files are never queued.
+ */
+@interface AylaDatapointOutbox : NSObject
+
+/** Time a datapoint waits before it expires, in seconds */
+@property (nonatomic, assign, readonly) NSTimeInterval expiry;
+
+/**
+ * @return Datapoints waiting in the outbox, oldest first
+ */
+- (NSArray<AylaQueuedDatapoint *> *)queuedDatapoints;
+
+/**
+ * Tries to deliver the queued datapoints now. The SDK calls it whenever connectivity changes or a LAN session opens.
+ */
+- (void)replay;
+
+/**
+ * Drops all queued datapoints without notifying listeners.
+ */
+- (void)removeAll;
+
+/** Add a listener which conforms to the `AylaDatapointOutboxListener` protocol */
+- (void)addListener:(id<AylaDatapointOutboxListener>)listener;
+
+/** Remove a listener which conforms to the `AylaDatapointOutboxListener` protocol */
+- (void)removeListener:(id<AylaDatapointOutboxListener>)listener;
+
+// Unavailable methods
+- (instancetype)init NS_UNAVAILABLE;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,477 @@
+//
+//  AylaDatapointOutbox.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDatapoint.h"
+#import "AylaDatapointBatchRequest.h"
+#import "AylaDatapointBatchResponse.h"
+#import "AylaDatapointOutbox+Internal.h"
+#import "AylaDatapointParams.h"
+#import "AylaDefines_Internal.h"
+#import "AylaDevice+Internal.h"
+#import "AylaDeviceManager.h"
+#import "AylaErrorUtils.h"
+#import "AylaHTTPError.h"
+#import "AylaListenerArray.h"
+#import "AylaProperty+Internal.h"
+
+NSString *const AylaDatapointOutboxQueuedDatapointKey = @"queuedDatapoint";
+
+static NSString *const attrNameDsn = @"dsn";
+static NSString *const attrNamePropertyName = @"property_name";
+static NSString *const attrNameValue = @"value";
+static NSString *const attrNameMetadata = @"metadata";
+static NSString *const attrNameQueuedAt = @"queued_at";
+static NSString *const attrNameExpiresAt = @"expires_at";
+
+@interface AylaQueuedDatapoint ()
+
+@property (nonatomic, strong, readwrite) NSString *dsn;
+@property (nonatomic, strong, readwrite) NSString *propertyName;
+@property (nonatomic, strong, readwrite) id value;
+@property (nonatomic, strong, readwrite, nullable) NSDictionary *metadata;
+@property (nonatomic, strong, readwrite) NSDate *queuedAt;
+@property (nonatomic, strong, readwrite) NSDate *expiresAt;
+
+@end
+
+@implementation AylaQueuedDatapoint
+
+- (instancetype)initWithJSONDictionary:(NSDictionary *)dictionary
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _dsn = [dictionary[attrNameDsn] nilIfNull];
+    _propertyName = [dictionary[attrNamePropertyName] nilIfNull];
+    _value = [dictionary[attrNameValue] nilIfNull];
+    _metadata = [dictionary[attrNameMetadata] nilIfNull];
+    _queuedAt = [NSDate dateWithTimeIntervalSince1970:[dictionary[attrNameQueuedAt] doubleValue]];
+    _expiresAt = [NSDate dateWithTimeIntervalSince1970:[dictionary[attrNameExpiresAt] doubleValue]];
+
+    if (!_dsn || !_propertyName || !_value) {
+        return nil;
+    }
+    return self;
+}
+
+- (NSDictionary *)toJSONDictionary
+{
+    return @{
+        attrNameDsn : self.dsn,
+        attrNamePropertyName : self.propertyName,
+        attrNameValue : self.value,
+        attrNameMetadata : AYLNullIfNil(self.metadata),
+        attrNameQueuedAt : @([self.queuedAt timeIntervalSince1970]),
+        attrNameExpiresAt : @([self.expiresAt timeIntervalSince1970])
+    };
+}
+
+/**
+ * @return Key the datapoint is coalesced on
+ */
+- (NSString *)key
+{
+    return [NSString stringWithFormat:@"%@/%@", self.dsn, self.propertyName];
+}
+
+- (AylaDatapointParams *)datapointParams
+{
+    AylaDatapointParams *params = [[AylaDatapointParams alloc] init];
+    params.value = self.value;
+    params.metadata = self.metadata;
+    return params;
+}
+
+- (BOOL)isExpired
+{
+    return [self.expiresAt timeIntervalSinceNow] <= 0;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %@ value:%@ expiresAt:%@>",
+                                      NSStringFromClass([self class]),
+                                      [self key],
+                                      self.value,
+                                      self.expiresAt];
+}
+
+@end
+
+@interface AylaDatapointOutbox ()
+
+@property (nonatomic, weak) AylaDeviceManager *deviceManager;
+@property (nonatomic, strong) NSString *filePath;
+@property (nonatomic, assign, readwrite) NSTimeInterval expiry;
+@property (nonatomic, strong) dispatch_queue_t processingQueue;
+@property (nonatomic, strong) AylaListenerArray *listeners;
+
+/** Queued datapoints keyed by device and property, only accessed on the processing queue */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaQueuedDatapoint *> *datapoints;
+
+/** Keys of the datapoints being sent, only accessed on the processing queue */
+@property (nonatomic, strong) NSMutableSet<NSString *> *sendingKeys;
+
+@end
+
+@implementation AylaDatapointOutbox
+
+- (instancetype)initWithDeviceManager:(AylaDeviceManager *)deviceManager
+                             filePath:(NSString *)filePath
+                               expiry:(NSTimeInterval)expiry
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _deviceManager = deviceManager;
+    _filePath = filePath;
+    _expiry = expiry;
+    _processingQueue = dispatch_queue_create("com.aylanetworks.datapointOutbox.queue.processing", DISPATCH_QUEUE_SERIAL);
+    _listeners = [[AylaListenerArray alloc] init];
+    _datapoints = [NSMutableDictionary dictionary];
+    _sendingKeys = [NSMutableSet set];
+
+    dispatch_async(_processingQueue, ^{
+        [self load];
+    });
+
+    return self;
+}
+
++ (BOOL)shouldQueueDatapointAfterError:(NSError *)error
+{
+    return [error.domain isEqualToString:AylaHTTPErrorDomain] && error.code == AylaHTTPErrorCodeLostConnectivity;
+}
+
+/**
+ * @return YES if the cloud answered with a status which says nothing about the datapoint, the service being down or
+ * busy
+ */
+static BOOL AylaDatapointOutboxIsTransientStatus(NSInteger statusCode)
+{
+    return statusCode == 429 || statusCode >= 500;
+}
+
+/**
+ * @return YES if a datapoint which failed to be sent with the error can be sent again later
+ */
++ (BOOL)isTransientError:(NSError *)error
+{
+    if ([self shouldQueueDatapointAfterError:error] ||
+        ([error.domain isEqualToString:AylaRequestErrorDomain] && error.code == AylaRequestErrorCodeTimedOut)) {
+        return YES;
+    }
+
+    // A failed batch request carries its HTTP response, a failed item of a batch carries its own status
+    NSInteger statusCode = error.ayla_httpStatusCode;
+    NSDictionary *responseJson = error.userInfo[AylaRequestErrorResponseJsonKey];
+    if (statusCode == 0 && [responseJson isKindOfClass:[NSDictionary class]] &&
+        [responseJson[@"status"] isKindOfClass:[NSNumber class]]) {
+        statusCode = [responseJson[@"status"] integerValue];
+    }
+    return AylaDatapointOutboxIsTransientStatus(statusCode);
+}
+
+- (void)addListener:(id<AylaDatapointOutboxListener>)listener
+{
+    [self.listeners addListener:listener];
+}
+
+- (void)removeListener:(id<AylaDatapointOutboxListener>)listener
+{
+    [self.listeners removeListener:listener];
+}
+
+- (NSArray<AylaQueuedDatapoint *> *)queuedDatapoints
+{
+    __block NSArray *datapoints;
+    dispatch_sync(self.processingQueue, ^{
+        datapoints = [self sortedDatapoints];
+    });
+    return datapoints;
+}
+
+- (AylaQueuedDatapoint *)queueDatapoint:(AylaDatapointParams *)datapointParams forProperty:(AylaProperty *)property
+{
+    NSString *dsn = property.device.dsn;
+    if (!dsn || !property.name || datapointParams.filePath || datapointParams.data || !datapointParams.value ||
+        ![NSJSONSerialization isValidJSONObject:@[ datapointParams.value, datapointParams.metadata ?: @{} ]]) {
+        return nil;
+    }
+
+    AylaQueuedDatapoint *queued = [[AylaQueuedDatapoint alloc] init];
+    queued.dsn = dsn;
+    queued.propertyName = property.name;
+    queued.value = datapointParams.value;
+    queued.metadata = datapointParams.metadata;
+    queued.queuedAt = [NSDate date];
+    queued.expiresAt = [queued.queuedAt dateByAddingTimeInterval:self.expiry];
+
+    dispatch_async(self.processingQueue, ^{
+        AylaLogI([self logTag], 0, @"queued %@", queued);
+        self.datapoints[[queued key]] = queued;
+        [self save];
+        [self.listeners iterateListenersRespondingToSelector:@selector(datapointOutbox:didQueueDatapoint:)
+                                                asyncOnQueue:dispatch_get_main_queue()
+                                                       block:^(id listener) {
+                                                           [listener datapointOutbox:self didQueueDatapoint:queued];
+                                                       }];
+    });
+    return queued;
+}
+
+- (void)removeAll
+{
+    dispatch_async(self.processingQueue, ^{
+        [self.datapoints removeAllObjects];
+        [self save];
+    });
+}
+
+//-----------------------------------------------------------
+#pragma mark - Replay
+//-----------------------------------------------------------
+
+- (void)replay
+{
+    dispatch_async(self.processingQueue, ^{
+        [self replayDatapoints];
+    });
+}
+
+/**
+ * Sends every queued datapoint whose property is known: over LAN if the LAN session of the device is active, in one
+ * batch request otherwise. Must be called on the processing queue.
+ */
+- (void)replayDatapoints
+{
+    [self expireDatapoints];
+
+    NSDictionary *devices = self.deviceManager.devices;
+    NSMutableArray *batch = [NSMutableArray array];
+    NSMutableArray *batchedDatapoints = [NSMutableArray array];
+    for (AylaQueuedDatapoint *queued in [self sortedDatapoints]) {
+        NSString *key = [queued key];
+        if ([self.sendingKeys containsObject:key]) {
+            continue;
+        }
+        AylaDevice *device = devices[queued.dsn];
+        AylaProperty *property = device.properties[queued.propertyName];
+        if (!property) {
+            // Wait until the properties of the device have been fetched
+            continue;
+        }
+
+        [self.sendingKeys addObject:key];
+        if (device.isLanModeActive) {
+            [property createDatapointLAN:[queued datapointParams]
+                success:^(AylaDatapoint *createdDatapoint) {
+                    [self didSendDatapoint:queued createdDatapoint:createdDatapoint error:nil];
+                }
+                failure:^(NSError *error) {
+                    [self didSendDatapoint:queued createdDatapoint:nil error:error];
+                }];
+        }
+        else {
+            [batch addObject:[[AylaDatapointBatchRequest alloc] initWithDatapoint:[queued datapointParams]
+                                                                         property:property]];
+            [batchedDatapoints addObject:queued];
+        }
+    }
+
+    if (batch.count > 0) {
+        [self sendBatch:batch datapoints:batchedDatapoints];
+    }
+}
+
+- (void)sendBatch:(NSArray<AylaDatapointBatchRequest *> *)batch datapoints:(NSArray<AylaQueuedDatapoint *> *)datapoints
+{
+    AylaLogI([self logTag], 0, @"replaying %lu datapoints in a batch", (unsigned long)datapoints.count);
+    AylaDeviceManager *deviceManager = self.deviceManager;
+    AylaHTTPTask *task = [deviceManager createDatapointBatch:batch
+        success:^(NSArray<AylaDatapointBatchResponse *> *responses) {
+            for (AylaQueuedDatapoint *queued in datapoints) {
+                AylaDatapointBatchResponse *response = nil;
+                for (AylaDatapointBatchResponse *candidate in responses) {
+                    if ([candidate.deviceDsn isEqualToString:queued.dsn] &&
+                        [candidate.propertyName isEqualToString:queued.propertyName]) {
+                        response = candidate;
+                        break;
+                    }
+                }
+                NSInteger statusCode = response.statusCode.integerValue;
+                if (response && statusCode >= 200 && statusCode < 300) {
+                    [self didSendDatapoint:queued createdDatapoint:response.datapoint error:nil];
+                    continue;
+                }
+                // 5xx and 429 statuses leave the datapoint queued, other statuses reject it
+                NSError *error = [AylaErrorUtils
+                    errorWithDomain:AylaRequestErrorDomain
+                               code:AylaRequestErrorCodeInvalidArguments
+                           userInfo:@{AylaRequestErrorResponseJsonKey : @{@"status" : response.statusCode ?: [NSNull null]}}];
+                [self didSendDatapoint:queued createdDatapoint:nil error:error];
+            }
+        }
+        failure:^(NSError *error) {
+            for (AylaQueuedDatapoint *queued in datapoints) {
+                [self didSendDatapoint:queued createdDatapoint:nil error:error];
+            }
+        }];
+
+    if (!task) {
+        // Failure block has been scheduled, the datapoints are released from there
+        AylaLogW([self logTag], 0, @"%@", @"batch not started");
+    }
+}
+
+- (void)didSendDatapoint:(AylaQueuedDatapoint *)queued
+        createdDatapoint:(AylaDatapoint *)createdDatapoint
+                   error:(NSError *)error
+{
+    dispatch_async(self.processingQueue, ^{
+        NSString *key = [queued key];
+        [self.sendingKeys removeObject:key];
+
+        if (error && [AylaDatapointOutbox isTransientError:error]) {
+            AylaLogI([self logTag], 0, @"%@ stays queued, err:%ld", key, (long)error.code);
+            return;
+        }
+
+        // A newer datapoint may have been queued for the property while this one was sent
+        if (self.datapoints[key] == queued) {
+            [self.datapoints removeObjectForKey:key];
+            [self save];
+        }
+
+        if (error) {
+            AylaLogW([self logTag], 0, @"%@ rejected, err:%@", key, error);
+            [self.listeners
+                iterateListenersRespondingToSelector:@selector(datapointOutbox:didFailToSendDatapoint:error:)
+                                        asyncOnQueue:dispatch_get_main_queue()
+                                               block:^(id listener) {
+                                                   [listener datapointOutbox:self
+                                                       didFailToSendDatapoint:queued
+                                                                        error:error];
+                                               }];
+            return;
+        }
+
+        AylaLogI([self logTag], 0, @"%@ sent", key);
+        [self.listeners iterateListenersRespondingToSelector:@selector(datapointOutbox:didSendDatapoint:createdDatapoint:)
+                                                asyncOnQueue:dispatch_get_main_queue()
+                                                       block:^(id listener) {
+                                                           [listener datapointOutbox:self
+                                                                    didSendDatapoint:queued
+                                                                    createdDatapoint:createdDatapoint];
+                                                       }];
+    });
+}
+
+/**
+ * Drops expired datapoints which are not being sent. Must be called on the processing queue.
+ */
+- (void)expireDatapoints
+{
+    NSMutableArray *expired = [NSMutableArray array];
+    for (AylaQueuedDatapoint *queued in self.datapoints.allValues) {
+        if ([queued isExpired] && ![self.sendingKeys containsObject:[queued key]]) {
+            [expired addObject:queued];
+        }
+    }
+    if (expired.count == 0) {
+        return;
+    }
+
+    for (AylaQueuedDatapoint *queued in expired) {
+        AylaLogI([self logTag], 0, @"expired %@", queued);
+        [self.datapoints removeObjectForKey:[queued key]];
+        [self.listeners iterateListenersRespondingToSelector:@selector(datapointOutbox:didExpireDatapoint:)
+                                                asyncOnQueue:dispatch_get_main_queue()
+                                                       block:^(id listener) {
+                                                           [listener datapointOutbox:self didExpireDatapoint:queued];
+                                                       }];
+    }
+    [self save];
+}
+
+/**
+ * @return Queued datapoints, oldest first. Must be called on the processing queue.
+ */
+- (NSArray<AylaQueuedDatapoint *> *)sortedDatapoints
+{
+    return [self.datapoints.allValues sortedArrayUsingComparator:^NSComparisonResult(AylaQueuedDatapoint *datapoint1,
+                                                                                      AylaQueuedDatapoint *datapoint2) {
+        return [datapoint1.queuedAt compare:datapoint2.queuedAt];
+    }];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Persistence
+//-----------------------------------------------------------
+
+/**
+ * Loads the datapoints persisted by a previous session. Must be called on the processing queue.
+ */
+- (void)load
+{
+    NSData *data = [NSData dataWithContentsOfFile:self.filePath];
+    if (!data) {
+        return;
+    }
+    NSError *error;
+    NSArray *datapointsInJson = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+    if (![datapointsInJson isKindOfClass:[NSArray class]]) {
+        AylaLogE([self logTag], 0, @"invalid outbox file, err:%@", error);
+        return;
+    }
+    for (NSDictionary *datapointInJson in datapointsInJson) {
+        AylaQueuedDatapoint *queued = [datapointInJson isKindOfClass:[NSDictionary class]]
+                                          ? [[AylaQueuedDatapoint alloc] initWithJSONDictionary:datapointInJson]
+                                          : nil;
+        if (queued) {
+            self.datapoints[[queued key]] = queued;
+        }
+    }
+    AylaLogI([self logTag], 0, @"loaded %lu datapoints", (unsigned long)self.datapoints.count);
+}
+
+/**
+ * Writes the queued datapoints to disk. Must be called on the processing queue.
+ */
+- (void)save
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSError *error;
+    if (self.datapoints.count == 0) {
+        [fileManager removeItemAtPath:self.filePath error:nil];
+        return;
+    }
+
+    NSMutableArray *datapointsInJson = [NSMutableArray array];
+    for (AylaQueuedDatapoint *queued in [self sortedDatapoints]) {
+        [datapointsInJson addObject:[queued toJSONDictionary]];
+    }
+    NSData *data = [NSJSONSerialization dataWithJSONObject:datapointsInJson options:0 error:&error];
+    if (!data) {
+        AylaLogE([self logTag], 0, @"failed to serialize outbox, err:%@", error);
+        return;
+    }
+    [fileManager createDirectoryAtPath:[self.filePath stringByDeletingLastPathComponent]
+           withIntermediateDirectories:YES
+                            attributes:nil
+                                 error:nil];
+    if (![data writeToFile:self.filePath options:NSDataWritingAtomic error:&error]) {
+        AylaLogE([self logTag], 0, @"failed to write outbox, err:%@", error);
+    }
+}
+
+- (NSString *)logTag
+{
+    return @"DatapointOutbox";
+}
+
+@end
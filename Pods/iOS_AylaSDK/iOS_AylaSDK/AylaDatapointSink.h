@@ -0,0 +1,35 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDatapoint;
+@class AylaProperty;
+
+/**
+ * Describes an object that receives a property's datapoint history chunk by chunk, as it is streamed from the cloud
+ * by `-[AylaProperty streamDatapointsFrom:to:windowInterval:maxConcurrentWindows:sink:success:failure:]`.
+ */
+@protocol AylaDatapointSink<NSObject>
+
+/**
+ * Writes a chunk of datapoints into the sink. Chunks are written in chronological order and datapoints within a
+ * chunk are sorted by `createdAt`.
+ *
+ * @note This method is called on a background queue owned by the stream. Chunks are never written concurrently.
+ *
+ * @param property   The `AylaProperty` whose datapoints are being streamed.
+ * @param datapoints A non-empty array of decoded `AylaDatapoint` objects.
+ *
+ * @return NO to stop the stream early. No more chunks will be written and the success block will be called.
+ */
+- (BOOL)property:(AylaProperty *)property writeDatapoints:(NSArray<AylaDatapoint *> *)datapoints;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,109 @@
+//
+//  AylaDatumCache.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDatum;
+
+/**
+ * Cache of the datums of one owner, the user of a session or a device, see `-[AylaSessionManager userDatumCache]` and
+ * `-[AylaDevice datumCache]`.
+ *
+ * - Reads are served from the cache while entries are fresh. Keys missing from the cache are fetched through the bulk
+ *   `fetchDatumsWithKeys` request, and lookups made within `batchingInterval` of each other share the same request, so
+ *   a screen looking up many keys at once costs at most one request.
+ * - Writes are applied to the cache right away and sent after `writeDelay`. Several writes to a key within that delay
+ *   are coalesced into one request which sends the latest value.
+ * - Datums created, updated or deleted through the non cached datum methods of the owner invalidate their key.
+ *
+ * All blocks are called on the main queue.
+ */
+@interface AylaDatumCache : NSObject
+
+/** Time a fetched datum is served from the cache, in seconds. Defaults to 300. */
+@property (nonatomic, assign) NSTimeInterval timeToLive;
+
+/** Time missing keys are collected for before they are fetched, in seconds. Defaults to 0.05. */
+@property (nonatomic, assign) NSTimeInterval batchingInterval;
+
+/** Time writes are held for coalescing before they are sent, in seconds. Defaults to 1. */
+@property (nonatomic, assign) NSTimeInterval writeDelay;
+
+/**
+ * Fetches a datum, from the cache if it holds a fresh entry for the key.
+ *
+ * @param key          Key of the datum.
+ * @param successBlock A block called with the datum, nil if no datum exists with this key.
+ * @param failureBlock A block called with an `NSError` if the datum could not be fetched.
+ */
+- (void)fetchDatumWithKey:(NSString *)key
+                  success:(void (^)(AylaDatum *_Nullable datum))successBlock
+                  failure:(void (^)(NSError *error))failureBlock;
+
+/**
+ * Fetches datums, from the cache for the keys it holds fresh entries for and in one request for the others.
+ *
+ * @param keys         Keys of the datums.
+ * @param successBlock A block called with the datums keyed by key. Keys no datum exists with are left out.
+ * @param failureBlock A block called with an `NSError` if some datums could not be fetched.
+ */
+- (void)fetchDatumsWithKeys:(NSArray<NSString *> *)keys
+                    success:(void (^)(NSDictionary<NSString *, AylaDatum *> *datums))successBlock
+                    failure:(void (^)(NSError *error))failureBlock;
+
+/**
+ * @param key Key of the datum.
+ *
+ * @return The datum held by the cache for the key if its entry is fresh, nil otherwise. Never makes a request.
+ */
+- (nullable AylaDatum *)cachedDatumWithKey:(NSString *)key;
+
+/**
+ * Sets the value of a datum. The datum is created if it does not exist yet.
+ *
+ * @param key             Key of the datum.
+ * @param value           New value of the datum.
+ * @param completionBlock A block called once the value has been written to the cloud, or replaced by a later write
+ *                        which has been, with an `NSError` if the write failed.
+ */
+- (void)updateDatumWithKey:(NSString *)key
+                   toValue:(NSString *)value
+                completion:(nullable void (^)(NSError *_Nullable error))completionBlock;
+
+/**
+ * Deletes a datum.
+ *
+ * @param key             Key of the datum.
+ * @param completionBlock A block called once the datum has been deleted from the cloud, with an `NSError` if the delete
+ *                        failed.
+ */
+- (void)deleteDatumWithKey:(NSString *)key completion:(nullable void (^)(NSError *_Nullable error))completionBlock;
+
+/**
+ * Sends pending writes right away.
+ *
+ * @param completionBlock A block called once all writes sent before it was called have completed.
+ */
+- (void)flushWithCompletion:(nullable void (^)(void))completionBlock;
+
+/**
+ * Drops the cached entry of a key, so the next lookup fetches it. Entries of keys with a pending write are kept.
+ */
+- (void)invalidateDatumWithKey:(NSString *)key;
+
+/**
+ * Drops all cached entries, except the ones of keys with a pending write.
+ */
+- (void)invalidateAll;
+
+// Unavailable methods
+- (instancetype)init NS_UNAVAILABLE;
+@end
+
+NS_ASSUME_NONNULL_END
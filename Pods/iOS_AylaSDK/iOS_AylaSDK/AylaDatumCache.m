@@ -0,0 +1,682 @@
+//
+//  AylaDatumCache.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDatum+Internal.h"
+#import "AylaDatumCache+Internal.h"
+#import "AylaDefines_Internal.h"
+#import "AylaErrorUtils.h"
+#import "AylaHTTPClient.h"
+#import "AylaHTTPError.h"
+#import "AylaMetrics.h"
+#import "AylaRequestError.h"
+
+/** Datum cache queue label */
+static char *const AylaDatumCacheQueueLabel = "com.aylanetworks.datumCache.queue.processing";
+
+/** Maximum number of keys fetched in one request, to keep urls short */
+static const NSUInteger AylaDatumCacheMaxKeysPerFetch = 50;
+
+static const NSTimeInterval DEFAULT_TIME_TO_LIVE = 300;
+static const NSTimeInterval DEFAULT_BATCHING_INTERVAL = 0.05;
+static const NSTimeInterval DEFAULT_WRITE_DELAY = 1;
+
+typedef void (^AylaDatumCacheFetchWaiter)(AylaDatum *_Nullable datum, NSError *_Nullable error);
+typedef void (^AylaDatumCacheWriteCompletion)(NSError *_Nullable error);
+
+static BOOL AylaDatumCacheIsNotFoundError(NSError *error)
+{
+    NSHTTPURLResponse *response = error.userInfo[AylaHTTPErrorHTTPResponseKey];
+    return [response isKindOfClass:[NSHTTPURLResponse class]] && response.statusCode == 404;
+}
+
+/**
+ * A cached datum, or the knowledge that no datum exists with the key.
+ */
+@interface AylaDatumCacheEntry : NSObject
+
+/** Datum, nil if no datum exists with the key */
+@property (nonatomic, strong, nullable) AylaDatum *datum;
+
+/** Time the entry was fetched or written at */
+@property (nonatomic, strong) NSDate *date;
+
+@end
+
+@implementation AylaDatumCacheEntry
+
++ (instancetype)entryWithDatum:(AylaDatum *)datum
+{
+    AylaDatumCacheEntry *entry = [[self alloc] init];
+    entry.datum = datum;
+    entry.date = [NSDate date];
+    return entry;
+}
+
+@end
+
+/**
+ * A write waiting to be sent.
+ */
+@interface AylaDatumCacheWrite : NSObject
+
+/** Value to write, nil to delete the datum */
+@property (nonatomic, copy, nullable) NSString *value;
+
+/** Completion blocks of the writes coalesced into this one */
+@property (nonatomic, strong) NSMutableArray<AylaDatumCacheWriteCompletion> *completionBlocks;
+
+/** `resetCount` of the cache when the write was sent */
+@property (nonatomic, assign) NSUInteger resetCount;
+
+@end
+
+@implementation AylaDatumCacheWrite
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _completionBlocks = [NSMutableArray array];
+
+    return self;
+}
+
+@end
+
+@interface AylaDatumCache ()
+
+@property (nonatomic, copy) NSString *collectionPath;
+@property (nonatomic, copy) AylaHTTPClient *_Nullable (^httpClientBlock)(NSError *_Nullable __autoreleasing *_Nullable);
+
+/** Serial queue all state below is accessed on */
+@property (nonatomic, strong) dispatch_queue_t processingQueue;
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaDatumCacheEntry *> *entries;
+
+/** Incremented on each invalidation, so fetches sent before it are not cached */
+@property (nonatomic, assign) NSUInteger generation;
+
+/** Incremented on each reset, so writes sent before it don't touch the cache */
+@property (nonatomic, assign) NSUInteger resetCount;
+
+/** Keys waiting for the next fetch */
+@property (nonatomic, strong) NSMutableOrderedSet<NSString *> *pendingFetchKeys;
+/** Blocks waiting for the fetch of a key, pending or sent */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<AylaDatumCacheFetchWaiter> *> *fetchWaiters;
+@property (nonatomic, assign) BOOL fetchScheduled;
+
+/** Writes waiting to be sent, keyed by key */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaDatumCacheWrite *> *pendingWrites;
+/** Keys which have a write being sent */
+@property (nonatomic, strong) NSMutableSet<NSString *> *writingKeys;
+/** Blocks waiting for all writes to complete */
+@property (nonatomic, strong) NSMutableArray<void (^)(void)> *flushWaiters;
+@property (nonatomic, assign) BOOL writeScheduled;
+
+@end
+
+@implementation AylaDatumCache
+
+- (instancetype)initWithCollectionPath:(NSString *)collectionPath
+                       httpClientBlock:(AylaHTTPClient *_Nullable (^)(NSError *_Nullable __autoreleasing *_Nullable error))
+                                           httpClientBlock
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _collectionPath = [collectionPath copy];
+    _httpClientBlock = [httpClientBlock copy];
+    _timeToLive = DEFAULT_TIME_TO_LIVE;
+    _batchingInterval = DEFAULT_BATCHING_INTERVAL;
+    _writeDelay = DEFAULT_WRITE_DELAY;
+
+    _processingQueue = dispatch_queue_create(AylaDatumCacheQueueLabel, DISPATCH_QUEUE_SERIAL);
+    _entries = [NSMutableDictionary dictionary];
+    _pendingFetchKeys = [NSMutableOrderedSet orderedSet];
+    _fetchWaiters = [NSMutableDictionary dictionary];
+    _pendingWrites = [NSMutableDictionary dictionary];
+    _writingKeys = [NSMutableSet set];
+    _flushWaiters = [NSMutableArray array];
+
+    return self;
+}
+
+//-----------------------------------------------------------
+#pragma mark - Reads
+//-----------------------------------------------------------
+
+- (void)fetchDatumWithKey:(NSString *)key
+                  success:(void (^)(AylaDatum *_Nullable datum))successBlock
+                  failure:(void (^)(NSError *error))failureBlock
+{
+    [self fetchDatumsWithKeys:@[ key ]
+                      success:^(NSDictionary<NSString *, AylaDatum *> *datums) {
+                          successBlock(datums[key]);
+                      }
+                      failure:failureBlock];
+}
+
+- (void)fetchDatumsWithKeys:(NSArray<NSString *> *)keys
+                    success:(void (^)(NSDictionary<NSString *, AylaDatum *> *datums))successBlock
+                    failure:(void (^)(NSError *error))failureBlock
+{
+    AYLAssert(successBlock, @"successBlock cannot be NULL!");
+    AYLAssert(failureBlock, @"failureBlock cannot be NULL!");
+
+    NSError *error;
+    for (NSString *key in keys) {
+        if (![AylaDatum datumKeyIsValid:key error:&error]) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                failureBlock(error);
+            });
+            return;
+        }
+    }
+
+    NSArray<NSString *> *requestedKeys = [[NSOrderedSet orderedSetWithArray:keys] array];
+    dispatch_async(self.processingQueue, ^{
+        NSMutableDictionary<NSString *, AylaDatum *> *datums = [NSMutableDictionary dictionary];
+        NSMutableArray<NSString *> *missingKeys = [NSMutableArray array];
+        for (NSString *key in requestedKeys) {
+            AylaDatumCacheEntry *entry = [self freshEntryWithKey:key];
+            if (entry) {
+                datums[key] = entry.datum;
+            }
+            else {
+                [missingKeys addObject:key];
+            }
+        }
+
+        AylaMetrics *metrics = [AylaMetrics sharedMetrics];
+        [metrics incrementCounter:AylaMetricsDatumCacheHits by:requestedKeys.count - missingKeys.count];
+        [metrics incrementCounter:AylaMetricsDatumCacheMisses by:missingKeys.count];
+
+        if (missingKeys.count == 0) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                successBlock(datums);
+            });
+            return;
+        }
+
+        __block NSUInteger remainingCount = missingKeys.count;
+        __block NSError *fetchError = nil;
+        for (NSString *key in missingKeys) {
+            [self addFetchWaiterForKey:key
+                                 block:^(AylaDatum *datum, NSError *error) {
+                                     datums[key] = datum;
+                                     fetchError = fetchError ?: error;
+                                     if (--remainingCount > 0) {
+                                         return;
+                                     }
+                                     NSError *anError = fetchError;
+                                     NSDictionary *result = [datums copy];
+                                     dispatch_async(dispatch_get_main_queue(), ^{
+                                         if (anError) {
+                                             failureBlock(anError);
+                                         }
+                                         else {
+                                             successBlock(result);
+                                         }
+                                     });
+                                 }];
+        }
+    });
+}
+
+- (AylaDatum *)cachedDatumWithKey:(NSString *)key
+{
+    __block AylaDatum *datum = nil;
+    dispatch_sync(self.processingQueue, ^{
+        datum = [self freshEntryWithKey:key].datum;
+    });
+    return datum;
+}
+
+/**
+ * @return The entry of a key if it is fresh or has a write pending, nil otherwise. Must be called on the processing
+ * queue.
+ */
+- (AylaDatumCacheEntry *)freshEntryWithKey:(NSString *)key
+{
+    AylaDatumCacheEntry *entry = self.entries[key];
+    if (!entry || [self hasWriteForKey:key]) {
+        return entry;
+    }
+    if (-[entry.date timeIntervalSinceNow] >= self.timeToLive) {
+        [self.entries removeObjectForKey:key];
+        return nil;
+    }
+    return entry;
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)addFetchWaiterForKey:(NSString *)key block:(AylaDatumCacheFetchWaiter)block
+{
+    NSMutableArray *waiters = self.fetchWaiters[key];
+    if (!waiters) {
+        // Keys already being fetched just wait for that fetch
+        waiters = [NSMutableArray array];
+        self.fetchWaiters[key] = waiters;
+        [self.pendingFetchKeys addObject:key];
+    }
+    [waiters addObject:[block copy]];
+
+    if (self.pendingFetchKeys.count > 0 && !self.fetchScheduled) {
+        self.fetchScheduled = YES;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.batchingInterval * NSEC_PER_SEC)),
+                       self.processingQueue,
+                       ^{
+                           [self sendPendingFetches];
+                       });
+    }
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)sendPendingFetches
+{
+    self.fetchScheduled = NO;
+    NSArray<NSString *> *keys = [self.pendingFetchKeys array];
+    [self.pendingFetchKeys removeAllObjects];
+
+    for (NSUInteger location = 0; location < keys.count; location += AylaDatumCacheMaxKeysPerFetch) {
+        NSRange range = NSMakeRange(location, MIN(AylaDatumCacheMaxKeysPerFetch, keys.count - location));
+        [self fetchKeys:[keys subarrayWithRange:range]];
+    }
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)fetchKeys:(NSArray<NSString *> *)keys
+{
+    NSError *error;
+    AylaHTTPClient *httpClient = self.httpClientBlock(&error);
+    if (!httpClient) {
+        [self completeFetchOfKeys:keys datums:nil generation:self.generation error:error ?: [self missingHTTPClientError]];
+        return;
+    }
+
+    AylaLogD([self logTag], 0, @"fetching %lu keys", (unsigned long)keys.count);
+    [[AylaMetrics sharedMetrics] incrementCounter:AylaMetricsDatumCacheRequests];
+
+    NSUInteger generation = self.generation;
+    [AylaDatum fetchDatumsWithKeys:keys
+        httpClient:httpClient
+        path:self.collectionPath
+        success:^(NSArray<AylaDatum *> *datums) {
+            dispatch_async(self.processingQueue, ^{
+                [self completeFetchOfKeys:keys datums:datums generation:generation error:nil];
+            });
+        }
+        failure:^(NSError *error) {
+            dispatch_async(self.processingQueue, ^{
+                // None of the keys exist
+                if (AylaDatumCacheIsNotFoundError(error)) {
+                    [self completeFetchOfKeys:keys datums:@[] generation:generation error:nil];
+                    return;
+                }
+                [self completeFetchOfKeys:keys datums:nil generation:generation error:error];
+            });
+        }];
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)completeFetchOfKeys:(NSArray<NSString *> *)keys
+                     datums:(NSArray<AylaDatum *> *)datums
+                 generation:(NSUInteger)generation
+                      error:(NSError *)error
+{
+    NSMutableDictionary<NSString *, AylaDatum *> *datumsByKey = [NSMutableDictionary dictionary];
+    for (AylaDatum *datum in datums) {
+        if (datum.key) {
+            datumsByKey[datum.key] = datum;
+        }
+    }
+
+    for (NSString *key in keys) {
+        AylaDatum *datum = datumsByKey[key];
+        if ([self hasWriteForKey:key]) {
+            // Keys with a write pending keep their local value
+            datum = self.entries[key].datum;
+        }
+        else if (!error && generation == self.generation) {
+            self.entries[key] = [AylaDatumCacheEntry entryWithDatum:datum];
+        }
+
+        NSArray<AylaDatumCacheFetchWaiter> *waiters = self.fetchWaiters[key];
+        [self.fetchWaiters removeObjectForKey:key];
+        for (AylaDatumCacheFetchWaiter waiter in waiters) {
+            waiter(datum, error);
+        }
+    }
+}
+
+//-----------------------------------------------------------
+#pragma mark - Writes
+//-----------------------------------------------------------
+
+- (void)updateDatumWithKey:(NSString *)key
+                   toValue:(NSString *)value
+                completion:(void (^)(NSError *error))completionBlock
+{
+    NSError *error;
+    if (![AylaDatum datumKeyIsValid:key error:&error] || ![AylaDatum datumValueIsValid:value error:&error]) {
+        if (completionBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock(error);
+            });
+        }
+        return;
+    }
+    [self queueWriteOfValue:value forKey:key completion:completionBlock];
+}
+
+- (void)deleteDatumWithKey:(NSString *)key completion:(void (^)(NSError *error))completionBlock
+{
+    NSError *error;
+    if (![AylaDatum datumKeyIsValid:key error:&error]) {
+        if (completionBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock(error);
+            });
+        }
+        return;
+    }
+    [self queueWriteOfValue:nil forKey:key completion:completionBlock];
+}
+
+- (void)queueWriteOfValue:(NSString *)value forKey:(NSString *)key completion:(void (^)(NSError *error))completionBlock
+{
+    dispatch_async(self.processingQueue, ^{
+        // Reads see the value right away
+        AylaDatum *datum = nil;
+        if (value) {
+            datum = [[AylaDatum alloc] initWithJSONDictionary:@{ @"datum" : @{ @"key" : key, @"value" : value } }
+                                                        error:nil];
+        }
+        self.entries[key] = [AylaDatumCacheEntry entryWithDatum:datum];
+
+        // Coalesce with the write of the key which has not been sent yet
+        AylaDatumCacheWrite *write = self.pendingWrites[key];
+        if (!write) {
+            write = [[AylaDatumCacheWrite alloc] init];
+            self.pendingWrites[key] = write;
+        }
+        write.value = value;
+        if (completionBlock) {
+            [write.completionBlocks addObject:[completionBlock copy]];
+        }
+
+        [self scheduleWrites];
+    });
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (BOOL)hasWriteForKey:(NSString *)key
+{
+    return self.pendingWrites[key] != nil || [self.writingKeys containsObject:key];
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)scheduleWrites
+{
+    if (self.writeScheduled) {
+        return;
+    }
+    self.writeScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.writeDelay * NSEC_PER_SEC)), self.processingQueue, ^{
+        if (self.writeScheduled) {
+            [self sendPendingWrites];
+        }
+    });
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)sendPendingWrites
+{
+    self.writeScheduled = NO;
+    for (NSString *key in self.pendingWrites.allKeys) {
+        // Writes of a key are sent in order, the next one once the current one completes
+        if ([self.writingKeys containsObject:key]) {
+            continue;
+        }
+        AylaDatumCacheWrite *write = self.pendingWrites[key];
+        [self.pendingWrites removeObjectForKey:key];
+        [self.writingKeys addObject:key];
+        write.resetCount = self.resetCount;
+        [self sendWrite:write forKey:key];
+    }
+    [self notifyFlushWaitersIfIdle];
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)sendWrite:(AylaDatumCacheWrite *)write forKey:(NSString *)key
+{
+    NSError *error;
+    AylaHTTPClient *httpClient = self.httpClientBlock(&error);
+    if (!httpClient) {
+        [self completeWrite:write forKey:key datum:nil error:error ?: [self missingHTTPClientError]];
+        return;
+    }
+
+    void (^successBlock)(AylaDatum *) = ^(AylaDatum *datum) {
+        dispatch_async(self.processingQueue, ^{
+            [self completeWrite:write forKey:key datum:datum error:nil];
+        });
+    };
+    void (^failureBlock)(NSError *) = ^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self completeWrite:write forKey:key datum:nil error:error];
+        });
+    };
+
+    NSString *path = [self pathOfKey:key];
+    if (!write.value) {
+        [AylaDatum deleteKey:key
+            httpClient:httpClient
+            path:path
+            success:^{
+                successBlock(nil);
+            }
+            failure:^(NSError *error) {
+                // Already deleted
+                if (AylaDatumCacheIsNotFoundError(error)) {
+                    successBlock(nil);
+                    return;
+                }
+                failureBlock(error);
+            }];
+        return;
+    }
+
+    void (^create)(void) = ^{
+        [AylaDatum createDatumWithKey:key
+                                value:write.value
+                           httpClient:httpClient
+                                 path:self.collectionPath
+                              success:successBlock
+                              failure:failureBlock];
+    };
+
+    // The entry of the key was replaced by the write, so only the cloud tells whether the datum exists
+    [AylaDatum updateKey:key
+        toValue:write.value
+        httpClient:httpClient
+        path:path
+        success:successBlock
+        failure:^(NSError *error) {
+            if (AylaDatumCacheIsNotFoundError(error)) {
+                create();
+                return;
+            }
+            failureBlock(error);
+        }];
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)completeWrite:(AylaDatumCacheWrite *)write forKey:(NSString *)key datum:(AylaDatum *)datum error:(NSError *)error
+{
+    // Writes sent before a reset only report to their callers
+    if (write.resetCount == self.resetCount) {
+        [self.writingKeys removeObject:key];
+
+        if (!self.pendingWrites[key]) {
+            if (error) {
+                // The local value may not match the cloud any more
+                [self.entries removeObjectForKey:key];
+            }
+            else if (!write.value || datum) {
+                self.entries[key] = [AylaDatumCacheEntry entryWithDatum:datum];
+            }
+        }
+        else {
+            [self scheduleWrites];
+        }
+    }
+
+    if (error) {
+        AylaLogW([self logTag], 0, @"failed to write %@: %ld", key, (long)error.code);
+    }
+    NSArray<AylaDatumCacheWriteCompletion> *completionBlocks = [write.completionBlocks copy];
+    if (completionBlocks.count > 0) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            for (AylaDatumCacheWriteCompletion completionBlock in completionBlocks) {
+                completionBlock(error);
+            }
+        });
+    }
+
+    [self notifyFlushWaitersIfIdle];
+}
+
+- (void)flushWithCompletion:(void (^)(void))completionBlock
+{
+    dispatch_async(self.processingQueue, ^{
+        if (completionBlock) {
+            [self.flushWaiters addObject:[completionBlock copy]];
+        }
+        [self sendPendingWrites];
+    });
+}
+
+/**
+ * Must be called on the processing queue.
+ */
+- (void)notifyFlushWaitersIfIdle
+{
+    if (self.flushWaiters.count == 0 || self.writingKeys.count > 0) {
+        return;
+    }
+    // Writes queued after the flush are left for the next one
+    NSArray *flushWaiters = [self.flushWaiters copy];
+    [self.flushWaiters removeAllObjects];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        for (void (^flushWaiter)(void) in flushWaiters) {
+            flushWaiter();
+        }
+    });
+}
+
+//-----------------------------------------------------------
+#pragma mark - Invalidation
+//-----------------------------------------------------------
+
+- (void)invalidateDatumWithKey:(NSString *)key
+{
+    dispatch_async(self.processingQueue, ^{
+        self.generation++;
+        if (![self hasWriteForKey:key]) {
+            [self.entries removeObjectForKey:key];
+        }
+    });
+}
+
+- (void)invalidateAll
+{
+    dispatch_async(self.processingQueue, ^{
+        self.generation++;
+        for (NSString *key in self.entries.allKeys) {
+            if (![self hasWriteForKey:key]) {
+                [self.entries removeObjectForKey:key];
+            }
+        }
+    });
+}
+
+- (void)reset
+{
+    dispatch_async(self.processingQueue, ^{
+        self.generation++;
+        self.resetCount++;
+        self.writeScheduled = NO;
+        [self.entries removeAllObjects];
+        [self.writingKeys removeAllObjects];
+
+        NSError *error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                                    code:AylaRequestErrorCodeCancelled
+                                                userInfo:nil];
+        NSMutableArray<AylaDatumCacheWriteCompletion> *completionBlocks = [NSMutableArray array];
+        for (AylaDatumCacheWrite *write in self.pendingWrites.allValues) {
+            [completionBlocks addObjectsFromArray:write.completionBlocks];
+        }
+        [self.pendingWrites removeAllObjects];
+        if (completionBlocks.count > 0) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                for (AylaDatumCacheWriteCompletion completionBlock in completionBlocks) {
+                    completionBlock(error);
+                }
+            });
+        }
+        [self notifyFlushWaitersIfIdle];
+    });
+}
+
+//-----------------------------------------------------------
+#pragma mark - Utilities
+//-----------------------------------------------------------
+
+/**
+ * @return Error passed on when the http client block returns neither a client nor an error.
+ */
+- (NSError *)missingHTTPClientError
+{
+    return [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                      code:AylaRequestErrorCodePreconditionFailure
+                                  userInfo:@{AylaHTTPClientTag : AylaErrorDescriptionCanNotBeFound}];
+}
+
+/**
+ * @return Service path of a single datum, e.g. `dsns/<dsn>/data/<key>.json` for `dsns/<dsn>/data.json`.
+ */
+- (NSString *)pathOfKey:(NSString *)key
+{
+    return [NSString stringWithFormat:@"%@/%@.json", [self.collectionPath stringByDeletingPathExtension], key];
+}
+
+- (NSString *)logTag
+{
+    return @"DatumCache";
+}
+
+@end
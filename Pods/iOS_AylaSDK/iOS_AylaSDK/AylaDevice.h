@@ -15,10 +15,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class AylaChange;
 @class AylaDatum;
+@class AylaDatumCache;
 @class AylaDevice;
 @class AylaDeviceManager;
 @class AylaDeviceNotification;
 @class AylaGrant;
+@class AylaPollDecision;
 @class AylaProperty;
 @class AylaSchedule;
 @class AylaTimeZone;
@@ -136,16 +138,32 @@ NS_ASSUME_NONNULL_BEGIN
 /** If tracking is active for the device */
 @property(nonatomic, readonly) BOOL isTracking;
 
+/** Last decision of the poll policy of the device manager for this device, see
+ * `-[AylaDeviceManager pollPolicy]` */
+@property(atomic, readonly, nullable) AylaPollDecision *lastPollDecision;
+
 /** Whether LAN mode is currently permitted for this device. */
 @property(nonatomic, readwrite) BOOL lanModePermitted;
 
 /** The grant for this device, if one is present. */
 @property(nonatomic, readonly, nullable) AylaGrant *grant;
 
+/** Cache of the datums of this device, see `AylaDatumCache`. Created on first
+ * access. */
+@property(nonatomic, readonly) AylaDatumCache *datumCache;
+
 /** The DataSource representing the service used to last update this device
  * status. */
 @property(nonatomic, assign, readonly) AylaDataSource lastUpdateSource;
 
+/**
+ * Returns an immutable snapshot of the device, properties included, made by copying its fields. A snapshot is not
+ * managed by the device manager, has no LAN session and is not updated afterwards. `copy` returns a snapshot too.
+ *
+ * @return Snapshot of the device.
+ */
+- (instancetype)snapshot;
+
 /**
  * Requests a factory reset of the device. If successful, the device will be reset.
  *
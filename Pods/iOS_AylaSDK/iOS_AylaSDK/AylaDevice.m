@@ -7,7 +7,9 @@
 #import "AylaCache+Internal.h"
 #import "AylaConnectTask.h"
 #import "AylaDatapoint+Internal.h"
+#import "AylaDatapointOutbox.h"
 #import "AylaDatum+Internal.h"
+#import "AylaDatumCache+Internal.h"
 #import "AylaDevice+Internal.h"
 #import "AylaDeviceChange.h"
 #import "AylaDeviceConnection.h"
@@ -24,8 +26,10 @@
 #import "AylaLanModule.h"
 #import "AylaLanTask.h"
 #import "AylaListenerArray.h"
+#import "AylaMetrics.h"
 #import "AylaNetworks+Internal.h"
 #import "AylaObject+Internal.h"
+#import "AylaPollPolicy.h"
 #import "AylaProperty+Internal.h"
 #import "AylaPropertyChange.h"
 #import "AylaSchedule+Internal.h"
@@ -33,6 +37,7 @@
 #import "AylaSystemUtils.h"
 #import "AylaTimeZone.h"
 #import "AylaTimer.h"
+#import "AylaTracer.h"
 #import "NSObject+Ayla.h"
 
 static NSString *const attrNameConnectionStatus = @"connection_status";
@@ -60,6 +65,13 @@ static NSString *const AylaNodeTypeLocal = @"Local";
 static const NSUInteger DEFAULT_POLL_INTERVAL_MS = 5000;
 static const NSUInteger DEFAULT_POLL_LEEWAY_MS = 1000;
 
+/**
+ * Returns the time elapsed since an event, DBL_MAX if the event never happened.
+ */
+static NSTimeInterval time_since(CFAbsoluteTime time) {
+  return time > 0 ? CFAbsoluteTimeGetCurrent() - time : DBL_MAX;
+}
+
 static dispatch_queue_t device_processing_queue() {
   static dispatch_queue_t device_processing_queue;
   static dispatch_once_t onceToken;
@@ -70,10 +82,55 @@ static dispatch_queue_t device_processing_queue() {
   return device_processing_queue;
 }
 
+/**
+ * Concurrent pool the processing queues of devices target, so independent
+ * devices are processed in parallel on as many threads as GCD sees fit for the
+ * available cores.
+ */
+static dispatch_queue_t device_processing_pool() {
+  static dispatch_queue_t device_processing_pool;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    device_processing_pool = dispatch_queue_create(
+        "com.aylanetworks.device.queue.pool", DISPATCH_QUEUE_CONCURRENT);
+  });
+  return device_processing_pool;
+}
+
+/**
+ * Returns the serial processing queue of a context, created on first use. Queues
+ * are held weakly and released with the last device using them.
+ */
+static dispatch_queue_t device_processing_queue_for_context(NSString *context) {
+  if (!context) {
+    return device_processing_queue();
+  }
+
+  static NSMapTable<NSString *, dispatch_queue_t> *queues;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    queues = [NSMapTable strongToWeakObjectsMapTable];
+  });
+
+  @synchronized(queues) {
+    dispatch_queue_t queue = [queues objectForKey:context];
+    if (!queue) {
+      NSString *label = [NSString
+          stringWithFormat:@"com.aylanetworks.device.queue.processing.%@",
+                           context];
+      queue = dispatch_queue_create(label.UTF8String, DISPATCH_QUEUE_SERIAL);
+      dispatch_set_target_queue(queue, device_processing_pool());
+      [queues setObject:queue forKey:context];
+    }
+    return queue;
+  }
+}
+
 @interface AylaDevice () <AylaLanModuleInternalDelegate,
                           AylaPropertyInternalDelegate>
 {
     BOOL _disableLANUntilNetworkChanges;
+    dispatch_queue_t _processingQueue;
 }
 
 @property(nonatomic, readwrite, nullable) NSNumber *key;
@@ -106,6 +163,14 @@ static dispatch_queue_t device_processing_queue() {
 @property(nonatomic, readwrite) AylaListenerArray *listeners;
 @property(nonatomic, readwrite) AylaTimer *timer;
 
+@property(atomic, readwrite, nullable) AylaPollDecision *lastPollDecision;
+
+/** Time a property of the device last changed at */
+@property(atomic, assign) CFAbsoluteTime lastChangeTime;
+
+/** Time the app last created a datapoint on the device at */
+@property(atomic, assign) CFAbsoluteTime lastUserWriteTime;
+
 @property(nonatomic, readwrite) AylaDataSource lastUpdateSource;
 
 /** Lan Module of current device */
@@ -113,6 +178,8 @@ static dispatch_queue_t device_processing_queue() {
 
 @property(nonatomic, strong, nullable) AylaGrant *grant;
 
+@property(nonatomic, strong, nullable) AylaDatumCache *datumCache;
+
 @end
 
 @implementation AylaDevice
@@ -166,6 +233,62 @@ static dispatch_queue_t device_processing_queue() {
     return self;
 }
 
+- (instancetype)snapshot {
+  return [self copy];
+}
+
+- (instancetype)initSnapshot {
+  // Runs the init chain of the class with no fields, which sets up the state
+  // every device has. The fields are copied over by copyFieldsToSnapshot:.
+  return [self initWithJSONDictionary:@{} error:nil];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+  AylaDevice *snapshot = [[self.class allocWithZone:zone] initSnapshot];
+  [self copyFieldsToSnapshot:snapshot];
+  return snapshot;
+}
+
+- (void)copyFieldsToSnapshot:(AylaDevice *)snapshot {
+  // Fields are assigned directly, setters with side effects must not run on a
+  // snapshot.
+  snapshot->_key = _key;
+  snapshot->_productName = _productName;
+  snapshot->_model = _model;
+  snapshot->_dsn = _dsn;
+  snapshot->_oemModel = _oemModel;
+  snapshot->_deviceType = _deviceType;
+  snapshot->_connectedAt = _connectedAt;
+  snapshot->_mac = _mac;
+  snapshot->_lanIp = _lanIp;
+  snapshot->_swVersion = _swVersion;
+  snapshot->_ssid = _ssid;
+  snapshot->_productClass = _productClass;
+  snapshot->_ip = _ip;
+  snapshot->_lanEnabled = _lanEnabled;
+  snapshot->_connectionStatus = _connectionStatus;
+  snapshot->_templateId = _templateId;
+  snapshot->_lat = _lat;
+  snapshot->_lng = _lng;
+  snapshot->_userId = _userId;
+  snapshot->_moduleUpdatedAt = _moduleUpdatedAt;
+  snapshot->_grant = _grant;
+  snapshot->_lanModePermitted = _lanModePermitted;
+  snapshot->_disableLANUntilNetworkChanges = _disableLANUntilNetworkChanges;
+  snapshot->_lastUpdateSource = _lastUpdateSource;
+
+  NSDictionary *properties = self.properties;
+  NSMutableDictionary *propertySnapshots =
+      [NSMutableDictionary dictionaryWithCapacity:properties.count];
+  for (NSString *name in properties) {
+    AylaProperty *propertySnapshot = [properties[name] copy];
+    propertySnapshot.device = snapshot;
+    propertySnapshots[name] = propertySnapshot;
+  }
+  snapshot->_mutableProperties = propertySnapshots;
+  snapshot->_properties = [propertySnapshots copy];
+}
+
 - (NSDictionary *)toJSONDictionary {
     NSDateFormatter *timeFormater = [AylaSystemUtils defaultDateFormatter];
     NSMutableDictionary *jsonDictionary = [NSMutableDictionary dictionary];
@@ -243,7 +366,11 @@ static dispatch_queue_t device_processing_queue() {
         return;
     }
     self.connectionStatus = deviceConnection.status;
-    AylaDeviceChange *change = [[AylaDeviceChange alloc] initWithChangedFields:[NSSet setWithObject:NSStringFromSelector(@selector(connectionStatus))]];
+    self.lastUpdateSource = dataSource;
+
+    // Listeners are notified asynchronously, hand them the status the device had when the change happened.
+    AylaDeviceChange *change = [[AylaDeviceChange alloc] initWithDevice:[self snapshot]
+                                                          changedFields:[NSSet setWithObject:NSStringFromSelector(@selector(connectionStatus))]];
     
     [self notifyChangesToListeners:@[ change ]];
 }
@@ -385,7 +512,7 @@ static dispatch_queue_t device_processing_queue() {
           attrNameProductName : newName
         }
                                                                   error:nil];
-        dispatch_async(device_processing_queue(), ^{
+        dispatch_async(self.processingQueue, ^{
           [self updateFrom:device dataSource:AylaDataSourceCloud];
           dispatch_async(dispatch_get_main_queue(), ^{
             successBlock();
@@ -434,19 +561,49 @@ fetchProperties:(NSArray *)propertyNames
     }
   }
 
-  // Check lan active status and property list to determine if request could be
-  // sent through lan.
-  if ([self.lanModule isActive] && propertyNames.count &&
-      allLanEnabledProperties) {
-    return [self fetchPropertiesLAN:propertyNames
-                            success:successBlock
-                            failure:failureBlock];
-  } else {
-    // Otherwise, redirect request to cloud
-    return [self fetchPropertiesCloud:propertyNames
-                              success:successBlock
-                              failure:failureBlock];
-  }
+  AylaTracer *tracer = [AylaTracer sharedTracer];
+  NSString *traceId = [tracer beginTraceWithName:@"fetchProperties"];
+  CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+  NSDictionary *details = @{ @"dsn" : self.dsn ?: @"" };
+  void (^tracedSuccessBlock)(NSArray *) = ^(NSArray *properties) {
+    [tracer recordSpanWithName:@"fetchProperties"
+                      category:@"operation"
+                       traceId:traceId
+                     startTime:startTime
+                       details:details];
+    successBlock(properties);
+  };
+  void (^tracedFailureBlock)(NSError *) = ^(NSError *error) {
+    [tracer recordSpanWithName:@"fetchProperties"
+                      category:@"operation"
+                       traceId:traceId
+                     startTime:startTime
+                       details:details];
+    failureBlock(error);
+  };
+
+  __block AylaConnectTask *task;
+  [tracer performInTrace:traceId
+                   block:^{
+                     // Check lan active status and property list to determine
+                     // if request could be sent through lan.
+                     if ([self.lanModule isActive] && propertyNames.count &&
+                         allLanEnabledProperties) {
+                       [[AylaMetrics sharedMetrics]
+                           incrementCounter:@"routing.fetchProperties.lan"];
+                       task = [self fetchPropertiesLAN:propertyNames
+                                               success:tracedSuccessBlock
+                                               failure:tracedFailureBlock];
+                     } else {
+                       // Otherwise, redirect request to cloud
+                       [[AylaMetrics sharedMetrics]
+                           incrementCounter:@"routing.fetchProperties.cloud"];
+                       task = [self fetchPropertiesCloud:propertyNames
+                                                 success:tracedSuccessBlock
+                                                 failure:tracedFailureBlock];
+                     }
+                   }];
+  return task;
 }
 
 - (AylaHTTPTask *)fetchPropertiesCloud:(NSArray *)propertyNames
@@ -475,7 +632,7 @@ fetchProperties:(NSArray *)propertyNames
       parameters:params
       success:^(AylaHTTPTask *task, id _Nullable responseObject) {
         // Swith to device processing queue
-        dispatch_async(device_processing_queue(), ^{
+        dispatch_async(self.processingQueue, ^{
           NSMutableArray *properties = [NSMutableArray array];
           NSError *error;
           for (NSDictionary *propertyInJson in responseObject) {
@@ -714,7 +871,21 @@ fetchProperties:(NSArray *)propertyNames
 }
 
 - (dispatch_queue_t)processingQueueForProperty:(AylaProperty *)property {
-  return device_processing_queue();
+  return self.processingQueue;
+}
+
+- (dispatch_queue_t)processingQueue {
+  @synchronized(self) {
+    if (!_processingQueue) {
+      _processingQueue =
+          device_processing_queue_for_context([self processingContext]);
+    }
+    return _processingQueue;
+  }
+}
+
+- (NSString *)processingContext {
+  return self.dsn;
 }
 
 - (void)shutDown {
@@ -946,11 +1117,14 @@ createAylaDatumWithKey:(NSString *)key
   NSString *path = [NSString stringWithFormat:@"dsns/%@/data.json", self.dsn];
 
   return [AylaDatum createDatumWithKey:key
-                                 value:value
-                            httpClient:httpClient
-                                  path:path
-                               success:successBlock
-                               failure:failureBlock];
+      value:value
+      httpClient:httpClient
+      path:path
+      success:^(AylaDatum *createdDatum) {
+        [self invalidateCachedDatumWithKey:key];
+        successBlock(createdDatum);
+      }
+      failure:failureBlock];
 }
 
 - (nullable AylaHTTPTask *)
@@ -1061,11 +1235,14 @@ updateAylaDatumWithKey:(NSString *)key
       [NSString stringWithFormat:@"dsns/%@/data/%@.json", self.dsn, key];
 
   return [AylaDatum updateKey:key
-                      toValue:value
-                   httpClient:httpClient
-                         path:path
-                      success:successBlock
-                      failure:failureBlock];
+      toValue:value
+      httpClient:httpClient
+      path:path
+      success:^(AylaDatum *updatedDatum) {
+        [self invalidateCachedDatumWithKey:key];
+        successBlock(updatedDatum);
+      }
+      failure:failureBlock];
 }
 
 - (nullable AylaHTTPTask *)deleteAylaDatumWithKey:(NSString *)key
@@ -1088,10 +1265,40 @@ updateAylaDatumWithKey:(NSString *)key
       [NSString stringWithFormat:@"dsns/%@/data/%@.json", self.dsn, key];
 
   return [AylaDatum deleteKey:key
-                   httpClient:httpClient
-                         path:path
-                      success:successBlock
-                      failure:failureBlock];
+      httpClient:httpClient
+      path:path
+      success:^{
+        [self invalidateCachedDatumWithKey:key];
+        successBlock();
+      }
+      failure:failureBlock];
+}
+
+- (AylaDatumCache *)datumCache {
+  @synchronized(self) {
+    if (!_datumCache) {
+      __weak typeof(self) weakSelf = self;
+      NSString *path = [NSString stringWithFormat:@"dsns/%@/data.json", self.dsn];
+      _datumCache = [[AylaDatumCache alloc]
+          initWithCollectionPath:path
+                 httpClientBlock:^AylaHTTPClient *(NSError **error) {
+                   return [weakSelf getHttpClient:error];
+                 }];
+    }
+    return _datumCache;
+  }
+}
+
+/**
+ * Keeps the datum cache, if it has been created, consistent with datums
+ * written through the non cached methods.
+ */
+- (void)invalidateCachedDatumWithKey:(NSString *)key {
+  AylaDatumCache *datumCache;
+  @synchronized(self) {
+    datumCache = _datumCache;
+  }
+  [datumCache invalidateDatumWithKey:key];
 }
 
 //-----------------------------------------------------------
@@ -1618,7 +1825,7 @@ didReceiveMessage:(AylaLanMessage *)message {
                                              dataSource:AylaDataSourceLAN
                                                   error:&error];
 
-      dispatch_async(device_processing_queue(), ^{
+      dispatch_async(self.processingQueue, ^{
         AylaPropertyChange *propertyChange =
             [property updateFromDatapoint:datapoint];
         if (propertyChange) {
@@ -1654,12 +1861,17 @@ didReceiveMessage:(AylaLanMessage *)message {
     self.timer =
         [[AylaTimer alloc] initWithTimeInterval:DEFAULT_POLL_INTERVAL_MS
                                          leeway:DEFAULT_POLL_LEEWAY_MS
-                                          queue:device_processing_queue()
+                                          queue:self.processingQueue
                                     handleBlock:^(AylaTimer *timer) {
                                       [weakSelf processPolling];
                                     }];
   }
 
+  // Devices are not idle as soon as they start being tracked
+  if (self.lastChangeTime == 0) {
+    self.lastChangeTime = CFAbsoluteTimeGetCurrent();
+  }
+
   // Set tracking as YES
   self.tracking = YES;
 
@@ -1672,8 +1884,10 @@ didReceiveMessage:(AylaLanMessage *)message {
 }
 
 - (void)adjustPollingBasedOnPermitAndStatus {
-  // Only enable polling session when preconditions are satisfied
-  if (!self.lanModule.isActive && self.isTracking && ![self isDSAvailable]) {
+  // Only enable polling session when preconditions are satisfied. The timer
+  // keeps running while DSS is connected, the poll policy skips polls as long
+  // as the stream is healthy.
+  if (!self.lanModule.isActive && self.isTracking) {
     AylaLogD([self logTag], 0, @"%@, Adjust polling(on) %d%d%d", self.dsn,
              self.lanModule.isActive, self.isTracking, [self isDSAvailable]);
     [self enablePolling];
@@ -1685,7 +1899,79 @@ didReceiveMessage:(AylaLanMessage *)message {
   }
 }
 
+/**
+ * Asks the poll policy of the device manager whether the device must be polled
+ * now, and adjusts the poll interval to its decision.
+ */
+- (AylaPollDecision *)refreshPollDecision {
+  AylaDeviceManager *deviceManager = self.deviceManager;
+  id<AylaPollPolicy> policy = deviceManager.pollPolicy;
+  AylaDSManager *dssManager = deviceManager.sessionManager.dssManager;
+
+  AylaPollDecision *decision;
+  if (policy) {
+    AylaPollContext *context = [[AylaPollContext alloc]
+        initWithDSSConnected:[self isDSAvailable]
+             dssCoversDevice:self.dsn && [dssManager isSubscribedToDeviceWithDsn:self.dsn]
+        timeSinceDSSActivity:time_since(dssManager.lastActivityTime)
+         timeSinceLastChange:time_since(self.lastChangeTime)
+      timeSinceLastUserWrite:time_since(self.lastUserWriteTime)
+             currentInterval:self.timer.timeIntervalMs / 1000];
+    decision = [policy pollDecisionForDevice:self context:context];
+  }
+  if (!decision) {
+    decision = [AylaPollDecision decisionToPoll:YES
+                                       interval:DEFAULT_POLL_INTERVAL_MS / 1000.
+                                         reason:AylaPollReasonDefault];
+  }
+
+  AylaPollDecision *lastDecision = self.lastPollDecision;
+  if (lastDecision.shouldPoll != decision.shouldPoll ||
+      lastDecision.interval != decision.interval) {
+    AylaLogD([self logTag], 0, @"%@, poll decision %@", self.dsn, decision);
+  }
+  self.lastPollDecision = decision;
+  [self adjustPollIntervalTo:decision.interval];
+  return decision;
+}
+
+/**
+ * Restarts the poll timer with a new interval, the next tick happens one
+ * interval from now.
+ */
+- (void)adjustPollIntervalTo:(NSTimeInterval)interval {
+  NSTimeInterval intervalMs = MAX(interval * 1000, DEFAULT_POLL_LEEWAY_MS);
+  if (!self.timer.isPolling || self.timer.timeIntervalMs == intervalMs) {
+    return;
+  }
+  __weak typeof(self) weakSelf = self;
+  [self.timer stopPolling];
+  [self.timer refreshWithTimeInterval:intervalMs
+                               leeway:DEFAULT_POLL_LEEWAY_MS
+                          handleBlock:^(AylaTimer *timer) {
+                            [weakSelf processPolling];
+                          }];
+  [self.timer startPollingWithDelay:YES];
+}
+
+- (void)recordUserWrite {
+  self.lastUserWriteTime = CFAbsoluteTimeGetCurrent();
+  dispatch_async(self.processingQueue, ^{
+    [self refreshPollDecision];
+  });
+}
+
 - (void)processPolling {
+  AylaPollDecision *decision = [self refreshPollDecision];
+  NSString *counter = [NSString
+      stringWithFormat:@"poll.%@.%@",
+                       decision.shouldPoll ? @"performed" : @"skipped",
+                       decision.reason];
+  [[AylaMetrics sharedMetrics] incrementCounter:counter];
+  if (!decision.shouldPoll) {
+    return;
+  }
+
   [self fetchProperties:[self.deviceManager.deviceDetailProvider
                             monitoredPropertyNamesForDevice:self]
       success:^(NSArray AYLA_GENERIC(AylaProperty *) * properties) {
@@ -1729,9 +2015,11 @@ didReceiveMessage:(AylaLanMessage *)message {
  */
 - (void)dataSourceChanged:(AylaDataSource)dataSource {
   BOOL fetchProperties = NO;
-  // If lan mode becomes active, fetch properties once.
+  // If lan mode becomes active, fetch properties once and deliver datapoints
+  // queued while the device could not be reached.
   if (dataSource == AylaDataSourceLAN && self.lanModule.isActive) {
     fetchProperties = YES;
+    [self.deviceManager.datapointOutbox replay];
   }
 
   // Notify listener if this is a lan state update.
@@ -1830,6 +2118,7 @@ didReceiveMessage:(AylaLanMessage *)message {
 
 - (void)notifyChangesToListeners:(NSArray *)changes {
   if (changes.count > 0) {
+    self.lastChangeTime = CFAbsoluteTimeGetCurrent();
     [self.listeners
         iterateListenersRespondingToSelector:@selector(device:didObserveChange:)
                                 asyncOnQueue:dispatch_get_main_queue()
@@ -22,6 +22,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSArray *)monitoredPropertyNamesForDevice:(AylaDevice *)device;
 
+@optional
+
+/**
+ * @param device The `AylaDevice` about to be set up by the `AylaDeviceManager`.
+ * @return YES if the device should be set up before the other ones, e.g. because it is visible or a favorite in the
+ * app.
+ */
+- (BOOL)shouldPrioritizeSetupOfDevice:(AylaDevice *)device;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,11 +7,13 @@
 #import <Foundation/Foundation.h>
 #import "AylaDefines.h"
 #import "AylaDeviceDetailProvider.h"
+#import "AylaPollPolicy.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class AylaDatapointBatchRequest;
 @class AylaDatapointBatchResponse;
+@class AylaDatapointOutbox;
 @class AylaDevice;
 @class AylaDeviceListChange;
 @class AylaDeviceManager;
@@ -100,6 +102,24 @@ typedef NS_ENUM(uint16_t, AylaDeviceManagerState) {
 - (void)deviceManager:(AylaDeviceManager *)deviceManager
     deviceManagerStateChanged:(AylaDeviceManagerState)oldState
                      newState:(AylaDeviceManagerState)newState;
+
+@optional
+
+/**
+ * Called each time a device has been set up while the `AylaDeviceManager` is fetching device properties, to report
+ * the progress of the initialization.
+ *
+ * @param deviceManager  The `AylaDeviceManager` instance being initialized
+ * @param device         The device which has been set up
+ * @param error          The error which caused the setup of the device to fail, nil if it succeeded
+ * @param completedCount Number of devices set up so far
+ * @param totalCount     Number of devices to set up
+ */
+- (void)deviceManager:(AylaDeviceManager *)deviceManager
+       didSetupDevice:(AylaDevice *)device
+                error:(nullable NSError *)error
+       completedCount:(NSUInteger)completedCount
+           totalCount:(NSUInteger)totalCount;
 @end
 
 /** `AylaDeviceManager` is the primary organizer of device data.
@@ -150,6 +170,33 @@ typedef NS_ENUM(uint16_t, AylaDeviceManagerState) {
  */
 @property (nonatomic, readonly, getter=isCachedDeviceList) BOOL cachedDeviceList;
 
+/**
+ * Maximum number of devices set up at the same time while fetching device properties. Devices are set up in the
+ * order of the device list, prioritized ones first, see `prioritizeSetupOfDevicesWithDsns:`. Defaults to 4.
+ */
+@property (atomic, assign) NSUInteger maxConcurrentDeviceSetups;
+
+/**
+ * YES if properties are only fetched, and devices tracked, while the app shows them, see
+ * `-[AylaSystemSettings lazyDevicePropertyHydration]` and `setVisibleDeviceDsns:`.
+ */
+@property (nonatomic, readonly) BOOL lazyPropertyHydration;
+
+/**
+ * Policy deciding when tracked devices are polled, an `AylaAdaptivePollPolicy` by default. Use `pollDecisions` to
+ * check what it decided.
+ */
+@property (atomic, strong) id<AylaPollPolicy> pollPolicy;
+
+/**
+ * Outbox of datapoints waiting for a path to the cloud or to their device, nil unless
+ * `-[AylaSystemSettings datapointOutboxEnabled]` is set.
+ */
+@property (nonatomic, strong, readonly, nullable) AylaDatapointOutbox *datapointOutbox;
+
+/** DSNs of the devices the app currently shows */
+@property (atomic, copy, readonly) NSSet AYLA_GENERIC(NSString *) *visibleDeviceDsns;
+
 /** @name Listener Methods */
 
 /** Add a listener which conforms to the `AylaDeviceManagerListener` protocol 
@@ -164,6 +211,28 @@ typedef NS_ENUM(uint16_t, AylaDeviceManagerState) {
  */
 - (void)removeListener:(id<AylaDeviceManagerListener>)listener;
 
+/**
+ * Sets up the given devices before the other ones still waiting to be set up, e.g. the devices visible in the app.
+ * Devices can also be prioritized from the start with `-[AylaDeviceDetailProvider shouldPrioritizeSetupOfDevice:]`.
+ *
+ * @param dsns DSNs of the devices to prioritize
+ */
+- (void)prioritizeSetupOfDevicesWithDsns:(NSArray AYLA_GENERIC(NSString *) *)dsns;
+
+/**
+ * Declares the devices the app currently shows. Visible devices are set up first. With `lazyPropertyHydration`,
+ * properties of a device are fetched and the device is tracked once it becomes visible, and it stops being tracked
+ * when it has not been visible for `-[AylaSystemSettings deviceInterestGracePeriod]`.
+ *
+ * @param dsns DSNs of the visible devices, replacing the ones set before
+ */
+- (void)setVisibleDeviceDsns:(NSSet AYLA_GENERIC(NSString *) *)dsns;
+
+/**
+ * @return Last poll decision of each tracked device, keyed by dsn
+ */
+- (NSDictionary AYLA_GENERIC(NSString *, AylaPollDecision *) *)pollDecisions;
+
 /** @name Fetch Device Method */
 
 /**
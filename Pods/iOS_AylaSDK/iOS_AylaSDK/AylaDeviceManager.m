@@ -7,6 +7,7 @@
 #import "AylaCache+Internal.h"
 #import "AylaDatapointBatchRequest.h"
 #import "AylaDatapointBatchResponse.h"
+#import "AylaDatapointOutbox+Internal.h"
 #import "AylaDefines_Internal.h"
 #import "AylaDevice+Internal.h"
 #import "AylaDeviceGateway.h"
@@ -18,10 +19,12 @@
 #import "AylaListenerArray.h"
 #import "AylaNetworks+Internal.h"
 #import "AylaObject+Internal.h"
+#import "AylaProfiler.h"
 #import "AylaProperty+Internal.h"
 #import "AylaRegistration+Internal.h"
 #import "AylaSessionManager+Internal.h"
 #import "AylaSystemSettings.h"
+#import "AylaSystemUtils.h"
 #import "AylaTimer.h"
 #import "AylaAlertHistory.h"
 
@@ -45,11 +48,23 @@ static const NSInteger DEFAULT_POLL_LEEEWAY_MS = 1000;
 /** Default Lan server port number */
 static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 
+/** Default number of devices set up at the same time */
+static const NSUInteger DEFAULT_MAX_CONCURRENT_DEVICE_SETUPS = 4;
+
+/** Name of the file the datapoint outbox is persisted to */
+static NSString *const DATAPOINT_OUTBOX_FILE_NAME = @"datapointOutbox.json";
+
 @interface AylaDeviceManager () <AylaConnectivityListener>
 
-/** Mutable Device List */
+/** Mutable Device List, only accessed while holding `lock` */
 @property (nonatomic, strong, readwrite) NSMutableDictionary *mutableDevices;
 
+/**
+ * Immutable copy of the device list, republished after each change of `mutableDevices`. Readers load it atomically
+ * without taking `lock`, so they never wait on a merge in progress.
+ */
+@property (atomic, copy, readwrite) NSDictionary *publishedDevices;
+
 /** Array of listeners */
 @property (nonatomic, strong, readwrite) AylaListenerArray *listeners;
 
@@ -78,10 +93,42 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 @property (nonatomic, readwrite) AylaHTTPClient *lanHttpClient;
 
 @property (strong, nonatomic) AylaRegistration *registration;
+
+/**
+ * Serial queue of the device setup pipeline. All properties below are only accessed on this queue.
+ */
+@property (nonatomic) dispatch_queue_t setupQueue;
+
+/** Devices waiting to be set up, prioritized ones first */
+@property (nonatomic) NSMutableArray AYLA_GENERIC(AylaDevice *) *pendingSetups;
+
+/** DSNs of the devices the app asked to set up first */
+@property (nonatomic) NSMutableSet AYLA_GENERIC(NSString *) *prioritizedSetupDsns;
+
+/** Number of devices being set up */
+@property (nonatomic) NSUInteger activeSetupCount;
+
+/** Incremented each time a device list is processed, so setups of a previous list are not counted */
+@property (nonatomic) NSUInteger setupGeneration;
+
+@property (nonatomic) NSUInteger setupCompletedCount;
+@property (nonatomic) NSUInteger setupTotalCount;
+@property (nonatomic) NSMutableDictionary AYLA_GENERIC(NSString *, NSError *) *setupFailures;
+
+/** Time each device stopped being visible at, only accessed on the setup queue */
+@property (nonatomic) NSMutableDictionary AYLA_GENERIC(NSString *, NSDate *) *interestLostDates;
+
+/** Time a device keeps being tracked after it stopped being visible */
+@property (nonatomic) NSTimeInterval interestGracePeriod;
+
+/** Time the last init of devices started at, 0 once its completion has been reported */
+@property (atomic) CFAbsoluteTime initStartTime;
 @end
 
 @implementation AylaDeviceManager
 
+@synthesize visibleDeviceDsns = _visibleDeviceDsns;
+
 - (void)setState:(AylaDeviceManagerState)state
 {
     if (_state == state) {
@@ -123,6 +170,27 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
     // Init lock
     _lock = [[NSRecursiveLock alloc] init];
 
+    // Init device setup pipeline
+    _setupQueue = dispatch_queue_create("com.aylanetworks.deviceManager.queue.setup", DISPATCH_QUEUE_SERIAL);
+    _pendingSetups = [NSMutableArray array];
+    _prioritizedSetupDsns = [NSMutableSet set];
+    _maxConcurrentDeviceSetups = DEFAULT_MAX_CONCURRENT_DEVICE_SETUPS;
+    _visibleDeviceDsns = [NSSet set];
+    _pollPolicy = [[AylaAdaptivePollPolicy alloc] init];
+    _interestLostDates = [NSMutableDictionary dictionary];
+    _lazyPropertyHydration = sessionManager.sdkRoot.systemSettings.lazyDevicePropertyHydration;
+    _interestGracePeriod = sessionManager.sdkRoot.systemSettings.deviceInterestGracePeriod;
+
+    // Init datapoint outbox, persisted along with the device archives of the session
+    AylaSystemSettings *settings = sessionManager.sdkRoot.systemSettings;
+    if (settings.datapointOutboxEnabled) {
+        NSString *outboxPath = [[AylaSystemUtils deviceArchivesPathForSession:sessionManager.sessionName]
+            stringByAppendingPathComponent:DATAPOINT_OUTBOX_FILE_NAME];
+        _datapointOutbox = [[AylaDatapointOutbox alloc] initWithDeviceManager:self
+                                                                     filePath:outboxPath
+                                                                       expiry:settings.datapointOutboxExpiry];
+    }
+
     // Init poll variable and timer
     _pollIntervalMs = DEFAULT_POLL_INTERVAL_MS;
     _pollLeewayMs = DEFAULT_POLL_LEEEWAY_MS;
@@ -151,12 +219,20 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 
 - (NSDictionary *)devices
 {
-    return [self.mutableDevices copy];
+    return self.publishedDevices;
 }
 
 - (AylaDevice *)_deviceWithDsn:(NSString *)dsn
 {
-    return self.mutableDevices[dsn];
+    return self.publishedDevices[dsn];
+}
+
+/**
+ * Publishes a snapshot of the device list. Must be called while holding `lock`, after `mutableDevices` has changed.
+ */
+- (void)publishDevices
+{
+    self.publishedDevices = self.mutableDevices;
 }
 
 /**
@@ -167,44 +243,208 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
  */
 - (void)processDeviceList:(NSArray AYLA_GENERIC(AylaDevice *) * _Nonnull)devices
 {
-    dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    dispatch_async(self.setupQueue, ^{
         AylaLogI([self logTag], 0, @"setup devices(%ld) properties", (unsigned long)devices.count);
 
-        dispatch_group_t group = dispatch_group_create();
-        NSMutableDictionary *failureDictionary = [NSMutableDictionary dictionary];
+        // Devices of a list processed before are dropped, their setups still in progress are not counted anymore
+        self.setupGeneration++;
+        self.setupCompletedCount = 0;
+        self.setupTotalCount = devices.count;
+        self.setupFailures = [NSMutableDictionary dictionary];
+        self.pendingSetups = [devices mutableCopy];
+        [self sortPendingSetups];
 
         // Set state to AylaDeviceManagerStateFetchingDeviceProperties
         self.state = AylaDeviceManagerStateFetchingDeviceProperties;
 
-        // Iterate all devices to fetch properties of each device
-        for (AylaDevice *device in devices) {
-            dispatch_group_enter(group);
-            [self setupDevice:device
-                completionBlock:^(NSError *error) {
-                    dispatch_group_leave(group);
-
-                    if (error) {
-                        AylaLogE([self logTag], 0, @"setup device properties %@", error);
-                        failureDictionary[device.dsn] = error;
-                    }
-                }];
+        if (devices.count == 0) {
+            [self finishDeviceSetups];
+            return;
         }
-        dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+        [self startPendingSetups];
+    });
+}
 
-        // Once all fetch request have been completed, set state to
-        // AylaDeviceManagerStateReady
-        self.state = AylaDeviceManagerStateReady;
+- (void)prioritizeSetupOfDevicesWithDsns:(NSArray AYLA_GENERIC(NSString *) *)dsns
+{
+    dispatch_async(self.setupQueue, ^{
+        [self.prioritizedSetupDsns addObjectsFromArray:dsns];
+        [self sortPendingSetups];
+    });
+}
 
-        // Enable polling timer
-        [self startPollTimer];
+- (NSSet AYLA_GENERIC(NSString *) *)visibleDeviceDsns
+{
+    @synchronized(self) {
+        return _visibleDeviceDsns;
+    }
+}
+
+- (void)setVisibleDeviceDsns:(NSSet AYLA_GENERIC(NSString *) *)dsns
+{
+    NSSet *visibleDsns = [dsns copy] ?: [NSSet set];
+    dispatch_async(self.setupQueue, ^{
+        NSMutableSet *hiddenDsns = [self.visibleDeviceDsns mutableCopy];
+        [hiddenDsns minusSet:visibleDsns];
+        @synchronized(self) {
+            _visibleDeviceDsns = visibleDsns;
+        }
+        [self sortPendingSetups];
+
+        if (!self.lazyPropertyHydration || self.state == AylaDeviceManagerStateShutDown ||
+            self.state == AylaDeviceManagerStatePaused) {
+            return;
+        }
+
+        for (NSString *dsn in visibleDsns) {
+            [self.interestLostDates removeObjectForKey:dsn];
+            AylaDevice *device = self.devices[dsn];
+            // Devices still waiting in the setup pipeline are set up once their turn comes
+            if (device && !device.isTracking && ![self.pendingSetups containsObject:device]) {
+                AylaLogI([self logTag], 0, @"hydrate %@", dsn);
+                [self hydrateDevice:device completionBlock:nil];
+            }
+        }
+
+        NSDate *now = [NSDate date];
+        for (NSString *dsn in hiddenDsns) {
+            self.interestLostDates[dsn] = now;
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.interestGracePeriod * NSEC_PER_SEC)),
+                           self.setupQueue,
+                           ^{
+                               [self demoteDeviceWithDsn:dsn interestLostDate:now];
+                           });
+        }
+    });
+}
+
+/**
+ * Stops tracking a device which has not been visible for the grace period. Must be called on the setup queue.
+ */
+- (void)demoteDeviceWithDsn:(NSString *)dsn interestLostDate:(NSDate *)interestLostDate
+{
+    // The device has become visible again, or stopped being visible later on
+    if (self.interestLostDates[dsn] != interestLostDate) {
+        return;
+    }
+    [self.interestLostDates removeObjectForKey:dsn];
+
+    AylaDevice *device = self.devices[dsn];
+    if (device.isTracking) {
+        AylaLogI([self logTag], 0, @"demote %@", dsn);
+        [device stopTracking];
+    }
+}
+
+/**
+ * @return YES if the properties of a device must be kept up to date
+ */
+- (BOOL)hasInterestInDevice:(AylaDevice *)device
+{
+    return !self.lazyPropertyHydration || [self.visibleDeviceDsns containsObject:device.dsn];
+}
+
+/**
+ * Moves prioritized devices to the front of the pending setups, keeping the order of the device list otherwise. Must
+ * be called on the setup queue.
+ */
+- (void)sortPendingSetups
+{
+    id<AylaDeviceDetailProvider> provider = self.deviceDetailProvider;
+    BOOL providerPrioritizes = [provider respondsToSelector:@selector(shouldPrioritizeSetupOfDevice:)];
+    NSMutableArray *prioritized = [NSMutableArray array];
+    NSMutableArray *others = [NSMutableArray array];
+    for (AylaDevice *device in self.pendingSetups) {
+        BOOL isPrioritized = [self.prioritizedSetupDsns containsObject:device.dsn] ||
+                             [self.visibleDeviceDsns containsObject:device.dsn] ||
+                             (providerPrioritizes && [provider shouldPrioritizeSetupOfDevice:device]);
+        [(isPrioritized ? prioritized : others) addObject:device];
+    }
+    [prioritized addObjectsFromArray:others];
+    self.pendingSetups = prioritized;
+}
+
+/**
+ * Starts setting up pending devices until `maxConcurrentDeviceSetups` devices are being set up. Must be called on the
+ * setup queue.
+ */
+- (void)startPendingSetups
+{
+    NSUInteger maxConcurrentSetups = MAX(self.maxConcurrentDeviceSetups, 1);
+    while (self.activeSetupCount < maxConcurrentSetups && self.pendingSetups.count > 0) {
+        AylaDevice *device = self.pendingSetups.firstObject;
+        [self.pendingSetups removeObjectAtIndex:0];
+        self.activeSetupCount++;
+
+        NSUInteger generation = self.setupGeneration;
+        [self setupDevice:device
+            completionBlock:^(NSError *error) {
+                dispatch_async(self.setupQueue, ^{
+                    [self didFinishSetupOfDevice:device error:error generation:generation];
+                });
+            }];
+    }
+}
+
+/**
+ * Must be called on the setup queue.
+ */
+- (void)didFinishSetupOfDevice:(AylaDevice *)device error:(NSError *)error generation:(NSUInteger)generation
+{
+    self.activeSetupCount--;
 
+    if (generation == self.setupGeneration) {
+        self.setupCompletedCount++;
+        if (error) {
+            AylaLogE([self logTag], 0, @"setup device properties %@", error);
+            self.setupFailures[device.dsn] = error;
+        }
+
+        NSUInteger completedCount = self.setupCompletedCount;
+        NSUInteger totalCount = self.setupTotalCount;
+        SEL progressSelector = @selector(deviceManager:didSetupDevice:error:completedCount:totalCount:);
         dispatch_async(self.notificationQueue, ^{
-            [self.listeners
-                iterateListenersRespondingToSelector:@selector(deviceManager:didInitComplete:)
-                                               block:^(id _Nonnull listener) {
-                                                   [listener deviceManager:self didInitComplete:failureDictionary];
-                                               }];
+            [self.listeners iterateListenersRespondingToSelector:progressSelector
+                                                           block:^(id _Nonnull listener) {
+                                                               [listener deviceManager:self
+                                                                        didSetupDevice:device
+                                                                                 error:error
+                                                                        completedCount:completedCount
+                                                                            totalCount:totalCount];
+                                                           }];
         });
+
+        if (completedCount == totalCount) {
+            [self finishDeviceSetups];
+        }
+    }
+
+    [self startPendingSetups];
+}
+
+/**
+ * Called once all devices of the list have been set up. Must be called on the setup queue.
+ */
+- (void)finishDeviceSetups
+{
+    NSDictionary *failures = [self.setupFailures copy];
+
+    // Once all fetch request have been completed, set state to
+    // AylaDeviceManagerStateReady
+    self.state = AylaDeviceManagerStateReady;
+
+    // Enable polling timer
+    [self startPollTimer];
+    [self reportInitCompletion];
+
+    // Properties are known now, deliver datapoints queued while offline
+    [self.datapointOutbox replay];
+
+    dispatch_async(self.notificationQueue, ^{
+        [self.listeners iterateListenersRespondingToSelector:@selector(deviceManager:didInitComplete:)
+                                                       block:^(id _Nonnull listener) {
+                                                           [listener deviceManager:self didInitComplete:failures];
+                                                       }];
     });
 }
 
@@ -219,13 +459,21 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
     // Set state to AylaDeviceManagerStateFetchingDeviceList
     self.state = AylaDeviceManagerStateFetchingDeviceList;
 
+    [self.lock lock];
     if (!self.mutableDevices) {
         self.mutableDevices = [NSMutableDictionary dictionary];
+        [self publishDevices];
     }
+    [self.lock unlock];
 
     AylaLogI([self logTag], 0, @"setup devices");
 
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    self.initStartTime = startTime;
     [self fetchDevices:^(NSArray<AylaDevice *> *_Nonnull devices) {
+        [[AylaProfiler sharedInstance] didCompleteSessionPhase:AylaProfilerPhaseDeviceListFetch
+                                                          host:[self getHttpClient:nil].baseURL.host
+                                                      duration:CFAbsoluteTimeGetCurrent() - startTime];
         [self processDeviceList:devices];
     }
         failure:^(NSError *_Nonnull error) {
@@ -266,6 +514,7 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 
     // Enable polling timer
     [self startPollTimer];
+    [self reportInitCompletion];
 
     dispatch_async(self.notificationQueue, ^{
         [self.listeners iterateListenersRespondingToSelector:@selector(deviceManager:didInitComplete:)
@@ -275,6 +524,21 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
     });
 }
 
+/**
+ * Reports the duration of the current init of devices through the profiler, once.
+ */
+- (void)reportInitCompletion
+{
+    CFAbsoluteTime startTime = self.initStartTime;
+    if (startTime == 0) {
+        return;
+    }
+    self.initStartTime = 0;
+    [[AylaProfiler sharedInstance] didCompleteSessionPhase:AylaProfilerPhaseDeviceManagerInit
+                                                      host:nil
+                                                  duration:CFAbsoluteTimeGetCurrent() - startTime];
+}
+
 /**
  * Use this method to merge devices which are fetched from cloud.
  * @param compeleteList Pass YES if the input device list is the complete device
@@ -292,7 +556,7 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
     for (AylaDevice *device in devices) {
         // If device is not a node, directly update device list maintained in
         // manager.
-        AylaDevice *found = [self _deviceWithDsn:device.dsn];
+        AylaDevice *found = self.mutableDevices[device.dsn];
         if (found) {
             [found updateFrom:device dataSource:AylaDataSourceCloud];
             [deleted removeObject:found];
@@ -316,6 +580,9 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
         deleted = [NSMutableArray array];
     }
 
+    // Readers see the new list from now on.
+    [self publishDevices];
+
     [self processDeviceListChangesWithAddedDevices:added removedDevices:deleted];
 
     // Do an update to lan ip status of each device.
@@ -379,6 +646,11 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
         device.disableLANUntilNetworkChanges = NO;
     }
     [self.lock unlock];
+
+    if (reachabilityStatus == AylaNetworkReachabilityStatusReachableViaWiFi ||
+        reachabilityStatus == AylaNetworkReachabilityStatusReachableViaWWAN) {
+        [self.datapointOutbox replay];
+    }
 }
 
 /**
@@ -434,12 +706,19 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 
     [self.lanServer stop];
 
+    // Drop devices waiting to be set up, setups in progress are not counted anymore
+    dispatch_async(self.setupQueue, ^{
+        self.setupGeneration++;
+        [self.pendingSetups removeAllObjects];
+    });
+
     for (AylaDevice *device in self.mutableDevices.allValues) {
         [device shutDown];
     }
 
     // Clean device list
     self.mutableDevices = nil;
+    [self publishDevices];
 
     self.state = AylaDeviceManagerStateShutDown;
 
@@ -461,7 +740,7 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
 
 - (void)removeDevices:(NSArray *)devices
 {
-    NSMutableArray *remainingDevices = [self.mutableDevices.allValues mutableCopy];
+    NSMutableArray *remainingDevices = [self.devices.allValues mutableCopy];
 
     for (AylaDevice *device in devices) {
         [remainingDevices removeObject:device];
@@ -483,13 +762,28 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
  * initialization.
  */
 - (void)setupDevice:(AylaDevice *)device completionBlock:(void (^)(NSError *error))completionBlock
+{
+    if (![self hasInterestInDevice:device]) {
+        // Only the device metadata is kept up to date until the app shows the device
+        if (completionBlock) completionBlock(nil);
+        return;
+    }
+    [self hydrateDevice:device completionBlock:completionBlock];
+}
+
+/**
+ * Fetches the monitored properties of a device and starts tracking it if the device is still of interest by then.
+ */
+- (void)hydrateDevice:(AylaDevice *)device completionBlock:(void (^)(NSError *error))completionBlock
 {
     // Call method to fetch all managed properties for this device
     [device fetchProperties:[self.deviceDetailProvider monitoredPropertyNamesForDevice:device]
         success:^(NSArray AYLA_GENERIC(AylaProperty *) * _Nonnull properties) {
 
-            // Enable tracking for a newly added device
-            [device startTracking];
+            // Enable tracking for a newly added device, unless it has been hidden while its properties were fetched
+            if ([self hasInterestInDevice:device]) {
+                [device startTracking];
+            }
 
             if (completionBlock) completionBlock(nil);
         }
@@ -497,7 +791,9 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
             
             // Enable tracking for a newly added device regardless of the first fetch properties failure
             // This will allow the DM to recover from an early failure
-            [device startTracking];
+            if ([self hasInterestInDevice:device]) {
+                [device startTracking];
+            }
             if (completionBlock) completionBlock(error);
         }];
 }
@@ -539,9 +835,7 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
                 
                 id<AylaDeviceListPlugin> deviceListPlugin = (id<AylaDeviceListPlugin>)[[AylaNetworks shared] getPluginWithId:PLUGIN_ID_DEVICE_LIST];
                 if (deviceListPlugin != nil) {
-                    @synchronized (_mutableDevices) {
-                        [deviceListPlugin updateDeviceDictionary:self.devices];
-                    }
+                    [deviceListPlugin updateDeviceDictionary:self.devices];
                 }
 
 
@@ -703,6 +997,18 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
         }];
 }
 
+- (NSDictionary AYLA_GENERIC(NSString *, AylaPollDecision *) *)pollDecisions
+{
+    NSMutableDictionary *decisions = [NSMutableDictionary dictionary];
+    for (AylaDevice *device in self.devices.allValues) {
+        AylaPollDecision *decision = device.lastPollDecision;
+        if (decision && device.dsn) {
+            decisions[device.dsn] = decision;
+        }
+    }
+    return decisions;
+}
+
 - (BOOL)isPolling
 {
     return self.pollTimer.isPolling;
@@ -713,7 +1019,9 @@ static const NSInteger DEFAULT_LAN_SERVER_PORT = 10275;
     [self.lock lock];
     
     for (AylaDevice *device in self.devices.allValues) {
-        [device startTracking];
+        if ([self hasInterestInDevice:device]) {
+            [device startTracking];
+        }
     }
     [self startPollTimer];
     
@@ -25,6 +25,14 @@ static NSString *const attrNodeType = @"node_type";
     return self.deviceManager.devices[self.gatewayDsn];
 }
 
+/**
+ * Nodes are updated through their gateway, they share its processing context.
+ */
+- (NSString *)processingContext
+{
+    return self.gatewayDsn ?: [super processingContext];
+}
+
 - (instancetype)initWithDeviceManager:(AylaDeviceManager *)deviceManager
                        JSONDictionary:(NSDictionary *)dictionary
                                 error:(NSError *_Nullable __autoreleasing *)error
@@ -43,6 +51,13 @@ static NSString *const attrNodeType = @"node_type";
     return self;
 }
 
+- (void)copyFieldsToSnapshot:(AylaDevice *)snapshot {
+    [super copyFieldsToSnapshot:snapshot];
+    AylaDeviceNode *nodeSnapshot = (AylaDeviceNode *)snapshot;
+    nodeSnapshot->_gatewayDsn = _gatewayDsn;
+    nodeSnapshot->_nodeType = _nodeType;
+}
+
 /**
  * Override fetch properties LAN api
  */
@@ -77,7 +92,7 @@ static NSString *const attrNodeType = @"node_type";
         success:^(id _Nonnull responseObject) {
             // Handle task callbacks.
             AylaLogI([self logTag], 0, @"%@, %@", @"finished", @"fetchPropertiesLAN");
-            dispatch_async([AylaDevice deviceProcessingQueue], ^{
+            dispatch_async(self.processingQueue, ^{
 
                 NSMutableArray *properties = [NSMutableArray array];
                 NSMutableDictionary *errorResponseInfo = [NSMutableDictionary dictionary];
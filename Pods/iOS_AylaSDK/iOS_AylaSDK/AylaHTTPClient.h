@@ -12,9 +12,11 @@ FOUNDATION_EXPORT NSString *const AylaHTTPRequestMethodGET;     // HTTP request
 FOUNDATION_EXPORT NSString *const AylaHTTPRequestMethodPOST;    // HTTP request method `POST`
 FOUNDATION_EXPORT NSString *const AylaHTTPRequestMethodPUT;     // HTTP request method `PUT`
 FOUNDATION_EXPORT NSString *const AylaHTTPRequestMethodDELETE;  // HTTP request method `DELETE`;
+FOUNDATION_EXPORT NSString *const AylaHTTPRequestMethodHEAD;    // HTTP request method `HEAD`
 
 FOUNDATION_EXPORT NSString *const AylaHTTPClientTag;  // Tag of HTTP client
 
+@class AylaHTTPDownloadDigest;
 @class AylaHTTPTask;
 @class AylaSystemSettings;
 
@@ -34,6 +36,16 @@ FOUNDATION_EXPORT NSString *const AylaHTTPClientTag;  // Tag of HTTP client
 /** If current http client has been invalidated or not */
 @property (nonatomic, assign, readonly) BOOL invalidated;
 
+/**
+ * If YES, JSON request bodies of at least `gzipRequestThreshold` bytes are compressed with gzip and gzip encoded
+ * responses are explicitly accepted. Only enable it for services which accept gzip encoded requests. Defaults to NO,
+ * see `-[AylaSystemSettings gzipHTTPClientTypes]`.
+ */
+@property (nonatomic, assign) BOOL gzipEnabled;
+
+/** Minimum size of a request body compressed with gzip, in bytes */
+@property (nonatomic, assign) NSUInteger gzipRequestThreshold;
+
 /**
  * Init method with base url as input.
  * @param baseUrl the base URL for all requests
@@ -300,6 +312,28 @@ FOUNDATION_EXPORT NSString *const AylaHTTPClientTag;  // Tag of HTTP client
                               destination:(NSURL *__nonnull (^)(NSURL *__nonnull, NSURLResponse *__nonnull))destination
                                   success:(void (^)(AylaHTTPTask *task, NSURL *filePath))successBlock
                                   failure:(void (^)(AylaHTTPTask *task, NSError *error))failureBlock;
+
+/**
+ * Use this method to create an AylaHTTPTask object for a download request whose file is hashed while it is written to
+ * disk. The MD5 and SHA-256 digests of the file are passed to the success block, so the file can be verified without
+ * being read again.
+ *
+ * @param request      Request of the file.
+ * @param downloadProgressBlock A block object to be executed when the download progress is updated. Note this block is called on a background queue, not the main queue.
+ * @param destination  A block object to be executed in order to determine the destination of the downloaded file. This block takes two arguments, the target path & the server response, and returns the desired file URL of the resulting download. An existing file at the returned URL is not replaced and fails the task.
+ * @param successBlock A block called when the request succeeds. Passed the completed AylaHTTPTask, the file URL and the digests of the file.
+ * @param failureBlock A block called when the request fails. Passed the AylaHTTPTask and an `NSError` describing the failure.
+ *
+ * @return An `AylaHTTPTask`
+ */
+- (AylaHTTPTask *)taskWithDigestingDownloadRequest:(NSURLRequest *)request
+                                          progress:(nullable void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                       destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                           success:(void (^)(AylaHTTPTask *task,
+                                                             NSURL *filePath,
+                                                             AylaHTTPDownloadDigest *digest))successBlock
+                                           failure:(void (^)(AylaHTTPTask *task, NSError *error))failureBlock;
+
 /**
  * Create a mutable url request with input method, path and parameters
  *
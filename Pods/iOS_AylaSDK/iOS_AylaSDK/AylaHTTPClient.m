@@ -7,18 +7,24 @@
 #import <AFNetworking/AFNetworking.h>
 #import "AylaConnectTask+Internal.h"
 #import "AylaDefines_Internal.h"
+#import "AylaDigestDownloader.h"
 #import "AylaErrorUtils.h"
+#import "AylaGzipJSONSerializer.h"
 #import "AylaHTTPClient.h"
+#import "AylaHTTPDownloadDigest.h"
 #import "AylaHTTPError.h"
 #import "AylaHTTPTask+Internal.h"
+#import "AylaMetrics.h"
 #import "AylaSystemSettings.h"
 #import "AylaSystemUtils.h"
+#import "AylaTracer.h"
 #import "AFHTTPSessionManagerProfiler.h"
 
 NSString *const AylaHTTPRequestMethodGET = @"GET";
 NSString *const AylaHTTPRequestMethodPOST = @"POST";
 NSString *const AylaHTTPRequestMethodPUT = @"PUT";
 NSString *const AylaHTTPRequestMethodDELETE = @"DELETE";
+NSString *const AylaHTTPRequestMethodHEAD = @"HEAD";
 
 NSString *const AylaHTTPClientTag = @"HTTPClient";
 
@@ -67,6 +73,7 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
 @interface AylaHTTPClient ()
 
 @property AFHTTPSessionManager *afSessionManager;
+@property (nonatomic, strong) AylaDigestDownloader *digestDownloader;
 @property (nonatomic, readwrite) BOOL invalidated;
 
 @end
@@ -105,12 +112,33 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
 
     Class afHTTPSessionManagerClass = NSClassFromString(AFSessionManagerClass);
     _afSessionManager = [[afHTTPSessionManagerClass alloc] initWithBaseURL:baseUrl sessionConfiguration:nil];
-    _afSessionManager.requestSerializer = [AFJSONRequestSerializer serializer];
+    _afSessionManager.requestSerializer = [AylaGzipJSONRequestSerializer serializer];
+    _afSessionManager.responseSerializer = [AylaGzipJSONResponseSerializer serializer];
     [self updateRequestHeaderWithAccessToken:accessToken];
 
     return self;
 }
 
+- (BOOL)gzipEnabled
+{
+    return ((AylaGzipJSONRequestSerializer *)self.afSessionManager.requestSerializer).gzipEnabled;
+}
+
+- (void)setGzipEnabled:(BOOL)gzipEnabled
+{
+    ((AylaGzipJSONRequestSerializer *)self.afSessionManager.requestSerializer).gzipEnabled = gzipEnabled;
+}
+
+- (NSUInteger)gzipRequestThreshold
+{
+    return ((AylaGzipJSONRequestSerializer *)self.afSessionManager.requestSerializer).gzipThreshold;
+}
+
+- (void)setGzipRequestThreshold:(NSUInteger)gzipRequestThreshold
+{
+    ((AylaGzipJSONRequestSerializer *)self.afSessionManager.requestSerializer).gzipThreshold = gzipRequestThreshold;
+}
+
 - (NSURL *)baseURL
 {
     return self.afSessionManager.baseURL;
@@ -382,6 +410,44 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
     return httpTask;
 }
 
+- (AylaHTTPTask *)taskWithDigestingDownloadRequest:(NSURLRequest *)request
+                                          progress:(void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                       destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                           success:(void (^)(AylaHTTPTask *task,
+                                                             NSURL *filePath,
+                                                             AylaHTTPDownloadDigest *digest))successBlock
+                                           failure:(void (^)(AylaHTTPTask *task, NSError *error))failureBlock
+{
+    AylaDigestDownloader *digestDownloader;
+    @synchronized(self) {
+        if (!self.digestDownloader) {
+            self.digestDownloader = [[AylaDigestDownloader alloc] init];
+        }
+        digestDownloader = self.digestDownloader;
+    }
+
+    __block AylaHTTPTask *httpTask = [[AylaHTTPTask alloc] init];
+    NSURLSessionTask *task = [digestDownloader
+        dataTaskWithRequest:request
+                   progress:downloadProgressBlock
+                destination:destination
+          completionHandler:^(NSURLResponse *response, NSURL *filePath, AylaHTTPDownloadDigest *digest, NSError *error) {
+              dispatch_async(self.completionQueue ?: dispatch_get_main_queue(), ^{
+                  [self processResponseWithTask:httpTask
+                                       response:response
+                                 responseObject:filePath
+                                          error:error
+                                        success:^(AylaHTTPTask *task, id responseObject) {
+                                            AylaLogD([AylaHTTPClient logTag], 0, @"%@:%@, %@", @"digest", digest, request.URL);
+                                            successBlock(task, responseObject, digest);
+                                        }
+                                        failure:failureBlock];
+              });
+          }];
+    httpTask.task = task;
+    return httpTask;
+}
+
 - (AylaHTTPTask *)taskWithUploadRequest:(NSURLRequest *)request
                                fromData:(NSData *)bodyData
                                 success:(void (^)(AylaHTTPTask *task, id responseObject))successBlock
@@ -441,6 +507,8 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
                         failure:(void (^)(AylaHTTPTask *task, NSError *error))failureBlock
 {
     [httpTask setFinished:YES];
+    [self recordMetricsOfTask:httpTask failed:error != nil];
+    [self recordTraceOfTask:httpTask error:error];
     if (!error) {
         httpTask.responseObject = responseObject;
         successBlock(httpTask, responseObject);
@@ -452,6 +520,67 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
     }
 }
 
+/**
+ * @return Method and endpoint template of the request of a task, e.g. `GET devices/:id/properties.json`
+ */
+- (NSString *)endpointOfTask:(NSURLSessionTask *)sessionTask
+{
+    NSURLRequest *request = sessionTask.originalRequest;
+    NSString *path = request.URL.path ?: @"";
+    NSString *basePath = self.baseURL.path;
+    if (basePath.length > 0 && [path hasPrefix:basePath]) {
+        path = [path substringFromIndex:basePath.length];
+    }
+    if ([path hasPrefix:@"/"]) {
+        path = [path substringFromIndex:1];
+    }
+    return [NSString
+        stringWithFormat:@"%@ %@", request.HTTPMethod ?: @"GET", [AylaMetrics endpointTemplateForPath:path]];
+}
+
+/**
+ * Records the request of a finished task in the shared metrics, keyed by method and endpoint template.
+ */
+- (void)recordMetricsOfTask:(AylaHTTPTask *)httpTask failed:(BOOL)failed
+{
+    AylaMetrics *metrics = [AylaMetrics sharedMetrics];
+    if (!metrics.enabled) {
+        return;
+    }
+    NSURLSessionTask *sessionTask = httpTask.task;
+    if (![sessionTask isKindOfClass:[NSURLSessionTask class]]) {
+        return;
+    }
+
+    NSString *endpoint = [self endpointOfTask:sessionTask];
+    [metrics incrementCounter:[@"cloud.requests." stringByAppendingString:endpoint]];
+    if (failed) {
+        [metrics incrementCounter:[@"cloud.failures." stringByAppendingString:endpoint]];
+    }
+    if (httpTask.startTime > 0) {
+        [metrics recordDuration:CFAbsoluteTimeGetCurrent() - httpTask.startTime
+                   forHistogram:[@"cloud.latency." stringByAppendingString:endpoint]];
+    }
+    [metrics incrementCounter:AylaMetricsCloudBytesSent by:sessionTask.countOfBytesSent];
+    [metrics incrementCounter:AylaMetricsCloudBytesReceived by:sessionTask.countOfBytesReceived];
+}
+
+/**
+ * Records the request of a finished task as a phase of the trace the task belongs to.
+ */
+- (void)recordTraceOfTask:(AylaHTTPTask *)httpTask error:(NSError *)error
+{
+    NSURLSessionTask *sessionTask = httpTask.task;
+    if (!httpTask.traceId || ![sessionTask isKindOfClass:[NSURLSessionTask class]]) {
+        return;
+    }
+    [[AylaTracer sharedTracer] recordSpanWithName:[@"cloud " stringByAppendingString:[self endpointOfTask:sessionTask]]
+                                         category:@"cloud"
+                                          traceId:httpTask.traceId
+                                        startTime:httpTask.startTime
+                                          details:error ? @{ @"error" : @(error.code) } : nil];
+}
+
 - (NSMutableURLRequest *)requestWithMethod:(NSString *)method
                                       path:(NSString *)path
                                 parameters:(NSDictionary *)parameters
@@ -476,6 +605,7 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
 {
     self.invalidated = YES;
     [self.afSessionManager invalidateSessionCancelingTasks:cancelPendingTasks];
+    [self.digestDownloader invalidateSessionCancelingTasks:cancelPendingTasks];
 }
 
 + (instancetype)deviceServiceClientWithSettings:(AylaSystemSettings *)settings usingHTTPS:(BOOL)usingHTTPS
@@ -545,6 +675,7 @@ static NSError *generateHTTPError(NSURLResponse *urlResponse, NSError *error)
     // If this http client has never invalidated, call invalidate api once.
     if (!self.invalidated) {
         [self.afSessionManager invalidateSessionCancelingTasks:YES];
+        [_digestDownloader invalidateSessionCancelingTasks:YES];
     }
 }
 
@@ -6,6 +6,7 @@
 
 #import "AylaAuthProvider.h"
 #import "AylaAuthorization.h"
+#import "AylaConnectionPrewarmer.h"
 #import "AylaNetworks+Internal.h"
 #import "AylaEmailTemplate.h"
 #import "AylaHTTPClient.h"
@@ -55,6 +56,11 @@ static NSString *const attrNameSignupConfirmationToken = @"confirmation_token";
 {
     AYLAssert(sessionName, @"Session name must not be nil");
 
+    // Warm up the services the new session starts with while authenticating
+    if (self.settings.prewarmConnections) {
+        [[AylaConnectionPrewarmer sharedPrewarmer] prewarmServicesWithSettings:self.settings];
+    }
+
     return [authProvider authenticateWithLoginManager:self
         success:^(AylaAuthorization *authorization) {
             AylaSessionManager *sessionManager = [[AylaSessionManager alloc] initWithAuthProvider:authProvider
@@ -0,0 +1,153 @@
+//
+//  AylaMetrics.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** Key of the counters in a metrics snapshot, a dictionary of `NSNumber` keyed by counter name */
+FOUNDATION_EXPORT NSString *const AylaMetricsCountersKey;
+
+/** Key of the histograms in a metrics snapshot, a dictionary keyed by histogram name */
+FOUNDATION_EXPORT NSString *const AylaMetricsHistogramsKey;
+
+/** Key of the upper bounds of the histogram buckets in a metrics snapshot, in milliseconds */
+FOUNDATION_EXPORT NSString *const AylaMetricsBucketBoundsKey;
+
+/** Key of the time the snapshot was taken, in seconds since 1970 */
+FOUNDATION_EXPORT NSString *const AylaMetricsTimestampKey;
+
+/** Key of the number of samples of a histogram */
+FOUNDATION_EXPORT NSString *const AylaMetricsHistogramCountKey;
+
+/** Key of the sum of the samples of a histogram, in milliseconds */
+FOUNDATION_EXPORT NSString *const AylaMetricsHistogramSumKey;
+
+/** Key of the sample counts of a histogram, one per bucket bound plus a last one for larger samples */
+FOUNDATION_EXPORT NSString *const AylaMetricsHistogramBucketsKey;
+
+/** Name of the counter of bytes sent to the cloud service */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudBytesSent;
+
+/** Name of the counter of bytes received from the cloud service */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudBytesReceived;
+
+/** Name of the counter of bytes sent to devices over LAN */
+FOUNDATION_EXPORT NSString *const AylaMetricsLanBytesSent;
+
+/** Name of the counter of bytes received from devices over LAN */
+FOUNDATION_EXPORT NSString *const AylaMetricsLanBytesReceived;
+
+/** Name of the counter of request bytes sent with gzip encoding, before compression */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudGzipRequestBytesUncompressed;
+
+/** Name of the counter of request bytes sent with gzip encoding, after compression */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudGzipRequestBytesCompressed;
+
+/** Name of the counter of response bytes received with gzip encoding, before decoding */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudGzipResponseBytesCompressed;
+
+/** Name of the counter of response bytes received with gzip encoding, after decoding */
+FOUNDATION_EXPORT NSString *const AylaMetricsCloudGzipResponseBytesUncompressed;
+
+/** Name of the counter of frames received from the data stream service */
+FOUNDATION_EXPORT NSString *const AylaMetricsDSSFrames;
+
+/** Name of the counter of cache lookups which found an entry */
+FOUNDATION_EXPORT NSString *const AylaMetricsCacheHits;
+
+/** Name of the counter of cache lookups which found no entry */
+FOUNDATION_EXPORT NSString *const AylaMetricsCacheMisses;
+
+/** Name of the counter of datum lookups served by a datum cache */
+FOUNDATION_EXPORT NSString *const AylaMetricsDatumCacheHits;
+
+/** Name of the counter of datum lookups a datum cache had to fetch */
+FOUNDATION_EXPORT NSString *const AylaMetricsDatumCacheMisses;
+
+/** Name of the counter of fetch requests sent by datum caches */
+FOUNDATION_EXPORT NSString *const AylaMetricsDatumCacheRequests;
+
+/**
+ * SDK-wide registry of counters and latency histograms.
+ *
+ * The SDK records cloud requests by method and endpoint template (`cloud.*`), LAN commands by type (`lan.*`), LAN vs
+ * cloud routing decisions (`routing.*`), data stream frames (`dss.*`), cache hits and misses and bytes in and out.
+ * Recording only takes atomic increments once a metric exists, so metrics can be left enabled in production builds.
+ */
+@interface AylaMetrics : NSObject
+
+/** Whether samples are recorded. Defaults to YES. */
+@property (atomic, assign, getter=isEnabled) BOOL enabled;
+
+/**
+ * @return Shared instance of the metrics registry
+ */
++ (AylaMetrics *)sharedMetrics;
+
+/**
+ * @return Upper bounds of the histogram buckets, in milliseconds
+ */
++ (NSArray<NSNumber *> *)histogramBucketBounds;
+
+/**
+ * Turns a request path into the template of its endpoint, replacing each path component holding a digit, such as an
+ * id or a dsn, with `:id`. e.g. `devices/1234/properties.json` becomes `devices/:id/properties.json`.
+ *
+ * @param path Request path, relative to the base url of the service
+ *
+ * @return Endpoint template of the path
+ */
++ (NSString *)endpointTemplateForPath:(NSString *)path;
+
+/**
+ * Increments a counter by one.
+ *
+ * @param name Name of the counter
+ */
+- (void)incrementCounter:(NSString *)name;
+
+/**
+ * Increments a counter.
+ *
+ * @param name   Name of the counter
+ * @param amount Amount to add to the counter
+ */
+- (void)incrementCounter:(NSString *)name by:(int64_t)amount;
+
+/**
+ * Records a latency sample in a histogram.
+ *
+ * @param duration Duration of the sample, in seconds
+ * @param name     Name of the histogram
+ */
+- (void)recordDuration:(CFTimeInterval)duration forHistogram:(NSString *)name;
+
+/**
+ * @return Snapshot of all metrics, see `AylaMetricsCountersKey` and `AylaMetricsHistogramsKey`. The snapshot can be
+ * serialized to JSON.
+ */
+- (NSDictionary *)snapshot;
+
+/**
+ * Writes a snapshot of all metrics to a file as JSON.
+ *
+ * @param path  Path of the file
+ * @param error A pointer to an `NSError` variable to store an error in case the snapshot can't be written
+ *
+ * @return YES if the snapshot has been written
+ */
+- (BOOL)exportToFile:(NSString *)path error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
+/**
+ * Drops all metrics.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
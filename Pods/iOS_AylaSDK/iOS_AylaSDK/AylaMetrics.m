@@ -0,0 +1,243 @@
+//
+//  AylaMetrics.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <stdatomic.h>
+#import "AylaDefines_Internal.h"
+#import "AylaMetrics.h"
+
+NSString *const AylaMetricsCountersKey = @"counters";
+NSString *const AylaMetricsHistogramsKey = @"histograms";
+NSString *const AylaMetricsBucketBoundsKey = @"bucketBoundsMs";
+NSString *const AylaMetricsTimestampKey = @"timestamp";
+NSString *const AylaMetricsHistogramCountKey = @"count";
+NSString *const AylaMetricsHistogramSumKey = @"sumMs";
+NSString *const AylaMetricsHistogramBucketsKey = @"buckets";
+
+NSString *const AylaMetricsCloudBytesSent = @"cloud.bytes.sent";
+NSString *const AylaMetricsCloudBytesReceived = @"cloud.bytes.received";
+NSString *const AylaMetricsCloudGzipRequestBytesUncompressed = @"cloud.gzip.request.bytes.uncompressed";
+NSString *const AylaMetricsCloudGzipRequestBytesCompressed = @"cloud.gzip.request.bytes.compressed";
+NSString *const AylaMetricsCloudGzipResponseBytesCompressed = @"cloud.gzip.response.bytes.compressed";
+NSString *const AylaMetricsCloudGzipResponseBytesUncompressed = @"cloud.gzip.response.bytes.uncompressed";
+NSString *const AylaMetricsLanBytesSent = @"lan.bytes.sent";
+NSString *const AylaMetricsLanBytesReceived = @"lan.bytes.received";
+NSString *const AylaMetricsDSSFrames = @"dss.frames";
+NSString *const AylaMetricsCacheHits = @"cache.hits";
+NSString *const AylaMetricsCacheMisses = @"cache.misses";
+NSString *const AylaMetricsDatumCacheHits = @"datum_cache.hits";
+NSString *const AylaMetricsDatumCacheMisses = @"datum_cache.misses";
+NSString *const AylaMetricsDatumCacheRequests = @"datum_cache.requests";
+
+static NSString *const AylaMetricsTag = @"Metrics";
+
+static const double AylaMetricsBucketBoundsMs[] = {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+#define AYLA_METRICS_BUCKET_COUNT (sizeof(AylaMetricsBucketBoundsMs) / sizeof(AylaMetricsBucketBoundsMs[0]) + 1)
+
+@interface AylaMetricsCounter : NSObject {
+  @public
+    _Atomic(int64_t) _value;
+}
+@end
+
+@implementation AylaMetricsCounter
+@end
+
+@interface AylaMetricsHistogram : NSObject {
+  @public
+    _Atomic(int64_t) _count;
+    _Atomic(int64_t) _sumMicroseconds;
+    _Atomic(int64_t) _buckets[AYLA_METRICS_BUCKET_COUNT];
+}
+@end
+
+@implementation AylaMetricsHistogram
+@end
+
+@interface AylaMetrics ()
+
+/**
+ * Immutable maps of the metrics. Readers load them without locking, a new map is only published when a metric is
+ * created.
+ */
+@property (atomic, copy) NSDictionary<NSString *, AylaMetricsCounter *> *counters;
+@property (atomic, copy) NSDictionary<NSString *, AylaMetricsHistogram *> *histograms;
+
+@end
+
+@implementation AylaMetrics
+
++ (AylaMetrics *)sharedMetrics
+{
+    static AylaMetrics *sharedMetrics = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedMetrics = [[AylaMetrics alloc] init];
+    });
+    return sharedMetrics;
+}
+
++ (NSArray<NSNumber *> *)histogramBucketBounds
+{
+    NSMutableArray *bounds = [NSMutableArray array];
+    for (size_t i = 0; i < AYLA_METRICS_BUCKET_COUNT - 1; i++) {
+        [bounds addObject:@(AylaMetricsBucketBoundsMs[i])];
+    }
+    return bounds;
+}
+
++ (NSString *)endpointTemplateForPath:(NSString *)path
+{
+    NSString *purePath = [[path componentsSeparatedByString:@"?"] firstObject];
+    NSCharacterSet *digits = [NSCharacterSet decimalDigitCharacterSet];
+    NSMutableArray *components = [NSMutableArray array];
+    for (NSString *component in [purePath componentsSeparatedByString:@"/"]) {
+        if ([component rangeOfCharacterFromSet:digits].location == NSNotFound) {
+            [components addObject:component];
+            continue;
+        }
+        NSString *extension = component.pathExtension;
+        BOOL keepExtension = extension.length > 0 && [extension rangeOfCharacterFromSet:digits].location == NSNotFound;
+        [components addObject:keepExtension ? [@":id" stringByAppendingPathExtension:extension] : @":id"];
+    }
+    return [components componentsJoinedByString:@"/"];
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _enabled = YES;
+    _counters = @{};
+    _histograms = @{};
+
+    return self;
+}
+
+- (AylaMetricsCounter *)counterWithName:(NSString *)name
+{
+    AylaMetricsCounter *counter = self.counters[name];
+    if (counter) {
+        return counter;
+    }
+    @synchronized(self) {
+        NSDictionary *counters = self.counters;
+        counter = counters[name];
+        if (!counter) {
+            counter = [[AylaMetricsCounter alloc] init];
+            NSMutableDictionary *newCounters = [counters mutableCopy];
+            newCounters[name] = counter;
+            self.counters = newCounters;
+        }
+        return counter;
+    }
+}
+
+- (AylaMetricsHistogram *)histogramWithName:(NSString *)name
+{
+    AylaMetricsHistogram *histogram = self.histograms[name];
+    if (histogram) {
+        return histogram;
+    }
+    @synchronized(self) {
+        NSDictionary *histograms = self.histograms;
+        histogram = histograms[name];
+        if (!histogram) {
+            histogram = [[AylaMetricsHistogram alloc] init];
+            NSMutableDictionary *newHistograms = [histograms mutableCopy];
+            newHistograms[name] = histogram;
+            self.histograms = newHistograms;
+        }
+        return histogram;
+    }
+}
+
+- (void)incrementCounter:(NSString *)name
+{
+    [self incrementCounter:name by:1];
+}
+
+- (void)incrementCounter:(NSString *)name by:(int64_t)amount
+{
+    if (!self.enabled || name.length == 0 || amount == 0) {
+        return;
+    }
+    AylaMetricsCounter *counter = [self counterWithName:name];
+    atomic_fetch_add_explicit(&counter->_value, amount, memory_order_relaxed);
+}
+
+- (void)recordDuration:(CFTimeInterval)duration forHistogram:(NSString *)name
+{
+    if (!self.enabled || name.length == 0 || duration < 0) {
+        return;
+    }
+    double durationMs = duration * 1000;
+    size_t bucket = 0;
+    while (bucket < AYLA_METRICS_BUCKET_COUNT - 1 && durationMs > AylaMetricsBucketBoundsMs[bucket]) {
+        bucket++;
+    }
+
+    AylaMetricsHistogram *histogram = [self histogramWithName:name];
+    atomic_fetch_add_explicit(&histogram->_buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->_sumMicroseconds, (int64_t)(duration * 1000000), memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->_count, 1, memory_order_relaxed);
+}
+
+- (NSDictionary *)snapshot
+{
+    NSDictionary *counters = self.counters;
+    NSMutableDictionary *countersSnapshot = [NSMutableDictionary dictionaryWithCapacity:counters.count];
+    [counters enumerateKeysAndObjectsUsingBlock:^(NSString *name, AylaMetricsCounter *counter, BOOL *stop) {
+        countersSnapshot[name] = @(atomic_load_explicit(&counter->_value, memory_order_relaxed));
+    }];
+
+    NSDictionary *histograms = self.histograms;
+    NSMutableDictionary *histogramsSnapshot = [NSMutableDictionary dictionaryWithCapacity:histograms.count];
+    [histograms enumerateKeysAndObjectsUsingBlock:^(NSString *name, AylaMetricsHistogram *histogram, BOOL *stop) {
+        NSMutableArray *buckets = [NSMutableArray arrayWithCapacity:AYLA_METRICS_BUCKET_COUNT];
+        for (size_t i = 0; i < AYLA_METRICS_BUCKET_COUNT; i++) {
+            [buckets addObject:@(atomic_load_explicit(&histogram->_buckets[i], memory_order_relaxed))];
+        }
+        int64_t sumMicroseconds = atomic_load_explicit(&histogram->_sumMicroseconds, memory_order_relaxed);
+        histogramsSnapshot[name] = @{
+            AylaMetricsHistogramCountKey : @(atomic_load_explicit(&histogram->_count, memory_order_relaxed)),
+            AylaMetricsHistogramSumKey : @(sumMicroseconds / 1000.0),
+            AylaMetricsHistogramBucketsKey : buckets
+        };
+    }];
+
+    return @{
+        AylaMetricsTimestampKey : @([[NSDate date] timeIntervalSince1970]),
+        AylaMetricsBucketBoundsKey : [AylaMetrics histogramBucketBounds],
+        AylaMetricsCountersKey : countersSnapshot,
+        AylaMetricsHistogramsKey : histogramsSnapshot
+    };
+}
+
+- (BOOL)exportToFile:(NSString *)path error:(NSError *__autoreleasing _Nullable *)error
+{
+    NSData *data = [NSJSONSerialization dataWithJSONObject:[self snapshot] options:NSJSONWritingPrettyPrinted error:error];
+    if (!data) {
+        AylaLogE(AylaMetricsTag, 0, @"failed to serialize snapshot, err:%@", error ? *error : nil);
+        return NO;
+    }
+    BOOL written = [data writeToFile:path options:NSDataWritingAtomic error:error];
+    if (!written) {
+        AylaLogE(AylaMetricsTag, 0, @"failed to export to %@, err:%@", path, error ? *error : nil);
+    }
+    return written;
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        self.counters = @{};
+        self.histograms = @{};
+    }
+}
+
+@end
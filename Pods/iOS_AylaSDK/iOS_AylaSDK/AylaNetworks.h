@@ -80,6 +80,13 @@ extern NSString * const PLUGIN_ID_DEVICE_LIST;
  * The AylaConnectivity instance that can be used to register for network state change notifications.
  */
 @property (nonatomic, readonly) AylaConnectivity *connectivity;
+
+/**
+ * Duration in seconds of the first LAN key negotiation completed since launch, e.g. by the first setup session. The
+ * RSA key pair used by setup key negotiation is loaded, or generated on first install, in the background when the SDK
+ * is initialized, so this is mostly network time. 0 if no negotiation has completed yet.
+ */
+@property (nonatomic, readonly) NSTimeInterval firstLanKeyNegotiationDuration;
 /** @name Initializer Methods */
 
 /**
@@ -10,6 +10,8 @@
 #import "AylaNetworks.h"
 #import "AylaDefines_Internal.h"
 #import "AylaHTTPClient.h"
+#import "AylaKeyCrypto.h"
+#import "AylaLanModule.h"
 #import "AylaLoginManager+Internal.h"
 #import "AylaSessionManager.h"
 #import "AylaSystemSettings.h"
@@ -48,6 +50,12 @@ static AylaNetworks *__shared;
 
     // Start connectivity monitoring immidiately.
     [_connectivity startMonitoringNetworkChanges];
+
+    // Get the key pair of setup key negotiation ready, generating it can take seconds. Only setup sessions negotiate
+    // keys, other LAN sessions use the key of their LAN config.
+    [AylaKeyCrypto preloadKeyPairWithPubKeyTag:AylaKeyCryptoSetupPublicKeyTag
+                                    privKeyTag:AylaKeyCryptoSetupPrivateKeyTag
+                                       keySize:AylaKeyCryptoRSAKeySize1024];
     
     _plugins = [NSMutableDictionary dictionary];
     
@@ -79,6 +87,11 @@ static AylaNetworks *__shared;
     return manager;
 }
 
+- (NSTimeInterval)firstLanKeyNegotiationDuration
+{
+    return [AylaLanModule firstKeyNegotiationDuration];
+}
+
 - (id<AylaPlugin>)getPluginWithId:(NSString *)pluginId
 {
     @synchronized (self) {
@@ -0,0 +1,145 @@
+//
+//  AylaPollPolicy.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDevice;
+
+/** Reason of a poll decision: the device is covered by a healthy data stream subscription */
+FOUNDATION_EXPORT NSString *const AylaPollReasonDSSHealthy;
+
+/** Reason of a poll decision: the data stream is connected but has been silent for too long */
+FOUNDATION_EXPORT NSString *const AylaPollReasonDSSSilent;
+
+/** Reason of a poll decision: a datapoint has recently been created by the app */
+FOUNDATION_EXPORT NSString *const AylaPollReasonUserActivity;
+
+/** Reason of a poll decision: the properties of the device have not changed for a while */
+FOUNDATION_EXPORT NSString *const AylaPollReasonIdle;
+
+/** Reason of a poll decision: none of the other reasons applied */
+FOUNDATION_EXPORT NSString *const AylaPollReasonDefault;
+
+/**
+ * State of a tracked device an `AylaPollPolicy` decides on. Times since events are `DBL_MAX` if the event never
+ * happened.
+ */
+@interface AylaPollContext : NSObject
+
+/** YES if the data stream service is connected */
+@property (nonatomic, assign, readonly) BOOL dssConnected;
+
+/** YES if the current data stream subscription covers the device */
+@property (nonatomic, assign, readonly) BOOL dssCoversDevice;
+
+/** Time since a frame or heart beat was last received from the data stream service */
+@property (nonatomic, assign, readonly) NSTimeInterval timeSinceDSSActivity;
+
+/** Time since a property of the device last changed */
+@property (nonatomic, assign, readonly) NSTimeInterval timeSinceLastChange;
+
+/** Time since the app last created a datapoint on the device */
+@property (nonatomic, assign, readonly) NSTimeInterval timeSinceLastUserWrite;
+
+/** Interval the device is currently checked at */
+@property (nonatomic, assign, readonly) NSTimeInterval currentInterval;
+
+- (instancetype)initWithDSSConnected:(BOOL)dssConnected
+                     dssCoversDevice:(BOOL)dssCoversDevice
+                timeSinceDSSActivity:(NSTimeInterval)timeSinceDSSActivity
+                 timeSinceLastChange:(NSTimeInterval)timeSinceLastChange
+              timeSinceLastUserWrite:(NSTimeInterval)timeSinceLastUserWrite
+                     currentInterval:(NSTimeInterval)currentInterval NS_DESIGNATED_INITIALIZER;
+
+// Unavailable methods
+- (instancetype)init NS_UNAVAILABLE;
+@end
+
+/**
+ * Decision of an `AylaPollPolicy` for one tick of the poll timer of a device.
+ */
+@interface AylaPollDecision : NSObject
+
+/** YES if the properties of the device are fetched on this tick */
+@property (nonatomic, assign, readonly) BOOL shouldPoll;
+
+/** Time until the next tick, in seconds */
+@property (nonatomic, assign, readonly) NSTimeInterval interval;
+
+/** Reason of the decision, one of the `AylaPollReason...` constants for the built-in policy */
+@property (nonatomic, strong, readonly) NSString *reason;
+
+/** Time the decision was taken at */
+@property (nonatomic, strong, readonly) NSDate *date;
+
+/**
+ * @param shouldPoll YES if the properties of the device are fetched on this tick
+ * @param interval   Time until the next tick, in seconds
+ * @param reason     Reason of the decision
+ */
++ (instancetype)decisionToPoll:(BOOL)shouldPoll interval:(NSTimeInterval)interval reason:(NSString *)reason;
+
+/**
+ * @return The decision as a JSON dictionary, for diagnostics
+ */
+- (NSDictionary *)toJSONDictionary;
+
+@end
+
+/**
+ * Decides, on each tick of the poll timer of a tracked device, whether its properties are fetched from the cloud and
+ * when the next tick happens. Devices are not polled while their LAN session is active, whatever the policy.
+ *
+ * Policies are called on the processing queue of the device and must return quickly.
+ */
+@protocol AylaPollPolicy <NSObject>
+
+/**
+ * @param device  Device to decide on
+ * @param context State of the device
+ *
+ * @return Decision for this tick
+ */
+- (AylaPollDecision *)pollDecisionForDevice:(AylaDevice *)device context:(AylaPollContext *)context;
+
+@end
+
+/**
+ * Default poll policy of the SDK.
+ *
+ * - Devices covered by a healthy data stream subscription are not polled, but still checked every `baseInterval`, so
+ *   polling resumes within one interval once the stream drops or goes silent for `dssSilenceTimeout`.
+ * - Devices are polled every `activeInterval` for `activeDuration` after the app created a datapoint on them.
+ * - Devices whose properties have not changed for `idleThreshold` back off, doubling the interval up to
+ *   `idleInterval`.
+ * - Other devices are polled every `baseInterval`.
+ */
+@interface AylaAdaptivePollPolicy : NSObject <AylaPollPolicy>
+
+/** Poll interval of devices with no particular activity. Defaults to 5 seconds. */
+@property (nonatomic, assign) NSTimeInterval baseInterval;
+
+/** Poll interval shortly after a user write. Defaults to 2 seconds. */
+@property (nonatomic, assign) NSTimeInterval activeInterval;
+
+/** Time the active interval is kept after a user write. Defaults to 20 seconds. */
+@property (nonatomic, assign) NSTimeInterval activeDuration;
+
+/** Longest poll interval of idle devices. Defaults to 60 seconds. */
+@property (nonatomic, assign) NSTimeInterval idleInterval;
+
+/** Time without property changes after which a device is idle. Defaults to 120 seconds. */
+@property (nonatomic, assign) NSTimeInterval idleThreshold;
+
+/** Time without frames or heart beats after which a connected data stream is deemed unhealthy. Defaults to 90 seconds. */
+@property (nonatomic, assign) NSTimeInterval dssSilenceTimeout;
+
+@end
+
+NS_ASSUME_NONNULL_END
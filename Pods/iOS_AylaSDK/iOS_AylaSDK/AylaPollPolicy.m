@@ -0,0 +1,122 @@
+//
+//  AylaPollPolicy.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDefines_Internal.h"
+#import "AylaPollPolicy.h"
+
+NSString *const AylaPollReasonDSSHealthy = @"dss_healthy";
+NSString *const AylaPollReasonDSSSilent = @"dss_silent";
+NSString *const AylaPollReasonUserActivity = @"user_activity";
+NSString *const AylaPollReasonIdle = @"idle";
+NSString *const AylaPollReasonDefault = @"default";
+
+@implementation AylaPollContext
+
+- (instancetype)initWithDSSConnected:(BOOL)dssConnected
+                     dssCoversDevice:(BOOL)dssCoversDevice
+                timeSinceDSSActivity:(NSTimeInterval)timeSinceDSSActivity
+                 timeSinceLastChange:(NSTimeInterval)timeSinceLastChange
+              timeSinceLastUserWrite:(NSTimeInterval)timeSinceLastUserWrite
+                     currentInterval:(NSTimeInterval)currentInterval
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _dssConnected = dssConnected;
+    _dssCoversDevice = dssCoversDevice;
+    _timeSinceDSSActivity = timeSinceDSSActivity;
+    _timeSinceLastChange = timeSinceLastChange;
+    _timeSinceLastUserWrite = timeSinceLastUserWrite;
+    _currentInterval = currentInterval;
+
+    return self;
+}
+
+@end
+
+@interface AylaPollDecision ()
+
+@property (nonatomic, assign, readwrite) BOOL shouldPoll;
+@property (nonatomic, assign, readwrite) NSTimeInterval interval;
+@property (nonatomic, strong, readwrite) NSString *reason;
+@property (nonatomic, strong, readwrite) NSDate *date;
+
+@end
+
+@implementation AylaPollDecision
+
++ (instancetype)decisionToPoll:(BOOL)shouldPoll interval:(NSTimeInterval)interval reason:(NSString *)reason
+{
+    AylaPollDecision *decision = [[self alloc] init];
+    decision.shouldPoll = shouldPoll;
+    decision.interval = interval;
+    decision.reason = reason;
+    decision.date = [NSDate date];
+    return decision;
+}
+
+- (NSDictionary *)toJSONDictionary
+{
+    return @{
+        @"should_poll" : @(self.shouldPoll),
+        @"interval" : @(self.interval),
+        @"reason" : self.reason,
+        @"date" : @([self.date timeIntervalSince1970])
+    };
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ poll:%d interval:%.1fs reason:%@>",
+                                      NSStringFromClass([self class]),
+                                      self.shouldPoll,
+                                      self.interval,
+                                      self.reason];
+}
+
+@end
+
+@implementation AylaAdaptivePollPolicy
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _baseInterval = 5;
+    _activeInterval = 2;
+    _activeDuration = 20;
+    _idleInterval = 60;
+    _idleThreshold = 120;
+    _dssSilenceTimeout = 90;
+
+    return self;
+}
+
+- (AylaPollDecision *)pollDecisionForDevice:(AylaDevice *)device context:(AylaPollContext *)context
+{
+    if (context.dssConnected && context.dssCoversDevice) {
+        if (context.timeSinceDSSActivity < self.dssSilenceTimeout) {
+            // Keep ticking at the base interval so a stream drop is caught within one interval
+            return [AylaPollDecision decisionToPoll:NO interval:self.baseInterval reason:AylaPollReasonDSSHealthy];
+        }
+        return [AylaPollDecision decisionToPoll:YES interval:self.baseInterval reason:AylaPollReasonDSSSilent];
+    }
+
+    if (context.timeSinceLastUserWrite < self.activeDuration) {
+        return [AylaPollDecision decisionToPoll:YES interval:self.activeInterval reason:AylaPollReasonUserActivity];
+    }
+
+    if (context.timeSinceLastChange >= self.idleThreshold) {
+        NSTimeInterval interval = MIN(MAX(context.currentInterval, self.baseInterval) * 2, self.idleInterval);
+        return [AylaPollDecision decisionToPoll:YES interval:interval reason:AylaPollReasonIdle];
+    }
+
+    return [AylaPollDecision decisionToPoll:YES interval:self.baseInterval reason:AylaPollReasonDefault];
+}
+
+@end
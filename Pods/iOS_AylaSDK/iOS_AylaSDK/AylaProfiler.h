@@ -8,6 +8,24 @@
 
 #import "AylaNetworks.h"
 
+/** Session phase: resolution of the host of a cloud service while pre-warming */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhasePrewarmDNS;
+
+/** Session phase: connection, TLS handshake included, to the host of a cloud service while pre-warming */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhasePrewarmConnect;
+
+/** Session phase: fetch of the device list by the device manager */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhaseDeviceListFetch;
+
+/** Session phase: init of the device manager, from the device list fetch to the setup of all devices */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhaseDeviceManagerInit;
+
+/** Session phase: creation of the data stream subscription */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhaseDSSSubscribe;
+
+/** Session phase: opening of the data stream web socket */
+FOUNDATION_EXPORT NSString *const AylaProfilerPhaseDSSConnect;
+
 /**
  Describes an object that will receive Cloud task updates from profiler
  */
@@ -69,10 +87,41 @@
 @end
 
 
+/**
+ Describes an object that will receive LAN session updates from profiler
+ */
+@protocol AylaLanSessionProfilerListener <NSObject>
+
+/**
+ Notifies when a LAN session has been established
+
+ @param dsn      DSN of the device the session was established with
+ @param duration time from the session being opened to the key exchange completing, lan config fetch included
+ */
+- (void)didEstablishLANSessionWithDsn:(NSString *)dsn duration:(CFTimeInterval)duration;
+@end
+
+
+/**
+ Describes an object that will receive session start updates from profiler
+ */
+@protocol AylaSessionPhaseProfilerListener <NSObject>
+
+/**
+ Notifies when a phase of a session start, on login or resume, has completed
+
+ @param phase    the phase, one of the `AylaProfilerPhase...` constants
+ @param host     host of the cloud service the phase applies to, nil for phases which apply to several hosts
+ @param duration duration of the phase
+ */
+- (void)didCompleteSessionPhase:(NSString *)phase host:(NSString *)host duration:(CFTimeInterval)duration;
+@end
+
+
 /**
  Forwards network time measurements of tasks to all listeners.
  */
-@interface AylaProfiler : NSObject <AylaCloudTaskProfilerListener, AylaLanTaskProfilerListener>
+@interface AylaProfiler : NSObject <AylaCloudTaskProfilerListener, AylaLanTaskProfilerListener, AylaLanSessionProfilerListener, AylaSessionPhaseProfilerListener>
 
 /**
  @return Shared instance of the profiler
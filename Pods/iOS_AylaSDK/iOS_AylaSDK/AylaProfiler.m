@@ -9,6 +9,13 @@
 #import "AylaProfiler.h"
 #import "AylaListenerArray.h"
 
+NSString *const AylaProfilerPhasePrewarmDNS = @"prewarm.dns";
+NSString *const AylaProfilerPhasePrewarmConnect = @"prewarm.connect";
+NSString *const AylaProfilerPhaseDeviceListFetch = @"device_list.fetch";
+NSString *const AylaProfilerPhaseDeviceManagerInit = @"device_manager.init";
+NSString *const AylaProfilerPhaseDSSSubscribe = @"dss.subscribe";
+NSString *const AylaProfilerPhaseDSSConnect = @"dss.connect";
+
 @interface AylaProfiler ()
 
 @property (nonatomic, strong) AylaListenerArray *listeners;
@@ -71,4 +78,16 @@
     }];
 }
 
+- (void)didEstablishLANSessionWithDsn:(NSString *)dsn duration:(CFTimeInterval)duration {
+    [self.listeners iterateListenersRespondingToSelector:_cmd block:^(id  _Nonnull listener) {
+        [listener didEstablishLANSessionWithDsn:dsn duration:duration];
+    }];
+}
+
+- (void)didCompleteSessionPhase:(NSString *)phase host:(NSString *)host duration:(CFTimeInterval)duration {
+    [self.listeners iterateListenersRespondingToSelector:_cmd block:^(id  _Nonnull listener) {
+        [listener didCompleteSessionPhase:phase host:host duration:duration];
+    }];
+}
+
 @end
@@ -5,6 +5,7 @@
 //
 
 #import "AylaDatapointParams.h"
+#import "AylaDatapointSink.h"
 #import "AylaObject.h"
 #import "AylaPropertyTrigger.h"
 #import "AylaPropertyChange.h"
@@ -74,6 +75,14 @@ FOUNDATION_EXPORT NSString *const AylaPropertyBaseTypeFile;
 /** Passthrough property to the metadata in the most recent datapoint */
 @property (nonatomic, copy, readonly) NSDictionary *metadata;
 
+/**
+ * Returns an immutable snapshot of the property, made by copying its fields. The snapshot is not updated afterwards.
+ * `copy` returns a snapshot too.
+ *
+ * @return Snapshot of the property.
+ */
+- (instancetype)snapshot;
+
 /** @name Datapoint Methods */
 
 /**
@@ -82,7 +91,9 @@ FOUNDATION_EXPORT NSString *const AylaPropertyBaseTypeFile;
  *
  * @param datapointParams Parameters of the datapoint to be created.
  * @param successBlock A block to be called if the request is successful. Passed the created `AylaDataPoint` object.
- * @param failureBlock A block to be called if the request fails. Passed an `NSError` object describing the failure.
+ * @param failureBlock A block to be called if the request fails. Passed an `NSError` object describing the failure. If
+ * the cloud service could not be reached and the datapoint outbox is enabled, the datapoint has been queued and is found
+ * in the user info of the error under `AylaDatapointOutboxQueuedDatapointKey`.
  */
 - (nullable AylaConnectTask *)createDatapoint:(AylaDatapointParams *)datapointParams
                                       success:(void (^)(AylaDatapoint * createdDatapoint))successBlock
@@ -125,6 +136,10 @@ FOUNDATION_EXPORT NSString *const AylaPropertyBaseTypeFile;
 /**
  Fetches a collection of datapoints for this property from the server.
 
+ When both `from` and `to` are set and `AylaCacheTypeDatapointHistory` is enabled, ranges fetched before are served
+ from the local history cache and only the part of the range which is not cached yet is requested from the server.
+ Datapoints served from the cache carry the value, creation time, id and metadata of the datapoint.
+
  @param count Number of datapoints to fetch. If zero, will fetch the maximum number of datapoints allowed in a single API call (MAX_DATAPOINT_COUNT).
  @param from Date of earliest datapoint to fetch. May be nil.
  @param to Date of the latest datapoint to fetch. May be null.
@@ -133,11 +148,41 @@ FOUNDATION_EXPORT NSString *const AylaPropertyBaseTypeFile;
  
  @return A started `AylaHTTPTask` representing the request.
  */
-- (AylaHTTPTask *)fetchDatapointsWithCount:(NSInteger)count
-                                      from:(nullable NSDate *)from
-                                        to:(nullable NSDate *)to
-                                   success:(nullable void (^)(NSArray<AylaDatapoint *>*fetchedDatapoint))successBlock
-                                   failure:(nullable void (^)(NSError *error))failureBlock;
+- (nullable AylaHTTPTask *)fetchDatapointsWithCount:(NSInteger)count
+                                               from:(nullable NSDate *)from
+                                                 to:(nullable NSDate *)to
+                                            success:(nullable void (^)(NSArray<AylaDatapoint *>*fetchedDatapoint))successBlock
+                                            failure:(nullable void (^)(NSError *error))failureBlock;
+
+/**
+ Streams the datapoint history of this property from the server, without the `MAX_DATAPOINT_COUNT` limit of
+ `fetchDatapointsWithCount:from:to:success:failure:`.
+
+ The requested range is walked in time windows of `windowInterval` seconds. A window which returns a full page is
+ split in half and fetched again, so no datapoint is skipped regardless of how many were created in it. Responses are
+ decoded on a background queue and written into `sink` in chronological order as soon as every earlier window has been
+ written. Windows covered by the local history cache are read from disk instead, and fetched windows are added to it.
+
+ @param from Date of the earliest datapoint to stream.
+ @param to Date of the latest datapoint to stream. If nil, the current date is used.
+ @param windowInterval Length of each time window in seconds. Values below one second are rounded up to one second.
+ @param maxConcurrentWindows Number of windows which may be fetched at the same time. Zero is treated as one.
+ @param sink The `AylaDatapointSink` the decoded datapoints are written into. The sink is retained until the stream
+ finishes.
+ @param successBlock A block to be called once the whole range has been streamed, or the sink stopped the stream.
+ Passed the total number of datapoints written.
+ @param failureBlock A block to be called if a window could not be fetched or decoded, or the returned task is
+ cancelled. Passed an `NSError` object describing the failure.
+
+ @return A started `AylaConnectTask` representing the stream, which may be cancelled while the stream is in progress.
+ */
+- (nullable AylaConnectTask *)streamDatapointsFrom:(NSDate *)from
+                                                to:(nullable NSDate *)to
+                                    windowInterval:(NSTimeInterval)windowInterval
+                              maxConcurrentWindows:(NSUInteger)maxConcurrentWindows
+                                              sink:(id<AylaDatapointSink>)sink
+                                           success:(void (^)(NSUInteger datapointCount))successBlock
+                                           failure:(void (^)(NSError *error))failureBlock;
 
 /** @name Property Trigger Methods */
 /**
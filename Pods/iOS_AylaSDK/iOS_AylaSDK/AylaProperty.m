@@ -4,15 +4,22 @@
 //  Copyright © 2015 Ayla Networks. All rights reserved.
 //
 
+#import "AylaCache+Internal.h"
+#import "AylaConnectTask+Internal.h"
 #import "AylaDatapoint+Internal.h"
 #import "AylaDatapointBlob.h"
+#import "AylaDatapointOutbox+Internal.h"
+#import "AylaDatapointHistoryCache.h"
+#import "AylaDatapointStreamTask.h"
 #import "AylaDefines_Internal.h"
 #import "AylaDevice+Internal.h"
+#import "AylaDeviceManager.h"
 #import "AylaErrorUtils.h"
 #import "AylaHTTPClient.h"
 #import "AylaHTTPTask.h"
 #import "AylaLanCommand.h"
 #import "AylaLanTask.h"
+#import "AylaMetrics.h"
 #import "AylaNetworks+Internal.h"
 #import "AylaObject+Internal.h"
 #import "AylaPoll.h"
@@ -22,6 +29,7 @@
 #import "AylaPropertyTrigger+Internal.h"
 #import "AylaSessionManager+Internal.h"
 #import "AylaSystemUtils.h"
+#import "AylaTracer.h"
 #import "NSObject+Ayla.h"
 #import "AylaLanTaskProfiler.h"
 
@@ -151,6 +159,40 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
     return self;
 }
 
+- (instancetype)snapshot
+{
+    return [self copy];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    AylaProperty *snapshot = [[self.class allocWithZone:zone] init];
+    [self copyFieldsToSnapshot:snapshot];
+    return snapshot;
+}
+
+- (void)copyFieldsToSnapshot:(AylaProperty *)snapshot
+{
+    snapshot->_device = _device;
+    snapshot->_key = _key;
+    snapshot->_name = _name;
+    snapshot->_baseType = _baseType;
+    snapshot->_type = _type;
+    snapshot->_direction = _direction;
+    snapshot->_displayName = _displayName;
+    snapshot->_dataUpdatedAt = _dataUpdatedAt;
+    snapshot->_ackEnabled = _ackEnabled;
+    snapshot->_ackedAt = _ackedAt;
+    snapshot->_ackStatus = _ackStatus;
+    snapshot->_ackMessage = _ackMessage;
+    snapshot->_lastUpdateSource = _lastUpdateSource;
+
+    // Datapoints are replaced, never mutated, so the snapshot shares the current one. It is assigned directly to leave
+    // the datapoint pointing at the live property.
+    snapshot->_datapoint = _datapoint;
+    snapshot->_processingQueue = dispatch_get_main_queue();
+}
+
 - (void)setDelegate:(id<AylaPropertyInternalDelegate>)delegate
 {
     _delegate = delegate;
@@ -207,21 +249,80 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
                              success:(void (^)(AylaDatapoint *createdDatapoint))successBlock
                              failure:(void (^)(NSError *error))failureBlock
 {
-    AylaConnectTask *task;
-    // if baseType is file, then don't use LAN creation
-    if (!self.device.isLanModeActive || [self.baseType isEqualToString:AylaPropertyBaseTypeFile]) {
-        task = [self createDatapointCloud:datapointParams success:successBlock failure:failureBlock];
+    // Let the poll policy shorten the poll interval of the device for a while
+    [self.device recordUserWrite];
+
+    AylaTracer *tracer = [AylaTracer sharedTracer];
+    NSString *traceId = [tracer beginTraceWithName:@"createDatapoint"];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSDictionary *details = @{ @"property" : self.name ?: @"" };
+    void (^tracedSuccessBlock)(AylaDatapoint *) = ^(AylaDatapoint *createdDatapoint) {
+        [tracer recordSpanWithName:@"createDatapoint"
+                          category:@"operation"
+                           traceId:traceId
+                         startTime:startTime
+                           details:details];
+        successBlock(createdDatapoint);
+    };
+    void (^tracedFailureBlock)(NSError *) = ^(NSError *error) {
+        [tracer recordSpanWithName:@"createDatapoint"
+                          category:@"operation"
+                           traceId:traceId
+                         startTime:startTime
+                           details:details];
+        failureBlock(error);
+    };
+
+    __block AylaConnectTask *task;
+    [tracer performInTrace:traceId
+                     block:^{
+                         // if baseType is file, then don't use LAN creation
+                         if (!self.device.isLanModeActive ||
+                             [self.baseType isEqualToString:AylaPropertyBaseTypeFile]) {
+                             [[AylaMetrics sharedMetrics] incrementCounter:@"routing.createDatapoint.cloud"];
+                             task = [self createDatapointCloud:datapointParams
+                                                       success:tracedSuccessBlock
+                                                       failure:^(NSError *error) {
+                                                           tracedFailureBlock(
+                                                               [self queueDatapoint:datapointParams afterError:error]);
+                                                       }];
+                         }
+                         else {
+                             [[AylaMetrics sharedMetrics] incrementCounter:@"routing.createDatapoint.lan"];
+                             task = [self createDatapointLAN:datapointParams
+                                                     success:tracedSuccessBlock
+                                                     failure:tracedFailureBlock];
+                         }
+                     }];
+    return task;
+}
+
+/**
+ * Queues a datapoint in the outbox of the device manager if it could not be created because the cloud service was
+ * unreachable.
+ *
+ * @return The error to pass to the caller, holding the queued datapoint if it has been queued
+ */
+- (NSError *)queueDatapoint:(AylaDatapointParams *)datapointParams afterError:(NSError *)error
+{
+    AylaDatapointOutbox *outbox = self.device.deviceManager.datapointOutbox;
+    if (!outbox || ![AylaDatapointOutbox shouldQueueDatapointAfterError:error]) {
+        return error;
     }
-    else {
-        task = [self createDatapointLAN:datapointParams success:successBlock failure:failureBlock];
+    AylaQueuedDatapoint *queued = [outbox queueDatapoint:datapointParams forProperty:self];
+    if (!queued) {
+        return error;
     }
-    return task;
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:error.userInfo];
+    userInfo[AylaDatapointOutboxQueuedDatapointKey] = queued;
+    return [NSError errorWithDomain:error.domain code:error.code userInfo:userInfo];
 }
 
 - (AylaConnectTask *)createDatapointCloud:(AylaDatapointParams *)datapointParams
                                   success:(void (^)(AylaDatapoint *createdDatapoint))successBlock
                                   failure:(void (^)(NSError *error))failureBlock
 {
+    NSString *traceId = [AylaTracer currentTraceId];
     NSError *error;
     if (![self validateValue:datapointParams lanMode:NO error:&error]) {
         dispatch_async(dispatch_get_main_queue(), ^{
@@ -280,12 +381,20 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
             }
             void (^notifyCreation)(AylaDatapoint *datapoint) = ^(AylaDatapoint *datapoint) {
                 AylaLogI([self logTag], 0, @"%@, %@", @"complete", @"createDatapointCloud");
+                CFAbsoluteTime notifyTime = CFAbsoluteTimeGetCurrent();
                 dispatch_async(self.processingQueue, ^{
                     [self.delegate property:self
                          didCreateDatapoint:datapoint
                              propertyChange:[self updateFromDatapoint:datapoint]];
 
                     dispatch_async(dispatch_get_main_queue(), ^{
+                        if (traceId) {
+                            [[AylaTracer sharedTracer] recordSpanWithName:@"notify"
+                                                                 category:@"notify"
+                                                                  traceId:traceId
+                                                                startTime:notifyTime
+                                                                  details:nil];
+                        }
                         successBlock(datapoint);
                     });
                 });
@@ -293,25 +402,38 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
             };
 
             if (self.ackEnabled && createdDatapoint.ackedAt == nil) {
+                CFAbsoluteTime ackStartTime = CFAbsoluteTimeGetCurrent();
                 AylaPoll *poll = [[AylaPoll alloc]
                     initWithPollBlock:^(ContinueBlock _Nonnull continueBlock, BOOL *stop, NSInteger repetitionNumber) {
-                        [self fetchDatapointWithId:createdDatapoint.id
-                            success:^(AylaDatapoint *fetchedDatapoint) {
-                                if (fetchedDatapoint.ackedAt != nil) {
-                                    *stop = YES;
-                                    notifyCreation(fetchedDatapoint);
+                        [[AylaTracer sharedTracer] performInTrace:traceId block:^{
+                            [self fetchDatapointWithId:createdDatapoint.id
+                                success:^(AylaDatapoint *fetchedDatapoint) {
+                                    if (fetchedDatapoint.ackedAt != nil) {
+                                        *stop = YES;
+                                        [[AylaTracer sharedTracer] recordSpanWithName:@"ack"
+                                                                             category:@"ack"
+                                                                              traceId:traceId
+                                                                            startTime:ackStartTime
+                                                                              details:@{ @"polls" : @(repetitionNumber + 1) }];
+                                        notifyCreation(fetchedDatapoint);
+                                    }
+                                    else {
+                                        continueBlock();
+                                    }
                                 }
-                                else {
+                                failure:^(NSError *error) {
                                     continueBlock();
-                                }
-                            }
-                            failure:^(NSError *error) {
-                                continueBlock();
-                            }];
+                                }];
+                        }];
                     }
                     delay:DEFAULT_DATAPOINT_ACK_DELAY
                     timeout:DEFAULT_DATAPOINT_ACK_TIMEOUT
                     timeoutBlock:^{
+                        [[AylaTracer sharedTracer] recordSpanWithName:@"ack"
+                                                             category:@"ack"
+                                                              traceId:traceId
+                                                            startTime:ackStartTime
+                                                              details:@{ @"timedOut" : @YES }];
                         NSError *error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
                                                                     code:AylaRequestErrorCodeTimedOut
                                                                 userInfo:nil];
@@ -335,6 +457,7 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
                                 success:(void (^)(AylaDatapoint *createdDatapint))successBlock
                                 failure:(void (^)(NSError *error))failureBlock
 {
+    NSString *traceId = [AylaTracer currentTraceId];
     NSError *error;
     if (![self validateValue:datapointParams lanMode:YES error:&error]) {
         dispatch_async(dispatch_get_main_queue(), ^{
@@ -405,8 +528,16 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
             datapoint.property = self;
 
             AylaLogI([self logTag], 0, @"%@, %@", @"complete", @"createDatapointLAN");
+            CFAbsoluteTime notifyTime = CFAbsoluteTimeGetCurrent();
             [self updateAndNotifyDelegateFromDatapoint:datapoint
                                           successBlock:^{
+                                              if (traceId) {
+                                                  [[AylaTracer sharedTracer] recordSpanWithName:@"notify"
+                                                                                       category:@"notify"
+                                                                                        traceId:traceId
+                                                                                      startTime:notifyTime
+                                                                                        details:nil];
+                                              }
                                               successBlock(datapoint);
                                           }];
         }
@@ -499,77 +630,247 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
                                    success:(void (^)(NSArray<AylaDatapoint *>*fetchedDatapoint))successBlock
                                    failure:(void (^)(NSError *error))failureBlock
     {
-        
-        NSError *error;
-        AylaHTTPClient *httpClient = [self getHttpClient:&error];
-        if (error) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                failureBlock(error);
-            });
-            return nil;
-        }
-        
         if (count <= 0 || count > MAX_DATAPOINT_COUNT) {
             count = MAX_DATAPOINT_COUNT;
         }
         
-        NSMutableDictionary *params = [NSMutableDictionary dictionaryWithObject:@(count) forKey:@"limit"];
-        if (from != nil) {
-            NSString *fromString = [[AylaSystemUtils defaultDateFormatter] stringFromDate:from];
-            params[@"filter[created_at_since_date]"] = fromString;
+        // Only a closed range can be served from the history cache
+        AylaDatapointHistoryCache *historyCache = from && to ? [self datapointHistoryCache] : nil;
+        if (historyCache == nil) {
+            return [self fetchDatapointsCloudWithCount:count
+                                                  from:from
+                                                    to:to
+                                          historyCache:nil
+                                               success:successBlock
+                                               failure:failureBlock];
         }
         
-        if (to != nil) {
-            NSString *fromString = [[AylaSystemUtils defaultDateFormatter] stringFromDate:to];
-            params[@"filter[created_at_end_date]"] = fromString;
-        }
-        
-        NSString *path = [NSString
-                          stringWithFormat:@"properties/%@/datapoints.json", self.key];
-        
-        return [httpClient getPath:path
-                        parameters:params
-                           success:^(AylaHTTPTask *_Nonnull task, NSDictionary *_Nullable responseObject) {
-                               NSMutableArray *datapoints = [NSMutableArray array];
-                               
-                               for (NSDictionary *datapointJSON in responseObject) {
-                                   NSError *error;
-                                   NSDictionary *datapointDictionary = datapointJSON[attrNameDatapoint];
-                                   
-                                   Class datapointClass = [AylaDatapoint class];
-                                   if (datapointDictionary[attrNameFile]) {
-                                       datapointClass = [AylaDatapointBlob class];
-                                   }
-                                   AylaDatapoint *datapoint = [[datapointClass alloc] initWithJSONDictionary:datapointDictionary error:&error];
-                                   datapoint.property = self;
-                                   if (error) {
-                                       AylaLogE([self logTag], 0, @"invalidResp:%@, %@", responseObject, @"createDatapointCloud");
-                                       dispatch_async(dispatch_get_main_queue(), ^{
-                                           failureBlock(error);
-                                       });
-                                       return;
-                                   }
-                                   [datapoints addObject:datapoint];
-                               }
-                               
-                               AylaLogI([self logTag], 0, @"%@, %@", @"complete", NSStringFromSelector(_cmd));
-                               
-                               if (successBlock != nil) {
-                                   dispatch_async(dispatch_get_main_queue(), ^{
-                                           successBlock(datapoints);
-                                   });
-                               }
-                           }
-                           failure:^(AylaHTTPTask *_Nonnull task, NSError *_Nonnull error) {
-                               AylaLogE([self logTag], 0, @"err:%@, %@", error, NSStringFromSelector(_cmd));
-                               
-                               if (failureBlock != nil) {
-                                   dispatch_async(dispatch_get_main_queue(), ^{
-                                       failureBlock(error);
-                                   });
-                               }
-                           }];
+        // The cache is read off the main queue, the returned task is chained to the cloud fetch which may follow.
+        AylaHTTPTask *task = [[AylaHTTPTask alloc] initWithTask:nil];
+        __weak AylaHTTPTask *weakTask = task;
+        [historyCache readDatapointsForPropertyKey:self.key
+                                              from:from
+                                                to:to
+                                        completion:^(NSArray<AylaDatapoint *> *cachedDatapoints, NSDate *coveredUntil, AylaDatapointHistoryOrder order) {
+            if (weakTask.cancelled) {
+                return;
+            }
+            for (AylaDatapoint *datapoint in cachedDatapoints) {
+                datapoint.property = self;
+            }
+            
+            // Cached datapoints are only returned if the cloud would have returned every datapoint of the range as well
+            BOOL coversRange = coveredUntil && [coveredUntil compare:to] != NSOrderedAscending;
+            if (coversRange && cachedDatapoints.count <= count) {
+                AylaLogI([self logTag], 0, @"%@, %@", @"fromCache", NSStringFromSelector(_cmd));
+                if (successBlock != nil) {
+                    successBlock([self datapoints:cachedDatapoints inOrder:order]);
+                }
+                return;
+            }
+            
+            // Otherwise only fetch the tail which is not covered yet
+            if (coversRange || cachedDatapoints == nil || cachedDatapoints.count >= count) {
+                weakTask.chainedTask = [self fetchDatapointsCloudWithCount:count
+                                                                      from:from
+                                                                        to:to
+                                                              historyCache:historyCache
+                                                                   success:successBlock
+                                                                   failure:failureBlock];
+                return;
+            }
+            weakTask.chainedTask = [self fetchDatapointsCloudWithCount:count
+                from:coveredUntil
+                to:to
+                historyCache:historyCache
+                success:^(NSArray<AylaDatapoint *> *tailDatapoints) {
+                    if (weakTask.cancelled) {
+                        return;
+                    }
+                    NSMutableSet *headIdentifiers = [NSMutableSet setWithArray:[cachedDatapoints valueForKey:NSStringFromSelector(@selector(historyIdentifier))]];
+                    NSMutableArray *datapoints = [cachedDatapoints mutableCopy];
+                    for (AylaDatapoint *datapoint in tailDatapoints) {
+                        if (![headIdentifiers containsObject:[datapoint historyIdentifier]]) {
+                            [datapoints addObject:datapoint];
+                        }
+                    }
+                    if (tailDatapoints.count < count && datapoints.count <= count) {
+                        // Return the merged range in the order the cloud returns datapoints in
+                        AylaDatapointHistoryOrder tailOrder = [AylaDatapointHistoryCache orderOfDatapoints:tailDatapoints];
+                        [datapoints sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(AylaDatapoint *obj1, AylaDatapoint *obj2) {
+                            return [obj1.createdAt compare:obj2.createdAt];
+                        }];
+                        if (successBlock != nil) {
+                            successBlock([self datapoints:datapoints inOrder:tailOrder != AylaDatapointHistoryOrderUnknown ? tailOrder : order]);
+                        }
+                        return;
+                    }
+                    
+                    // The combined range holds more datapoints than requested, let the cloud pick them
+                    weakTask.chainedTask = [self fetchDatapointsCloudWithCount:count
+                                                                          from:from
+                                                                            to:to
+                                                                  historyCache:nil
+                                                                       success:successBlock
+                                                                       failure:failureBlock];
+                }
+                failure:failureBlock];
+        }];
+        return task;
+    }
+
+/**
+ * Arranges datapoints sorted by `createdAt` in the given order, keeping them ascending if the order is unknown.
+ */
+- (NSArray<AylaDatapoint *> *)datapoints:(NSArray<AylaDatapoint *> *)datapoints inOrder:(AylaDatapointHistoryOrder)order
+{
+    return order == AylaDatapointHistoryOrderDescending ? [[datapoints reverseObjectEnumerator] allObjects] : datapoints;
+}
+
+/**
+ * Fetches a page of datapoints from the cloud and records it in the history cache if the page holds every datapoint
+ * of the range. Blocks are called on main queue.
+ */
+- (AylaHTTPTask *)fetchDatapointsCloudWithCount:(NSInteger)count
+                                           from:(NSDate *)from
+                                             to:(NSDate *)to
+                                   historyCache:(AylaDatapointHistoryCache *)historyCache
+                                        success:(void (^)(NSArray<AylaDatapoint *> *fetchedDatapoint))successBlock
+                                        failure:(void (^)(NSError *error))failureBlock
+{
+    return [self fetchDatapointsJSONWithCount:count
+                                         from:from
+                                           to:to
+                                      success:^(NSArray *datapointsJSON) {
+                                          NSMutableArray *datapoints = [NSMutableArray array];
+                                          
+                                          for (NSDictionary *datapointJSON in datapointsJSON) {
+                                              NSError *error;
+                                              AylaDatapoint *datapoint = [self datapointWithJSONDictionary:datapointJSON error:&error];
+                                              if (error) {
+                                                  AylaLogE([self logTag], 0, @"invalidResp:%@, %@", datapointsJSON, @"createDatapointCloud");
+                                                  if (failureBlock != nil) {
+                                                      dispatch_async(dispatch_get_main_queue(), ^{
+                                                          failureBlock(error);
+                                                      });
+                                                  }
+                                                  return;
+                                              }
+                                              [datapoints addObject:datapoint];
+                                          }
+                                          
+                                          if (datapoints.count < count) {
+                                              [historyCache appendDatapoints:[datapoints copy] forPropertyKey:self.key from:from to:to];
+                                          }
+                                          
+                                          AylaLogI([self logTag], 0, @"%@, %@", @"complete", NSStringFromSelector(_cmd));
+                                          
+                                          if (successBlock != nil) {
+                                              dispatch_async(dispatch_get_main_queue(), ^{
+                                                  successBlock(datapoints);
+                                              });
+                                          }
+                                      }
+                                      failure:^(NSError *error) {
+                                          if (failureBlock != nil) {
+                                              dispatch_async(dispatch_get_main_queue(), ^{
+                                                  failureBlock(error);
+                                              });
+                                          }
+                                      }];
+}
+
+- (AylaHTTPTask *)fetchDatapointsJSONWithCount:(NSInteger)count
+                                          from:(NSDate *)from
+                                            to:(NSDate *)to
+                                       success:(void (^)(NSArray *datapointsJSON))successBlock
+                                       failure:(void (^)(NSError *error))failureBlock
+{
+    NSError *error;
+    AylaHTTPClient *httpClient = [self getHttpClient:&error];
+    if (error) {
+        failureBlock(error);
+        return nil;
+    }
+    
+    if (count <= 0 || count > MAX_DATAPOINT_COUNT) {
+        count = MAX_DATAPOINT_COUNT;
+    }
+    
+    NSMutableDictionary *params = [NSMutableDictionary dictionaryWithObject:@(count) forKey:@"limit"];
+    if (from != nil) {
+        NSString *fromString = [[AylaSystemUtils defaultDateFormatter] stringFromDate:from];
+        params[@"filter[created_at_since_date]"] = fromString;
+    }
+    
+    if (to != nil) {
+        NSString *toString = [[AylaSystemUtils defaultDateFormatter] stringFromDate:to];
+        params[@"filter[created_at_end_date]"] = toString;
     }
+    
+    NSString *path = [NSString
+                      stringWithFormat:@"properties/%@/datapoints.json", self.key];
+    
+    return [httpClient getPath:path
+                    parameters:params
+                       success:^(AylaHTTPTask *_Nonnull task, id _Nullable responseObject) {
+                           successBlock([responseObject isKindOfClass:[NSArray class]] ? responseObject : @[]);
+                       }
+                       failure:^(AylaHTTPTask *_Nonnull task, NSError *_Nonnull error) {
+                           AylaLogE([self logTag], 0, @"err:%@, %@", error, NSStringFromSelector(_cmd));
+                           failureBlock(error);
+                       }];
+}
+
+- (AylaDatapoint *)datapointWithJSONDictionary:(NSDictionary *)datapointJSON error:(NSError *__autoreleasing _Nullable *)error
+{
+    NSDictionary *datapointDictionary = datapointJSON[attrNameDatapoint];
+    
+    Class datapointClass = [AylaDatapoint class];
+    if (datapointDictionary[attrNameFile]) {
+        datapointClass = [AylaDatapointBlob class];
+    }
+    AylaDatapoint *datapoint = [[datapointClass alloc] initWithJSONDictionary:datapointDictionary error:error];
+    datapoint.property = self;
+    return datapoint;
+}
+
++ (NSInteger)maxDatapointCount
+{
+    return MAX_DATAPOINT_COUNT;
+}
+
+- (AylaConnectTask *)streamDatapointsFrom:(NSDate *)from
+                                       to:(NSDate *)to
+                           windowInterval:(NSTimeInterval)windowInterval
+                     maxConcurrentWindows:(NSUInteger)maxConcurrentWindows
+                                     sink:(id<AylaDatapointSink>)sink
+                                  success:(void (^)(NSUInteger datapointCount))successBlock
+                                  failure:(void (^)(NSError *error))failureBlock
+{
+    NSDate *endDate = to ?: [NSDate date];
+    if (!from || !sink || [from compare:endDate] != NSOrderedAscending) {
+        NSString *invalidParam = !from ? @"from" : (!sink ? @"sink" : @"to");
+        NSError *error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                                    code:AylaRequestErrorCodeInvalidArguments
+                                                userInfo:@{AylaRequestErrorResponseJsonKey : @{invalidParam : AylaErrorDescriptionIsInvalid}}];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            failureBlock(error);
+        });
+        return nil;
+    }
+    
+    AylaDatapointStreamTask *task = [[AylaDatapointStreamTask alloc] initWithProperty:self
+                                                                                  from:from
+                                                                                    to:endDate
+                                                                        windowInterval:windowInterval
+                                                                  maxConcurrentWindows:maxConcurrentWindows
+                                                                                  sink:sink
+                                                                               success:successBlock
+                                                                               failure:failureBlock];
+    [task start];
+    return task;
+}
 
 - (void)updateAndNotifyDelegateFromDatapoint:(AylaDatapoint *)datapoint successBlock:(nonnull void (^)())successBlock
 {
@@ -931,6 +1232,12 @@ static NSString* AylaLanTaskClass = @"AylaLanTask";
     return client;
 }
 
+- (AylaDatapointHistoryCache *)datapointHistoryCache
+{
+    AylaSessionManager *manager = (AylaSessionManager *)[self valueForKeyPath:@"device.deviceManager.sessionManager"];
+    return [manager.aylaCache datapointHistoryCache];
+}
+
 + (void)enableNetworkProfiler {
     AylaLanTaskClass = NSStringFromClass([AylaLanTaskProfiler class]);
 }
@@ -12,6 +12,7 @@ NS_ASSUME_NONNULL_BEGIN
 @class AylaAuthorization;
 @class AylaContact;
 @class AylaDatum;
+@class AylaDatumCache;
 @class AylaDeviceManager;
 @class AylaEmailTemplate;
 @class AylaHTTPTask;
@@ -90,6 +91,9 @@ NS_ASSUME_NONNULL_BEGIN
 /** AylaCache instance for the current session */
 @property(nonatomic, readonly) AylaCache *aylaCache;
 
+/** Cache of the user datums of the current session, see `AylaDatumCache` */
+@property(nonatomic, readonly) AylaDatumCache *userDatumCache;
+
 /** Provider used to authenticate */
 @property(nonatomic, readonly) id<AylaAuthProvider> authProvider;
 
@@ -7,9 +7,12 @@
 #import "AylaAuthorization.h"
 #import "AylaCache+Internal.h"
 #import "AylaCache.h"
+#import "AylaConnectionPrewarmer.h"
 #import "AylaContact.h"
 #import "AylaDSManager.h"
+#import "AylaDatapointOutbox.h"
 #import "AylaDatum+Internal.h"
+#import "AylaDatumCache+Internal.h"
 #import "AylaDeviceManager+Internal.h"
 #import "AylaErrorUtils.h"
 #import "AylaHTTPClient.h"
@@ -36,6 +39,7 @@ static const NSUInteger DEFAULT_TOKEN_REFRESH_THRESHOULD_SEC = 1800;
 @property(nonatomic, readwrite) AylaDSManager *dssManager;
 @property(nonatomic) AylaSystemSettings *settings;
 @property(nonatomic, assign) BOOL cachedSession;
+@property(nonatomic, readwrite) AylaDatumCache *userDatumCache;
 
 /** Array of listeners */
 @property(nonatomic, strong, readwrite) AylaListenerArray *listeners;
@@ -69,6 +73,13 @@ static NSString *const AylaShareAccepted = @"accepted";
   [self setupHttpClients];
   _aylaCache = [[AylaCache alloc] initWithSessionName:sessionName];
 
+  __weak typeof(self) weakSelf = self;
+  _userDatumCache = [[AylaDatumCache alloc]
+      initWithCollectionPath:@"api/v1/users/data.json"
+             httpClientBlock:^AylaHTTPClient *(NSError **error) {
+               return [weakSelf userServiceHttpClient];
+             }];
+
   _deviceManager = [[AylaDeviceManager alloc] initWithSessionManager:self];
 
   // Only enable ds manager if allowDSS is set as YES
@@ -116,6 +127,13 @@ static NSString *const AylaShareAccepted = @"accepted";
       [AylaHTTPClient mdssSubscriptionServiceClientWithSettings:self.settings
                                                      usingHTTPS:YES];
 
+  // Enable gzip on the clients of the services chosen in settings.
+  [self.httpClients enumerateKeysAndObjectsUsingBlock:^(
+                        NSNumber *type, AylaHTTPClient *client, BOOL *stop) {
+    client.gzipEnabled = [self.settings.gzipHTTPClientTypes containsObject:type];
+    client.gzipRequestThreshold = self.settings.gzipRequestThreshold;
+  }];
+
   // Update http clients after setup.
   [self updateHttpClients];
 }
@@ -349,9 +367,36 @@ static NSString *const AylaShareAccepted = @"accepted";
 }
 
 - (void)resume {
+  [self prewarmConnections];
   [self validateAuthorization];
-  [self.deviceManager resume];
+  // The subscription covers all devices of the user, so the data stream is
+  // opened alongside the device list fetch rather than after it.
   [self.dssManager resume];
+  [self.deviceManager resume];
+}
+
+/**
+ * Pre-warm connections of the http clients used first on resume.
+ */
+- (void)prewarmConnections {
+  if (!self.settings.prewarmConnections) {
+    return;
+  }
+  NSMutableArray *types = [NSMutableArray
+      arrayWithObjects:@(AylaHTTPClientTypeDeviceService), @(AylaHTTPClientTypeUserService), nil];
+  if (self.dssManager) {
+    [types addObject:@(AylaHTTPClientTypeMDSSService)];
+    [types addObject:@(AylaHTTPClientTypeStreamService)];
+  }
+  NSMutableArray *clients = [NSMutableArray array];
+  for (NSNumber *type in types) {
+    // Clients of services not configured for this session are missing
+    AylaHTTPClient *client = self.httpClients[type];
+    if (client) {
+      [clients addObject:client];
+    }
+  }
+  [[AylaConnectionPrewarmer sharedPrewarmer] prewarmClients:clients];
 }
 
 //-----------------------------------------------------------
@@ -395,6 +440,10 @@ static NSString *const AylaShareAccepted = @"accepted";
 
       // Clear all caches
       [self.aylaCache clearAll];
+      [self.userDatumCache reset];
+
+      // Queued datapoints belong to the user signing out, they must not be replayed for the next one
+      [self.deviceManager.datapointOutbox removeAll];
 
       // Clean authorization
       self.authorization = nil;
@@ -925,11 +974,14 @@ createAylaDatumWithKey:(NSString *)key
   NSString *path = @"api/v1/users/data.json";
 
   return [AylaDatum createDatumWithKey:key
-                                 value:value
-                            httpClient:httpClient
-                                  path:path
-                               success:successBlock
-                               failure:failureBlock];
+      value:value
+      httpClient:httpClient
+      path:path
+      success:^(AylaDatum *createdDatum) {
+        [self.userDatumCache invalidateDatumWithKey:key];
+        successBlock(createdDatum);
+      }
+      failure:failureBlock];
 }
 
 - (nullable AylaHTTPTask *)
@@ -1000,11 +1052,14 @@ updateAylaDatumWithKey:(NSString *)key
       [NSString stringWithFormat:@"api/v1/users/data/%@.json", key];
 
   return [AylaDatum updateKey:key
-                      toValue:value
-                   httpClient:httpClient
-                         path:path
-                      success:successBlock
-                      failure:failureBlock];
+      toValue:value
+      httpClient:httpClient
+      path:path
+      success:^(AylaDatum *updatedDatum) {
+        [self.userDatumCache invalidateDatumWithKey:key];
+        successBlock(updatedDatum);
+      }
+      failure:failureBlock];
 }
 
 - (nullable AylaHTTPTask *)deleteAylaDatumWithKey:(NSString *)key
@@ -1017,10 +1072,13 @@ updateAylaDatumWithKey:(NSString *)key
       [NSString stringWithFormat:@"api/v1/users/data/%@.json", key];
 
   return [AylaDatum deleteKey:key
-                   httpClient:httpClient
-                         path:path
-                      success:successBlock
-                      failure:failureBlock];
+      httpClient:httpClient
+      path:path
+      success:^{
+        [self.userDatumCache invalidateDatumWithKey:key];
+        successBlock();
+      }
+      failure:failureBlock];
 }
 
 @end
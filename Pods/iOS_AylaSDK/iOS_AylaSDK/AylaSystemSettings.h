@@ -28,6 +28,26 @@ NS_ASSUME_NONNULL_BEGIN
 
 #define AYLA_SETTINGS_DEFAULT_DSS_TYPE AylaDSSubscriptionTypeDatapoint;
 
+/** Default time a device keeps being tracked after the app stopped showing it, in seconds */
+#define AYLA_SETTINGS_DEFAULT_DEVICE_INTEREST_GRACE_PERIOD 60
+
+/** Default time a datapoint waits in the outbox before it expires, in seconds */
+#define AYLA_SETTINGS_DEFAULT_DATAPOINT_OUTBOX_EXPIRY (60 * 60)
+
+/** Default minimum size of a request body compressed with gzip, in bytes */
+#define AYLA_SETTINGS_DEFAULT_GZIP_REQUEST_THRESHOLD 1024
+
+/** Key of the user service in `serviceBaseUrlOverrides` */
+FOUNDATION_EXPORT NSString *const AylaServiceNameUser;
+/** Key of the device service in `serviceBaseUrlOverrides` */
+FOUNDATION_EXPORT NSString *const AylaServiceNameDevice;
+/** Key of the log service in `serviceBaseUrlOverrides` */
+FOUNDATION_EXPORT NSString *const AylaServiceNameLog;
+/** Key of the stream service in `serviceBaseUrlOverrides` */
+FOUNDATION_EXPORT NSString *const AylaServiceNameStream;
+/** Key of the stream subscription service in `serviceBaseUrlOverrides` */
+FOUNDATION_EXPORT NSString *const AylaServiceNameStreamSubscription;
+
 /**
  *  Contains a list of system level settings. `AylaNetworks` must use
  *  an instance of this class to complete initialize.
@@ -75,6 +95,51 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy) NSString *fallbackDeviceLANIP;
 
+/**
+ * Base urls used instead of the ones of the Ayla cloud services, keyed by `AylaServiceName...`. Meant to point the SDK
+ * at a local service, e.g. a mock cloud used for load testing. Urls are used as is, scheme included, and must end with
+ * a slash. The device service url must include the api version path, e.g. `http://127.0.0.1:8080/apiv1/`.
+ */
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *serviceBaseUrlOverrides;
+
+/**
+ * If YES, `AylaDeviceManager` only fetches the device list on init. Properties of a device are fetched, and the device
+ * tracked, once the app shows it, see `-[AylaDeviceManager setVisibleDeviceDsns:]`. Defaults to NO.
+ */
+@property (nonatomic) BOOL lazyDevicePropertyHydration;
+
+/**
+ * Time a device keeps being tracked after the app stopped showing it when `lazyDevicePropertyHydration` is enabled, in
+ * seconds. Defaults to 60.
+ */
+@property (nonatomic) NSTimeInterval deviceInterestGracePeriod;
+
+/**
+ * If YES, datapoints which can't be created because neither the cloud service nor the LAN session of their device can
+ * be reached are kept in a durable outbox and created once either becomes available, see
+ * `-[AylaDeviceManager datapointOutbox]`. Defaults to NO.
+ */
+@property (nonatomic) BOOL datapointOutboxEnabled;
+
+/** Time a datapoint waits in the outbox before it expires, in seconds. Defaults to one hour. */
+@property (nonatomic) NSTimeInterval datapointOutboxExpiry;
+
+/**
+ * Types of the HTTP clients, as `AylaHTTPClientType` numbers, which compress request bodies of at least
+ * `gzipRequestThreshold` bytes with gzip and explicitly accept gzip encoded responses. Only add services which accept
+ * gzip encoded requests. Defaults to nil, no compression.
+ */
+@property (nonatomic, copy, nullable) NSSet<NSNumber *> *gzipHTTPClientTypes;
+
+/** Minimum size of a request body compressed with gzip, in bytes. Defaults to 1024. */
+@property (nonatomic) NSUInteger gzipRequestThreshold;
+
+/**
+ * If YES, hosts of the cloud services are resolved and connected to as soon as a login or a session resume begins, so
+ * the first requests of the session don't pay DNS, TCP and TLS setup. Defaults to YES.
+ */
+@property (nonatomic) BOOL prewarmConnections;
+
 /** @name Initializer Methods */
 
 /**
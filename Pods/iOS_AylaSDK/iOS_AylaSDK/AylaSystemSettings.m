@@ -6,6 +6,12 @@
 
 #import "AylaSystemSettings.h"
 
+NSString *const AylaServiceNameUser = @"user";
+NSString *const AylaServiceNameDevice = @"device";
+NSString *const AylaServiceNameLog = @"log";
+NSString *const AylaServiceNameStream = @"stream";
+NSString *const AylaServiceNameStreamSubscription = @"streamSubscription";
+
 @implementation AylaSystemSettings
 
 - (instancetype)init
@@ -21,6 +27,10 @@
     _fallbackDeviceLANIP = AYLA_SETTINGS_DEFAULT_SETUP_DEVICE_IP;
     _deviceSSIDRegex = AYLA_SETTINGS_DEFAULT_DEVICE_SSID_REGEX;
     _dssSubscriptionType = AYLA_SETTINGS_DEFAULT_DSS_TYPE;
+    _deviceInterestGracePeriod = AYLA_SETTINGS_DEFAULT_DEVICE_INTEREST_GRACE_PERIOD;
+    _datapointOutboxExpiry = AYLA_SETTINGS_DEFAULT_DATAPOINT_OUTBOX_EXPIRY;
+    _gzipRequestThreshold = AYLA_SETTINGS_DEFAULT_GZIP_REQUEST_THRESHOLD;
+    _prewarmConnections = YES;
 
     return self;
 }
@@ -42,6 +52,14 @@
     copy.serviceLocation = self.serviceLocation;
     copy.deviceDetailProvider = self.deviceDetailProvider;
     copy.fallbackDeviceLANIP = self.fallbackDeviceLANIP;
+    copy.serviceBaseUrlOverrides = self.serviceBaseUrlOverrides;
+    copy.lazyDevicePropertyHydration = self.lazyDevicePropertyHydration;
+    copy.deviceInterestGracePeriod = self.deviceInterestGracePeriod;
+    copy.datapointOutboxEnabled = self.datapointOutboxEnabled;
+    copy.datapointOutboxExpiry = self.datapointOutboxExpiry;
+    copy.gzipHTTPClientTypes = self.gzipHTTPClientTypes;
+    copy.gzipRequestThreshold = self.gzipRequestThreshold;
+    copy.prewarmConnections = self.prewarmConnections;
 
     return copy;
 }
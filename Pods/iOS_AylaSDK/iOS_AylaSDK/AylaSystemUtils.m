@@ -47,6 +47,10 @@ static NSString *documentsDirectory = nil;
  */
 + (NSString *)userServiceBaseUrl:(AylaSystemSettings *)settings
                         isSecure:(BOOL)isSecure {
+    NSString *overrideUrl = settings.serviceBaseUrlOverrides[AylaServiceNameUser];
+    if (overrideUrl) {
+        return overrideUrl;
+    }
     static NSDictionary *userServiceUrlMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
@@ -84,6 +88,10 @@ static NSString *documentsDirectory = nil;
  */
 + (NSString *)deviceServiceBaseUrl:(AylaSystemSettings *)settings
                           isSecure:(BOOL)isSecure {
+    NSString *overrideUrl = settings.serviceBaseUrlOverrides[AylaServiceNameDevice];
+    if (overrideUrl) {
+        return overrideUrl;
+    }
     static NSDictionary *deviceServiceUrlMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
@@ -121,6 +129,10 @@ static NSString *documentsDirectory = nil;
  */
 + (NSString *)logServiceBaseUrl:(AylaSystemSettings *)settings
                        isSecure:(BOOL)isSecure {
+    NSString *overrideUrl = settings.serviceBaseUrlOverrides[AylaServiceNameLog];
+    if (overrideUrl) {
+        return overrideUrl;
+    }
     static NSDictionary *logServiceUrlMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
@@ -158,6 +170,10 @@ static NSString *documentsDirectory = nil;
  */
 + (NSString *)streamServiceBaseUrl:(AylaSystemSettings *)settings
                           isSecure:(BOOL)isSecure {
+    NSString *overrideUrl = settings.serviceBaseUrlOverrides[AylaServiceNameStream];
+    if (overrideUrl) {
+        return overrideUrl;
+    }
     static NSDictionary *dsServiceUrlMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
@@ -197,6 +213,10 @@ static NSString *documentsDirectory = nil;
  */
 + (NSString *)mdssSubscriptionServiceBaseUrl:(AylaSystemSettings *)settings
                                     isSecure:(BOOL)isSecure {
+    NSString *overrideUrl = settings.serviceBaseUrlOverrides[AylaServiceNameStreamSubscription];
+    if (overrideUrl) {
+        return overrideUrl;
+    }
     static NSDictionary *dsSubscriptionServiceUrlMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
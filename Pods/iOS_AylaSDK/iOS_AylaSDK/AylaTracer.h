@@ -0,0 +1,140 @@
+//
+//  AylaTracer.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A phase of an operation recorded by `AylaTracer`.
+ */
+@interface AylaTraceEvent : NSObject
+
+/** Name of the phase, e.g. `lan.queue.property` */
+@property (nonatomic, strong, readonly) NSString *name;
+
+/** Category of the phase: `operation`, `cloud`, `lan`, `ack`, `dss` or `notify` */
+@property (nonatomic, strong, readonly) NSString *category;
+
+/** Id of the trace the phase belongs to, nil for phases which are not part of an operation, e.g. LAN key exchanges */
+@property (nonatomic, strong, readonly, nullable) NSString *traceId;
+
+/** Time the phase started at */
+@property (nonatomic, assign, readonly) CFAbsoluteTime startTime;
+
+/** Duration of the phase in seconds, 0 for instant events */
+@property (nonatomic, assign, readonly) CFTimeInterval duration;
+
+/** Additional details of the phase, e.g. the dsn of the device */
+@property (nonatomic, strong, readonly, nullable) NSDictionary<NSString *, id> *details;
+
+@end
+
+/**
+ * Records the phases of public operations, e.g. `createDatapoint:` or `fetchProperties:`, to tell where the time of an
+ * operation went: LAN command queue, LAN response, cloud request, ack polling or delivery to the caller.
+ *
+ * Each operation starts a trace. The trace id is attached to the `AylaConnectTask`s and LAN commands created for the
+ * operation, which record their phases under it as they complete. Events are kept in a bounded in-memory ring, the
+ * oldest ones are dropped once `capacity` is reached, and can be exported in the Chrome trace event format to be
+ * opened in chrome://tracing.
+ */
+@interface AylaTracer : NSObject
+
+/** Whether traces are recorded. Defaults to YES. */
+@property (atomic, assign, getter=isEnabled) BOOL enabled;
+
+/** Maximum number of events kept. Defaults to 2048. */
+@property (atomic, assign) NSUInteger capacity;
+
+/**
+ * @return Shared instance of the tracer
+ */
++ (AylaTracer *)sharedTracer;
+
+/**
+ * @return Id of the trace being set up on the current thread, see `performInTrace:block:`. Tasks and LAN commands pick
+ * it up when they are created.
+ */
++ (nullable NSString *)currentTraceId;
+
+/**
+ * Starts a trace.
+ *
+ * @param name Name of the operation
+ *
+ * @return Id of the new trace, nil if tracing is disabled
+ */
+- (nullable NSString *)beginTraceWithName:(NSString *)name;
+
+/**
+ * Runs a block with a trace set as the current trace of the calling thread.
+ *
+ * @param traceId Id of the trace, the block is run without a current trace if nil
+ * @param block   Block to run
+ */
+- (void)performInTrace:(nullable NSString *)traceId block:(void (^)(void))block;
+
+/**
+ * Records a phase which ends now.
+ *
+ * @param name      Name of the phase
+ * @param category  Category of the phase
+ * @param traceId   Id of the trace the phase belongs to
+ * @param startTime Time the phase started at
+ * @param details   Additional details of the phase
+ */
+- (void)recordSpanWithName:(NSString *)name
+                  category:(NSString *)category
+                   traceId:(nullable NSString *)traceId
+                 startTime:(CFAbsoluteTime)startTime
+                   details:(nullable NSDictionary<NSString *, id> *)details;
+
+/**
+ * Records an instant event.
+ *
+ * @param name     Name of the event
+ * @param category Category of the event
+ * @param traceId  Id of the trace the event belongs to
+ * @param details  Additional details of the event
+ */
+- (void)recordInstantWithName:(NSString *)name
+                     category:(NSString *)category
+                      traceId:(nullable NSString *)traceId
+                      details:(nullable NSDictionary<NSString *, id> *)details;
+
+/**
+ * @return All recorded events, oldest first
+ */
+- (NSArray<AylaTraceEvent *> *)events;
+
+/**
+ * @param traceId Id of a trace
+ *
+ * @return Recorded events of the trace, oldest first
+ */
+- (NSArray<AylaTraceEvent *> *)eventsOfTrace:(NSString *)traceId;
+
+/**
+ * Writes all recorded events to a file in the Chrome trace event format. Each trace is shown on its own row, events
+ * which are not part of a trace on row 0.
+ *
+ * @param path  Path of the file
+ * @param error A pointer to an `NSError` variable to store an error in case the events can't be written
+ *
+ * @return YES if the events have been written
+ */
+- (BOOL)exportChromeTraceToFile:(NSString *)path error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
+/**
+ * Drops all recorded events.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,242 @@
+//
+//  AylaTracer.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDefines_Internal.h"
+#import "AylaTracer.h"
+
+static NSString *const AylaTracerTag = @"Tracer";
+static NSString *const AylaTracerCurrentTraceIdKey = @"com.aylanetworks.tracer.currentTraceId";
+static const NSUInteger AylaTracerDefaultCapacity = 2048;
+
+@interface AylaTraceEvent ()
+
+@property (nonatomic, strong, readwrite) NSString *name;
+@property (nonatomic, strong, readwrite) NSString *category;
+@property (nonatomic, strong, readwrite, nullable) NSString *traceId;
+@property (nonatomic, assign, readwrite) CFAbsoluteTime startTime;
+@property (nonatomic, assign, readwrite) CFTimeInterval duration;
+@property (nonatomic, assign) BOOL instant;
+@property (nonatomic, strong, readwrite, nullable) NSDictionary<NSString *, id> *details;
+
+@end
+
+@implementation AylaTraceEvent
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %@ %@ trace:%@ %.3fms>",
+                                      NSStringFromClass([self class]),
+                                      self.category,
+                                      self.name,
+                                      self.traceId,
+                                      self.duration * 1000];
+}
+
+@end
+
+@interface AylaTracer ()
+
+/** Ring of events, `nextEventIndex` points at the oldest one once the ring is full */
+@property (nonatomic, strong) NSMutableArray<AylaTraceEvent *> *ring;
+@property (nonatomic, assign) NSUInteger nextEventIndex;
+@property (nonatomic, assign) unsigned long long lastTraceNumber;
+
+@end
+
+@implementation AylaTracer
+
+@synthesize capacity = _capacity;
+
++ (AylaTracer *)sharedTracer
+{
+    static AylaTracer *sharedTracer = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedTracer = [[AylaTracer alloc] init];
+    });
+    return sharedTracer;
+}
+
++ (NSString *)currentTraceId
+{
+    return [NSThread currentThread].threadDictionary[AylaTracerCurrentTraceIdKey];
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _enabled = YES;
+    _capacity = AylaTracerDefaultCapacity;
+    _ring = [NSMutableArray array];
+
+    return self;
+}
+
+- (NSUInteger)capacity
+{
+    @synchronized(self) {
+        return _capacity;
+    }
+}
+
+- (void)setCapacity:(NSUInteger)capacity
+{
+    @synchronized(self) {
+        _capacity = MAX(capacity, 1);
+        NSArray *events = [self orderedEvents];
+        NSUInteger dropped = events.count > _capacity ? events.count - _capacity : 0;
+        self.ring = [[events subarrayWithRange:NSMakeRange(dropped, events.count - dropped)] mutableCopy];
+        self.nextEventIndex = 0;
+    }
+}
+
+- (NSString *)beginTraceWithName:(NSString *)name
+{
+    if (!self.enabled) {
+        return nil;
+    }
+    NSString *traceId;
+    @synchronized(self) {
+        traceId = [NSString stringWithFormat:@"%llu", ++self.lastTraceNumber];
+    }
+    [self recordInstantWithName:name category:@"operation" traceId:traceId details:nil];
+    return traceId;
+}
+
+- (void)performInTrace:(NSString *)traceId block:(void (^)(void))block
+{
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSString *previousTraceId = threadDictionary[AylaTracerCurrentTraceIdKey];
+    threadDictionary[AylaTracerCurrentTraceIdKey] = traceId;
+    block();
+    threadDictionary[AylaTracerCurrentTraceIdKey] = previousTraceId;
+}
+
+- (void)recordSpanWithName:(NSString *)name
+                  category:(NSString *)category
+                   traceId:(NSString *)traceId
+                 startTime:(CFAbsoluteTime)startTime
+                   details:(NSDictionary<NSString *, id> *)details
+{
+    if (!self.enabled || startTime <= 0) {
+        return;
+    }
+    AylaTraceEvent *event = [[AylaTraceEvent alloc] init];
+    event.name = name;
+    event.category = category;
+    event.traceId = traceId;
+    event.startTime = startTime;
+    event.duration = MAX(CFAbsoluteTimeGetCurrent() - startTime, 0);
+    event.details = details;
+    [self addEvent:event];
+}
+
+- (void)recordInstantWithName:(NSString *)name
+                     category:(NSString *)category
+                      traceId:(NSString *)traceId
+                      details:(NSDictionary<NSString *, id> *)details
+{
+    if (!self.enabled) {
+        return;
+    }
+    AylaTraceEvent *event = [[AylaTraceEvent alloc] init];
+    event.name = name;
+    event.category = category;
+    event.traceId = traceId;
+    event.startTime = CFAbsoluteTimeGetCurrent();
+    event.instant = YES;
+    event.details = details;
+    [self addEvent:event];
+}
+
+- (void)addEvent:(AylaTraceEvent *)event
+{
+    @synchronized(self) {
+        if (self.ring.count < self.capacity) {
+            [self.ring addObject:event];
+            return;
+        }
+        self.ring[self.nextEventIndex] = event;
+        self.nextEventIndex = (self.nextEventIndex + 1) % self.ring.count;
+    }
+}
+
+/**
+ * @return Events of the ring, oldest first. Must be called while synchronized on self.
+ */
+- (NSArray<AylaTraceEvent *> *)orderedEvents
+{
+    NSUInteger count = self.ring.count;
+    NSUInteger oldest = self.nextEventIndex;
+    NSMutableArray *events = [NSMutableArray arrayWithCapacity:count];
+    [events addObjectsFromArray:[self.ring subarrayWithRange:NSMakeRange(oldest, count - oldest)]];
+    [events addObjectsFromArray:[self.ring subarrayWithRange:NSMakeRange(0, oldest)]];
+    return events;
+}
+
+- (NSArray<AylaTraceEvent *> *)events
+{
+    @synchronized(self) {
+        return [self orderedEvents];
+    }
+}
+
+- (NSArray<AylaTraceEvent *> *)eventsOfTrace:(NSString *)traceId
+{
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"traceId == %@", traceId];
+    return [[self events] filteredArrayUsingPredicate:predicate];
+}
+
+- (BOOL)exportChromeTraceToFile:(NSString *)path error:(NSError *__autoreleasing _Nullable *)error
+{
+    NSMutableArray *traceEvents = [NSMutableArray array];
+    for (AylaTraceEvent *event in [self events]) {
+        NSMutableDictionary *args = [NSMutableDictionary dictionaryWithDictionary:event.details ?: @{}];
+        if (event.traceId) {
+            args[@"traceId"] = event.traceId;
+        }
+        NSMutableDictionary *traceEvent = [@{
+            @"name" : event.name,
+            @"cat" : event.category,
+            @"ph" : event.instant ? @"i" : @"X",
+            @"ts" : @((long long)((event.startTime + kCFAbsoluteTimeIntervalSince1970) * 1000000)),
+            @"pid" : @1,
+            @"tid" : @(event.traceId.longLongValue),
+            @"args" : args
+        } mutableCopy];
+        if (event.instant) {
+            traceEvent[@"s"] = @"t";
+        }
+        else {
+            traceEvent[@"dur"] = @((long long)(event.duration * 1000000));
+        }
+        [traceEvents addObject:traceEvent];
+    }
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{ @"traceEvents" : traceEvents } options:0 error:error];
+    if (!data) {
+        AylaLogE(AylaTracerTag, 0, @"failed to serialize events, err:%@", error ? *error : nil);
+        return NO;
+    }
+    BOOL written = [data writeToFile:path options:NSDataWritingAtomic error:error];
+    if (!written) {
+        AylaLogE(AylaTracerTag, 0, @"failed to export to %@, err:%@", path, error ? *error : nil);
+    }
+    return written;
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        [self.ring removeAllObjects];
+        self.nextEventIndex = 0;
+    }
+}
+
+@end
@@ -37,6 +37,9 @@ typedef NS_ENUM(uint8_t, AylaConnectTaskType) {
 /** If task if finished */
 @property (nonatomic, readonly) BOOL finished;
 
+/** Id of the trace of the operation the task was created for, see `AylaTracer` */
+@property (nonatomic, copy, readonly) NSString *traceId;
+
 /** 
  * Init method for an `AylaConnectTask` instance given a specified `AylaConnectTaskType` 
  *
@@ -6,6 +6,7 @@
 
 #import "AylaConnectTask.h"
 #import "AylaDefines.h"
+#import "AylaTracer.h"
 
 @interface AylaConnectTask ()
 
@@ -14,6 +15,7 @@
 @property (nonatomic, readwrite) BOOL cancelled;
 @property (nonatomic, readwrite) BOOL executing;
 @property (nonatomic, readwrite) BOOL finished;
+@property (nonatomic, copy, readwrite) NSString *traceId;
 
 /** Property which is used by api retainSelf/unretrainSelf */
 @property (nonatomic, readwrite) AylaConnectTask *me;
@@ -33,6 +35,7 @@
     if(!self) return nil;
     
     _type = type;
+    _traceId = [AylaTracer currentTraceId];
     
     return self;
 }
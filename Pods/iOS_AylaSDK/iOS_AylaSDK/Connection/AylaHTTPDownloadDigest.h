@@ -0,0 +1,54 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Digests of a downloaded file, computed while the file was being written to disk.
+ */
+@interface AylaHTTPDownloadDigest : NSObject
+
+/** MD5 digest of the file. */
+@property (nonatomic, strong, readonly) NSData *md5;
+
+/** SHA-256 digest of the file. */
+@property (nonatomic, strong, readonly) NSData *sha256;
+
+/** Number of bytes hashed, i.e. the size of the file. */
+@property (nonatomic, assign, readonly) unsigned long long length;
+
+/** MD5 digest as a lowercase hex string. */
+@property (nonatomic, readonly) NSString *md5String;
+
+/** SHA-256 digest as a lowercase hex string. */
+@property (nonatomic, readonly) NSString *sha256String;
+
+/**
+ * Init method
+ *
+ * @param md5    MD5 digest.
+ * @param sha256 SHA-256 digest.
+ * @param length Number of bytes hashed.
+ */
+- (instancetype)initWithMD5:(NSData *)md5 sha256:(NSData *)sha256 length:(unsigned long long)length NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Compares a checksum with the digest. The algorithm is picked from the length of the checksum, 32 hex characters for
+ * MD5 and 64 for SHA-256. Case is ignored.
+ *
+ * @param checksum Hex encoded MD5 or SHA-256 checksum.
+ *
+ * @return YES if the checksum matches the digest.
+ */
+- (BOOL)matchesChecksum:(nullable NSString *)checksum;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,61 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaHTTPDownloadDigest.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString *hexStringFromData(NSData *data)
+{
+    const unsigned char *bytes = data.bytes;
+    NSMutableString *hex = [NSMutableString stringWithCapacity:data.length * 2];
+    for (NSUInteger i = 0; i < data.length; i++) {
+        [hex appendFormat:@"%02x", bytes[i]];
+    }
+    return hex;
+}
+
+@implementation AylaHTTPDownloadDigest
+
+- (instancetype)initWithMD5:(NSData *)md5 sha256:(NSData *)sha256 length:(unsigned long long)length
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _md5 = [md5 copy];
+    _sha256 = [sha256 copy];
+    _length = length;
+
+    return self;
+}
+
+- (NSString *)md5String
+{
+    return hexStringFromData(self.md5);
+}
+
+- (NSString *)sha256String
+{
+    return hexStringFromData(self.sha256);
+}
+
+- (BOOL)matchesChecksum:(NSString *)checksum
+{
+    if (checksum.length == CC_MD5_DIGEST_LENGTH * 2) {
+        return [self.md5String caseInsensitiveCompare:checksum] == NSOrderedSame;
+    }
+    if (checksum.length == CC_SHA256_DIGEST_LENGTH * 2) {
+        return [self.sha256String caseInsensitiveCompare:checksum] == NSOrderedSame;
+    }
+    return NO;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"{length:%llu, md5:%@, sha256:%@}", self.length, self.md5String, self.sha256String];
+}
+
+@end
@@ -15,6 +15,7 @@
 @property (nonatomic, readwrite, getter=type) AylaConnectTaskType type;
 @property (nonatomic) NSRecursiveLock *lock;
 @property BOOL started;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
 
 @end
 
@@ -47,6 +48,7 @@
     }
 
     [super start];
+    self.startTime = CFAbsoluteTimeGetCurrent();
 
     // resume NSURLSessionTask to start the job
     [self.task resume];
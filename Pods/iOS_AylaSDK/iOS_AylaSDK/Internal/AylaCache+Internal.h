@@ -7,6 +7,8 @@
 #import "AylaCache.h"
 #import "AylaSessionManager.h"
 
+@class AylaDatapointHistoryCache;
+
 NS_ASSUME_NONNULL_BEGIN
 
 extern NSString *const AylaCacheTypeLANConfigPrefix;
@@ -70,7 +72,14 @@ extern NSString *const AylaCacheTypeGroupPrefix;
    andObject:(id)valueToCache;
 
 /**
- * Property used to aid testability by injecting an encryption key, only used during DEBUG
+ * The store of fetched datapoint history, or nil if
+ * `AylaCacheTypeDatapointHistory` is disabled.
+ */
+- (nullable AylaDatapointHistoryCache *)datapointHistoryCache;
+
+/**
+ * Property used to aid testability by injecting the access token the legacy lan config key is derived from, only used
+ * during DEBUG
  */
 @property (strong, nonatomic) NSString *_testSessionAccessToken;
 @end
@@ -0,0 +1,111 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDatapoint;
+
+/**
+ * Order in which the cloud returned the datapoints of a range.
+ */
+typedef NS_ENUM(uint8_t, AylaDatapointHistoryOrder) {
+    /** Order could not be told, e.g. the range held less than two datapoints */
+    AylaDatapointHistoryOrderUnknown = 0,
+    /** Oldest datapoint first */
+    AylaDatapointHistoryOrderAscending = 1,
+    /** Newest datapoint first */
+    AylaDatapointHistoryOrderDescending = 2
+};
+
+/**
+ * An on-disk, append-only time-series store of fetched datapoint history, with one file per property key.
+ *
+ * Each file is a sequence of segments. A segment records a time range which is known to be complete, i.e. every
+ * datapoint the cloud holds for that range, followed by the columns of those datapoints: timestamps as varint deltas in
+ * milliseconds, values as zigzag varints, doubles, strings or JSON depending on what the values of the segment are,
+ * ids, and metadata as JSON. The order the cloud returned the range in is kept in the segment header.
+ *
+ * All file access happens on a private serial queue. Writes are applied asynchronously in submission order.
+ */
+@interface AylaDatapointHistoryCache : NSObject
+
+/** Segments whose range ended more than `maxAge` seconds ago are dropped. */
+@property (nonatomic, assign) NSTimeInterval maxAge;
+
+/** Total size budget of all history files in bytes. Least recently written files are removed to stay within it. */
+@property (nonatomic, assign) unsigned long long sizeLimit;
+
+/**
+ * Init method
+ *
+ * @param directoryPath Directory which holds the history files. Created on first write.
+ */
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Reads the datapoints of a property in a time range. Blocks on the store's queue, so must not be called on main queue.
+ *
+ * @param propertyKey Key of the property.
+ * @param from        Start of the range, inclusive.
+ * @param to          End of the range, inclusive.
+ *
+ * @return Datapoints sorted by `createdAt`, with `AylaDataSourceCache` as data source. Nil if any part of the range is
+ * not covered by the store.
+ */
+- (nullable NSArray<AylaDatapoint *> *)datapointsForPropertyKey:(NSNumber *)propertyKey
+                                                           from:(NSDate *)from
+                                                             to:(NSDate *)to;
+
+/**
+ * Reads the covered beginning of a time range asynchronously.
+ *
+ * @param propertyKey Key of the property.
+ * @param from        Start of the range, inclusive.
+ * @param to          End of the range, inclusive.
+ * @param completion  Called on main queue. `coveredUntil` is the end of the contiguous range covered by the store which
+ * starts at or before `from`, nil if `from` itself is not covered. `datapoints` holds the datapoints from `from` to the
+ * earlier of `to` and `coveredUntil`, sorted by `createdAt`, with `AylaDataSourceCache` as data source. `order` is the
+ * order the cloud returned those datapoints in.
+ */
+- (void)readDatapointsForPropertyKey:(NSNumber *)propertyKey
+                                from:(NSDate *)from
+                                  to:(NSDate *)to
+                          completion:(void (^)(NSArray<AylaDatapoint *> *_Nullable datapoints,
+                                               NSDate *_Nullable coveredUntil,
+                                               AylaDatapointHistoryOrder order))completion;
+
+/**
+ * Appends a complete range of datapoints of a property to the store. Datapoints outside of the range are ignored. The
+ * range is not recorded if any datapoint of it can't be stored.
+ *
+ * @param datapoints  Every datapoint of the property created within the range, in the order the cloud returned them.
+ * @param propertyKey Key of the property.
+ * @param from        Start of the range, inclusive.
+ * @param to          End of the range, inclusive. Clamped to the current time minus a small skew, as datapoints may
+ * still be created close to now.
+ */
+- (void)appendDatapoints:(NSArray<AylaDatapoint *> *)datapoints
+          forPropertyKey:(NSNumber *)propertyKey
+                    from:(NSDate *)from
+                      to:(NSDate *)to;
+
+/**
+ * Removes all history files.
+ */
+- (void)removeAll;
+
+/**
+ * Tells the order of datapoints from their creation times.
+ */
++ (AylaDatapointHistoryOrder)orderOfDatapoints:(NSArray<AylaDatapoint *> *)datapoints;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,825 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDatapoint+Internal.h"
+#import "AylaDatapointBlob.h"
+#import "AylaDatapointHistoryCache.h"
+#import "AylaDefines_Internal.h"
+
+static const char *AylaDatapointHistoryCacheQueueLabel = "com.aylanetworks.cache.queue.datapointHistory";
+static NSString *const AylaDatapointHistoryFileExtension = @"tsc";
+
+static const uint32_t AylaDatapointHistoryMagic = 0x53545941; // "AYTS"
+static const uint8_t AylaDatapointHistoryVersion = 2;
+static const NSUInteger AylaDatapointHistoryHeaderLength = 32;
+
+/** Datapoints may still be created for the last moments before now, those are never recorded as covered. */
+static const int64_t AylaDatapointHistorySkewMs = 60 * 1000;
+
+static const NSTimeInterval DEFAULT_DATAPOINT_HISTORY_MAX_AGE = 30 * 24 * 60 * 60;
+static const unsigned long long DEFAULT_DATAPOINT_HISTORY_SIZE_LIMIT = 4 * 1024 * 1024;
+
+typedef NS_ENUM(uint8_t, AylaDatapointHistoryValueType) {
+    AylaDatapointHistoryValueTypeInteger = 1,
+    AylaDatapointHistoryValueTypeDouble = 2,
+    AylaDatapointHistoryValueTypeString = 3,
+    AylaDatapointHistoryValueTypeJSON = 4
+};
+
+#pragma mark - Encoding
+
+static int64_t AylaHistoryMsFromDate(NSDate *date)
+{
+    return llround([date timeIntervalSince1970] * 1000.);
+}
+
+static NSDate *AylaHistoryDateFromMs(int64_t ms)
+{
+    return [NSDate dateWithTimeIntervalSince1970:ms / 1000.];
+}
+
+static void AylaHistoryAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    uint32_t littleEndian = CFSwapInt32HostToLittle(value);
+    [data appendBytes:&littleEndian length:sizeof(littleEndian)];
+}
+
+static void AylaHistoryAppendInt64(NSMutableData *data, int64_t value)
+{
+    uint64_t littleEndian = CFSwapInt64HostToLittle((uint64_t)value);
+    [data appendBytes:&littleEndian length:sizeof(littleEndian)];
+}
+
+static uint32_t AylaHistoryReadUInt32(const uint8_t *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return CFSwapInt32LittleToHost(value);
+}
+
+static int64_t AylaHistoryReadInt64(const uint8_t *bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return (int64_t)CFSwapInt64LittleToHost(value);
+}
+
+static void AylaHistoryAppendVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    size_t length = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        buffer[length++] = byte;
+    } while (value);
+    [data appendBytes:buffer length:length];
+}
+
+static BOOL AylaHistoryReadVarint(const uint8_t *bytes, NSUInteger length, NSUInteger *offset, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; *offset < length && shift < 64; shift += 7) {
+        uint8_t byte = bytes[(*offset)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static uint64_t AylaHistoryZigZagEncode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t AylaHistoryZigZagDecode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static AylaDatapointHistoryValueType AylaHistoryValueTypeForValues(NSArray *values)
+{
+    BOOL allIntegers = YES;
+    BOOL allNumbers = YES;
+    BOOL allStrings = YES;
+    for (id value in values) {
+        if ([value isKindOfClass:[NSNumber class]]) {
+            allStrings = NO;
+            if ([value isKindOfClass:[NSDecimalNumber class]] || CFNumberIsFloatType((__bridge CFNumberRef)value)) {
+                allIntegers = NO;
+            }
+        }
+        else if ([value isKindOfClass:[NSString class]]) {
+            allIntegers = NO;
+            allNumbers = NO;
+        }
+        else {
+            allIntegers = NO;
+            allNumbers = NO;
+            allStrings = NO;
+        }
+    }
+
+    if (allIntegers) {
+        return AylaDatapointHistoryValueTypeInteger;
+    }
+    if (allNumbers) {
+        return AylaDatapointHistoryValueTypeDouble;
+    }
+    if (allStrings) {
+        return AylaDatapointHistoryValueTypeString;
+    }
+    return AylaDatapointHistoryValueTypeJSON;
+}
+
+/**
+ * A segment of a history file. Offsets point into the file, at the start of the segment payload.
+ */
+@interface AylaDatapointHistorySegment : NSObject
+
+@property (nonatomic, assign) int64_t fromMs;
+@property (nonatomic, assign) int64_t toMs;
+@property (nonatomic, assign) AylaDatapointHistoryValueType valueType;
+@property (nonatomic, assign) AylaDatapointHistoryOrder order;
+@property (nonatomic, assign) uint32_t count;
+@property (nonatomic, assign) unsigned long long payloadOffset;
+@property (nonatomic, assign) uint32_t payloadLength;
+
+@end
+
+@implementation AylaDatapointHistorySegment
+@end
+
+@interface AylaDatapointHistoryCache ()
+
+@property (nonatomic, strong) NSString *directoryPath;
+@property (nonatomic, strong) dispatch_queue_t queue;
+
+/** Segments of each loaded file sorted by `fromMs`, keyed by property key */
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSMutableArray<AylaDatapointHistorySegment *> *> *indexes;
+
+@end
+
+@implementation AylaDatapointHistoryCache
+
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _directoryPath = directoryPath;
+    _maxAge = DEFAULT_DATAPOINT_HISTORY_MAX_AGE;
+    _sizeLimit = DEFAULT_DATAPOINT_HISTORY_SIZE_LIMIT;
+    _queue = dispatch_queue_create(AylaDatapointHistoryCacheQueueLabel, DISPATCH_QUEUE_SERIAL);
+    _indexes = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+#pragma mark - Public
+
+- (NSArray<AylaDatapoint *> *)datapointsForPropertyKey:(NSNumber *)propertyKey from:(NSDate *)from to:(NSDate *)to
+{
+    __block NSArray *datapoints = nil;
+    dispatch_sync(self.queue, ^{
+        datapoints = [self readDatapointsForPropertyKey:propertyKey
+                                                 fromMs:AylaHistoryMsFromDate(from)
+                                                   toMs:AylaHistoryMsFromDate(to)
+                                                  order:NULL];
+    });
+    return datapoints;
+}
+
+- (void)readDatapointsForPropertyKey:(NSNumber *)propertyKey
+                                from:(NSDate *)from
+                                  to:(NSDate *)to
+                          completion:(void (^)(NSArray<AylaDatapoint *> *datapoints,
+                                               NSDate *coveredUntil,
+                                               AylaDatapointHistoryOrder order))completion
+{
+    dispatch_async(self.queue, ^{
+        int64_t fromMs = AylaHistoryMsFromDate(from);
+        int64_t coveredUntilMs;
+        NSArray *datapoints = nil;
+        NSDate *coveredUntil = nil;
+        AylaDatapointHistoryOrder order = AylaDatapointHistoryOrderUnknown;
+        if ([self coveredUntilMs:&coveredUntilMs forPropertyKey:propertyKey fromMs:fromMs]) {
+            datapoints = [self readDatapointsForPropertyKey:propertyKey
+                                                     fromMs:fromMs
+                                                       toMs:MIN(coveredUntilMs, AylaHistoryMsFromDate(to))
+                                                      order:&order];
+            coveredUntil = datapoints ? AylaHistoryDateFromMs(coveredUntilMs) : nil;
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(datapoints, coveredUntil, order);
+        });
+    });
+}
+
+- (void)appendDatapoints:(NSArray<AylaDatapoint *> *)datapoints
+          forPropertyKey:(NSNumber *)propertyKey
+                    from:(NSDate *)from
+                      to:(NSDate *)to
+{
+    int64_t fromMs = AylaHistoryMsFromDate(from);
+    int64_t toMs = MIN(AylaHistoryMsFromDate(to), AylaHistoryMsFromDate([NSDate date]) - AylaDatapointHistorySkewMs);
+    if (toMs <= fromMs) {
+        return;
+    }
+
+    dispatch_async(self.queue, ^{
+        [self writeDatapoints:datapoints forPropertyKey:propertyKey fromMs:fromMs toMs:toMs];
+    });
+}
+
+- (void)removeAll
+{
+    dispatch_async(self.queue, ^{
+        [self.indexes removeAllObjects];
+        NSError *error;
+        if (![[NSFileManager defaultManager] removeItemAtPath:self.directoryPath error:&error] &&
+            error.code != NSFileNoSuchFileError) {
+            AylaLogE([self logTag], 0, @"%@. Error: %@", NSStringFromSelector(_cmd), error);
+        }
+    });
+}
+
++ (AylaDatapointHistoryOrder)orderOfDatapoints:(NSArray<AylaDatapoint *> *)datapoints
+{
+    NSDate *first = datapoints.firstObject.createdAt;
+    NSDate *last = datapoints.lastObject.createdAt;
+    if (!first || !last) {
+        return AylaDatapointHistoryOrderUnknown;
+    }
+    switch ([first compare:last]) {
+        case NSOrderedAscending:
+            return AylaDatapointHistoryOrderAscending;
+        case NSOrderedDescending:
+            return AylaDatapointHistoryOrderDescending;
+        default:
+            return AylaDatapointHistoryOrderUnknown;
+    }
+}
+
+#pragma mark - Index
+
+- (NSString *)filePathForPropertyKey:(NSNumber *)propertyKey
+{
+    return [self.directoryPath
+        stringByAppendingPathComponent:[[propertyKey stringValue]
+                                           stringByAppendingPathExtension:AylaDatapointHistoryFileExtension]];
+}
+
+/**
+ * Loads the index of a history file, dropping a partially written tail and expired segments.
+ */
+- (NSMutableArray<AylaDatapointHistorySegment *> *)segmentsForPropertyKey:(NSNumber *)propertyKey
+{
+    NSMutableArray *segments = self.indexes[propertyKey];
+    if (segments) {
+        return segments;
+    }
+
+    segments = [NSMutableArray array];
+    self.indexes[propertyKey] = segments;
+
+    NSString *path = [self filePathForPropertyKey:propertyKey];
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return segments;
+    }
+
+    const uint8_t *bytes = data.bytes;
+    NSUInteger offset = 0;
+    while (offset + AylaDatapointHistoryHeaderLength <= data.length) {
+        const uint8_t *header = bytes + offset;
+        uint32_t payloadLength = AylaHistoryReadUInt32(header + 28);
+        if (AylaHistoryReadUInt32(header) != AylaDatapointHistoryMagic || header[4] != AylaDatapointHistoryVersion ||
+            offset + AylaDatapointHistoryHeaderLength + payloadLength > data.length) {
+            break;
+        }
+
+        AylaDatapointHistorySegment *segment = [[AylaDatapointHistorySegment alloc] init];
+        segment.valueType = header[5];
+        segment.order = header[6];
+        segment.fromMs = AylaHistoryReadInt64(header + 8);
+        segment.toMs = AylaHistoryReadInt64(header + 16);
+        segment.count = AylaHistoryReadUInt32(header + 24);
+        segment.payloadOffset = offset + AylaDatapointHistoryHeaderLength;
+        segment.payloadLength = payloadLength;
+        [segments addObject:segment];
+
+        offset += AylaDatapointHistoryHeaderLength + payloadLength;
+    }
+    [segments sortUsingComparator:^NSComparisonResult(AylaDatapointHistorySegment *obj1,
+                                                      AylaDatapointHistorySegment *obj2) {
+        return obj1.fromMs < obj2.fromMs ? NSOrderedAscending
+                                         : (obj1.fromMs > obj2.fromMs ? NSOrderedDescending : NSOrderedSame);
+    }];
+
+    int64_t expiredBeforeMs = AylaHistoryMsFromDate([NSDate dateWithTimeIntervalSinceNow:-self.maxAge]);
+    NSIndexSet *expired = [segments indexesOfObjectsPassingTest:^BOOL(AylaDatapointHistorySegment *segment,
+                                                                     NSUInteger idx, BOOL *stop) {
+        return segment.toMs < expiredBeforeMs;
+    }];
+    if (offset != data.length || expired.count > 0) {
+        if (offset != data.length) {
+            AylaLogW([self logTag], 0, @"truncated:%@, %@", propertyKey, NSStringFromSelector(_cmd));
+        }
+        [segments removeObjectsAtIndexes:expired];
+        [self rewriteFileForPropertyKey:propertyKey fromData:data];
+    }
+    return segments;
+}
+
+/**
+ * Rewrites a history file so it only contains the segments currently in its index.
+ */
+- (void)rewriteFileForPropertyKey:(NSNumber *)propertyKey fromData:(NSData *)data
+{
+    NSMutableArray *segments = self.indexes[propertyKey];
+    NSString *path = [self filePathForPropertyKey:propertyKey];
+    if (segments.count == 0) {
+        [self.indexes removeObjectForKey:propertyKey];
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        return;
+    }
+
+    NSMutableData *compacted = [NSMutableData data];
+    for (AylaDatapointHistorySegment *segment in segments) {
+        NSRange range = NSMakeRange((NSUInteger)segment.payloadOffset - AylaDatapointHistoryHeaderLength,
+                                    AylaDatapointHistoryHeaderLength + segment.payloadLength);
+        segment.payloadOffset = compacted.length + AylaDatapointHistoryHeaderLength;
+        [compacted appendData:[data subdataWithRange:range]];
+    }
+
+    NSError *error;
+    if (![compacted writeToFile:path options:NSDataWritingAtomic error:&error]) {
+        AylaLogE([self logTag], 0, @"%@. Error: %@", NSStringFromSelector(_cmd), error);
+        [self.indexes removeObjectForKey:propertyKey];
+    }
+}
+
+#pragma mark - Read
+
+/**
+ * Finds the end of the contiguous range covered by the store which starts at or before `fromMs`.
+ *
+ * @return NO if `fromMs` itself is not covered.
+ */
+- (BOOL)coveredUntilMs:(int64_t *)coveredUntilMs forPropertyKey:(NSNumber *)propertyKey fromMs:(int64_t)fromMs
+{
+    int64_t cursor = fromMs;
+    BOOL covered = NO;
+    for (AylaDatapointHistorySegment *segment in [self segmentsForPropertyKey:propertyKey]) {
+        if (segment.fromMs > cursor) {
+            break;
+        }
+        if (segment.toMs >= cursor) {
+            cursor = segment.toMs;
+            covered = YES;
+        }
+    }
+    *coveredUntilMs = cursor;
+    return covered;
+}
+
+- (NSArray<AylaDatapoint *> *)readDatapointsForPropertyKey:(NSNumber *)propertyKey
+                                                    fromMs:(int64_t)fromMs
+                                                      toMs:(int64_t)toMs
+                                                     order:(AylaDatapointHistoryOrder *)order
+{
+    NSMutableArray *overlapping = [NSMutableArray array];
+    int64_t cursor = fromMs;
+    for (AylaDatapointHistorySegment *segment in [self segmentsForPropertyKey:propertyKey]) {
+        if (segment.toMs < fromMs) {
+            continue;
+        }
+        if (segment.fromMs > cursor) {
+            break;
+        }
+        [overlapping addObject:segment];
+        cursor = MAX(cursor, segment.toMs);
+        if (cursor >= toMs) {
+            break;
+        }
+    }
+    if (cursor < toMs || overlapping.count == 0) {
+        return nil;
+    }
+    if (order) {
+        *order = AylaDatapointHistoryOrderUnknown;
+        for (AylaDatapointHistorySegment *segment in overlapping) {
+            if (segment.order != AylaDatapointHistoryOrderUnknown) {
+                *order = segment.order;
+                break;
+            }
+        }
+    }
+
+    NSData *data = [NSData dataWithContentsOfFile:[self filePathForPropertyKey:propertyKey]
+                                          options:NSDataReadingMappedIfSafe
+                                            error:nil];
+    if (!data) {
+        [self.indexes removeObjectForKey:propertyKey];
+        return nil;
+    }
+
+    // Neighbouring segments share their boundary, drop datapoints an earlier segment already returned.
+    NSMutableArray *datapoints = [NSMutableArray array];
+    NSMutableSet *returnedKeys = [NSMutableSet set];
+    for (AylaDatapointHistorySegment *segment in overlapping) {
+        NSMutableSet *segmentKeys = [NSMutableSet set];
+        BOOL decoded = [self decodeSegment:segment
+                                  fromData:data
+                                 withBlock:^(int64_t timestampMs, id value, NSString *identifier,
+                                             NSDictionary *metadata) {
+                                     if (timestampMs < fromMs || timestampMs > toMs) {
+                                         return;
+                                     }
+                                     AylaDatapoint *datapoint =
+                                         [[AylaDatapoint alloc] initWithValue:value
+                                                                    createdAt:AylaHistoryDateFromMs(timestampMs)
+                                                                           id:identifier
+                                                                     metadata:metadata
+                                                                   dataSource:AylaDataSourceCache];
+                                     NSString *key = [datapoint historyIdentifier];
+                                     if ([returnedKeys containsObject:key]) {
+                                         return;
+                                     }
+                                     [segmentKeys addObject:key];
+                                     [datapoints addObject:datapoint];
+                                 }];
+        if (!decoded) {
+            AylaLogE([self logTag], 0, @"corrupted:%@, %@", propertyKey, NSStringFromSelector(_cmd));
+            [[self segmentsForPropertyKey:propertyKey] removeObject:segment];
+            [self rewriteFileForPropertyKey:propertyKey fromData:data];
+            return nil;
+        }
+        [returnedKeys unionSet:segmentKeys];
+    }
+
+    [datapoints sortWithOptions:NSSortStable
+                usingComparator:^NSComparisonResult(AylaDatapoint *obj1, AylaDatapoint *obj2) {
+                    return [obj1.createdAt compare:obj2.createdAt];
+                }];
+    return datapoints;
+}
+
+- (BOOL)decodeSegment:(AylaDatapointHistorySegment *)segment
+             fromData:(NSData *)data
+            withBlock:(void (^)(int64_t timestampMs, id value, NSString *identifier, NSDictionary *metadata))block
+{
+    if (segment.payloadOffset + segment.payloadLength > data.length) {
+        return NO;
+    }
+    const uint8_t *bytes = (const uint8_t *)data.bytes + segment.payloadOffset;
+    NSUInteger length = segment.payloadLength;
+    NSUInteger offset = 0;
+
+    int64_t *timestamps = malloc(sizeof(int64_t) * MAX(segment.count, 1));
+    int64_t timestamp = segment.fromMs;
+    for (uint32_t i = 0; i < segment.count; i++) {
+        uint64_t delta;
+        if (!AylaHistoryReadVarint(bytes, length, &offset, &delta)) {
+            free(timestamps);
+            return NO;
+        }
+        timestamp += (int64_t)delta;
+        timestamps[i] = timestamp;
+    }
+
+    NSArray *jsonValues = nil;
+    if (segment.valueType == AylaDatapointHistoryValueTypeJSON) {
+        uint64_t jsonLength;
+        if (!AylaHistoryReadVarint(bytes, length, &offset, &jsonLength) || offset + jsonLength > length) {
+            free(timestamps);
+            return NO;
+        }
+        jsonValues = [NSJSONSerialization JSONObjectWithData:[NSData dataWithBytes:bytes + offset length:jsonLength]
+                                                     options:NSJSONReadingAllowFragments
+                                                       error:nil];
+        if (![jsonValues isKindOfClass:[NSArray class]] || jsonValues.count != segment.count) {
+            free(timestamps);
+            return NO;
+        }
+    }
+
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:segment.count];
+    BOOL decoded = YES;
+    for (uint32_t i = 0; i < segment.count && decoded; i++) {
+        id value = nil;
+        switch (segment.valueType) {
+            case AylaDatapointHistoryValueTypeInteger: {
+                uint64_t encoded;
+                decoded = AylaHistoryReadVarint(bytes, length, &offset, &encoded);
+                value = @(AylaHistoryZigZagDecode(encoded));
+                break;
+            }
+            case AylaDatapointHistoryValueTypeDouble: {
+                decoded = offset + sizeof(uint64_t) <= length;
+                if (decoded) {
+                    uint64_t bits = (uint64_t)AylaHistoryReadInt64(bytes + offset);
+                    double doubleValue;
+                    memcpy(&doubleValue, &bits, sizeof(doubleValue));
+                    value = @(doubleValue);
+                    offset += sizeof(uint64_t);
+                }
+                break;
+            }
+            case AylaDatapointHistoryValueTypeString: {
+                uint64_t stringLength;
+                decoded = AylaHistoryReadVarint(bytes, length, &offset, &stringLength) &&
+                          offset + stringLength <= length;
+                if (decoded) {
+                    value = [[NSString alloc] initWithBytes:bytes + offset
+                                                     length:(NSUInteger)stringLength
+                                                   encoding:NSUTF8StringEncoding];
+                    offset += stringLength;
+                    decoded = value != nil;
+                }
+                break;
+            }
+            case AylaDatapointHistoryValueTypeJSON:
+                value = jsonValues[i];
+                break;
+            default:
+                decoded = NO;
+                break;
+        }
+        if (decoded) {
+            [values addObject:value];
+        }
+    }
+
+    NSMutableArray *identifiers = [NSMutableArray arrayWithCapacity:segment.count];
+    for (uint32_t i = 0; i < segment.count && decoded; i++) {
+        uint64_t identifierLength;
+        decoded = AylaHistoryReadVarint(bytes, length, &offset, &identifierLength) &&
+                  offset + identifierLength <= length;
+        if (decoded) {
+            NSString *identifier = [[NSString alloc] initWithBytes:bytes + offset
+                                                            length:(NSUInteger)identifierLength
+                                                          encoding:NSUTF8StringEncoding];
+            offset += identifierLength;
+            decoded = identifier != nil;
+            [identifiers addObject:identifier.length > 0 ? identifier : [NSNull null]];
+        }
+    }
+
+    NSArray *metadataValues = nil;
+    uint64_t metadataLength = 0;
+    decoded = decoded && AylaHistoryReadVarint(bytes, length, &offset, &metadataLength) &&
+              offset + metadataLength <= length;
+    if (decoded && metadataLength > 0) {
+        metadataValues = [NSJSONSerialization JSONObjectWithData:[NSData dataWithBytes:bytes + offset
+                                                                                length:metadataLength]
+                                                         options:0
+                                                           error:nil];
+        decoded = [metadataValues isKindOfClass:[NSArray class]] && metadataValues.count == segment.count;
+    }
+
+    if (decoded) {
+        for (uint32_t i = 0; i < segment.count; i++) {
+            id identifier = identifiers[i];
+            id metadata = metadataValues[i];
+            block(timestamps[i], values[i], identifier == [NSNull null] ? nil : identifier,
+                  [metadata isKindOfClass:[NSDictionary class]] ? metadata : nil);
+        }
+    }
+    free(timestamps);
+    return decoded;
+}
+
+#pragma mark - Write
+
+- (void)writeDatapoints:(NSArray<AylaDatapoint *> *)datapoints
+         forPropertyKey:(NSNumber *)propertyKey
+                 fromMs:(int64_t)fromMs
+                   toMs:(int64_t)toMs
+{
+    AylaDatapointHistoryOrder order = [[self class] orderOfDatapoints:datapoints];
+    NSMutableArray *inRange = [NSMutableArray arrayWithCapacity:datapoints.count];
+    for (AylaDatapoint *datapoint in datapoints) {
+        // File datapoints only carry a location which expires, they are not worth keeping.
+        if ([datapoint isKindOfClass:[AylaDatapointBlob class]]) {
+            return;
+        }
+        // Without every datapoint of the range stored, the range can't be served as complete.
+        if (datapoint.createdAt == nil || datapoint.value == nil) {
+            return;
+        }
+        int64_t timestampMs = AylaHistoryMsFromDate(datapoint.createdAt);
+        if (timestampMs >= fromMs && timestampMs <= toMs) {
+            [inRange addObject:datapoint];
+        }
+    }
+    [inRange sortWithOptions:NSSortStable
+             usingComparator:^NSComparisonResult(AylaDatapoint *obj1, AylaDatapoint *obj2) {
+                 return [obj1.createdAt compare:obj2.createdAt];
+             }];
+
+    NSMutableArray *segments = [self segmentsForPropertyKey:propertyKey];
+    int64_t cursor = fromMs;
+    for (AylaDatapointHistorySegment *segment in segments) {
+        if (segment.fromMs > cursor) {
+            break;
+        }
+        cursor = MAX(cursor, segment.toMs);
+    }
+    if (cursor >= toMs) {
+        // Range is already covered
+        return;
+    }
+
+    NSMutableData *payload = [NSMutableData data];
+    int64_t previousMs = fromMs;
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:inRange.count];
+    for (AylaDatapoint *datapoint in inRange) {
+        int64_t timestampMs = AylaHistoryMsFromDate(datapoint.createdAt);
+        AylaHistoryAppendVarint(payload, (uint64_t)(timestampMs - previousMs));
+        previousMs = timestampMs;
+        [values addObject:datapoint.value];
+    }
+
+    AylaDatapointHistoryValueType valueType = AylaHistoryValueTypeForValues(values);
+    if (valueType == AylaDatapointHistoryValueTypeJSON) {
+        NSData *jsonData = [NSJSONSerialization isValidJSONObject:values]
+                               ? [NSJSONSerialization dataWithJSONObject:values options:0 error:nil]
+                               : nil;
+        if (!jsonData) {
+            return;
+        }
+        AylaHistoryAppendVarint(payload, jsonData.length);
+        [payload appendData:jsonData];
+    }
+    else {
+        for (id value in values) {
+            switch (valueType) {
+                case AylaDatapointHistoryValueTypeInteger:
+                    AylaHistoryAppendVarint(payload, AylaHistoryZigZagEncode([value longLongValue]));
+                    break;
+                case AylaDatapointHistoryValueTypeDouble: {
+                    double doubleValue = [value doubleValue];
+                    uint64_t bits;
+                    memcpy(&bits, &doubleValue, sizeof(bits));
+                    AylaHistoryAppendInt64(payload, (int64_t)bits);
+                    break;
+                }
+                default: {
+                    NSData *stringData = [value dataUsingEncoding:NSUTF8StringEncoding];
+                    AylaHistoryAppendVarint(payload, stringData.length);
+                    [payload appendData:stringData];
+                    break;
+                }
+            }
+        }
+    }
+
+    NSMutableArray *metadataValues = [NSMutableArray arrayWithCapacity:inRange.count];
+    BOOL hasMetadata = NO;
+    for (AylaDatapoint *datapoint in inRange) {
+        NSData *identifierData = [datapoint.id dataUsingEncoding:NSUTF8StringEncoding];
+        AylaHistoryAppendVarint(payload, identifierData.length);
+        if (identifierData) {
+            [payload appendData:identifierData];
+        }
+        [metadataValues addObject:datapoint.metadata ?: [NSNull null]];
+        hasMetadata = hasMetadata || datapoint.metadata != nil;
+    }
+    if (hasMetadata) {
+        NSData *metadataData = [NSJSONSerialization isValidJSONObject:metadataValues]
+                                   ? [NSJSONSerialization dataWithJSONObject:metadataValues options:0 error:nil]
+                                   : nil;
+        if (!metadataData) {
+            return;
+        }
+        AylaHistoryAppendVarint(payload, metadataData.length);
+        [payload appendData:metadataData];
+    }
+    else {
+        AylaHistoryAppendVarint(payload, 0);
+    }
+
+    NSMutableData *segmentData = [NSMutableData dataWithCapacity:AylaDatapointHistoryHeaderLength + payload.length];
+    AylaHistoryAppendUInt32(segmentData, AylaDatapointHistoryMagic);
+    uint8_t flags[4] = {AylaDatapointHistoryVersion, valueType, order, 0};
+    [segmentData appendBytes:flags length:sizeof(flags)];
+    AylaHistoryAppendInt64(segmentData, fromMs);
+    AylaHistoryAppendInt64(segmentData, toMs);
+    AylaHistoryAppendUInt32(segmentData, (uint32_t)inRange.count);
+    AylaHistoryAppendUInt32(segmentData, (uint32_t)payload.length);
+    [segmentData appendData:payload];
+
+    NSString *path = [self filePathForPropertyKey:propertyKey];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.directoryPath
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+    unsigned long long fileLength =
+        [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize];
+
+    NSOutputStream *stream = [NSOutputStream outputStreamToFileAtPath:path append:YES];
+    [stream open];
+    NSInteger written = [stream write:segmentData.bytes maxLength:segmentData.length];
+    [stream close];
+    if (written != (NSInteger)segmentData.length) {
+        AylaLogE([self logTag], 0, @"%@. Error: %@", NSStringFromSelector(_cmd), stream.streamError);
+        // A partial segment is dropped the next time the file is indexed.
+        [self.indexes removeObjectForKey:propertyKey];
+        return;
+    }
+
+    AylaDatapointHistorySegment *segment = [[AylaDatapointHistorySegment alloc] init];
+    segment.fromMs = fromMs;
+    segment.toMs = toMs;
+    segment.valueType = valueType;
+    segment.order = order;
+    segment.count = (uint32_t)inRange.count;
+    segment.payloadOffset = fileLength + AylaDatapointHistoryHeaderLength;
+    segment.payloadLength = (uint32_t)payload.length;
+    NSUInteger index = [segments indexOfObjectPassingTest:^BOOL(AylaDatapointHistorySegment *obj, NSUInteger idx,
+                                                                BOOL *stop) {
+        return obj.fromMs > fromMs;
+    }];
+    [segments insertObject:segment atIndex:index == NSNotFound ? segments.count : index];
+
+    [self enforceSizeLimitKeepingPropertyKey:propertyKey];
+}
+
+/**
+ * Removes least recently written history files until the store fits in `sizeLimit`. If the file just written is
+ * larger than the limit on its own, its oldest segments are dropped.
+ */
+- (void)enforceSizeLimitKeepingPropertyKey:(NSNumber *)propertyKey
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray *fileNames = [fileManager contentsOfDirectoryAtPath:self.directoryPath error:nil];
+    NSMutableArray *files = [NSMutableArray arrayWithCapacity:fileNames.count];
+    unsigned long long totalSize = 0;
+    for (NSString *fileName in fileNames) {
+        if (![fileName.pathExtension isEqualToString:AylaDatapointHistoryFileExtension]) {
+            continue;
+        }
+        NSString *path = [self.directoryPath stringByAppendingPathComponent:fileName];
+        NSDictionary *attributes = [fileManager attributesOfItemAtPath:path error:nil];
+        totalSize += attributes.fileSize;
+        [files addObject:@{ @"path" : path, @"attributes" : attributes ?: @{} }];
+    }
+    if (totalSize <= self.sizeLimit) {
+        return;
+    }
+
+    [files sortUsingComparator:^NSComparisonResult(NSDictionary *obj1, NSDictionary *obj2) {
+        return [[obj1[@"attributes"] fileModificationDate] compare:[obj2[@"attributes"] fileModificationDate]];
+    }];
+    NSString *keptPath = [self filePathForPropertyKey:propertyKey];
+    for (NSDictionary *file in files) {
+        if (totalSize <= self.sizeLimit) {
+            break;
+        }
+        if ([file[@"path"] isEqualToString:keptPath]) {
+            continue;
+        }
+        if ([fileManager removeItemAtPath:file[@"path"] error:nil]) {
+            totalSize -= [file[@"attributes"] fileSize];
+            NSString *key = [[file[@"path"] lastPathComponent] stringByDeletingPathExtension];
+            [self.indexes removeObjectForKey:@([key longLongValue])];
+        }
+    }
+
+    if (totalSize > self.sizeLimit) {
+        NSData *data = [NSData dataWithContentsOfFile:keptPath];
+        NSMutableArray *segments = [self segmentsForPropertyKey:propertyKey];
+        NSArray *byAge = [segments sortedArrayUsingComparator:^NSComparisonResult(AylaDatapointHistorySegment *obj1,
+                                                                                 AylaDatapointHistorySegment *obj2) {
+            return obj1.toMs < obj2.toMs ? NSOrderedAscending
+                                         : (obj1.toMs > obj2.toMs ? NSOrderedDescending : NSOrderedSame);
+        }];
+        for (AylaDatapointHistorySegment *segment in byAge) {
+            if (totalSize <= self.sizeLimit) {
+                break;
+            }
+            totalSize -= AylaDatapointHistoryHeaderLength + segment.payloadLength;
+            [segments removeObject:segment];
+        }
+        [self rewriteFileForPropertyKey:propertyKey fromData:data];
+    }
+    AylaLogI([self logTag], 0, @"size:%llu, %@", totalSize, NSStringFromSelector(_cmd));
+}
+
+- (NSString *)logTag
+{
+    return @"DatapointHistoryCache";
+}
+
+@end
@@ -122,6 +122,26 @@ NS_ASSUME_NONNULL_BEGIN
                              success:(void (^)())successBlock
                              failure:(void (^)(NSError *error))failureBlock;
 
+/**
+ *  Validates a datum key.
+ *
+ *  @param key   The key to validate.
+ *  @param error Set to an `AylaRequestErrorCodeInvalidArguments` error if the key is invalid.
+ *
+ *  @return YES if the key is valid.
+ */
++ (BOOL)datumKeyIsValid:(NSString *)key error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
+/**
+ *  Validates a datum value.
+ *
+ *  @param value The value to validate.
+ *  @param error Set to an `AylaRequestErrorCodeInvalidArguments` error if the value is invalid.
+ *
+ *  @return YES if the value is valid.
+ */
++ (BOOL)datumValueIsValid:(NSString *)value error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
\ No newline at end of file
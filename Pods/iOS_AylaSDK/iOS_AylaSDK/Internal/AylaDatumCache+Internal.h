@@ -0,0 +1,36 @@
+//
+//  AylaDatumCache+Internal.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDatumCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaHTTPClient;
+
+@interface AylaDatumCache (Internal)
+
+/**
+ * Init method.
+ *
+ * @param collectionPath  Service path of the datums of the owner, e.g. `dsns/<dsn>/data.json`. Paths of single datums
+ *                        are derived from it.
+ * @param httpClientBlock A block returning the http client requests are issued with, or nil and an error if there is
+ *                        none.
+ */
+- (instancetype)initWithCollectionPath:(NSString *)collectionPath
+                       httpClientBlock:(AylaHTTPClient *_Nullable (^)(NSError *_Nullable __autoreleasing *_Nullable error))
+                                           httpClientBlock;
+
+/**
+ * Drops all cached entries and pending writes. Completion blocks of dropped writes are called with a cancelled error,
+ * writes already being sent complete without updating the cache.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -24,14 +24,15 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)initWithDeviceManager:(nullable AylaDeviceManager *)deviceManager NS_DESIGNATED_INITIALIZER;
 
 /**
- * Use this method to let DS handler invoke corresponding receivers for each message.
+ * Use this method to let DS handler invoke corresponding receivers for each message. Must be called on the processing
+ * queue of the device the message is for.
  *
  * @param message To-be-processed datastream message .
  */
 - (void)handleMessage:(AylaDSMessage *)message;
 
 /**
- * A helpful method to get a DS message from raw string.
+ * A helpful method to get a DS message from raw string. Can be called from any queue.
  *
  * @param string String to be parsed from.
  *
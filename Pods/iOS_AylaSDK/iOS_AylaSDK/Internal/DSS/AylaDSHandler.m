@@ -56,8 +56,6 @@
     AylaDevice *device = self.deviceManager.devices[dsn];
     AylaProperty *property = device.properties[message.metadata.propertyName];
 
-    // TODO: Api updateFromDatapoint: is not thead-safe in a concurrency environment. Should be deployed through device
-    // queue or synchronization.
     if (!device.lanModule.isActive && property) {
         AylaPropertyChange *change = [property updateFromDatapoint:datapoint];
         if (change) {
@@ -76,9 +74,8 @@
         return;
     }
     
-    AylaDevice *device = [self.deviceManager.devices[dsn] copy];
+    AylaDevice *device = self.deviceManager.devices[dsn];
     [device updateFromConnection:message.connection dataSource:AylaDataSourceDSS];
-    
 }
 
 static const int RAW_STRING_LENGTH_CHECK = 3;
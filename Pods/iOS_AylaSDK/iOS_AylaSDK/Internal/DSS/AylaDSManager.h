@@ -28,6 +28,17 @@ typedef NS_ENUM(NSInteger, AylaDSState) {
     AylaDSStateDisconnected
 };
 
+/** Number of frames received from the web socket, heart beats excluded */
+FOUNDATION_EXPORT NSString *const AylaDSManagerStatisticsReceivedFramesKey;
+/** Number of frames received which have not been applied to their device yet */
+FOUNDATION_EXPORT NSString *const AylaDSManagerStatisticsQueuedFramesKey;
+/** Highest number of queued frames */
+FOUNDATION_EXPORT NSString *const AylaDSManagerStatisticsPeakQueuedFramesKey;
+/** Total time spent decoding frames, in seconds */
+FOUNDATION_EXPORT NSString *const AylaDSManagerStatisticsDecodeTimeKey;
+/** Total time spent applying decoded messages to devices, in seconds */
+FOUNDATION_EXPORT NSString *const AylaDSManagerStatisticsApplyTimeKey;
+
 @class AylaDSManager;
 @class AylaSessionManager;
 @class AylaSystemSettings;
@@ -73,6 +84,9 @@ typedef NS_ENUM(NSInteger, AylaDSState) {
 /** Manager state. */
 @property (nonatomic, assign, readonly) AylaDSState state;
 
+/** Time a frame or heart beat was last received at, 0 if none has been received since the manager was created. */
+@property (atomic, assign, readonly) CFAbsoluteTime lastActivityTime;
+
 
 /**
  Client used during Subscription tests
@@ -106,6 +120,21 @@ typedef NS_ENUM(NSInteger, AylaDSState) {
  */
 - (void)pause;
 
+/**
+ * Frames are decoded concurrently off the manager queue, then applied to their device in the order they were received.
+ * Use this method to check whether the manager keeps up with the stream.
+ *
+ * @return Frame counters and timings, see the `AylaDSManagerStatistics...Key` constants.
+ */
+- (NSDictionary<NSString *, NSNumber *> *)messageStatistics;
+
+/**
+ * @param dsn DSN of a device
+ *
+ * @return YES if the current subscription covers the device
+ */
+- (BOOL)isSubscribedToDeviceWithDsn:(NSString *)dsn;
+
 // Unavailable methods
 - (instancetype)init NS_UNAVAILABLE;
 
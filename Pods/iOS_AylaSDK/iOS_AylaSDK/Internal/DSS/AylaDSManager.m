@@ -17,14 +17,29 @@
 #import "AylaHTTPClient.h"
 #import "AylaHTTPError.h"
 #import "AylaListenerArray.h"
+#import "AylaMetrics.h"
 #import "AylaObject+Internal.h"
+#import "AylaProfiler.h"
 #import "AylaSessionManager+Internal.h"
 #import "AylaSystemSettings.h"
 #import "AylaSystemUtils.h"
+#import "AylaTracer.h"
 
 /** DSS Manager queue label */
 static char *const AylaDSManagerQueueLabel = "com.aylanetworks.dsmgr.queue.processing";
 
+/** DSS Manager decode queue label */
+static char *const AylaDSManagerDecodeQueueLabel = "com.aylanetworks.dsmgr.queue.decode";
+
+/** Number of queued frames above which the manager warns it is falling behind */
+static const NSUInteger AylaDSManagerQueuedFramesWarningThreshold = 256;
+
+NSString *const AylaDSManagerStatisticsReceivedFramesKey = @"receivedFrames";
+NSString *const AylaDSManagerStatisticsQueuedFramesKey = @"queuedFrames";
+NSString *const AylaDSManagerStatisticsPeakQueuedFramesKey = @"peakQueuedFrames";
+NSString *const AylaDSManagerStatisticsDecodeTimeKey = @"decodeTime";
+NSString *const AylaDSManagerStatisticsApplyTimeKey = @"applyTime";
+
 /** Default retries for web socket eastalishment */
 static const NSInteger DEFAULT_WEB_SOCKET_EASTABLISHMENT_RETIRES = 2;
 
@@ -45,9 +60,34 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
 @property (nonatomic, strong, readwrite) SRWebSocket *webSocket;
 @property (nonatomic, strong, readwrite) AylaSystemSettings *settings;
 @property (nonatomic, assign, readwrite) AylaDSState state;
+@property (atomic, assign, readwrite) CFAbsoluteTime lastActivityTime;
 @property (nonatomic, strong, readwrite) dispatch_queue_t processingQueue;
 @property (nonatomic, strong, readwrite) AylaDSHandler *handler;
 
+/** Concurrent queue frames are decoded on */
+@property (nonatomic, strong) dispatch_queue_t decodeQueue;
+/** Sequence number given to the next received frame */
+@property (nonatomic, assign) NSUInteger nextFrameSeq;
+/** Sequence number of the next frame to hand over to its device */
+@property (nonatomic, assign) NSUInteger nextDispatchSeq;
+/** Decoded frames waiting for the frames received before them, keyed by sequence number */
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, id> *decodedFrames;
+/** Decoded messages waiting to be applied, keyed by dsn */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<AylaDSMessage *> *> *pendingMessages;
+/** Dsns which have a batch of messages being applied */
+@property (nonatomic, strong) NSMutableSet<NSString *> *applyingDsns;
+
+@property (nonatomic, assign) NSUInteger receivedFrames;
+@property (nonatomic, assign) NSUInteger queuedFrames;
+@property (nonatomic, assign) NSUInteger peakQueuedFrames;
+@property (nonatomic, assign) CFTimeInterval decodeTime;
+@property (nonatomic, assign) CFTimeInterval applyTime;
+
+/** Time the current subscription creation started at, 0 once reported */
+@property (nonatomic, assign) CFAbsoluteTime subscribeStartTime;
+/** Time the current web socket started opening at, 0 once reported */
+@property (nonatomic, assign) CFAbsoluteTime connectStartTime;
+
 @property (nonatomic, assign) int subscriptionRetries;
 @property (nonatomic, assign) int wsConnectionRetries;
 @property (nonatomic, assign) BOOL isPaused;
@@ -92,6 +132,12 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     isOnQueueKey = &isOnQueueKey;
     dispatch_queue_set_specific(_processingQueue, isOnQueueKey, aPointer, NULL);
 
+    // Frames are decoded concurrently, then handed over in order on the processing queue.
+    _decodeQueue = dispatch_queue_create(AylaDSManagerDecodeQueueLabel, DISPATCH_QUEUE_CONCURRENT);
+    _decodedFrames = [NSMutableDictionary dictionary];
+    _pendingMessages = [NSMutableDictionary dictionary];
+    _applyingDsns = [NSMutableSet set];
+
     // Init device manager.
     _handler = [[AylaDSHandler alloc] initWithDeviceManager:deviceManager];
 
@@ -178,6 +224,7 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     NSURL *url = [NSURL URLWithString:absoluteUrlString];
 
     // init ws
+    self.connectStartTime = CFAbsoluteTimeGetCurrent();
     SRWebSocket *ws = [[SRWebSocket alloc] initWithURL:url];
 
     [ws setDelegateDispatchQueue:self.processingQueue];
@@ -202,9 +249,17 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
             // Add self as listener of device manager.
             [deviceManager addListener:self];
             self.subscriptionRetries = DEFAULT_SUBSCRIPTION_RETIRES;
+            self.subscribeStartTime = CFAbsoluteTimeGetCurrent();
             [self subscribeWithDsns:nil
                     completionBlock:^(AylaDSSubscription *subscription, BOOL created, NSError *error) {
                         if (subscription && !error) {
+                            AylaHTTPClient *subscriptionClient =
+                                self.deviceManager.sessionManager.httpClients[@(AylaHTTPClientTypeMDSSService)];
+                            [self reportPhase:AylaProfilerPhaseDSSSubscribe
+                                         host:subscriptionClient.baseURL.host
+                                    startTime:self.subscribeStartTime];
+                            self.subscribeStartTime = 0;
+
                             // Reset retries
                             self.wsConnectionRetries = DEFAULT_WEB_SOCKET_EASTABLISHMENT_RETIRES;
                             
@@ -283,6 +338,19 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     self.webSocket = nil;
 }
 
+/**
+ * Reports the duration of a phase of the connection through the profiler. Must be called on the processing queue.
+ */
+- (void)reportPhase:(NSString *)phase host:(NSString *)host startTime:(CFAbsoluteTime)startTime
+{
+    if (startTime == 0) {
+        return;
+    }
+    [[AylaProfiler sharedInstance] didCompleteSessionPhase:phase
+                                                      host:host
+                                                  duration:CFAbsoluteTimeGetCurrent() - startTime];
+}
+
 - (NSString *)nameOfState:(AylaDSState)state {
     switch (state) {
         case AylaDSStateConnected:
@@ -362,6 +430,19 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     [self _cleanDSConnection];
 }
 
+- (BOOL)isSubscribedToDeviceWithDsn:(NSString *)dsn
+{
+    AylaDSSubscription *subscription = self.subscription;
+    if (!subscription) {
+        return NO;
+    }
+    // Subscriptions created without dsns cover all devices of the user
+    if (subscription.dsn.length == 0 || [subscription.dsn isEqualToString:@"*"]) {
+        return YES;
+    }
+    return [[subscription.dsn componentsSeparatedByString:AylaDSSubscriptionDefaultDelimiter] containsObject:dsn];
+}
+
 //-----------------------------------------------------------
 #pragma mark - Device manager
 //-----------------------------------------------------------
@@ -432,26 +513,22 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
 
 - (void)webSocketDidOpen:(SRWebSocket *)webSocket
 {
+    self.lastActivityTime = CFAbsoluteTimeGetCurrent();
+    [self reportPhase:AylaProfilerPhaseDSSConnect host:self.httpClient.baseURL.host startTime:self.connectStartTime];
+    self.connectStartTime = 0;
     [self setDSState:AylaDSStateConnected object:nil error:nil];
 }
 
 - (void)webSocket:(SRWebSocket *)webSocket didReceiveMessage:(id)rawString
 {
     if (rawString != nil) {
+        self.lastActivityTime = CFAbsoluteTimeGetCurrent();
         if ([rawString isEqualToString:AylaDSHeartBeat]) {
             // respond with the same string
             [webSocket send:rawString];
         }
         else {
-            AylaDSMessage *message = [self.handler messageFromRawString:rawString];
-            if (message) {
-                [self.handler handleMessage:message];
-                [self.listeners iterateListenersRespondingToSelector:@selector(dsManager:didReceiveMessage:)
-                                                        asyncOnQueue:dispatch_get_main_queue()
-                                                               block:^(id _Nonnull listener) {
-                                                                   [listener dsManager:self didReceiveMessage:message];
-                                                               }];
-            }
+            [self enqueueFrame:rawString];
         }
     }
 }
@@ -500,6 +577,143 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     self.subscription = nil;
 }
 
+//-----------------------------------------------------------
+#pragma mark - Frames
+//-----------------------------------------------------------
+
+/**
+ * Decodes a frame on the decode queue. Must be called on the processing queue.
+ */
+- (void)enqueueFrame:(NSString *)rawString
+{
+    NSUInteger frameSeq = self.nextFrameSeq++;
+    self.receivedFrames++;
+    self.queuedFrames++;
+    [[AylaMetrics sharedMetrics] incrementCounter:AylaMetricsDSSFrames];
+    if (self.queuedFrames > self.peakQueuedFrames) {
+        self.peakQueuedFrames = self.queuedFrames;
+    }
+    if (self.queuedFrames == AylaDSManagerQueuedFramesWarningThreshold) {
+        AylaLogW([self logTag], 0, @"%lu frames queued, %@", (unsigned long)self.queuedFrames, NSStringFromSelector(_cmd));
+    }
+
+    AylaDSHandler *handler = self.handler;
+    dispatch_async(self.decodeQueue, ^{
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        AylaDSMessage *message = [handler messageFromRawString:rawString];
+        CFTimeInterval decodeTime = CFAbsoluteTimeGetCurrent() - startTime;
+        [[AylaMetrics sharedMetrics] recordDuration:decodeTime forHistogram:@"dss.decode"];
+        if (!message) {
+            [[AylaMetrics sharedMetrics] incrementCounter:@"dss.frames.undecodable"];
+        }
+
+        dispatch_async(self.processingQueue, ^{
+            self.decodeTime += decodeTime;
+            self.decodedFrames[@(frameSeq)] = message ?: [NSNull null];
+            [self dispatchDecodedFrames];
+        });
+    });
+}
+
+/**
+ * Groups decoded frames per dsn in the order they were received. Must be called on the processing queue.
+ */
+- (void)dispatchDecodedFrames
+{
+    NSMutableSet *dsns = [NSMutableSet set];
+    id frame;
+    while ((frame = self.decodedFrames[@(self.nextDispatchSeq)])) {
+        [self.decodedFrames removeObjectForKey:@(self.nextDispatchSeq)];
+        self.nextDispatchSeq++;
+
+        if (frame == [NSNull null]) {
+            self.queuedFrames--;
+            continue;
+        }
+
+        AylaDSMessage *message = frame;
+        NSString *dsn = message.metadata.dsn ?: @"";
+        NSMutableArray *messages = self.pendingMessages[dsn];
+        if (!messages) {
+            messages = [NSMutableArray array];
+            self.pendingMessages[dsn] = messages;
+        }
+        [messages addObject:message];
+        [dsns addObject:dsn];
+    }
+
+    for (NSString *dsn in dsns) {
+        [self applyPendingMessagesOfDsn:dsn];
+    }
+}
+
+/**
+ * Applies the pending messages of a device as a batch on its processing queue. A device only has one batch
+ * being applied at a time so its messages are applied in order. Must be called on the processing queue.
+ */
+- (void)applyPendingMessagesOfDsn:(NSString *)dsn
+{
+    NSArray<AylaDSMessage *> *messages = self.pendingMessages[dsn];
+    if (messages.count == 0 || [self.applyingDsns containsObject:dsn]) {
+        return;
+    }
+    [self.pendingMessages removeObjectForKey:dsn];
+    [self.applyingDsns addObject:dsn];
+
+    AylaDSHandler *handler = self.handler;
+    AylaDevice *device = self.deviceManager.devices[dsn];
+    dispatch_queue_t queue = device ? device.processingQueue : [AylaDevice deviceProcessingQueue];
+    dispatch_async(queue, ^{
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        for (AylaDSMessage *message in messages) {
+            [handler handleMessage:message];
+        }
+        CFTimeInterval applyTime = CFAbsoluteTimeGetCurrent() - startTime;
+        [[AylaMetrics sharedMetrics] recordDuration:applyTime forHistogram:@"dss.apply"];
+        [[AylaTracer sharedTracer] recordSpanWithName:@"dss.apply"
+                                             category:@"dss"
+                                              traceId:nil
+                                            startTime:startTime
+                                              details:@{ @"dsn" : dsn, @"messages" : @(messages.count) }];
+
+        [self.listeners iterateListenersRespondingToSelector:@selector(dsManager:didReceiveMessage:)
+                                                asyncOnQueue:dispatch_get_main_queue()
+                                                       block:^(id _Nonnull listener) {
+                                                           for (AylaDSMessage *message in messages) {
+                                                               [listener dsManager:self didReceiveMessage:message];
+                                                           }
+                                                       }];
+
+        dispatch_async(self.processingQueue, ^{
+            self.applyTime += applyTime;
+            self.queuedFrames -= messages.count;
+            [self.applyingDsns removeObject:dsn];
+            [self applyPendingMessagesOfDsn:dsn];
+        });
+    });
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)messageStatistics
+{
+    __block NSDictionary *statistics;
+    void (^collect)(void) = ^{
+        statistics = @{
+            AylaDSManagerStatisticsReceivedFramesKey : @(self.receivedFrames),
+            AylaDSManagerStatisticsQueuedFramesKey : @(self.queuedFrames),
+            AylaDSManagerStatisticsPeakQueuedFramesKey : @(self.peakQueuedFrames),
+            AylaDSManagerStatisticsDecodeTimeKey : @(self.decodeTime),
+            AylaDSManagerStatisticsApplyTimeKey : @(self.applyTime),
+        };
+    };
+    if (dispatch_get_specific(isOnQueueKey)) {
+        collect();
+    }
+    else {
+        dispatch_sync(self.processingQueue, collect);
+    }
+    return statistics;
+}
+
 //-----------------------------------------------------------
 #pragma mark - Device manager
 //-----------------------------------------------------------
@@ -508,12 +722,12 @@ static NSString *const AylaDSHeartBeat = @"1|Z";
     // Notify devices in device manager
     NSArray *devices = self.deviceManager.devices.allValues;
     if (devices.count) {
-        // Switch to processing queue to call data source changed.
-        dispatch_async([AylaDevice deviceProcessingQueue], ^{
-            for (AylaDevice *device in devices) {
+        // Switch to processing queue of each device to call data source changed.
+        for (AylaDevice *device in devices) {
+            dispatch_async(device.processingQueue, ^{
                 [device dataSourceChanged:AylaDataSourceDSS];
-            }
-        });
+            });
+        }
     }
 }
 
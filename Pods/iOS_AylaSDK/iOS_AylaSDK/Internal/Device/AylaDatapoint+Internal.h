@@ -24,6 +24,29 @@ NS_ASSUME_NONNULL_BEGIN
                             dataSource:(AylaDataSource)dataSource
                                  error:(NSError *_Nullable __autoreleasing *_Nullable)error;
 
+/**
+ * Init method for datapoints restored from a local store.
+ *
+ * @param value      Value of the datapoint.
+ * @param createdAt  Creation time of the datapoint.
+ * @param id         Id of the datapoint.
+ * @param metadata   Metadata of the datapoint.
+ * @param dataSource Data source of this datapoint
+ *
+ * @return Initialized datapoint instance.
+ */
+- (instancetype)initWithValue:(id)value
+                    createdAt:(NSDate *)createdAt
+                           id:(nullable NSString *)id
+                     metadata:(nullable NSDictionary *)metadata
+                   dataSource:(AylaDataSource)dataSource;
+
+/**
+ * Identifies the datapoint within a property's history by creation time (in milliseconds) and value. Unlike `id` it
+ * is also available for datapoints restored from a local store.
+ */
+- (NSString *)historyIdentifier;
+
 /**
  *  A weak reference to the parent property to use the HTTP Client
  */
@@ -0,0 +1,48 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDatapointOutbox.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaDatapointParams;
+@class AylaDeviceManager;
+@class AylaProperty;
+
+@interface AylaDatapointOutbox (Internal)
+
+/**
+ * Init method. Datapoints persisted by a previous session are loaded right away.
+ *
+ * @param deviceManager Device manager whose devices the datapoints are replayed on.
+ * @param filePath      Path of the file the outbox is persisted to.
+ * @param expiry        Time a datapoint waits before it expires, in seconds.
+ */
+- (instancetype)initWithDeviceManager:(AylaDeviceManager *)deviceManager
+                             filePath:(NSString *)filePath
+                               expiry:(NSTimeInterval)expiry;
+
+/**
+ * @param error Error a datapoint creation failed with.
+ *
+ * @return YES if the datapoint must be queued, i.e. the creation failed because the cloud service was unreachable.
+ */
++ (BOOL)shouldQueueDatapointAfterError:(NSError *)error;
+
+/**
+ * Queues a datapoint, replacing the one queued before for the same property.
+ *
+ * @param datapointParams Params of the datapoint. Params of file datapoints are rejected.
+ * @param property        Property of the datapoint.
+ *
+ * @return The queued datapoint, nil if it can't be queued.
+ */
+- (nullable AylaQueuedDatapoint *)queueDatapoint:(AylaDatapointParams *)datapointParams
+                                     forProperty:(AylaProperty *)property;
+
+@end
+
+NS_ASSUME_NONNULL_END
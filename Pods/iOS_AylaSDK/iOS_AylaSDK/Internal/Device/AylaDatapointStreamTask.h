@@ -0,0 +1,55 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaConnectTask.h"
+#import "AylaDatapointSink.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaProperty;
+
+/**
+ * A task which streams the datapoint history of a property by walking the requested range in time windows.
+ *
+ * Windows are fetched through `-[AylaProperty fetchDatapointsJSONWithCount:from:to:success:failure:]`, up to
+ * `maxConcurrentWindows` at a time. Any window returning a full page is split in half and fetched again. Decoding and
+ * writes into the sink happen on a private serial queue, in window order.
+ */
+@interface AylaDatapointStreamTask : AylaConnectTask
+
+/** The property being streamed */
+@property (nonatomic, weak, readonly) AylaProperty *property;
+
+/** Number of datapoints written into the sink so far */
+@property (nonatomic, readonly) NSUInteger datapointCount;
+
+/**
+ * Init method
+ *
+ * @param property             The property whose datapoints will be streamed.
+ * @param from                 Date of the earliest datapoint to stream.
+ * @param to                   Date of the latest datapoint to stream.
+ * @param windowInterval       Length of each time window in seconds.
+ * @param maxConcurrentWindows Number of windows which may be fetched at the same time.
+ * @param sink                 The sink datapoints are written into.
+ * @param successBlock         Called on main queue once the stream is complete.
+ * @param failureBlock         Called on main queue if the stream fails or is cancelled.
+ */
+- (instancetype)initWithProperty:(AylaProperty *)property
+                            from:(NSDate *)from
+                              to:(NSDate *)to
+                  windowInterval:(NSTimeInterval)windowInterval
+            maxConcurrentWindows:(NSUInteger)maxConcurrentWindows
+                            sink:(id<AylaDatapointSink>)sink
+                         success:(void (^)(NSUInteger datapointCount))successBlock
+                         failure:(void (^)(NSError *error))failureBlock NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)initWithType:(AylaConnectTaskType)type NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,409 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaConnectTask+Internal.h"
+#import "AylaDatapoint+Internal.h"
+#import "AylaDatapointHistoryCache.h"
+#import "AylaDatapointStreamTask.h"
+#import "AylaDefines_Internal.h"
+#import "AylaHTTPTask.h"
+#import "AylaProperty+Internal.h"
+
+static const char *AylaDatapointStreamQueueLabel = "com.aylanetworks.datapointStream.queue.processing";
+
+/** Number of undelivered windows kept per concurrent window before the stream stops opening new windows */
+static const NSUInteger AylaDatapointStreamPendingWindowsFactor = 4;
+
+/**
+ * A time window of a datapoint stream. Both ends are aligned to whole seconds, matching the precision of the cloud
+ * date filters.
+ */
+@interface AylaDatapointStreamWindow : NSObject
+
+@property (nonatomic, strong, readonly) NSDate *from;
+@property (nonatomic, strong, readonly) NSDate *to;
+
+/** If the window is being fetched */
+@property (nonatomic, assign) BOOL fetching;
+
+/** The HTTP task of an in-flight fetch */
+@property (nonatomic, strong, nullable) AylaHTTPTask *httpTask;
+
+/** Decoded datapoints of the window, set once the window is ready to be written */
+@property (nonatomic, strong, nullable) NSArray<AylaDatapoint *> *datapoints;
+
+- (instancetype)initWithFrom:(NSDate *)from to:(NSDate *)to;
+
+@end
+
+@implementation AylaDatapointStreamWindow
+
+- (instancetype)initWithFrom:(NSDate *)from to:(NSDate *)to
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _from = from;
+    _to = to;
+
+    return self;
+}
+
+@end
+
+@interface AylaDatapointStreamTask ()
+
+@property (nonatomic, weak, readwrite) AylaProperty *property;
+@property (nonatomic, readwrite) NSUInteger datapointCount;
+
+@property (nonatomic, strong) NSDate *endDate;
+@property (nonatomic, strong) NSDate *nextWindowStart;
+@property (nonatomic, assign) NSTimeInterval windowInterval;
+@property (nonatomic, assign) NSUInteger maxConcurrentWindows;
+@property (nonatomic, assign) NSUInteger inFlightCount;
+
+/** Undelivered windows in chronological order */
+@property (nonatomic, strong) NSMutableArray<AylaDatapointStreamWindow *> *windows;
+
+/** History identifiers of the last chunk written, used to drop datapoints returned by both windows sharing a boundary */
+@property (nonatomic, strong) NSSet *lastWrittenIdentifiers;
+
+@property (nonatomic, strong, nullable) id<AylaDatapointSink> sink;
+@property (nonatomic, copy, nullable) void (^successBlock)(NSUInteger datapointCount);
+@property (nonatomic, copy, nullable) void (^failureBlock)(NSError *error);
+
+@property (nonatomic, strong) dispatch_queue_t streamQueue;
+@property (nonatomic) NSRecursiveLock *lock;
+
+@end
+
+@implementation AylaDatapointStreamTask
+
+- (instancetype)initWithType:(AylaConnectTaskType)type
+{
+    AYLAssert(NO, @"Use -initWithProperty:from:to:windowInterval:maxConcurrentWindows:sink:success:failure:");
+    return nil;
+}
+
+- (instancetype)initWithProperty:(AylaProperty *)property
+                            from:(NSDate *)from
+                              to:(NSDate *)to
+                  windowInterval:(NSTimeInterval)windowInterval
+            maxConcurrentWindows:(NSUInteger)maxConcurrentWindows
+                            sink:(id<AylaDatapointSink>)sink
+                         success:(void (^)(NSUInteger))successBlock
+                         failure:(void (^)(NSError *))failureBlock
+{
+    self = [super initWithType:AylaConnectTaskTypeHTTP];
+    if (!self) return nil;
+
+    _property = property;
+    _nextWindowStart = [NSDate dateWithTimeIntervalSince1970:floor([from timeIntervalSince1970])];
+    _endDate = [NSDate dateWithTimeIntervalSince1970:ceil([to timeIntervalSince1970])];
+    _windowInterval = MAX(1., ceil(windowInterval));
+    _maxConcurrentWindows = MAX(1, maxConcurrentWindows);
+    _windows = [NSMutableArray array];
+    _sink = sink;
+    _successBlock = successBlock;
+    _failureBlock = failureBlock;
+    _streamQueue = dispatch_queue_create(AylaDatapointStreamQueueLabel, DISPATCH_QUEUE_SERIAL);
+    _lock = [[NSRecursiveLock alloc] init];
+
+    return self;
+}
+
+- (BOOL)start
+{
+    [self.lock lock];
+    if (self.executing || self.finished) {
+        [self.lock unlock];
+        return NO;
+    }
+
+    [super start];
+
+    // Keep the task alive until the stream is finished, callers are not required to hold on to it.
+    [self retainSelf];
+    [self.lock unlock];
+
+    dispatch_async(self.streamQueue, ^{
+        [self scheduleWindows];
+    });
+    return YES;
+}
+
+- (void)cancel
+{
+    [self.lock lock];
+    if (self.finished) {
+        [self.lock unlock];
+        return;
+    }
+    self.cancelled = YES;
+    [self.lock unlock];
+
+    dispatch_async(self.streamQueue, ^{
+        [self finishWithError:[AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                                         code:AylaRequestErrorCodeCancelled
+                                                     userInfo:nil]];
+    });
+}
+
+#pragma mark - Stream Queue
+
+- (BOOL)isStopped
+{
+    [self.lock lock];
+    BOOL stopped = self.finished || self.cancelled;
+    [self.lock unlock];
+    return stopped;
+}
+
+- (void)scheduleWindows
+{
+    if ([self isStopped]) {
+        return;
+    }
+
+    AylaProperty *property = self.property;
+    if (!property) {
+        [self finishWithError:[AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                                         code:AylaRequestErrorCodePreconditionFailure
+                                                     userInfo:@{AylaRequestErrorResponseJsonKey : @{@"property" : AylaErrorDescriptionCanNotBeFound}}]];
+        return;
+    }
+
+    AylaDatapointHistoryCache *historyCache = [property datapointHistoryCache];
+    BOOL readFromCache;
+    do {
+        readFromCache = NO;
+        while (self.inFlightCount < self.maxConcurrentWindows) {
+            AylaDatapointStreamWindow *window = [self nextWindowToFetch];
+            if (!window) {
+                break;
+            }
+            NSArray *cachedDatapoints =
+                [historyCache datapointsForPropertyKey:property.key from:window.from to:window.to];
+            if (cachedDatapoints) {
+                for (AylaDatapoint *datapoint in cachedDatapoints) {
+                    datapoint.property = property;
+                }
+                window.datapoints = cachedDatapoints;
+                readFromCache = YES;
+                continue;
+            }
+            [self fetchWindow:window property:property];
+        }
+        if (![self writeCompletedWindowsToProperty:property]) {
+            return;
+        }
+    } while (readFromCache);
+
+    if (self.inFlightCount == 0 && self.windows.count == 0) {
+        [self finishWithError:nil];
+    }
+}
+
+- (AylaDatapointStreamWindow *)nextWindowToFetch
+{
+    for (AylaDatapointStreamWindow *window in self.windows) {
+        if (!window.fetching && !window.datapoints) {
+            return window;
+        }
+    }
+
+    // Stop opening windows while earlier ones are outstanding, so a slow window can't make completed ones pile up.
+    if (self.windows.count >= self.maxConcurrentWindows * AylaDatapointStreamPendingWindowsFactor ||
+        [self.nextWindowStart compare:self.endDate] != NSOrderedAscending) {
+        return nil;
+    }
+
+    NSDate *windowEnd = [self.nextWindowStart dateByAddingTimeInterval:self.windowInterval];
+    if ([windowEnd compare:self.endDate] == NSOrderedDescending) {
+        windowEnd = self.endDate;
+    }
+    AylaDatapointStreamWindow *window =
+        [[AylaDatapointStreamWindow alloc] initWithFrom:self.nextWindowStart to:windowEnd];
+    [self.windows addObject:window];
+    self.nextWindowStart = windowEnd;
+    return window;
+}
+
+- (void)fetchWindow:(AylaDatapointStreamWindow *)window property:(AylaProperty *)property
+{
+    window.fetching = YES;
+    self.inFlightCount++;
+
+    window.httpTask = [property fetchDatapointsJSONWithCount:[AylaProperty maxDatapointCount]
+        from:window.from
+        to:window.to
+        success:^(NSArray *datapointsJSON) {
+            dispatch_async(self.streamQueue, ^{
+                [self window:window didFetchDatapointsJSON:datapointsJSON];
+            });
+        }
+        failure:^(NSError *error) {
+            dispatch_async(self.streamQueue, ^{
+                [self window:window didFailWithError:error];
+            });
+        }];
+}
+
+- (void)window:(AylaDatapointStreamWindow *)window didFetchDatapointsJSON:(NSArray *)datapointsJSON
+{
+    if ([self isStopped]) {
+        return;
+    }
+    self.inFlightCount--;
+    window.fetching = NO;
+    window.httpTask = nil;
+
+    AylaProperty *property = self.property;
+    NSTimeInterval span = [window.to timeIntervalSinceDate:window.from];
+    if (datapointsJSON.count >= [AylaProperty maxDatapointCount]) {
+        if (span >= 2.) {
+            // A full page may have been truncated, split the window and fetch both halves instead.
+            NSDate *middle = [window.from dateByAddingTimeInterval:floor(span / 2.)];
+            AylaDatapointStreamWindow *first = [[AylaDatapointStreamWindow alloc] initWithFrom:window.from to:middle];
+            AylaDatapointStreamWindow *second = [[AylaDatapointStreamWindow alloc] initWithFrom:middle to:window.to];
+            NSUInteger index = [self.windows indexOfObjectIdenticalTo:window];
+            [self.windows replaceObjectsInRange:NSMakeRange(index, 1) withObjectsFromArray:@[ first, second ]];
+            AylaLogD([self logTag], 0, @"split:%@-%@, %@", window.from, window.to, NSStringFromSelector(_cmd));
+            [self scheduleWindows];
+            return;
+        }
+        AylaLogW([self logTag], 0, @"truncated:%@-%@, %@", window.from, window.to, NSStringFromSelector(_cmd));
+    }
+
+    NSMutableArray *datapoints = [NSMutableArray arrayWithCapacity:datapointsJSON.count];
+    for (NSDictionary *datapointJSON in datapointsJSON) {
+        NSError *error;
+        AylaDatapoint *datapoint = [property datapointWithJSONDictionary:datapointJSON error:&error];
+        if (!datapoint) {
+            AylaLogE([self logTag], 0, @"invalidResp:%@, %@", datapointJSON, NSStringFromSelector(_cmd));
+            [self finishWithError:error];
+            return;
+        }
+        [datapoints addObject:datapoint];
+    }
+    // The cache records the order the cloud returned the datapoints in, so append them before sorting.
+    if (datapointsJSON.count < [AylaProperty maxDatapointCount]) {
+        [[property datapointHistoryCache] appendDatapoints:[datapoints copy]
+                                            forPropertyKey:property.key
+                                                      from:window.from
+                                                        to:window.to];
+    }
+    [datapoints sortUsingDescriptors:@[ [NSSortDescriptor sortDescriptorWithKey:@"createdAt" ascending:YES] ]];
+    window.datapoints = datapoints;
+
+    [self scheduleWindows];
+}
+
+- (void)window:(AylaDatapointStreamWindow *)window didFailWithError:(NSError *)error
+{
+    if ([self isStopped]) {
+        return;
+    }
+    self.inFlightCount--;
+    window.fetching = NO;
+    window.httpTask = nil;
+
+    [self finishWithError:error];
+}
+
+/**
+ * Writes every decoded window at the head of the stream into the sink.
+ *
+ * @return NO if the stream has been finished.
+ */
+- (BOOL)writeCompletedWindowsToProperty:(AylaProperty *)property
+{
+    while (self.windows.firstObject.datapoints) {
+        if ([self isStopped]) {
+            return NO;
+        }
+
+        NSArray<AylaDatapoint *> *datapoints = self.windows.firstObject.datapoints;
+        [self.windows removeObjectAtIndex:0];
+
+        // Cloud date filters are inclusive, so datapoints on a window boundary are returned by both windows. Windows
+        // read from the history cache have no datapoint ids, hence they are matched by time and value.
+        if (self.lastWrittenIdentifiers.count > 0) {
+            NSSet *lastWrittenIdentifiers = self.lastWrittenIdentifiers;
+            datapoints = [datapoints filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(
+                                                                     AylaDatapoint *datapoint, NSDictionary *bindings) {
+                return ![lastWrittenIdentifiers containsObject:[datapoint historyIdentifier]];
+            }]];
+        }
+        if (datapoints.count == 0) {
+            continue;
+        }
+
+        NSMutableSet *writtenIdentifiers = [NSMutableSet setWithCapacity:datapoints.count];
+        for (AylaDatapoint *datapoint in datapoints) {
+            [writtenIdentifiers addObject:[datapoint historyIdentifier]];
+        }
+        self.lastWrittenIdentifiers = writtenIdentifiers;
+        self.datapointCount += datapoints.count;
+
+        if (![self.sink property:property writeDatapoints:datapoints]) {
+            AylaLogI([self logTag], 0, @"%@, %@", @"stoppedBySink", NSStringFromSelector(_cmd));
+            [self finishWithError:nil];
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (void)finishWithError:(NSError *)error
+{
+    [self.lock lock];
+    if (self.finished) {
+        [self.lock unlock];
+        return;
+    }
+    self.executing = NO;
+    self.finished = YES;
+    [self.lock unlock];
+
+    for (AylaDatapointStreamWindow *window in self.windows) {
+        [window.httpTask cancel];
+    }
+    [self.windows removeAllObjects];
+
+    void (^successBlock)(NSUInteger) = self.successBlock;
+    void (^failureBlock)(NSError *) = self.failureBlock;
+    NSUInteger datapointCount = self.datapointCount;
+    self.successBlock = nil;
+    self.failureBlock = nil;
+    self.sink = nil;
+
+    if (error) {
+        AylaLogE([self logTag], 0, @"err:%@, %@", error, NSStringFromSelector(_cmd));
+        if (failureBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                failureBlock(error);
+            });
+        }
+    }
+    else {
+        AylaLogI([self logTag], 0, @"count:%lu, %@", (unsigned long)datapointCount, NSStringFromSelector(_cmd));
+        if (successBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                successBlock(datapointCount);
+            });
+        }
+    }
+
+    [self unretainSelf];
+}
+
+- (NSString *)logTag
+{
+    return @"DatapointStream";
+}
+
+@end
@@ -45,6 +45,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)updateFromConnection:(AylaDeviceConnection *)deviceConnection dataSource:(AylaDataSource)dataSource;
 
+/**
+ * Init method of snapshots. The snapshot has its own listeners but no device manager or LAN module, its fields are set
+ * by copyFieldsToSnapshot:.
+ */
+- (instancetype)initSnapshot;
+
+/**
+ * Copies the fields of the device to a snapshot of it. Subclasses which add fields override it and call super.
+ */
+- (void)copyFieldsToSnapshot:(AylaDevice *)snapshot;
+
 /**
  * Use this method to notify changes to all listeners.
  *
@@ -52,6 +63,12 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)notifyChangesToListeners:(NSArray *)changes;
 
+/**
+ * Records that the app wrote to the device, which lets the poll policy shorten
+ * the poll interval for a while.
+ */
+- (void)recordUserWrite;
+
 /**
  * Use this method to let device refresh its current sync strategy.
  */
@@ -107,7 +124,19 @@ NS_ASSUME_NONNULL_BEGIN
 + (Class)deviceClassFromJSONDictionary:(NSDictionary *)dictionary;
 
 /**
- * Get device processing queue
+ * Serial queue the device parses responses, updates properties and notifies listeners on. Devices sharing a processing
+ * context share the queue, queues of different contexts run in parallel.
+ */
+@property (nonatomic, readonly) dispatch_queue_t processingQueue;
+
+/**
+ * Key of the processing context of the device, its dsn by default. Only read once, the first time `processingQueue`
+ * is accessed.
+ */
+- (nullable NSString *)processingContext;
+
+/**
+ * Get the shared device processing queue, used for work which is not bound to a single device.
  */
 + (dispatch_queue_t)deviceProcessingQueue;
 
@@ -10,7 +10,9 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class AylaDatapoint;
+@class AylaDatapointHistoryCache;
 @class AylaHTTPClient;
+@class AylaHTTPTask;
 @class AylaLanCommand;
 @class AylaPropertyChange;
 
@@ -52,6 +54,11 @@ NS_ASSUME_NONNULL_BEGIN
 @end
 
 @interface AylaProperty ()
+/**
+ * Copies the fields of the property to a snapshot of it. Subclasses which add fields override it and call super.
+ */
+- (void)copyFieldsToSnapshot:(AylaProperty *)snapshot;
+
 /**
  * Use this method to update a property with a copy from cloud.
  *
@@ -78,6 +85,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)updateAndNotifyDelegateFromDatapoint:(AylaDatapoint *)datapoint successBlock:(void (^)())successBlock;
 
+/**
+ * Creates a datapoint through the LAN session of the device, without falling back to the cloud.
+ *
+ * @param datapointParams Params of the datapoint.
+ * @param successBlock    A block called on the main queue once the datapoint has been created.
+ * @param failureBlock    A block called on the main queue if the datapoint could not be created.
+ *
+ * @return A started `AylaConnectTask` representing the request.
+ */
+- (nullable AylaConnectTask *)createDatapointLAN:(AylaDatapointParams *)datapointParams
+                                         success:(void (^)(AylaDatapoint *createdDatapoint))successBlock
+                                         failure:(void (^)(NSError *error))failureBlock;
+
 /**
  *  Returns the Cloud HTTP Client
  *
@@ -87,6 +107,46 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (AylaHTTPClient *)getHttpClient:(NSError *_Nullable __autoreleasing *_Nullable)error;
 
+/**
+ * @return The history cache of the session this property belongs to, or nil if it is not available or disabled.
+ */
+- (nullable AylaDatapointHistoryCache *)datapointHistoryCache;
+
+/**
+ * Fetches a single page of datapoints of this property from the cloud without decoding them.
+ *
+ * @param count        Number of datapoints to fetch. Clamped to `+maxDatapointCount`.
+ * @param from         Date of earliest datapoint to fetch. May be nil.
+ * @param to           Date of the latest datapoint to fetch. May be nil.
+ * @param successBlock A block called on the completion queue of the HTTP client. Passed the raw JSON array of the
+ * response, which can be decoded with `-datapointWithJSONDictionary:error:`.
+ * @param failureBlock A block called on the completion queue of the HTTP client, or synchronously if no HTTP client is
+ * available.
+ *
+ * @return A started `AylaHTTPTask` representing the request.
+ */
+- (nullable AylaHTTPTask *)fetchDatapointsJSONWithCount:(NSInteger)count
+                                                   from:(nullable NSDate *)from
+                                                     to:(nullable NSDate *)to
+                                                success:(void (^)(NSArray *datapointsJSON))successBlock
+                                                failure:(void (^)(NSError *error))failureBlock;
+
+/**
+ * Decodes a datapoint of this property from an element of the cloud datapoints response.
+ *
+ * @param datapointJSON A dictionary wrapping the datapoint under the `datapoint` key.
+ * @param error         A pointer to an `NSError` variable to store an error in case of failure.
+ *
+ * @return The decoded `AylaDatapoint`, or an `AylaDatapointBlob` for file properties.
+ */
+- (nullable AylaDatapoint *)datapointWithJSONDictionary:(NSDictionary *)datapointJSON
+                                                  error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
+/**
+ * @return Maximum number of datapoints the cloud returns in a single datapoints request.
+ */
++ (NSInteger)maxDatapointCount;
+
 
 /**
  Enables network profiling.
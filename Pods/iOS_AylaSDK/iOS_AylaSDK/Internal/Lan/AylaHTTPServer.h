@@ -42,8 +42,28 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ * Keys of the dictionary returned by -connectionStatistics
+ */
+FOUNDATION_EXPORT NSString *const AylaHTTPServerStatisticsConnectionsKey;       // Connections closed so far
+FOUNDATION_EXPORT NSString *const AylaHTTPServerStatisticsRequestsKey;          // Requests served by those connections
+FOUNDATION_EXPORT NSString *const AylaHTTPServerStatisticsAcceptLatencyKey;     // Average seconds from accept to the headers of the first request
+FOUNDATION_EXPORT NSString *const AylaHTTPServerStatisticsParseLatencyKey;      // Average seconds from the headers of a request to its complete body
+
 @interface AylaHTTPServer : HTTPServer
 
+/**
+ * Number of requests a connection serves before it is closed. Connections are kept alive in between, so a device
+ * sending several requests in a row only pays for one connection setup. Set to 1 to close connections after each
+ * request. Defaults to 100.
+ */
+@property (atomic, assign) NSUInteger maxRequestsPerConnection;
+
+/**
+ * Seconds an idle connection is kept open, as advertised to clients in the Keep-Alive response header.
+ */
+@property (nonatomic, readonly) NSTimeInterval keepAliveTimeout;
+
 /**
  * Init method
  *
@@ -74,6 +94,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable id<AylaHTTPServerResponder>)getResponderOfLanIp:(NSString *)lanIp;
 
+/**
+ * @return Aggregated statistics of the closed connections, see the AylaHTTPServerStatistics keys.
+ */
+- (NSDictionary<NSString *, NSNumber *> *)connectionStatistics;
+
 @end
 
 /**
@@ -14,12 +14,35 @@
 
 #import <CocoaAsyncSocket/GCDAsyncSocket.h>
 
+NSString *const AylaHTTPServerStatisticsConnectionsKey = @"connections";
+NSString *const AylaHTTPServerStatisticsRequestsKey = @"requests";
+NSString *const AylaHTTPServerStatisticsAcceptLatencyKey = @"acceptLatency";
+NSString *const AylaHTTPServerStatisticsParseLatencyKey = @"parseLatency";
+
+static const NSUInteger AylaHTTPServerDefaultMaxRequestsPerConnection = 100;
+
+/** Matches the time HTTPConnection waits for the first header line of the next request */
+static const NSTimeInterval AylaHTTPServerKeepAliveTimeout = 30.;
+
+/** Largest body buffer allocated up front from the Content-Length of a request */
+static const UInt64 AylaHTTPServerMaxPreallocatedBodySize = 1024 * 1024;
+
 @interface AylaHTTPServer ()
 /**
  * The reponder set. Right now we only registers one responder to one lan ip.
  */
 @property NSMutableDictionary AYLA_GENERIC(NSString *, id<AylaHTTPServerResponder>) * responders;
 
+@property (nonatomic) NSUInteger closedConnections;
+@property (nonatomic) NSUInteger servedRequests;
+@property (nonatomic) NSUInteger acceptedRequestConnections;
+@property (nonatomic) CFTimeInterval totalAcceptLatency;
+@property (nonatomic) CFTimeInterval totalParseLatency;
+
+- (void)connectionDidCloseWithRequestCount:(NSUInteger)requestCount
+                             acceptLatency:(CFTimeInterval)acceptLatency
+                        totalParseLatency:(CFTimeInterval)totalParseLatency;
+
 @end
 
 /**
@@ -33,6 +56,18 @@
 /** Http server which handles this http server connection */
 @property (nonatomic, weak) AylaHTTPServer *httpServer;
 
+/** Number of requests received on this connection */
+@property (nonatomic) NSUInteger requestCount;
+
+/** Body of the current request, sized from its Content-Length */
+@property (nonatomic) NSMutableData *bodyBuffer;
+
+@property (nonatomic) CFAbsoluteTime acceptTime;
+@property (nonatomic) CFTimeInterval acceptLatency;
+@property (nonatomic) CFAbsoluteTime headerTime;
+@property (nonatomic) CFTimeInterval totalParseLatency;
+@property (nonatomic) BOOL reportedClose;
+
 @end
 
 /**
@@ -67,6 +102,7 @@
         connectionClass = [AylaHTTPServerConnection class];
 
         _responders = [NSMutableDictionary dictionary];
+        _maxRequestsPerConnection = AylaHTTPServerDefaultMaxRequestsPerConnection;
     }
     return self;
 }
@@ -109,6 +145,40 @@
     }
 }
 
+- (NSTimeInterval)keepAliveTimeout
+{
+    return AylaHTTPServerKeepAliveTimeout;
+}
+
+- (void)connectionDidCloseWithRequestCount:(NSUInteger)requestCount
+                             acceptLatency:(CFTimeInterval)acceptLatency
+                        totalParseLatency:(CFTimeInterval)totalParseLatency
+{
+    @synchronized(self) {
+        self.closedConnections++;
+        self.servedRequests += requestCount;
+        if (requestCount > 0) {
+            self.acceptedRequestConnections++;
+            self.totalAcceptLatency += acceptLatency;
+        }
+        self.totalParseLatency += totalParseLatency;
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)connectionStatistics
+{
+    @synchronized(self) {
+        return @{
+            AylaHTTPServerStatisticsConnectionsKey : @(self.closedConnections),
+            AylaHTTPServerStatisticsRequestsKey : @(self.servedRequests),
+            AylaHTTPServerStatisticsAcceptLatencyKey :
+                @(self.acceptedRequestConnections > 0 ? self.totalAcceptLatency / self.acceptedRequestConnections : 0),
+            AylaHTTPServerStatisticsParseLatencyKey :
+                @(self.servedRequests > 0 ? self.totalParseLatency / self.servedRequests : 0)
+        };
+    }
+}
+
 @end
 
 @implementation AylaHTTPServerConnection
@@ -117,6 +187,7 @@
 {
     self = [super initWithAsyncSocket:socket configuration:aConfig];
     self.hostIp = [socket connectedHost];
+    self.acceptTime = CFAbsoluteTimeGetCurrent();
 
     HTTPServer *server = aConfig.server;
     if ([server isKindOfClass:[AylaHTTPServer class]]) {
@@ -136,6 +207,12 @@
  */
 - (BOOL)supportsMethod:(NSString *)method atPath:(NSString *)path
 {
+    // Called once the headers of a request have been parsed
+    self.headerTime = CFAbsoluteTimeGetCurrent();
+    if (self.requestCount++ == 0) {
+        self.acceptLatency = self.headerTime - self.acceptTime;
+    }
+
     // Add support for POST/PUT/DELETE
     if ([method isEqualToString:AylaHTTPRequestMethodPOST] || [method isEqualToString:AylaHTTPRequestMethodPUT] ||
         [method isEqualToString:AylaHTTPRequestMethodDELETE]) {
@@ -159,13 +236,15 @@
     NSString *lanIp = self.hostIp;
 
     AylaHTTPServer *httpServer = self.httpServer;
-    id<AylaHTTPServerResponder> responder = httpServer.responders[lanIp];
+    id<AylaHTTPServerResponder> responder = [httpServer getResponderOfLanIp:lanIp];
+
+    self.totalParseLatency += CFAbsoluteTimeGetCurrent() - self.headerTime;
 
     // Compose server request with known data.
     AylaHTTPServerRequest *req = [[AylaHTTPServerRequest alloc] initWithMethod:method
                                                                            URI:path
                                                                   headerFields:[request allHeaderFields]
-                                                                      bodyData:[request body]];
+                                                                      bodyData:self.bodyBuffer ?: [request body]];
 
     AylaHTTPServerResponse *response = [responder httpServer:httpServer didReceiveRequest:req];
 
@@ -177,8 +256,9 @@
 
 - (void)prepareForBodyWithSize:(UInt64)contentLength
 {
-    // If we supported large uploads,
-    // we might use this method to create/open files, allocate memory, etc.
+    // Content length is UINT64_MAX for chunked requests
+    NSUInteger capacity = (NSUInteger)(contentLength <= AylaHTTPServerMaxPreallocatedBodySize ? contentLength : 0);
+    self.bodyBuffer = [NSMutableData dataWithCapacity:capacity];
 }
 
 - (void)processBodyData:(NSData *)postDataChunk
@@ -188,10 +268,59 @@
     // The size of the chunks are limited by the POST_CHUNKSIZE definition.
     // Therefore, this method may be called multiple times for the same POST request.
 
-    BOOL result = [request appendData:postDataChunk];
-    if (!result) {
-        AylaLogW(@"httpServer", 0, @"%@, %@", @"Couldn't append bytes", @"processBodyData");
+    [self.bodyBuffer appendData:postDataChunk];
+}
+
+- (BOOL)shouldDie
+{
+    AylaHTTPServer *httpServer = self.httpServer;
+    if (httpServer && self.requestCount >= httpServer.maxRequestsPerConnection) {
+        return YES;
+    }
+    return [super shouldDie];
+}
+
+- (NSData *)preprocessResponse:(HTTPMessage *)response
+{
+    // HTTP/1.0 clients only keep a connection alive when the response confirms it
+    if ([self shouldDie]) {
+        [response setHeaderField:@"Connection" value:@"close"];
+    }
+    else {
+        AylaHTTPServer *httpServer = self.httpServer;
+        NSUInteger remainingRequests = httpServer.maxRequestsPerConnection - self.requestCount;
+        [response setHeaderField:@"Connection" value:@"keep-alive"];
+        [response setHeaderField:@"Keep-Alive"
+                           value:[NSString stringWithFormat:@"timeout=%d, max=%lu",
+                                                            (int)httpServer.keepAliveTimeout,
+                                                            (unsigned long)remainingRequests]];
     }
+    return [super preprocessResponse:response];
+}
+
+- (void)finishResponse
+{
+    self.bodyBuffer = nil;
+    [super finishResponse];
+}
+
+- (void)die
+{
+    // die may be invoked twice
+    if (!self.reportedClose) {
+        self.reportedClose = YES;
+        AylaLogD([self logTag],
+                 0,
+                 @"host:%@, requests:%lu, accept:%.1fms, parse:%.1fms",
+                 self.hostIp,
+                 (unsigned long)self.requestCount,
+                 self.acceptLatency * 1000.,
+                 self.requestCount > 0 ? self.totalParseLatency * 1000. / self.requestCount : 0.);
+        [self.httpServer connectionDidCloseWithRequestCount:self.requestCount
+                                              acceptLatency:self.acceptLatency
+                                          totalParseLatency:self.totalParseLatency];
+    }
+    [super die];
 }
 
 - (NSString *)logTag
@@ -214,6 +343,7 @@
     
     _method = method;
     _URI = uri;
+    _headerFields = headerFields;
     _bodyData = bodyData;
     
     return self;
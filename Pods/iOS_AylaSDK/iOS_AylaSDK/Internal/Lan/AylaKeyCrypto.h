@@ -26,6 +26,12 @@ typedef NS_ENUM(uint32_t, AylaKeyCryptoRSAKeySize) {
     AylaKeyCryptoRSAKeySize2048 = 2048
 };
 
+/** Tag of the public key of the key pair used by Wi-Fi setup sessions */
+FOUNDATION_EXPORT NSString *const AylaKeyCryptoSetupPublicKeyTag;
+
+/** Tag of the private key of the key pair used by Wi-Fi setup sessions */
+FOUNDATION_EXPORT NSString *const AylaKeyCryptoSetupPrivateKeyTag;
+
 /**
  * Key Crypto helps get and manage a key pair fetched from system key chain.
  *
@@ -36,6 +42,9 @@ typedef NS_ENUM(uint32_t, AylaKeyCryptoRSAKeySize) {
  *
  * @note Synchronous api -updateRSAKeyPairInKeyChain: will potentialy take a while to generate a new key pair. Calling
  * it from main thread will cause an assertion.
+ *
+ * Key pairs are loaded from the key chain once and then shared in memory by all instances. Use
+ * +preloadKeyPairWithPubKeyTag:privKeyTag:keySize: to load, or generate, a key pair ahead of its first use.
  */
 @interface AylaKeyCrypto : NSObject
 
@@ -68,6 +77,33 @@ typedef NS_ENUM(uint32_t, AylaKeyCryptoRSAKeySize) {
  */
 - (BOOL)getKeyPairFromKeyChainWithPubKeyTag:(nullable NSString *)pubKeyTag privKeyTag:(nullable NSString *)privKeyTag;
 
+/**
+ * Use this method to get key pair with tags, generating a new key pair if none can be found in key chain. Loading and
+ * generation are serialized across all instances, so a key pair is never generated twice for the same tags.
+ *
+ * @param pubKeyTag  The tag of public key in the key chain. In nil is passed in, default public key tag will be used.
+ * @param privKeyTag The tag of private key in the key chain. In nil is passed in, default private key tag will be used.
+ * @param keySize    The key size of a generated key pair.
+ *
+ * @return YES if current crypto has been updated with a key pair.
+ *
+ * @note An assertion would be fired if this method had to generate a key pair on main thread.
+ */
+- (BOOL)loadOrGenerateKeyPairWithPubKeyTag:(nullable NSString *)pubKeyTag
+                                privKeyTag:(nullable NSString *)privKeyTag
+                                   keySize:(AylaKeyCryptoRSAKeySize)keySize;
+
+/**
+ * Loads, or generates if it is missing, a key pair on a background queue so it is ready in memory for its first use.
+ *
+ * @param pubKeyTag  The tag of public key in the key chain. In nil is passed in, default public key tag will be used.
+ * @param privKeyTag The tag of private key in the key chain. In nil is passed in, default private key tag will be used.
+ * @param keySize    The key size of a generated key pair.
+ */
++ (void)preloadKeyPairWithPubKeyTag:(nullable NSString *)pubKeyTag
+                         privKeyTag:(nullable NSString *)privKeyTag
+                            keySize:(AylaKeyCryptoRSAKeySize)keySize;
+
 /**
  * Use this method to update key pair inside the key chain with a key size.
  *
@@ -16,16 +16,99 @@ static NSString *const defaultKeyExchangeIdentifierRSAPublic = @"com.aylanetwork
 /** Default RSA private key tag */
 static NSString *const defaultKeyExchangeIdentifierRSAPrivate = @"com.aylanetworks.keyCrypto.rsaPrivateKey";
 
+NSString *const AylaKeyCryptoSetupPublicKeyTag = @"com.aylanetworks.setup.crypto.publicKey";
+NSString *const AylaKeyCryptoSetupPrivateKeyTag = @"com.aylanetworks.setup.crypto.privateKey";
+
+/**
+ * A key pair loaded in memory, shared by all key cryptos using the same tags.
+ */
+@interface AylaKeyCryptoKeyPair : NSObject
+
+@property (nonatomic, readonly) SecKeyRef pubKeyRef;
+@property (nonatomic, readonly) SecKeyRef privKeyRef;
+
+/** Bits of the public key, as sent to modules */
+@property (nonatomic, readonly, nullable) NSData *publicKeyData;
+
+- (instancetype)initWithPubKeyRef:(SecKeyRef)pubKeyRef
+                       privKeyRef:(SecKeyRef)privKeyRef
+                    publicKeyData:(nullable NSData *)publicKeyData;
+
+@end
+
+@implementation AylaKeyCryptoKeyPair
+
+- (instancetype)initWithPubKeyRef:(SecKeyRef)pubKeyRef
+                       privKeyRef:(SecKeyRef)privKeyRef
+                    publicKeyData:(NSData *)publicKeyData
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _pubKeyRef = (SecKeyRef)CFRetain(pubKeyRef);
+    _privKeyRef = (SecKeyRef)CFRetain(privKeyRef);
+    _publicKeyData = publicKeyData;
+
+    return self;
+}
+
+- (void)dealloc
+{
+    CFRelease(_pubKeyRef);
+    CFRelease(_privKeyRef);
+}
+
+@end
+
 @interface AylaKeyCrypto ()
 
 @property (nonatomic, readwrite) SecKeyRef pubKeyRef;
 @property (nonatomic, readwrite) SecKeyRef privKeyRef;
 @property (nonatomic, readwrite) NSRecursiveLock *lock;
+@property (nonatomic, nullable) AylaKeyCryptoKeyPair *keyPair;
 
 @end
 
 @implementation AylaKeyCrypto
 
+/**
+ * Key pairs loaded in memory, keyed by their tags. Guarded by the shared lock, which also serializes key chain
+ * lookups and key pair generation.
+ */
+static NSMutableDictionary<NSString *, AylaKeyCryptoKeyPair *> *sharedKeyPairs;
+static NSRecursiveLock *sharedKeyPairsLock;
+
++ (void)initialize
+{
+    if (self == [AylaKeyCrypto class]) {
+        sharedKeyPairs = [NSMutableDictionary dictionary];
+        sharedKeyPairsLock = [[NSRecursiveLock alloc] init];
+    }
+}
+
++ (NSString *)sharedKeyPairKeyWithPubKeyTag:(NSString *)pubKeyTag privKeyTag:(NSString *)privKeyTag
+{
+    return [NSString stringWithFormat:@"%@|%@", pubKeyTag, privKeyTag];
+}
+
++ (void)preloadKeyPairWithPubKeyTag:(NSString *)pubKeyTag
+                         privKeyTag:(NSString *)privKeyTag
+                            keySize:(AylaKeyCryptoRSAKeySize)keySize
+{
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AylaKeyCrypto *keyCrypto = [[AylaKeyCrypto alloc] init];
+        BOOL loaded = [keyCrypto loadOrGenerateKeyPairWithPubKeyTag:pubKeyTag privKeyTag:privKeyTag keySize:keySize];
+        AylaLogI([keyCrypto logTag],
+                 0,
+                 @"tag:%@, loaded:%d, %.3fs, %@",
+                 keyCrypto.pubKeyTag ?: pubKeyTag,
+                 loaded,
+                 CFAbsoluteTimeGetCurrent() - start,
+                 @"preloadKeyPair");
+    });
+}
+
 - (instancetype)init
 {
     self = [super init];
@@ -44,35 +127,89 @@ static NSString *const defaultKeyExchangeIdentifierRSAPrivate = @"com.aylanetwor
  */
 - (NSData *)publicKeyInData
 {
+    [self.lock lock];
+    NSData *publicKeyData = self.keyPair.publicKeyData;
+    [self.lock unlock];
+    if (publicKeyData) {
+        return publicKeyData;
+    }
     if (self.pubKeyTag) {
         return [self getKeyInBitsFromKeyChainWithTag:self.pubKeyTag];
     }
     return nil;
 }
 
-- (BOOL)getKeyPairFromKeyChainWithPubKeyTag:(nullable NSString *)pubKeyTag privKeyTag:(nullable NSString *)privKeyTag
+/**
+ * Makes a key pair the current one, holding on to its key refs.
+ */
+- (void)useKeyPair:(AylaKeyCryptoKeyPair *)keyPair pubKeyTag:(NSString *)pubKeyTag privKeyTag:(NSString *)privKeyTag
 {
     [self.lock lock];
-    
+    if (self.pubKeyRef) {
+        CFRelease(self.pubKeyRef);
+    }
+    if (self.privKeyRef) {
+        CFRelease(self.privKeyRef);
+    }
+    self.keyPair = keyPair;
+    self.pubKeyRef = (SecKeyRef)CFRetain(keyPair.pubKeyRef);
+    self.privKeyRef = (SecKeyRef)CFRetain(keyPair.privKeyRef);
+    self.pubKeyTag = pubKeyTag;
+    self.privKeyTag = privKeyTag;
+    [self.lock unlock];
+}
+
+- (BOOL)getKeyPairFromKeyChainWithPubKeyTag:(nullable NSString *)pubKeyTag privKeyTag:(nullable NSString *)privKeyTag
+{
     // Use default key tags if tags are not set correctly.
     if(!pubKeyTag || !privKeyTag) {
         pubKeyTag = defaultKeyExchangeIdentifierRSAPublic;
         privKeyTag = defaultKeyExchangeIdentifierRSAPrivate;
     }
-    
-    self.pubKeyRef = [self getKeyRefFromKeyChainWithTag:pubKeyTag];
-    self.privKeyRef = [self getKeyRefFromKeyChainWithTag:privKeyTag];
-    BOOL re = YES;
-    if (self.pubKeyRef && self.privKeyRef) {
-        self.pubKeyTag = pubKeyTag;
-        self.privKeyTag = privKeyTag;;
+
+    [sharedKeyPairsLock lock];
+    NSString *key = [AylaKeyCrypto sharedKeyPairKeyWithPubKeyTag:pubKeyTag privKeyTag:privKeyTag];
+    AylaKeyCryptoKeyPair *keyPair = sharedKeyPairs[key];
+    if (!keyPair) {
+        SecKeyRef pubKeyRef = [self getKeyRefFromKeyChainWithTag:pubKeyTag];
+        SecKeyRef privKeyRef = [self getKeyRefFromKeyChainWithTag:privKeyTag];
+        if (pubKeyRef && privKeyRef) {
+            keyPair = [[AylaKeyCryptoKeyPair alloc] initWithPubKeyRef:pubKeyRef
+                                                           privKeyRef:privKeyRef
+                                                        publicKeyData:[self getKeyInBitsFromKeyChainWithTag:pubKeyTag]];
+            sharedKeyPairs[key] = keyPair;
+        }
+        if (pubKeyRef) {
+            CFRelease(pubKeyRef);
+        }
+        if (privKeyRef) {
+            CFRelease(privKeyRef);
+        }
     }
-    else {
-        re = NO;
+    [sharedKeyPairsLock unlock];
+
+    if (!keyPair) {
+        return NO;
     }
-    
-    [self.lock unlock];
-    return re;
+    [self useKeyPair:keyPair pubKeyTag:pubKeyTag privKeyTag:privKeyTag];
+    return YES;
+}
+
+- (BOOL)loadOrGenerateKeyPairWithPubKeyTag:(NSString *)pubKeyTag
+                                privKeyTag:(NSString *)privKeyTag
+                                   keySize:(AylaKeyCryptoRSAKeySize)keySize
+{
+    if(!pubKeyTag || !privKeyTag) {
+        pubKeyTag = defaultKeyExchangeIdentifierRSAPublic;
+        privKeyTag = defaultKeyExchangeIdentifierRSAPrivate;
+    }
+
+    // Holding the shared lock makes a concurrent caller wait for the key pair instead of generating another one.
+    [sharedKeyPairsLock lock];
+    BOOL ready = [self getKeyPairFromKeyChainWithPubKeyTag:pubKeyTag privKeyTag:privKeyTag] ||
+                 [self generateRSAKeyPair:keySize pubKeyTag:pubKeyTag privKeyTag:privKeyTag];
+    [sharedKeyPairsLock unlock];
+    return ready;
 }
 
 - (BOOL)updateRSAKeyPairInKeyChain:(AylaKeyCryptoRSAKeySize)keySize
@@ -92,7 +229,7 @@ static NSString *const defaultKeyExchangeIdentifierRSAPrivate = @"com.aylanetwor
 {
     AYLAssert(![NSThread isMainThread], @"Key pair generation must be off main thread.");
 
-    [self.lock lock];
+    [sharedKeyPairsLock lock];
     
     SecKeyRef publicKey = NULL;
     SecKeyRef privateKey = NULL;
@@ -117,21 +254,20 @@ static NSString *const defaultKeyExchangeIdentifierRSAPrivate = @"com.aylanetwor
 
     OSStatus sanityCheck = SecKeyGeneratePair((__bridge CFDictionaryRef)keyPairAttr, &publicKey, &privateKey);
     if (sanityCheck == noErr) {
-        if (self.pubKeyRef) {
-            CFRelease(self.pubKeyRef);
-        }
-        self.pubKeyRef = publicKey;
-
-        if (self.privKeyRef) {
-            CFRelease(self.privKeyRef);
-        }
-        self.privKeyRef = privateKey;
+        AylaKeyCryptoKeyPair *keyPair =
+            [[AylaKeyCryptoKeyPair alloc] initWithPubKeyRef:publicKey
+                                                 privKeyRef:privateKey
+                                              publicKeyData:[self getKeyInBitsFromKeyChainWithTag:pubKeyTag]];
+        CFRelease(publicKey);
+        CFRelease(privateKey);
+        sharedKeyPairs[[AylaKeyCrypto sharedKeyPairKeyWithPubKeyTag:pubKeyTag privKeyTag:privKeyTag]] = keyPair;
+        [self useKeyPair:keyPair pubKeyTag:pubKeyTag privKeyTag:privKeyTag];
     }
     else {
         AylaLogE([self logTag], 0, @"%@:%d, %@", @"failed", (int)sanityCheck, @"generateRSAKeyPair");
     }
 
-    [self.lock unlock];
+    [sharedKeyPairsLock unlock];
     
     return sanityCheck == noErr;
 }
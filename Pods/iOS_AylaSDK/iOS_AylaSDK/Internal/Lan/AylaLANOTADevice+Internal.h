@@ -0,0 +1,38 @@
+//
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaLANOTADevice.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaHTTPTask;
+@class AylaOTAImageInfo;
+
+@interface AylaLANOTADevice (Internal)
+
+/**
+ * @return Directory which holds the OTA image files of the session, also the document root of the LAN OTA server.
+ */
+- (NSString *)otaDirectory;
+
+/**
+ * @return Path of the image file of this device for the given image.
+ */
+- (NSString *)generateFileNameWithImageInfo:(AylaOTAImageInfo *)info;
+
+/**
+ * @return Path of the image file saved for this device, nil if there is none.
+ */
+- (nullable NSString *)getOTAFilePathIfExist;
+
+/**
+ * Reports the result of the image download of this device to the cloud service.
+ */
+- (nullable AylaHTTPTask *)notifyStatus:(BOOL)status reason:(NSString *)reason;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -6,8 +6,16 @@
 
 #import "HTTPServer.h"
 
+NS_ASSUME_NONNULL_BEGIN
+
 FOUNDATION_EXPORT NSInteger const AylaLANOTAHTTPDefaultServerPort;
 
+/**
+ * Size of the header which prefixes every OTA image file. The header is passed to the device in the push request and
+ * is not part of the image served over HTTP.
+ */
+FOUNDATION_EXPORT NSUInteger const AylaLANOTAImageHeaderSize;
+
 /**
  * Delegate for image pushing status
  */
@@ -20,17 +28,33 @@ FOUNDATION_EXPORT NSInteger const AylaLANOTAHTTPDefaultServerPort;
  */
 - (void)didReceiveImagePushStatus:(NSInteger)status;
 
+@optional
+
+/**
+ * Method to be called each time a chunk of the image has been handed to the connection of the device.
+ *
+ * @param bytesServed    Bytes of the image served by the current request, including the start offset of a range
+ * request.
+ * @param totalBytes     Size of the image.
+ * @param bytesPerSecond Average throughput of the current request.
+ */
+- (void)didServeImageBytes:(UInt64)bytesServed totalBytes:(UInt64)totalBytes bytesPerSecond:(double)bytesPerSecond;
+
 @end
 
 /**
- * HTTP Server for LAN OTA
+ * HTTP Server for LAN OTA.
+ *
+ * A single server serves every device being updated. Devices are told apart by the address their requests come from,
+ * each one is registered with its own delegate. Images are memory mapped and served without copying, and HTTP range
+ * requests are honored so an interrupted transfer can resume where it stopped.
  */
 @interface AylaLANOTAHTTPServer : HTTPServer
 
 /**
- * Delegate for image pushing status
+ * @return The server shared by all LAN OTA devices, listening on `AylaLANOTAHTTPDefaultServerPort`.
  */
-@property (nonatomic, weak) id<AylaLANOTAHTTPServerDelegate> delegate;
++ (instancetype)sharedServer;
 
 /**
  * Initial a HTTP Server with given port number
@@ -41,10 +65,36 @@ FOUNDATION_EXPORT NSInteger const AylaLANOTAHTTPDefaultServerPort;
 - (instancetype)initWithPort:(int)portNum;
 
 /**
- * Get cureent image pushing status
+ * Registers a device and starts the server if it is not running yet.
+ *
+ * @param hostIp       LAN IP of the device.
+ * @param documentRoot Directory which holds the OTA image files.
+ * @param delegate     Delegate receiving push status and throughput of the device. Held weakly.
+ * @param error        A pointer to an `NSError` variable to store an error in case the server can't be started.
+ *
+ * @return YES if the server is running.
+ */
+- (BOOL)startServingHost:(NSString *)hostIp
+            documentRoot:(NSString *)documentRoot
+                delegate:(id<AylaLANOTAHTTPServerDelegate>)delegate
+                   error:(NSError *_Nullable __autoreleasing *_Nullable)error;
+
+/**
+ * Unregisters a device. The server is stopped once no device is registered anymore.
+ *
+ * @param hostIp LAN IP of the device.
+ */
+- (void)stopServingHost:(NSString *)hostIp;
+
+/**
+ * Get the latest image pushing status reported by a device
+ *
+ * @param hostIp LAN IP of the device.
  *
  * @return Image push status
  */
-- (NSNumber *)imagePushStatus;
+- (nullable NSNumber *)imagePushStatusForHost:(NSString *)hostIp;
 
 @end
+
+NS_ASSUME_NONNULL_END
@@ -11,9 +11,22 @@
 #import "AylaSystemUtils.h"
 #import "GCDAsyncSocket.h"
 #import "HTTPConnection.h"
-#import "HTTPFileResponse.h"
 
 NSInteger const AylaLANOTAHTTPDefaultServerPort = 8888;
+NSUInteger const AylaLANOTAImageHeaderSize = 256;
+
+@interface AylaLANOTAHTTPServer ()
+
+@property (nonatomic, strong) NSMapTable<NSString *, id<AylaLANOTAHTTPServerDelegate>> *delegates;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *imagePushStatuses;
+
+- (void)host:(NSString *)hostIp didReceiveImagePushStatus:(NSNumber *)status;
+- (void)host:(NSString *)hostIp
+    didServeImageBytes:(UInt64)bytesServed
+            totalBytes:(UInt64)totalBytes
+        bytesPerSecond:(double)bytesPerSecond;
+
+@end
 
 @interface AylaLANOTAPUTResponse : NSObject<HTTPResponse>
 @property (nonatomic, readwrite) NSInteger status;
@@ -42,19 +55,106 @@ NSInteger const AylaLANOTAHTTPDefaultServerPort = 8888;
 }
 @end
 
-@interface AylaLANOTAGETResponse : HTTPFileResponse
+/**
+ * Serves an OTA image, without its header, from a memory mapped file. Chunks handed to the connection point straight
+ * into the mapping and keep it alive until the socket has written them.
+ */
+@interface AylaLANOTAGETResponse : NSObject<HTTPResponse>
+
+- (nullable instancetype)initWithFilePath:(NSString *)filePath
+                                   hostIp:(NSString *)hostIp
+                                   server:(AylaLANOTAHTTPServer *)server;
+
 @end
 
-@implementation AylaLANOTAGETResponse
+@implementation AylaLANOTAGETResponse {
+    NSData *_image;
+    NSString *_hostIp;
+    __weak AylaLANOTAHTTPServer *_server;
+    UInt64 _offset;
+    UInt64 _startOffset;
+    CFAbsoluteTime _startTime;
+}
 
-- (UInt64)offset
+- (instancetype)initWithFilePath:(NSString *)filePath hostIp:(NSString *)hostIp server:(AylaLANOTAHTTPServer *)server
 {
-    return self->fileOffset + 256;
+    self = [super init];
+    if (!self) return nil;
+
+    NSError *error;
+    _image = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedAlways error:&error];
+    if (_image.length < AylaLANOTAImageHeaderSize) {
+        AylaLogE(@"httpLANOTAServer", 0, @"invalidImage:%@, err:%@", filePath, error);
+        return nil;
+    }
+    _hostIp = hostIp;
+    _server = server;
+    _startTime = CFAbsoluteTimeGetCurrent();
+
+    return self;
 }
 
 - (UInt64)contentLength
 {
-    return self->fileLength - 256;
+    return _image.length - AylaLANOTAImageHeaderSize;
+}
+
+- (UInt64)offset
+{
+    return _offset;
+}
+
+- (void)setOffset:(UInt64)offset
+{
+    _offset = MIN(offset, [self contentLength]);
+    _startOffset = _offset;
+}
+
+- (NSData *)readDataOfLength:(NSUInteger)length
+{
+    UInt64 available = [self contentLength] - _offset;
+    NSUInteger chunkLength = (NSUInteger)MIN((UInt64)length, available);
+    if (chunkLength == 0) {
+        return nil;
+    }
+
+    NSData *image = _image;
+    void *bytes = (uint8_t *)image.bytes + AylaLANOTAImageHeaderSize + _offset;
+    NSData *chunk = [[NSData alloc] initWithBytesNoCopy:bytes
+                                                 length:chunkLength
+                                            deallocator:^(void *chunkBytes, NSUInteger mappedLength) {
+                                                // Holds on to the mapping until the chunk is released
+                                                [image length];
+                                            }];
+    _offset += chunkLength;
+
+    CFTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - _startTime;
+    double bytesPerSecond = elapsed > 0 ? (_offset - _startOffset) / elapsed : 0;
+    [_server host:_hostIp didServeImageBytes:_offset totalBytes:[self contentLength] bytesPerSecond:bytesPerSecond];
+    return chunk;
+}
+
+- (BOOL)isDone
+{
+    return _offset >= [self contentLength];
+}
+
+- (NSDictionary *)httpHeaders
+{
+    return @{ @"Accept-Ranges" : @"bytes" };
+}
+
+- (void)connectionDidClose
+{
+    CFTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - _startTime;
+    AylaLogI(@"httpLANOTAServer",
+             0,
+             @"host:%@, served:%llu-%llu/%llu, %.3fs",
+             _hostIp,
+             _startOffset,
+             _offset,
+             [self contentLength],
+             elapsed);
 }
 
 @end
@@ -64,19 +164,25 @@ NSInteger const AylaLANOTAHTTPDefaultServerPort = 8888;
 @property (weak, nonatomic) AylaLANOTAHTTPServer *lanOTAServer;
 @end
 
-@interface AylaLANOTAHTTPServer ()
-
-@property (strong, nonatomic) NSNumber *imagePushStatus;
-@end
-
 @implementation AylaLANOTAHTTPServer
 static AylaLANOTAHTTPServer *_sharedInstance = nil;
 
++ (instancetype)sharedServer
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _sharedInstance = [[AylaLANOTAHTTPServer alloc] initWithPort:(int)AylaLANOTAHTTPDefaultServerPort];
+    });
+    return _sharedInstance;
+}
+
 - (instancetype)initWithPort:(int)portNum
 {
     self = [super init];
     if (self) {
         [self setPort:portNum];
+        _delegates = [NSMapTable strongToWeakObjectsMapTable];
+        _imagePushStatuses = [NSMutableDictionary dictionary];
     }
     return self;
 }
@@ -88,10 +194,74 @@ static AylaLANOTAHTTPServer *_sharedInstance = nil;
     return [super start:errPtr];
 }
 
-- (void)setImagePushStatus:(NSNumber *)imagePushStatus
+- (BOOL)startServingHost:(NSString *)hostIp
+            documentRoot:(NSString *)documentRoot
+                delegate:(id<AylaLANOTAHTTPServerDelegate>)delegate
+                   error:(NSError *__autoreleasing _Nullable *)error
 {
-    _imagePushStatus = imagePushStatus;
-    [self.delegate didReceiveImagePushStatus:imagePushStatus.integerValue];
+    @synchronized(self) {
+        [self.delegates setObject:delegate forKey:hostIp];
+        [self.imagePushStatuses removeObjectForKey:hostIp];
+
+        if (self.isRunning) {
+            return YES;
+        }
+        self.documentRoot = documentRoot;
+        NSError *startError = nil;
+        BOOL started = [self start:&startError];
+        if (!started) {
+            [self.delegates removeObjectForKey:hostIp];
+            if (error) {
+                *error = startError;
+            }
+        }
+        return started;
+    }
+}
+
+- (void)stopServingHost:(NSString *)hostIp
+{
+    @synchronized(self) {
+        [self.delegates removeObjectForKey:hostIp];
+
+        // Released delegates are only purged from the map table when it is enumerated
+        if ([[self.delegates objectEnumerator] allObjects].count == 0) {
+            [self stop];
+        }
+    }
+}
+
+- (NSNumber *)imagePushStatusForHost:(NSString *)hostIp
+{
+    @synchronized(self) {
+        return self.imagePushStatuses[hostIp];
+    }
+}
+
+- (id<AylaLANOTAHTTPServerDelegate>)delegateForHost:(NSString *)hostIp
+{
+    @synchronized(self) {
+        return [self.delegates objectForKey:hostIp];
+    }
+}
+
+- (void)host:(NSString *)hostIp didReceiveImagePushStatus:(NSNumber *)status
+{
+    @synchronized(self) {
+        self.imagePushStatuses[hostIp] = status;
+    }
+    [[self delegateForHost:hostIp] didReceiveImagePushStatus:status.integerValue];
+}
+
+- (void)host:(NSString *)hostIp
+    didServeImageBytes:(UInt64)bytesServed
+            totalBytes:(UInt64)totalBytes
+        bytesPerSecond:(double)bytesPerSecond
+{
+    id<AylaLANOTAHTTPServerDelegate> delegate = [self delegateForHost:hostIp];
+    if ([delegate respondsToSelector:@selector(didServeImageBytes:totalBytes:bytesPerSecond:)]) {
+        [delegate didServeImageBytes:bytesServed totalBytes:totalBytes bytesPerSecond:bytesPerSecond];
+    }
 }
 
 @end
@@ -121,7 +291,7 @@ static AylaLANOTAHTTPServer *_sharedInstance = nil;
 - (NSObject<HTTPResponse> *)httpResponseForMethod:(NSString *)method URI:(NSString *)path
 {
     // Print out url for each incoming request - DEBUG level only
-    AylaLogD(@"httpLANOTAServer", 0, @"%@, %@:%@", method, @"url", path);
+    AylaLogD(@"httpLANOTAServer", 0, @"%@, %@:%@, %@", method, @"url", path, self.hostIp);
     if ([method isEqualToString:@"PUT"]) {
         NSURL *url = [NSURL URLWithString:path];
         NSArray *query = [[url query] componentsSeparatedByString:@"&"];
@@ -135,7 +305,10 @@ static AylaLANOTAHTTPServer *_sharedInstance = nil;
 
         NSNumberFormatter *formatter = [[NSNumberFormatter alloc] init];
         formatter.numberStyle = NSNumberFormatterDecimalStyle;
-        self.lanOTAServer.imagePushStatus = [formatter numberFromString:[parameters objectForKey:@"status"]];
+        NSNumber *status = [formatter numberFromString:[[parameters objectForKey:@"status"] nilIfNull]];
+        if (status) {
+            [self.lanOTAServer host:self.hostIp didReceiveImagePushStatus:status];
+        }
 
         NSInteger statusCode = 200;
         AylaLANOTAPUTResponse *response = [[AylaLANOTAPUTResponse alloc] init];
@@ -148,12 +321,14 @@ static AylaLANOTAHTTPServer *_sharedInstance = nil;
         BOOL isDir = NO;
 
         if (filePath && [[NSFileManager defaultManager] fileExistsAtPath:filePath isDirectory:&isDir] && !isDir) {
-            AylaLANOTAGETResponse *response = [[AylaLANOTAGETResponse alloc] initWithFilePath:filePath forConnection:self];
-            [response setOffset:256];  // stripping the first 256 bytes
-            return response;
+            AylaLANOTAGETResponse *response =
+                [[AylaLANOTAGETResponse alloc] initWithFilePath:filePath hostIp:self.hostIp server:self.lanOTAServer];
+            if (response) {
+                return response;
+            }
         }
     }
 
     return [super httpResponseForMethod:method URI:path];
 }
-@end
\ No newline at end of file
+@end
@@ -58,6 +58,15 @@ typedef void (^CallbackBlock)(AylaLanCommand *command, id _Nullable responseObje
 /** Command identifier */
 @property (nonatomic, nullable) NSString *identifier;
 
+/** Time the command has been sent to the device at, 0 if it has not been sent yet */
+@property (nonatomic) CFAbsoluteTime sentTime;
+
+/** Time the command has been created at */
+@property (nonatomic, readonly) CFAbsoluteTime createdTime;
+
+/** Id of the trace of the operation the command was created for, see `AylaTracer` */
+@property (nonatomic, copy, nullable) NSString *traceId;
+
 /**
  * Init method
  */
@@ -6,6 +6,7 @@
 
 #import "AylaLanCommand.h"
 #import "AylaProperty+Internal.h"
+#import "AylaTracer.h"
 
 @interface AylaLanCommand ()
 
@@ -25,6 +26,8 @@ static long __nextLanCommandId = 1;
     _type = type;
     _commandInJson = jsonObject;
     _cmdId = __nextLanCommandId++;
+    _createdTime = CFAbsoluteTimeGetCurrent();
+    _traceId = [AylaTracer currentTraceId];
 
     return self;
 }
@@ -177,6 +177,12 @@ typedef NS_ENUM(NSInteger, AylaLanSessionType) {
 - (nullable AylaConnectTask *)fetchLanConfig:(void (^)(AylaLanConfig *_Nullable lanConfig))successBlock
                                      failure:(void (^)(NSError *_Nonnull error))failureBlock;
 
+/**
+ * @return Duration of the first key negotiation completed by any lan module since launch, from the negotiation
+ * request to the decryption of the key sent by the module. 0 if no negotiation has completed yet.
+ */
++ (NSTimeInterval)firstKeyNegotiationDuration;
+
 @end
 
 NS_ASSUME_NONNULL_END
\ No newline at end of file
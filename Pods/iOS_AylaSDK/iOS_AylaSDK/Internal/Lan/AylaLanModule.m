@@ -19,10 +19,13 @@
 #import "AylaLanModule.h"
 #import "AylaLanTask.h"
 #import "AylaLogManager.h"
+#import "AylaMetrics.h"
 #import "AylaNetworks+Internal.h"
 #import "AylaObject+Internal.h"
+#import "AylaProfiler.h"
 #import "AylaSessionManager+Internal.h"
 #import "AylaSystemUtils.h"
+#import "AylaTracer.h"
 #import "NSData+Base64.h"
 
 /** Default adjustment to lan session poll interval */
@@ -63,6 +66,22 @@ static NSError *composeLanSessionError(AylaLanErrorCode code, NSError *origErr,
                         addOnDescription:decrip];
 }
 
+/**
+ * @return Name a lan command is recorded under in the shared metrics.
+ */
+static NSString *metricNameOfCommand(AylaLanCommand *command) {
+  switch (command.type) {
+  case AylaLanCommandTypeCommand:
+    return @"command";
+  case AylaLanCommandTypeProperty:
+    return @"property";
+  case AylaLanCommandTypeNodeProperty:
+    return @"nodeProperty";
+  default:
+    return @"unknown";
+  }
+}
+
 @interface AylaLanModule () <AylaHTTPServerResponder>
 
 @property(nonatomic) AylaTimer *sessionTimer;
@@ -71,6 +90,12 @@ static NSError *composeLanSessionError(AylaLanErrorCode code, NSError *origErr,
 
 @property(nonatomic) AylaKeyCrypto *keyCrypto;
 
+/** Time the current key negotiation started, 0 if none is in progress */
+@property(nonatomic) CFAbsoluteTime keyNegotiationStartTime;
+
+/** Time the session being opened was opened, 0 if none is being opened */
+@property(nonatomic) CFAbsoluteTime sessionOpenTime;
+
 @property(nonatomic) NSError *lastestError;
 
 @property(nonatomic) AylaHTTPServer *httpServer;
@@ -168,6 +193,7 @@ static NSError *composeLanSessionError(AylaLanErrorCode code, NSError *origErr,
       self.sessionState == AylaLanSessionStateError ||
       self.sessionState == AylaLanSessionStateDisabled) {
     [self setSessionState:AylaLanSessionStateOpening object:nil error:nil];
+    self.sessionOpenTime = CFAbsoluteTimeGetCurrent();
     // Clean all pending task before openning a new session.
     [self cleanPendingTasks];
 
@@ -206,10 +232,20 @@ static NSError *composeLanSessionError(AylaLanErrorCode code, NSError *origErr,
       }
     };
 
+    AylaLanConfig *knownConfig = self.config ?: [self cachedLanConfig];
+
     // Fetch lan config will be skipped if lan module is opening a setup sesion
     if (self.sessionType == AylaLanSessionTypeSetup) {
       continueBlock(self.config);
       // Skip fetch lan config
+    } else if (knownConfig) {
+      // Open the session right away with the known config and revalidate it
+      // in the background. The session is only re-keyed if the lan ip key
+      // changed on cloud.
+      self.config = knownConfig;
+      [self refreshSessionTimerWithConfig:knownConfig];
+      continueBlock(knownConfig);
+      [self revalidateLanConfigWithKeyId:knownConfig.lanipKeyId];
     } else {
       // Attempt to refresh lan config
       [self fetchLanConfig:^(AylaLanConfig *_Nullable lanConfig) {
@@ -419,6 +455,19 @@ static NSError *composeLanSessionError(AylaLanErrorCode code, NSError *origErr,
     AylaLogD([self logTag], 0, @"session active:%@, %@", self.device.dsn,
              @"setSessionState");
     _sessionState = state;
+    if (self.sessionOpenTime != 0) {
+      [[AylaProfiler sharedInstance]
+          didEstablishLANSessionWithDsn:self.device.dsn
+                               duration:CFAbsoluteTimeGetCurrent() -
+                                        self.sessionOpenTime];
+      [[AylaTracer sharedTracer]
+          recordSpanWithName:@"lan.session.establish"
+                    category:@"lan"
+                     traceId:nil
+                   startTime:self.sessionOpenTime
+                     details:@{ @"dsn" : self.device.dsn ?: @"" }];
+      self.sessionOpenTime = 0;
+    }
     [self.delegate lanModule:self didEastablishSessionOnLanIp:self.lanIp];
   } else if (error) {
     _sessionState = state;
@@ -474,26 +523,7 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
           if (config &&
               lanipKeyId.integerValue != config.lanipKeyId.integerValue) {
             self.config = config;
-            // Get new refresh time and update timer
-            // Adjust refresh time interval with a value set in
-            // DEFAULT_ADJUST_TO_CONFIG_POLL_INTERVAL
-            // TODO: Maybe an adjust to gurantee the interval value will greater
-            // than 0
-            NSTimeInterval interval = config.keepAlive.doubleValue * 1000 -
-                                      DEFAULT_ADJUST_TO_CONFIG_POLL_INTERVAL_MS;
-
-            __weak __block typeof(self) weakSelf = self;
-            [self.sessionTimer refreshWithTimeInterval:interval
-                                                leeway:DEFAULT_POLL_LEEWAY_MS
-                                           handleBlock:^(AylaTimer *timer) {
-                                             __strong typeof(weakSelf)
-                                                 strongSelf = weakSelf;
-                                             if (strongSelf) {
-                                               [strongSelf timerFired:timer];
-                                             } else {
-                                               [timer stopPolling];
-                                             }
-                                           }];
+            [self refreshSessionTimerWithConfig:config];
             [self.device.sessionManager.aylaCache save:AylaCacheTypeLANConfig
                                               uniqueId:self.device.dsn
                                              andObject:config];
@@ -505,16 +535,17 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
             self.config = nil;
           }
         } else {
+          // No lan config on cloud, drop the known one
           AylaLogW([self logTag], 0, @"%@, %@", @"emptyOnCloud", @"fetch");
+          self.config = nil;
         }
         successBlock(config);
       }
       failure:^(AylaHTTPTask *_Nonnull task, NSError *_Nonnull error) {
-        if ([self.device.sessionManager.aylaCache
-                cachingEnabled:AylaCacheTypeLANConfig]) {
-          AylaLanConfig *lanConfig = [self.device.sessionManager.aylaCache
-               getData:AylaCacheTypeLANConfig
-              uniqueId:self.device.dsn];
+        // The cloud did not answer, which says nothing about the config. Fall
+        // back to the cached one if any, and leave the known one otherwise.
+        AylaLanConfig *lanConfig = [self cachedLanConfig];
+        if (lanConfig) {
           self.config = lanConfig;
           successBlock(lanConfig);
           return;
@@ -523,6 +554,87 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
       }];
 }
 
+/**
+ * @return The lan config saved in cache for current device, nil if there is
+ * none or lan config caching is disabled.
+ */
+- (nullable AylaLanConfig *)cachedLanConfig {
+  AylaCache *cache = self.device.sessionManager.aylaCache;
+  if (![cache cachingEnabled:AylaCacheTypeLANConfig]) {
+    return nil;
+  }
+  return [cache getData:AylaCacheTypeLANConfig uniqueId:self.device.dsn];
+}
+
+/**
+ * Updates the session timer with the keep alive interval of a lan config.
+ */
+- (void)refreshSessionTimerWithConfig:(AylaLanConfig *)config {
+  // Adjust refresh time interval with a value set in
+  // DEFAULT_ADJUST_TO_CONFIG_POLL_INTERVAL
+  // TODO: Maybe an adjust to gurantee the interval value will greater
+  // than 0
+  NSTimeInterval interval = config.keepAlive.doubleValue * 1000 -
+                            DEFAULT_ADJUST_TO_CONFIG_POLL_INTERVAL_MS;
+
+  __weak __block typeof(self) weakSelf = self;
+  [self.sessionTimer refreshWithTimeInterval:interval
+                                      leeway:DEFAULT_POLL_LEEWAY_MS
+                                 handleBlock:^(AylaTimer *timer) {
+                                   __strong typeof(weakSelf) strongSelf =
+                                       weakSelf;
+                                   if (strongSelf) {
+                                     [strongSelf timerFired:timer];
+                                   } else {
+                                     [timer stopPolling];
+                                   }
+                                 }];
+}
+
+/**
+ * Fetches the lan config from cloud while a session is opened with a known
+ * config. If the lan ip key has changed, the session is re-keyed with the
+ * refreshed config.
+ *
+ * @param keyId Lan ip key id of the config the session has been opened with.
+ */
+- (void)revalidateLanConfigWithKeyId:(NSNumber *)keyId {
+  [self fetchLanConfig:^(AylaLanConfig *_Nullable lanConfig) {
+    if (self.sessionState == AylaLanSessionStateDisabled) {
+      return;
+    }
+    if (!lanConfig) {
+      // The cloud answered with no config and fetchLanConfig: has dropped the
+      // known one. Stop the session as a cold open would.
+      AylaLogW([self logTag], 0, @"%@, %@, %@", self.device.dsn,
+               @"emptyOnCloud", @"revalidateLanConfig");
+      [self setSessionState:AylaLanSessionStateError
+                     object:nil
+                      error:composeLanSessionError(AylaLanErrorCodeEmptyConfig,
+                                                   nil,
+                                                   @"Empty config on cloud.",
+                                                   YES)];
+      return;
+    }
+    if (lanConfig.lanipKeyId.integerValue == keyId.integerValue) {
+      return;
+    }
+
+    AylaLogI([self logTag], 0, @"%@, lanipKeyId:%@->%@, %@", self.device.dsn,
+             keyId, lanConfig.lanipKeyId, @"revalidateLanConfig");
+    // Start a new key exchange with the refreshed config
+    [self setSessionState:AylaLanSessionStateOpening object:nil error:nil];
+    self.sessionOpenTime = CFAbsoluteTimeGetCurrent();
+    [self sendExtensionMessageWithCompletionBlock:nil];
+  }
+      failure:^(NSError *_Nonnull error) {
+        // The cloud is unreachable and no config is cached, keep the session
+        // on the known config until the cloud can be asked again
+        AylaLogW([self logTag], 0, @"%@, err:%@, %@", self.device.dsn, error,
+                 @"revalidateLanConfig");
+      }];
+}
+
 /**
  * A method which would be called when session timer got fired.
  */
@@ -578,6 +690,25 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
     // Remove this command
     self.responseWaitingCommands[cmdIdInString] = nil;
 
+    NSString *metricName = metricNameOfCommand(pendingCommand);
+    if (pendingCommand.sentTime > 0) {
+      [[AylaMetrics sharedMetrics]
+              recordDuration:CFAbsoluteTimeGetCurrent() - pendingCommand.sentTime
+                forHistogram:[@"lan.latency." stringByAppendingString:metricName]];
+    }
+    if (pendingCommand.traceId) {
+      [[AylaTracer sharedTracer]
+          recordSpanWithName:[@"lan.response." stringByAppendingString:metricName]
+                    category:@"lan"
+                     traceId:pendingCommand.traceId
+                   startTime:pendingCommand.sentTime
+                     details:@{ @"status" : @(message.status) }];
+    }
+    if (message.status >= 400 || message.error) {
+      [[AylaMetrics sharedMetrics]
+          incrementCounter:[@"lan.failures." stringByAppendingString:metricName]];
+    }
+
     if (pendingCommand.callbackBlock) {
       // If we find pending commands for current message, we update that command
       // with data received in lan
@@ -639,6 +770,20 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
     if (command.processingBlock) {
       command.processingBlock(command, YES);
     }
+    command.sentTime = CFAbsoluteTimeGetCurrent();
+    [[AylaMetrics sharedMetrics]
+        incrementCounter:[@"lan.commands."
+                             stringByAppendingString:metricNameOfCommand(command)]];
+    if (command.traceId) {
+      // Time spent in the command queue, waiting for the device to poll
+      [[AylaTracer sharedTracer]
+          recordSpanWithName:[@"lan.queue."
+                                 stringByAppendingString:metricNameOfCommand(command)]
+                    category:@"lan"
+                     traceId:command.traceId
+                   startTime:command.createdTime
+                     details:@{ @"dsn" : self.device.dsn ?: @"" }];
+    }
 
     // If command needs response from module
     if (command.needsWaitResponse) {
@@ -670,6 +815,8 @@ fetchLanConfig:(void (^)(AylaLanConfig *_Nonnull lanConfig))successBlock
       initWithHttpStatusCode:httpStatusCode
                 headerFields:[AylaHTTPServerResponse JSONContentHeaderField]
                     bodyData:data];
+  [[AylaMetrics sharedMetrics] incrementCounter:AylaMetricsLanBytesSent
+                                             by:data.length];
 
   return resp;
 }
@@ -810,6 +957,7 @@ static const int DEFAULT_LAN_TOKEN_LEN = 16;
       if (keyInData) {
         encrypConfig.type = AylaEncryptionTypeWifiSetup;
         encrypConfig.data = keyInData;
+        [self keyNegotiationDidComplete];
       } else {
         // an error happened
         return keyExchangeErrorResponseBlock(
@@ -868,6 +1016,8 @@ static const int DEFAULT_LAN_TOKEN_LEN = 16;
 //-----------------------------------------------------------
 - (AylaHTTPServerResponse *)httpServer:(AylaHTTPServer *)server
                      didReceiveRequest:(AylaHTTPServerRequest *)request {
+  [[AylaMetrics sharedMetrics] incrementCounter:AylaMetricsLanBytesReceived
+                                             by:request.bodyData.length];
   NSError *error;
   AylaLanMessage *message =
       [self.messageCreator messageFromHTTPServerRequest:request
@@ -959,31 +1109,37 @@ static const int DEFAULT_LAN_TOKEN_LEN = 16;
     return;
   }
 
+  if (self.keyNegotiationStartTime == 0) {
+    self.keyNegotiationStartTime = CFAbsoluteTimeGetCurrent();
+  }
+
   // Switch to a different thread to handle the key checks
   dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
-    if (![self.keyCrypto getKeyPairFromKeyChainWithPubKeyTag:pubKeyTag
-                                                  privKeyTag:privKeyTag]) {
-      // Key Negoitation will take some time if key generation is required.
-      self.keyCrypto.pubKeyTag = pubKeyTag;
-      self.keyCrypto.privKeyTag = privKeyTag;
-
-      int keySize = self.config.keySizeOfKeysInKeyPair
-                        ? [self.config.keySizeOfKeysInKeyPair intValue]
-                        : DEFAULT_KEY_SIZE_OF_KEYS_IN_KEY_NEGOTIATION;
-      if (![self.keyCrypto updateRSAKeyPairInKeyChain:keySize]) {
-        NSError *error = [AylaErrorUtils
-             errorWithDomain:AylaLanErrorDomain
-                        code:AylaLanErrorCodeKeyGenerationFailure
-                    userInfo:@{
-                      AylaLanErrorResponseJsonKey :
-                          @{@"key_nego" : @"Unable to create a new key pair."}
-                    }
-                   shouldLog:YES
-                      logTag:[self logTag]
-            addOnDescription:@"startKeyNegotiation"];
-        [self setSessionState:AylaLanSessionStateError object:nil error:error];
-        return;
-      }
+    // The key pair is usually in memory already, preloaded at SDK init.
+    // Key Negoitation will take some time if key generation is required.
+    int keySize = self.config.keySizeOfKeysInKeyPair
+                      ? [self.config.keySizeOfKeysInKeyPair intValue]
+                      : DEFAULT_KEY_SIZE_OF_KEYS_IN_KEY_NEGOTIATION;
+    CFAbsoluteTime keyPairStart = CFAbsoluteTimeGetCurrent();
+    BOOL keyPairReady =
+        [self.keyCrypto loadOrGenerateKeyPairWithPubKeyTag:pubKeyTag
+                                                privKeyTag:privKeyTag
+                                                   keySize:keySize];
+    AylaLogD([self logTag], 0, @"keyPair:%.3fs, %@",
+             CFAbsoluteTimeGetCurrent() - keyPairStart, @"startKeyNegotiation");
+    if (!keyPairReady) {
+      NSError *error = [AylaErrorUtils
+           errorWithDomain:AylaLanErrorDomain
+                      code:AylaLanErrorCodeKeyGenerationFailure
+                  userInfo:@{
+                    AylaLanErrorResponseJsonKey :
+                        @{@"key_nego" : @"Unable to create a new key pair."}
+                  }
+                 shouldLog:YES
+                    logTag:[self logTag]
+          addOnDescription:@"startKeyNegotiation"];
+      [self setSessionState:AylaLanSessionStateError object:nil error:error];
+      return;
     }
 
     // Key pair should be ready in keyCrypto
@@ -1013,6 +1169,35 @@ static const int DEFAULT_LAN_TOKEN_LEN = 16;
   });
 }
 
+static NSTimeInterval firstKeyNegotiationDuration = 0;
+
++ (NSTimeInterval)firstKeyNegotiationDuration {
+  @synchronized([AylaLanModule class]) {
+    return firstKeyNegotiationDuration;
+  }
+}
+
+/**
+ * Records how long the key negotiation of this session took, from the first
+ * negotiation request to the decryption of the key sent by the module.
+ */
+- (void)keyNegotiationDidComplete {
+  if (self.keyNegotiationStartTime == 0) {
+    return;
+  }
+  NSTimeInterval duration =
+      CFAbsoluteTimeGetCurrent() - self.keyNegotiationStartTime;
+  self.keyNegotiationStartTime = 0;
+
+  @synchronized([AylaLanModule class]) {
+    if (firstKeyNegotiationDuration == 0) {
+      firstKeyNegotiationDuration = duration;
+    }
+  }
+  AylaLogI([self logTag], 0, @"duration:%.3fs, %@", duration,
+           @"keyNegotiationDidComplete");
+}
+
 //-----------------------------------------------------------
 #pragma mark - Helpful
 //-----------------------------------------------------------
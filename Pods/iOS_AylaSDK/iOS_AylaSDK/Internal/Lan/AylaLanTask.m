@@ -13,6 +13,7 @@
 #import "AylaLanModule.h"
 #import "AylaLanTask.h"
 #import "AylaTimer.h"
+#import "AylaTracer.h"
 
 static dispatch_queue_t lan_task_processing_queue()
 {
@@ -46,6 +47,8 @@ typedef void (^FailureBlock)(NSError *_Nonnull error);
 
 @property (nonatomic) NSUInteger timeoutInterval;
 
+@property (nonatomic) CFAbsoluteTime startTime;
+
 @end
 
 @implementation AylaLanTask
@@ -117,6 +120,14 @@ typedef void (^FailureBlock)(NSError *_Nonnull error);
             self.isCallbackInvoked = YES;
             self.finished = YES;
 
+            if (self.traceId) {
+                [[AylaTracer sharedTracer] recordSpanWithName:@"lan.task"
+                                                     category:@"lan"
+                                                      traceId:self.traceId
+                                                    startTime:self.startTime
+                                                      details:error ? @{ @"error" : @(error.code) } : nil];
+            }
+
             if (!error) {
                 // Call success block
                 self.successBlock(response);
@@ -157,6 +168,7 @@ typedef void (^FailureBlock)(NSError *_Nonnull error);
     }
 
     [self setupCommands];
+    self.startTime = CFAbsoluteTimeGetCurrent();
     [self.timer startPollingWithDelay:YES];
     [module addTask:self];
 
@@ -14,6 +14,7 @@
 @property (nonatomic, readwrite) BOOL cancelled;
 @property (nonatomic, readwrite) BOOL executing;
 @property (nonatomic, readwrite) BOOL finished;
+@property (nonatomic, copy, readwrite) NSString *traceId;
 
 /**
  * Use this method to let a task retain itself.
@@ -0,0 +1,46 @@
+//
+//  AylaConnectionPrewarmer.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaHTTPClient;
+@class AylaSystemSettings;
+
+/**
+ * Resolves the hosts of cloud services and opens a connection to them ahead of the first real request, so DNS, TCP
+ * and TLS setup overlap with other work instead of delaying it. Hosts are pre-warmed in parallel, and the time taken by
+ * each phase is reported through `AylaProfiler`.
+ */
+@interface AylaConnectionPrewarmer : NSObject
+
+/**
+ * @return Shared instance of the prewarmer
+ */
++ (instancetype)sharedPrewarmer;
+
+/**
+ * Pre-warms the base urls of the given clients through the clients themselves, which leaves an open connection in the
+ * connection pool of each of them.
+ *
+ * @param clients Clients to pre-warm.
+ */
+- (void)prewarmClients:(NSArray<AylaHTTPClient *> *)clients;
+
+/**
+ * Pre-warms the device and user services, and the stream services if DSS is allowed, of the given settings. The
+ * connections opened here are not pooled with the ones of session clients, but resolved hosts and TLS sessions are
+ * reused by them.
+ *
+ * @param settings Settings the service urls are composed from.
+ */
+- (void)prewarmServicesWithSettings:(AylaSystemSettings *)settings;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,167 @@
+//
+//  AylaConnectionPrewarmer.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <netdb.h>
+
+#import "AylaConnectionPrewarmer.h"
+#import "AylaDefines_Internal.h"
+#import "AylaHTTPClient.h"
+#import "AylaHTTPError.h"
+#import "AylaHTTPTask.h"
+#import "AylaProfiler.h"
+#import "AylaSystemSettings.h"
+#import "AylaSystemUtils.h"
+
+/** Prewarmer queue label */
+static char *const AylaConnectionPrewarmerQueueLabel = "com.aylanetworks.prewarmer.queue.processing";
+
+/** Time during which a host is not pre-warmed again through the same client, in seconds */
+static const NSTimeInterval AylaConnectionPrewarmerMinimumInterval = 30;
+
+/** Timeout of pre-warm requests, in seconds */
+static const NSTimeInterval AylaConnectionPrewarmerRequestTimeout = 10;
+
+static NSString *const AylaConnectionPrewarmerTag = @"Prewarmer";
+
+@interface AylaConnectionPrewarmer ()
+
+@property (nonatomic, strong) dispatch_queue_t processingQueue;
+
+/** Dates hosts were last pre-warmed at, keyed by client and host */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDate *> *prewarmDates;
+
+/** Client the services of settings are pre-warmed through */
+@property (nonatomic, strong) AylaHTTPClient *httpClient;
+
+@end
+
+@implementation AylaConnectionPrewarmer
+
++ (instancetype)sharedPrewarmer
+{
+    static AylaConnectionPrewarmer *sharedPrewarmer = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPrewarmer = [[self alloc] init];
+    });
+    return sharedPrewarmer;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _processingQueue = dispatch_queue_create(AylaConnectionPrewarmerQueueLabel, DISPATCH_QUEUE_SERIAL);
+    _prewarmDates = [NSMutableDictionary dictionary];
+    _httpClient = [[AylaHTTPClient alloc] initWithBaseUrl:nil];
+
+    return self;
+}
+
+- (void)prewarmClients:(NSArray<AylaHTTPClient *> *)clients
+{
+    for (AylaHTTPClient *client in clients) {
+        if (client.baseURL) {
+            [self prewarmURL:client.baseURL usingClient:client];
+        }
+    }
+}
+
+- (void)prewarmServicesWithSettings:(AylaSystemSettings *)settings
+{
+    NSMutableArray<NSString *> *urls = [NSMutableArray array];
+    [urls addObject:[AylaSystemUtils deviceServiceBaseUrl:settings isSecure:YES]];
+    [urls addObject:[AylaSystemUtils userServiceBaseUrl:settings isSecure:YES]];
+    if (settings.allowDSS) {
+        [urls addObject:[AylaSystemUtils streamServiceBaseUrl:settings isSecure:YES]];
+        [urls addObject:[AylaSystemUtils mdssSubscriptionServiceBaseUrl:settings isSecure:YES]];
+    }
+
+    for (NSString *url in urls) {
+        NSURL *baseURL = [NSURL URLWithString:url];
+        if (baseURL) {
+            [self prewarmURL:baseURL usingClient:self.httpClient];
+        }
+    }
+}
+
+- (void)prewarmURL:(NSURL *)url usingClient:(AylaHTTPClient *)client
+{
+    NSString *host = url.host;
+    if (host.length == 0) {
+        return;
+    }
+
+    dispatch_async(self.processingQueue, ^{
+        NSString *key = [NSString stringWithFormat:@"%p/%@", client, host];
+        NSDate *lastPrewarmDate = self.prewarmDates[key];
+        if (lastPrewarmDate && -[lastPrewarmDate timeIntervalSinceNow] < AylaConnectionPrewarmerMinimumInterval) {
+            return;
+        }
+        self.prewarmDates[key] = [NSDate date];
+
+        // Hosts are pre-warmed in parallel, the resolution blocks its thread
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self resolveHost:host];
+            [self connectToURL:url host:host usingClient:client];
+        });
+    });
+}
+
+- (void)resolveHost:(NSString *)host
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *result = NULL;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    int status = getaddrinfo(host.UTF8String, NULL, &hints, &result);
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    if (result) {
+        freeaddrinfo(result);
+    }
+
+    if (status != 0) {
+        AylaLogD(AylaConnectionPrewarmerTag, 0, @"failed to resolve %@: %s", host, gai_strerror(status));
+        return;
+    }
+    [[AylaProfiler sharedInstance] didCompleteSessionPhase:AylaProfilerPhasePrewarmDNS host:host duration:duration];
+}
+
+- (void)connectToURL:(NSURL *)url host:(NSString *)host usingClient:(AylaHTTPClient *)client
+{
+    // Paths are appended to the base url of the client
+    NSString *path = client.baseURL ? @"" : url.absoluteString;
+    NSMutableURLRequest *request = [client requestWithMethod:AylaHTTPRequestMethodHEAD path:path parameters:nil];
+    request.timeoutInterval = AylaConnectionPrewarmerRequestTimeout;
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    void (^completion)(NSError *) = ^(NSError *error) {
+        // Any response, whatever its status, means the connection has been established
+        if (error && error.code != AylaHTTPErrorCodeInvalidResponse) {
+            AylaLogD(AylaConnectionPrewarmerTag, 0, @"failed to pre-warm %@: %ld", host, (long)error.code);
+            return;
+        }
+        [[AylaProfiler sharedInstance] didCompleteSessionPhase:AylaProfilerPhasePrewarmConnect
+                                                          host:host
+                                                      duration:CFAbsoluteTimeGetCurrent() - startTime];
+    };
+
+    AylaHTTPTask *task = [client taskWithRequest:request
+        success:^(AylaHTTPTask *task, id responseObject) {
+            completion(nil);
+        }
+        failure:^(AylaHTTPTask *task, NSError *error) {
+            completion(error);
+        }];
+    [task start];
+}
+
+@end
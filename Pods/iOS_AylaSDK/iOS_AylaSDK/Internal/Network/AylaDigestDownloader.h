@@ -0,0 +1,47 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaHTTPDownloadDigest;
+
+/**
+ * Downloads files with data tasks of a private session, writing each received chunk to a temporary file and feeding
+ * it to MD5 and SHA-256 digests on the way, so the file never has to be read back to be verified.
+ *
+ * Delegate callbacks, the progress block and the completion handler are called on a private serial queue.
+ */
+@interface AylaDigestDownloader : NSObject
+
+/**
+ * Creates a download task. The task has to be resumed to start.
+ *
+ * @param request           Request of the file.
+ * @param progressBlock     Called each time a chunk has been written.
+ * @param destination       Called once the download is complete with the temporary file and the server response,
+ * returns the URL the file is moved to.
+ * @param completionHandler Called when the task finishes, with the moved file and its digest on success.
+ */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     progress:(nullable void (^)(NSProgress *downloadProgress))progressBlock
+                                  destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                            completionHandler:(void (^)(NSURLResponse *_Nullable response,
+                                                        NSURL *_Nullable filePath,
+                                                        AylaHTTPDownloadDigest *_Nullable digest,
+                                                        NSError *_Nullable error))completionHandler;
+
+/**
+ * Invalidates the session. Required to release the downloader, as the session retains it.
+ *
+ * @param cancelPendingTasks YES to cancel the running tasks.
+ */
+- (void)invalidateSessionCancelingTasks:(BOOL)cancelPendingTasks;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,248 @@
+//
+//  AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <AFNetworking/AFNetworking.h>
+#import <CommonCrypto/CommonDigest.h>
+#import "AylaDefines_Internal.h"
+#import "AylaDigestDownloader.h"
+#import "AylaHTTPDownloadDigest.h"
+
+/** Largest error response body kept to build the error of a failed download. */
+static const NSUInteger AylaDigestDownloaderMaxErrorBodyLength = 64 * 1024;
+
+typedef void (^AylaDigestDownloadCompletionHandler)(NSURLResponse *_Nullable response,
+                                                    NSURL *_Nullable filePath,
+                                                    AylaHTTPDownloadDigest *_Nullable digest,
+                                                    NSError *_Nullable error);
+
+/**
+ * State of a single download.
+ */
+@interface AylaDigestDownload : NSObject {
+  @public
+    CC_MD5_CTX _md5;
+    CC_SHA256_CTX _sha256;
+}
+
+@property (nonatomic, strong) NSProgress *progress;
+@property (nonatomic, copy) void (^progressBlock)(NSProgress *);
+@property (nonatomic, copy) NSURL * (^destination)(NSURL *, NSURLResponse *);
+@property (nonatomic, copy) AylaDigestDownloadCompletionHandler completionHandler;
+
+@property (nonatomic, strong) NSURL *temporaryURL;
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic, assign) unsigned long long length;
+
+/** Body of a response with an unacceptable status code */
+@property (nonatomic, strong) NSMutableData *errorBody;
+
+/** Error which occurred while writing the file */
+@property (nonatomic, strong) NSError *error;
+
+@end
+
+@implementation AylaDigestDownload
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _progress = [NSProgress progressWithTotalUnitCount:NSURLSessionTransferSizeUnknown];
+    CC_MD5_Init(&_md5);
+    CC_SHA256_Init(&_sha256);
+
+    return self;
+}
+
+- (void)appendData:(NSData *)data
+{
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        CC_MD5_Update(&self->_md5, bytes, (CC_LONG)byteRange.length);
+        CC_SHA256_Update(&self->_sha256, bytes, (CC_LONG)byteRange.length);
+    }];
+    [self.fileHandle writeData:data];
+    self.length += data.length;
+}
+
+- (AylaHTTPDownloadDigest *)finalDigest
+{
+    NSMutableData *md5 = [NSMutableData dataWithLength:CC_MD5_DIGEST_LENGTH];
+    NSMutableData *sha256 = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_MD5_Final(md5.mutableBytes, &_md5);
+    CC_SHA256_Final(sha256.mutableBytes, &_sha256);
+    return [[AylaHTTPDownloadDigest alloc] initWithMD5:md5 sha256:sha256 length:self.length];
+}
+
+@end
+
+@interface AylaDigestDownloader ()<NSURLSessionDataDelegate>
+
+@property (nonatomic, strong) NSURLSession *session;
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, AylaDigestDownload *> *downloads;
+
+@end
+
+@implementation AylaDigestDownloader
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return nil;
+
+    NSOperationQueue *delegateQueue = [[NSOperationQueue alloc] init];
+    delegateQueue.maxConcurrentOperationCount = 1;
+    _session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                             delegate:self
+                                        delegateQueue:delegateQueue];
+    _downloads = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     progress:(void (^)(NSProgress *))progressBlock
+                                  destination:(NSURL * (^)(NSURL *, NSURLResponse *))destination
+                            completionHandler:(AylaDigestDownloadCompletionHandler)completionHandler
+{
+    AylaDigestDownload *download = [[AylaDigestDownload alloc] init];
+    download.progressBlock = progressBlock;
+    download.destination = destination;
+    download.completionHandler = completionHandler;
+
+    NSURLSessionDataTask *task = [self.session dataTaskWithRequest:request];
+    @synchronized(self.downloads) {
+        self.downloads[@(task.taskIdentifier)] = download;
+    }
+    return task;
+}
+
+- (AylaDigestDownload *)downloadForTask:(NSURLSessionTask *)task
+{
+    @synchronized(self.downloads) {
+        return self.downloads[@(task.taskIdentifier)];
+    }
+}
+
+- (void)invalidateSessionCancelingTasks:(BOOL)cancelPendingTasks
+{
+    if (cancelPendingTasks) {
+        [self.session invalidateAndCancel];
+    }
+    else {
+        [self.session finishTasksAndInvalidate];
+    }
+}
+
+#pragma mark - NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session
+              dataTask:(NSURLSessionDataTask *)dataTask
+    didReceiveResponse:(NSURLResponse *)response
+     completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler
+{
+    AylaDigestDownload *download = [self downloadForTask:dataTask];
+
+    NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)response).statusCode : 200;
+    if (statusCode < 200 || statusCode > 299) {
+        download.errorBody = [NSMutableData data];
+        completionHandler(NSURLSessionResponseAllow);
+        return;
+    }
+
+    NSString *fileName = [NSString stringWithFormat:@"ayla-download-%@.tmp", [NSUUID UUID].UUIDString];
+    NSURL *temporaryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    if (![[NSFileManager defaultManager] createFileAtPath:temporaryURL.path contents:nil attributes:nil]) {
+        download.error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                             code:NSFileWriteUnknownError
+                                         userInfo:@{NSFilePathErrorKey : temporaryURL.path}];
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    download.temporaryURL = temporaryURL;
+    download.fileHandle = [NSFileHandle fileHandleForWritingToURL:temporaryURL error:nil];
+    download.progress.totalUnitCount = response.expectedContentLength;
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
+{
+    AylaDigestDownload *download = [self downloadForTask:dataTask];
+    if (download.errorBody) {
+        if (download.errorBody.length < AylaDigestDownloaderMaxErrorBodyLength) {
+            [download.errorBody appendData:data];
+        }
+        return;
+    }
+
+    @try {
+        [download appendData:data];
+    }
+    @catch (NSException *exception) {
+        AylaLogE(@"DigestDownloader", 0, @"writeFailed:%@, %@", exception.reason, download.temporaryURL);
+        download.error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                             code:NSFileWriteUnknownError
+                                         userInfo:@{NSFilePathErrorKey : download.temporaryURL.path}];
+        [dataTask cancel];
+        return;
+    }
+
+    download.progress.completedUnitCount = download.length;
+    if (download.progressBlock) {
+        download.progressBlock(download.progress);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
+{
+    AylaDigestDownload *download = [self downloadForTask:task];
+    @synchronized(self.downloads) {
+        [self.downloads removeObjectForKey:@(task.taskIdentifier)];
+    }
+    if (!download) {
+        return;
+    }
+    [download.fileHandle closeFile];
+
+    NSURLResponse *response = task.response;
+    if (download.error) {
+        error = download.error;
+    }
+    else if (!error && download.errorBody) {
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
+        userInfo[NSLocalizedDescriptionKey] = [NSString
+            stringWithFormat:@"Request failed: %@ (%ld)",
+                             [NSHTTPURLResponse localizedStringForStatusCode:((NSHTTPURLResponse *)response).statusCode],
+                             (long)((NSHTTPURLResponse *)response).statusCode];
+        userInfo[NSURLErrorFailingURLErrorKey] = response.URL;
+        userInfo[AFNetworkingOperationFailingURLResponseErrorKey] = response;
+        userInfo[AFNetworkingOperationFailingURLResponseDataErrorKey] = [download.errorBody copy];
+        error = [NSError errorWithDomain:AFURLResponseSerializationErrorDomain
+                                    code:NSURLErrorBadServerResponse
+                                userInfo:userInfo];
+    }
+
+    NSURL *filePath = nil;
+    AylaHTTPDownloadDigest *digest = nil;
+    if (!error) {
+        digest = [download finalDigest];
+        filePath = download.destination(download.temporaryURL, response);
+        NSError *moveError = nil;
+        if (![filePath isEqual:download.temporaryURL] &&
+            ![[NSFileManager defaultManager] moveItemAtURL:download.temporaryURL toURL:filePath error:&moveError]) {
+            error = moveError;
+            filePath = nil;
+            digest = nil;
+        }
+    }
+    if (error && download.temporaryURL) {
+        [[NSFileManager defaultManager] removeItemAtURL:download.temporaryURL error:nil];
+    }
+
+    download.completionHandler(response, filePath, digest, error);
+}
+
+@end
@@ -0,0 +1,36 @@
+//
+//  AylaGzipJSONSerializer.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <AFNetworking/AFURLRequestSerialization.h>
+#import <AFNetworking/AFURLResponseSerialization.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * JSON request serializer which compresses bodies with gzip once enabled. Bodies of at least `gzipThreshold` bytes are
+ * sent with `Content-Encoding: gzip` unless compression does not make them smaller, and gzip encoded responses are
+ * explicitly accepted.
+ */
+@interface AylaGzipJSONRequestSerializer : AFJSONRequestSerializer
+
+/** Whether bodies are compressed. Defaults to NO. */
+@property (atomic, assign) BOOL gzipEnabled;
+
+/** Minimum size of a compressed body, in bytes */
+@property (atomic, assign) NSUInteger gzipThreshold;
+
+@end
+
+/**
+ * JSON response serializer which decodes gzip encoded bodies the URL loading system left compressed, e.g. when a proxy
+ * strips the `Content-Encoding` header, and counts the bytes of gzip encoded responses before and after decoding.
+ */
+@interface AylaGzipJSONResponseSerializer : AFJSONResponseSerializer
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,91 @@
+//
+//  AylaGzipJSONSerializer.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDefines_Internal.h"
+#import "AylaGzipJSONSerializer.h"
+#import "AylaMetrics.h"
+#import "NSData+AylaGzip.h"
+
+static NSString *const AylaGzipEncoding = @"gzip";
+static NSString *const AylaGzipTag = @"Gzip";
+
+@implementation AylaGzipJSONRequestSerializer
+
+- (NSURLRequest *)requestBySerializingRequest:(NSURLRequest *)request
+                               withParameters:(id)parameters
+                                        error:(NSError *__autoreleasing *)error
+{
+    NSURLRequest *serializedRequest = [super requestBySerializingRequest:request withParameters:parameters error:error];
+    if (!self.gzipEnabled || !serializedRequest) {
+        return serializedRequest;
+    }
+
+    NSMutableURLRequest *mutableRequest = [serializedRequest mutableCopy];
+    [mutableRequest setValue:AylaGzipEncoding forHTTPHeaderField:@"Accept-Encoding"];
+
+    NSData *body = mutableRequest.HTTPBody;
+    if (body.length == 0 || body.length < self.gzipThreshold ||
+        [mutableRequest valueForHTTPHeaderField:@"Content-Encoding"]) {
+        return mutableRequest;
+    }
+    NSData *compressedBody = [body ayla_gzippedData];
+    if (!compressedBody || compressedBody.length >= body.length) {
+        return mutableRequest;
+    }
+
+    mutableRequest.HTTPBody = compressedBody;
+    [mutableRequest setValue:AylaGzipEncoding forHTTPHeaderField:@"Content-Encoding"];
+    [mutableRequest setValue:[@(compressedBody.length) stringValue] forHTTPHeaderField:@"Content-Length"];
+
+    AylaMetrics *metrics = [AylaMetrics sharedMetrics];
+    [metrics incrementCounter:AylaMetricsCloudGzipRequestBytesUncompressed by:body.length];
+    [metrics incrementCounter:AylaMetricsCloudGzipRequestBytesCompressed by:compressedBody.length];
+    return mutableRequest;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+    AylaGzipJSONRequestSerializer *serializer = [super copyWithZone:zone];
+    serializer.gzipEnabled = self.gzipEnabled;
+    serializer.gzipThreshold = self.gzipThreshold;
+    return serializer;
+}
+
+@end
+
+@implementation AylaGzipJSONResponseSerializer
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    AylaMetrics *metrics = [AylaMetrics sharedMetrics];
+    if ([data ayla_isGzipped]) {
+        NSData *decodedData = [data ayla_gunzippedData];
+        if (decodedData) {
+            [metrics incrementCounter:AylaMetricsCloudGzipResponseBytesCompressed by:data.length];
+            [metrics incrementCounter:AylaMetricsCloudGzipResponseBytesUncompressed by:decodedData.length];
+            data = decodedData;
+        }
+        else {
+            AylaLogW(AylaGzipTag, 0, @"failed to decode response of %@", response.URL);
+        }
+    }
+    else if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        // Already decoded by the URL loading system, Content-Length still holds the encoded size
+        NSDictionary *headers = ((NSHTTPURLResponse *)response).allHeaderFields;
+        NSString *encoding = headers[@"Content-Encoding"];
+        long long encodedLength = [headers[@"Content-Length"] longLongValue];
+        if ([encoding caseInsensitiveCompare:AylaGzipEncoding] == NSOrderedSame && encodedLength > 0) {
+            [metrics incrementCounter:AylaMetricsCloudGzipResponseBytesCompressed by:encodedLength];
+            [metrics incrementCounter:AylaMetricsCloudGzipResponseBytesUncompressed by:data.length];
+        }
+    }
+    return [super responseObjectForResponse:response data:data error:error];
+}
+
+@end
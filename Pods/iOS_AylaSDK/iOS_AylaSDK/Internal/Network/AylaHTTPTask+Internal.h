@@ -15,4 +15,7 @@
 /** Response(result) of current HTTP task */
 @property (nonatomic, strong, readwrite) id responseObject;
 
+/** Time the task has been started at, 0 if it has not been started */
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+
 @end
@@ -9,5 +9,6 @@
 @implementation AylaHTTPTask (Internal)
 @dynamic task;
 @dynamic responseObject;
+@dynamic startTime;
 
 @end
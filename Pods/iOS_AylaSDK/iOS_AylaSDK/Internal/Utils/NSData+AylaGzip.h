@@ -0,0 +1,46 @@
+//
+//  NSData+AylaGzip.h
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+NS_ASSUME_NONNULL_BEGIN
+
+/** Default maximum length of gunzipped data, in bytes */
+FOUNDATION_EXPORT const NSUInteger AylaGunzipDefaultMaxLength;
+
+/**
+ Gzip helpers of the AylaNetworks SDK, built on zlib.
+ */
+@interface NSData (AylaGzip)
+/**
+ @return YES if the data starts with the gzip magic bytes
+ */
+- (BOOL)ayla_isGzipped;
+
+/**
+ Compresses the data in the gzip format.
+
+ @return The compressed data, or nil if it could not be compressed
+ */
+- (nullable NSData *)ayla_gzippedData;
+
+/**
+ Decompresses gzip or zlib compressed data, up to `AylaGunzipDefaultMaxLength` bytes.
+
+ @return The decompressed data, or nil if the data is not valid compressed data
+ */
+- (nullable NSData *)ayla_gunzippedData;
+
+/**
+ Decompresses gzip or zlib compressed data.
+
+ @param maxLength Maximum length of the decompressed data.
+ @return The decompressed data, or nil if the data is not valid compressed data or inflates beyond `maxLength`
+ */
+- (nullable NSData *)ayla_gunzippedDataWithMaxLength:(NSUInteger)maxLength;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,101 @@
+//
+//  NSData+AylaGzip.m
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <zlib.h>
+#import "NSData+AylaGzip.h"
+
+/** Window bits selecting the gzip format when compressing */
+static const int AylaGzipWindowBits = MAX_WBITS + 16;
+
+/** Window bits detecting gzip or zlib headers when decompressing */
+static const int AylaGunzipWindowBits = MAX_WBITS + 32;
+
+static const NSUInteger AylaGzipChunkLength = 16 * 1024;
+
+const NSUInteger AylaGunzipDefaultMaxLength = 16 * 1024 * 1024;
+
+@implementation NSData (AylaGzip)
+
+- (BOOL)ayla_isGzipped
+{
+    const uint8_t *bytes = self.bytes;
+    return self.length >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b;
+}
+
+- (NSData *)ayla_gzippedData
+{
+    if (self.length == 0 || self.length > UINT_MAX) {
+        return nil;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, AylaGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *compressed = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)self.length)];
+    stream.next_in = (Bytef *)self.bytes;
+    stream.avail_in = (uInt)self.length;
+    stream.next_out = compressed.mutableBytes;
+    stream.avail_out = (uInt)compressed.length;
+
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+    compressed.length = stream.total_out;
+    return compressed;
+}
+
+- (NSData *)ayla_gunzippedData
+{
+    return [self ayla_gunzippedDataWithMaxLength:AylaGunzipDefaultMaxLength];
+}
+
+- (NSData *)ayla_gunzippedDataWithMaxLength:(NSUInteger)maxLength
+{
+    if (self.length == 0 || self.length > UINT_MAX || maxLength == 0) {
+        return nil;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, AylaGunzipWindowBits) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *decompressed =
+        [NSMutableData dataWithLength:MIN(MAX(self.length * 4, AylaGzipChunkLength), maxLength)];
+    stream.next_in = (Bytef *)self.bytes;
+    stream.avail_in = (uInt)self.length;
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out >= decompressed.length) {
+            if (decompressed.length >= maxLength) {
+                // Corrupt or hostile data inflating beyond what any response needs
+                status = Z_BUF_ERROR;
+                break;
+            }
+            NSUInteger growth = MAX(decompressed.length / 2, AylaGzipChunkLength);
+            [decompressed increaseLengthBy:MIN(growth, maxLength - decompressed.length)];
+        }
+        stream.next_out = (Bytef *)decompressed.mutableBytes + stream.total_out;
+        stream.avail_out = (uInt)(decompressed.length - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+    decompressed.length = stream.total_out;
+    return decompressed;
+}
+
+@end
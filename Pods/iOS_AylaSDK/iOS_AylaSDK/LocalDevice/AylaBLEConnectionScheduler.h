@@ -0,0 +1,125 @@
+//
+//  AylaBLEConnectionScheduler.h
+//  Ayla_LocalDevice_SDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import CoreBluetooth;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Part of the central manager the SDK connects peripherals through. `CBCentralManager` conforms to it, a fake central
+ can be used instead to drive `AylaBLEConnectionScheduler` without radios.
+ */
+@protocol AylaBLECentral <NSObject>
+
+/**
+ Starts connecting to a peripheral, see `-[CBCentralManager connectPeripheral:options:]`
+ */
+- (void)connectPeripheral:(CBPeripheral *)peripheral options:(nullable NSDictionary<NSString *, id> *)options;
+
+/**
+ Cancels a connection or a pending connection to a peripheral, see `-[CBCentralManager cancelPeripheralConnection:]`
+ */
+- (void)cancelPeripheralConnection:(CBPeripheral *)peripheral;
+@end
+
+@interface CBCentralManager (AylaBLECentral) <AylaBLECentral>
+@end
+
+/** Default value of `maxConcurrentConnections` */
+extern const NSUInteger AylaBLEConnectionSchedulerDefaultMaxConcurrentConnections;
+
+/**
+ Schedules connections to discovered peripherals. At most `maxConcurrentConnections` connection attempts are in
+ flight, the other peripherals wait in a queue and the one with the strongest signal is connected first.
+
+ Peripherals still waiting when a scan times out keep being connected afterwards, so every candidate of the scan gets
+ its connection. Only cancelling the scan drops them.
+
+ Must be used on the main queue, which the central manager of `AylaBLEDeviceManager` calls its delegate on.
+ */
+@interface AylaBLEConnectionScheduler : NSObject
+
+/**
+ Maximum number of connection attempts in flight
+ */
+@property (nonatomic, assign) NSUInteger maxConcurrentConnections;
+
+/**
+ Time after which a connection attempt with no outcome is cancelled so its slot can be reused, in seconds
+ */
+@property (nonatomic, assign) NSTimeInterval connectionTimeout;
+
+/**
+ Number of peripherals waiting to be connected
+ */
+@property (nonatomic, assign, readonly) NSUInteger numberOfPendingConnections;
+
+/**
+ Number of connection attempts in flight
+ */
+@property (nonatomic, assign, readonly) NSUInteger numberOfActiveConnections;
+
+/**
+ Init method
+
+ @param central Central manager the connections are made through
+ @return An initialized scheduler
+ */
+- (instancetype)initWithCentral:(id<AylaBLECentral>)central NS_DESIGNATED_INITIALIZER;
+
+/**
+ Queues a connection to a peripheral. If the peripheral is already waiting its RSSI is updated, if a connection
+ attempt to it is already in flight nothing happens.
+
+ @param peripheral Peripheral to connect
+ @param rssi Last RSSI received from the peripheral
+ @return YES if the peripheral is waiting or being connected, NO if it was already being connected.
+ */
+- (BOOL)scheduleConnectionToPeripheral:(CBPeripheral *)peripheral rssi:(NSInteger)rssi;
+
+/**
+ Updates the RSSI of a waiting peripheral, does nothing if the peripheral is not waiting.
+
+ @param rssi Last RSSI received from the peripheral
+ @param identifier Identifier of the peripheral
+ */
+- (void)updateRSSI:(NSInteger)rssi forPeripheralWithIdentifier:(NSUUID *)identifier;
+
+/**
+ Must be called when a connection attempt completes, whether it succeeded or failed, to free its slot.
+
+ @param peripheral The peripheral
+ */
+- (void)peripheralDidFinishConnecting:(CBPeripheral *)peripheral;
+
+/**
+ Removes a peripheral from the queue, does not affect an attempt in flight.
+
+ @param identifier Identifier of the peripheral
+ */
+- (void)cancelPendingConnectionWithIdentifier:(NSUUID *)identifier;
+
+/**
+ Hands a peripheral over to a connection made outside of the scheduler: removes it from the queue and, if an attempt
+ to it is in flight, frees its slot without cancelling the attempt, which then is no longer timed out.
+
+ @param identifier Identifier of the peripheral
+ */
+- (void)handOverConnectionWithIdentifier:(NSUUID *)identifier;
+
+/**
+ Removes all peripherals from the queue, attempts in flight are left to complete.
+ */
+- (void)cancelPendingConnections;
+
+// Unavailable methods
+- (instancetype)init NS_UNAVAILABLE;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,175 @@
+//
+//  AylaBLEConnectionScheduler.m
+//  Ayla_LocalDevice_SDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaBLEConnectionScheduler.h"
+#import "AylaLogManager.h"
+
+const NSUInteger AylaBLEConnectionSchedulerDefaultMaxConcurrentConnections = 2;
+
+/** RSSI reported by CoreBluetooth when it is not available */
+static const NSInteger AylaBLERSSIUnavailable = 127;
+
+@implementation CBCentralManager (AylaBLECentral)
+@end
+
+/**
+ A peripheral waiting to be connected or being connected
+ */
+@interface AylaBLEScheduledConnection : NSObject
+@property (nonatomic, strong) CBPeripheral *peripheral;
+@property (nonatomic, strong) NSUUID *identifier;
+@property (nonatomic, assign) NSInteger rssi;
+/** Order the peripheral was queued in, breaks ties between equal RSSIs */
+@property (nonatomic, assign) NSUInteger sequence;
+@end
+
+@implementation AylaBLEScheduledConnection
+@end
+
+@interface AylaBLEConnectionScheduler ()
+@property (nonatomic, strong) id<AylaBLECentral> central;
+@property (nonatomic, strong) NSMutableArray<AylaBLEScheduledConnection *> *pendingConnections;
+@property (nonatomic, strong) NSMutableDictionary<NSUUID *, AylaBLEScheduledConnection *> *activeConnections;
+@property (nonatomic, assign) NSUInteger sequence;
+@end
+
+@implementation AylaBLEConnectionScheduler
+
+- (instancetype)initWithCentral:(id<AylaBLECentral>)central {
+    if (self = [super init]) {
+        _central = central;
+        _maxConcurrentConnections = AylaBLEConnectionSchedulerDefaultMaxConcurrentConnections;
+        _connectionTimeout = 10;
+        _pendingConnections = [NSMutableArray array];
+        _activeConnections = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSUInteger)numberOfPendingConnections {
+    return self.pendingConnections.count;
+}
+
+- (NSUInteger)numberOfActiveConnections {
+    return self.activeConnections.count;
+}
+
+- (BOOL)scheduleConnectionToPeripheral:(CBPeripheral *)peripheral rssi:(NSInteger)rssi {
+    NSUUID *identifier = peripheral.identifier;
+    if (identifier == nil || self.activeConnections[identifier] != nil) {
+        return NO;
+    }
+
+    AylaBLEScheduledConnection *connection = [self pendingConnectionWithIdentifier:identifier];
+    if (connection == nil) {
+        connection = [[AylaBLEScheduledConnection alloc] init];
+        connection.identifier = identifier;
+        connection.sequence = self.sequence++;
+        [self.pendingConnections addObject:connection];
+    }
+    connection.peripheral = peripheral;
+    connection.rssi = rssi;
+
+    [self startPendingConnections];
+    return YES;
+}
+
+- (void)updateRSSI:(NSInteger)rssi forPeripheralWithIdentifier:(NSUUID *)identifier {
+    [self pendingConnectionWithIdentifier:identifier].rssi = rssi;
+}
+
+- (void)peripheralDidFinishConnecting:(CBPeripheral *)peripheral {
+    NSUUID *identifier = peripheral.identifier;
+    if (identifier == nil || self.activeConnections[identifier] == nil) {
+        return;
+    }
+    [self.activeConnections removeObjectForKey:identifier];
+    [self startPendingConnections];
+}
+
+- (void)cancelPendingConnectionWithIdentifier:(NSUUID *)identifier {
+    AylaBLEScheduledConnection *connection = [self pendingConnectionWithIdentifier:identifier];
+    if (connection != nil) {
+        [self.pendingConnections removeObject:connection];
+    }
+}
+
+- (void)handOverConnectionWithIdentifier:(NSUUID *)identifier {
+    [self cancelPendingConnectionWithIdentifier:identifier];
+    if (identifier == nil || self.activeConnections[identifier] == nil) {
+        return;
+    }
+    [self.activeConnections removeObjectForKey:identifier];
+    [self startPendingConnections];
+}
+
+- (void)cancelPendingConnections {
+    [self.pendingConnections removeAllObjects];
+}
+
+- (AylaBLEScheduledConnection *)pendingConnectionWithIdentifier:(NSUUID *)identifier {
+    for (AylaBLEScheduledConnection *connection in self.pendingConnections) {
+        if ([connection.identifier isEqual:identifier]) {
+            return connection;
+        }
+    }
+    return nil;
+}
+
+- (NSInteger)priorityOfConnection:(AylaBLEScheduledConnection *)connection {
+    return connection.rssi == AylaBLERSSIUnavailable ? NSIntegerMin : connection.rssi;
+}
+
+- (AylaBLEScheduledConnection *)nextPendingConnection {
+    AylaBLEScheduledConnection *next = nil;
+    for (AylaBLEScheduledConnection *connection in self.pendingConnections) {
+        NSInteger priority = [self priorityOfConnection:connection];
+        NSInteger nextPriority = [self priorityOfConnection:next];
+        if (next == nil || priority > nextPriority || (priority == nextPriority && connection.sequence < next.sequence)) {
+            next = connection;
+        }
+    }
+    return next;
+}
+
+- (void)startPendingConnections {
+    NSUInteger maxConcurrentConnections = MAX(self.maxConcurrentConnections, 1);
+    while (self.activeConnections.count < maxConcurrentConnections && self.pendingConnections.count > 0) {
+        AylaBLEScheduledConnection *connection = [self nextPendingConnection];
+        [self.pendingConnections removeObject:connection];
+        self.activeConnections[connection.identifier] = connection;
+
+        AylaLogD([self logTag], 0, @"Connecting to %@ (RSSI %ld), %lu waiting", connection.identifier.UUIDString,
+                 (long)connection.rssi, (unsigned long)self.pendingConnections.count);
+        [self.central connectPeripheral:connection.peripheral options:nil];
+        [self scheduleTimeoutForConnection:connection];
+    }
+}
+
+- (void)scheduleTimeoutForConnection:(AylaBLEScheduledConnection *)connection {
+    if (self.connectionTimeout <= 0) {
+        return;
+    }
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.connectionTimeout * NSEC_PER_SEC)),
+                   dispatch_get_main_queue(), ^{
+        AylaBLEConnectionScheduler *strongSelf = weakSelf;
+        // Only time out the attempt this block was scheduled for, the peripheral may have been connected again since
+        if (strongSelf == nil || strongSelf.activeConnections[connection.identifier] != connection) {
+            return;
+        }
+        AylaLogW([strongSelf logTag], 0, @"Connection to %@ timed out", connection.identifier.UUIDString);
+        [strongSelf.activeConnections removeObjectForKey:connection.identifier];
+        [strongSelf.central cancelPeripheralConnection:connection.peripheral];
+        [strongSelf startPendingConnections];
+    });
+}
+
+- (NSString *)logTag {
+    return NSStringFromClass([self class]);
+}
+@end
@@ -8,6 +8,7 @@
 
 #import "AylaBLEDeviceManager.h"
 #import "AylaBLEDevice+Internal.h"
+#import "AylaBLEConnectionScheduler.h"
 
 @import CoreBluetooth;
 
@@ -55,6 +56,12 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong, nullable) AylaGenericTask *scanTask;
 /** Holds the results of the scan */
 @property (nonatomic, strong) NSMutableArray <AylaRegistrationCandidate *> *scanResults;
+/** Results of the scan keyed by peripheral identifier, used to drop repeated advertisements */
+@property (nonatomic, strong) NSMutableDictionary <NSUUID *, AylaBLECandidate *> *scanResultsByIdentifier;
+/** Schedules the connections to the peripherals found during scans */
+@property (nonatomic, strong, nullable) AylaBLEConnectionScheduler *connectionScheduler;
+/** BLE devices of the device manager keyed by the identifier of their peripheral */
+@property (nonatomic, strong) NSMapTable <NSUUID *, AylaBLEDevice *> *devicesByIdentifier;
 /** Helps identifying the connection tasks in the operation queue */
 @property (nonatomic, strong) NSMutableDictionary *connectionDescriptors;
 @end
@@ -63,6 +70,20 @@ NS_ASSUME_NONNULL_BEGIN
 extern NSString * const AylaBLEDeviceManagerStatePoweredOff;
 @interface  AylaBLEDeviceManager (Internal)
 
+/**
+ Adds the device to the peripheral identifier index, must be called whenever a peripheral is assigned to a device.
+
+ @param device The device, ignored if it has no peripheral
+ */
+- (void)indexDevice:(AylaBLEDevice *)device;
+
+/**
+ Rebuilds the peripheral identifier index from a device list
+
+ @param devices Devices of the device manager
+ */
+- (void)rebuildDeviceIndexWithDevices:(NSArray<AylaDevice *> *)devices;
+
 /**
  Adds a connection descriptor
 
@@ -109,7 +130,8 @@ extern NSString * const AylaBLEDeviceManagerStatePoweredOff;
 
 
 /**
- Starts the scan for local devices with the specified timeout and returns the results in the success block
+ Starts the scan for local devices with the specified timeout and returns the results in the success block. Peripherals
+ found by the scan whose connection is still queued when it times out keep being connected afterwards.
 
  @param timeoutInMs timeout for scan for devices
  @param successBlock block called when the device scan is complete, takes an array with the results
@@ -31,6 +31,7 @@
     }
     
     self.scanResults = [NSMutableArray array];
+    self.scanResultsByIdentifier = [NSMutableDictionary dictionary];
     self.scanSuccessBlock = successBlock;
     self.scanFailureBlock = failureBlock;
     
@@ -40,6 +41,10 @@
         return YES;
     } cancel:^(BOOL timedOut) {
         [self.bleManager stopScan];
+        // Peripherals still waiting keep being connected once a scan times out, a cancelled scan drops them
+        if (!timedOut) {
+            [self.connectionScheduler cancelPendingConnections];
+        }
         self.scanTask = nil;
         self.scanSuccessBlock = nil;
         self.scanFailureBlock = nil;
@@ -57,7 +62,10 @@
 
 - (AylaGenericTask *)connectLocalDevice:(AylaBLEDevice *)device success:(void (^)())successBlock failure:(void (^)(NSError * _Nonnull))failureBlock {
     AylaGenericTask * (^connect)() = ^{
+        [self indexDevice:device];
         AylaGenericTask *connectionTask = [[AylaGenericTask alloc] initWithTask:^BOOL{
+            // Explicit connections are not throttled nor timed out by the scheduler, take over the one a scan may have started
+            [self.connectionScheduler handOverConnectionWithIdentifier:device.peripheral.identifier];
             [self.bleManager connectPeripheral:device.peripheral options:nil];
             return YES;
         } cancel:^(BOOL timedOut) {
@@ -118,6 +126,22 @@
     return disconnectTask;
 }
 
+- (void)indexDevice:(AylaBLEDevice *)device {
+    NSUUID *identifier = device.peripheral.identifier;
+    if (identifier != nil) {
+        [self.devicesByIdentifier setObject:device forKey:identifier];
+    }
+}
+
+- (void)rebuildDeviceIndexWithDevices:(NSArray<AylaDevice *> *)devices {
+    [self.devicesByIdentifier removeAllObjects];
+    for (AylaDevice *device in devices) {
+        if ([device isKindOfClass:[AylaBLEDevice class]]) {
+            [self indexDevice:(AylaBLEDevice *)device];
+        }
+    }
+}
+
 - (void)addConnectionDescriptor:(AylaBLEConnectionDescriptor *)descriptor forPeripheral:(CBPeripheral *)peripheral {
     self.connectionDescriptors[peripheral.identifier.UUIDString] = descriptor;
 }
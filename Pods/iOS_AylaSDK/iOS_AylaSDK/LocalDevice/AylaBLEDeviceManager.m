@@ -42,6 +42,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 - (instancetype)initWithServices:(NSArray<CBUUID *> *)scanServices {
     if (self = [super init]) {
         _scanServices = scanServices;
+        _devicesByIdentifier = [NSMapTable strongToWeakObjectsMapTable];
     }
     return self;
 }
@@ -64,6 +65,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 - (void)initializePlugin:(NSString *)pluginId sessionManager:(AylaSessionManager *)sessionManager {
     if ([pluginId isEqualToString:PLUGIN_ID_DEVICE_LIST]) {
         self.bleManager = [[CBCentralManager alloc] initWithDelegate:self queue:nil];
+        self.connectionScheduler = [[AylaBLEConnectionScheduler alloc] initWithCentral:self.bleManager];
         self.connectionDescriptors = [NSMutableDictionary dictionary];
         [self reconnectDevices:sessionManager];
         [sessionManager.deviceManager addListener:self];
@@ -72,6 +74,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (void)updateDeviceDictionary:(NSDictionary<NSString *,AylaDevice *> *)devices {
+    [self rebuildDeviceIndexWithDevices:devices.allValues];
     for (AylaDevice *device in devices.allValues) {
         if ([device isKindOfClass:[AylaBLEDevice class]]) {
             [(AylaBLEDevice *)device initializeBluetooth];
@@ -114,6 +117,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
         AylaLogE([self logTag], 0, @"No device manager found");
         return;
     }
+    [self rebuildDeviceIndexWithDevices:deviceManager.devices.allValues];
     for (AylaDevice *device in deviceManager.devices.allValues) {
         if ([device isKindOfClass:[AylaBLEDevice class]]) {
             AylaBLEDevice *bleDevice = (AylaBLEDevice *)device;
@@ -182,6 +186,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
                 CBPeripheral *peripheral = bleCandidate.peripheral;
                 bleDevice.peripheral = peripheral;
                 bleDevice.bleDeviceManager = bleCandidate.bleDeviceManager;
+                [self indexDevice:bleDevice];
                 [self connectLocalDevice:bleDevice success:^{
                     [bleDevice mapToIdentifier:peripheral.identifier];
                 } failure:^(NSError * _Nonnull error) {}];
@@ -257,13 +262,31 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 @implementation AylaBLEDeviceManager (CBCentralManagerDelegate)
 - (void)centralManager:(CBCentralManager *)central didDiscoverPeripheral:(CBPeripheral *)peripheral advertisementData:(NSDictionary<NSString *,id> *)advertisementData RSSI:(NSNumber *)RSSI {
     NSArray <CBUUID *>*serviceUUIDs = advertisementData[@"kCBAdvDataServiceUUIDs"];
+    BOOL advertisesScanService = NO;
     for (CBUUID *service in serviceUUIDs) {
         if ([self.scanServices containsObject:service]) {
-            AylaBLECandidate *device = [self createLocalCandidate:peripheral advertisementData:advertisementData rssi:RSSI.integerValue];
-            [self.scanResults addObject:device];
-            [self.bleManager connectPeripheral:peripheral options:nil];
+            advertisesScanService = YES;
+            break;
         }
     }
+    NSUUID *identifier = peripheral.identifier;
+    if (!advertisesScanService || identifier == nil) {
+        return;
+    }
+    
+    AylaBLECandidate *candidate = self.scanResultsByIdentifier[identifier];
+    if (candidate != nil) {
+        // Peripherals advertise repeatedly, only refresh what the advertisement carries
+        candidate.advertisementData = advertisementData;
+        candidate.rssi = RSSI.integerValue;
+        [self.connectionScheduler updateRSSI:RSSI.integerValue forPeripheralWithIdentifier:identifier];
+        return;
+    }
+    
+    candidate = [self createLocalCandidate:peripheral advertisementData:advertisementData rssi:RSSI.integerValue];
+    self.scanResultsByIdentifier[identifier] = candidate;
+    [self.scanResults addObject:candidate];
+    [self.connectionScheduler scheduleConnectionToPeripheral:peripheral rssi:RSSI.integerValue];
 }
 
 - (void)centralManagerDidUpdateState:(CBCentralManager *)central {
@@ -290,14 +313,17 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (AylaBLEDevice *)deviceForPeripheral:(CBPeripheral *)peripheral {
-    for (AylaBLEDevice *device in self.sessionManager.deviceManager.devices.allValues) {
-        if ([device isKindOfClass:[AylaBLEDevice class]]) {
-            if ([device.peripheral.identifier isEqual:peripheral.identifier]) {
-                return device;
-            }
-        }
+    NSUUID *identifier = peripheral.identifier;
+    if (identifier == nil) {
+        return nil;
     }
-    return nil;
+    AylaBLEDevice *device = [self.devicesByIdentifier objectForKey:identifier];
+    // The device may have been given another peripheral since it was indexed
+    if (device != nil && ![device.peripheral.identifier isEqual:identifier]) {
+        [self.devicesByIdentifier removeObjectForKey:identifier];
+        return nil;
+    }
+    return device;
 }
 
 - (void)updateDeviceForPeripheral:(CBPeripheral *)peripheral fromDevice:(AylaBLEDevice *)updateDevice {
@@ -307,6 +333,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (void)centralManager:(CBCentralManager *)central didConnectPeripheral:(CBPeripheral *)peripheral {
+    [self.connectionScheduler peripheralDidFinishConnecting:peripheral];
     AylaBLEDevice *updateDevice = [[AylaBLEDevice alloc] initExtensible];
     updateDevice.connectedAt = [NSDate date];
     updateDevice.connectionStatus = AylaDeviceConnectionStatusOnline;
@@ -325,6 +352,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (void)centralManager:(CBCentralManager *)central didFailToConnectPeripheral:(CBPeripheral *)peripheral error:(NSError *)error {
+    [self.connectionScheduler peripheralDidFinishConnecting:peripheral];
     AylaBLEConnectionDescriptor *connectionDescriptor = [self connectionDescriptorForPeripheral:peripheral];
     if (connectionDescriptor.connectionFailureCallback) {
         
@@ -335,6 +363,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (void)centralManager:(CBCentralManager *)central didDisconnectPeripheral:(CBPeripheral *)peripheral error:(NSError *)error {
+    [self.connectionScheduler peripheralDidFinishConnecting:peripheral];
     AylaBLEDevice *updateDevice = [[AylaBLEDevice alloc] initExtensible];
     updateDevice.connectionStatus = AylaDeviceConnectionStatusOffline;
     [self updateDeviceForPeripheral:peripheral fromDevice:updateDevice];
@@ -354,6 +383,7 @@ NSString * const AylaBLEDeviceManagerStatePoweredOff = @"Bluetooth is currently
 }
 
 - (void)deviceManager:(AylaDeviceManager *)deviceManager didObserveDeviceListChange:(AylaDeviceListChange *)change {
+    [self rebuildDeviceIndexWithDevices:deviceManager.devices.allValues];
 }
 
 - (void)deviceManager:(AylaDeviceManager *)deviceManager deviceManagerStateChanged:(AylaDeviceManagerState)oldState newState:(AylaDeviceManagerState)newState {
@@ -14,7 +14,7 @@
 #import "AylaDeviceCommand.h"
 #import "AylaObject+Internal.h"
 #import "AylaLocalOTACommand.h"
-#import <CommonCrypto/CommonDigest.h>
+#import "AylaHTTPDownloadDigest.h"
 
 static NSString *const attrNameHardwareAddress = @"unique_hardware_id";
 NSString const * OTATypeHostMCU = @"host_mcu";
@@ -44,6 +44,11 @@ NSString const * OTATypeHostMCU = @"host_mcu";
     return self;
 }
 
+- (void)copyFieldsToSnapshot:(AylaDevice *)snapshot {
+    [super copyFieldsToSnapshot:snapshot];
+    ((AylaLocalDevice *)snapshot).hardwareAddress = self.hardwareAddress;
+}
+
 - (AylaGenericTask *)connectLocalWithSuccess:(void (^)())successBlock failure:(void (^)(NSError * _Nonnull))failureBlock {
     return nil;
 }
@@ -179,14 +184,18 @@ NSString const * OTATypeHostMCU = @"host_mcu";
     request.allHTTPHeaderFields = httpClient.currentRequestHeaders;
 
     
-    self.otaTask = [httpClient taskWithDownloadRequest:request progress:^(NSProgress * _Nonnull downloadProgress) {
+    self.otaTask = [httpClient taskWithDigestingDownloadRequest:request progress:^(NSProgress * _Nonnull downloadProgress) {
         AylaLogI([self logTag], 0, @"LAN OTA Image Download progress: %@", downloadProgress);
     } destination:^NSURL * _Nonnull(NSURL * _Nonnull url, NSURLResponse * _Nonnull response) {
+        // delete the former exist file
+        if ([[NSFileManager defaultManager] fileExistsAtPath:fileName isDirectory:nil]) {
+            [[NSFileManager defaultManager] removeItemAtPath:fileName error:nil];
+        }
         return [NSURL fileURLWithPath:fileName];
-    } success:^(AylaHTTPTask * _Nonnull task, NSURL * _Nonnull filePath) {
+    } success:^(AylaHTTPTask * _Nonnull task, NSURL * _Nonnull filePath, AylaHTTPDownloadDigest * _Nonnull digest) {
         self.otaTask = nil;
         AylaLogI([self logTag], 0, @"Finished downloading OTA: %@", filePath);
-        if ([self verifyChecksum:command.checksum filePath:filePath]) {
+        if ([self verifyChecksum:command.checksum digest:digest]) {
             AylaLogI([self logTag], 0, @"Checksum succceeded");
             [self otaReceived:command filePath:filePath];
         } else {
@@ -207,42 +216,15 @@ NSString const * OTATypeHostMCU = @"host_mcu";
     [self.otaTask start];
 }
 
-- (BOOL)verifyChecksum:(NSString *)checksum filePath:(NSURL *)filePath {
-    const NSInteger chunkSize = 128 *  1024;
-    if (filePath == nil || checksum == nil) {
-        return nil;
-    }
-    if (checksum.length != 32) {
+- (BOOL)verifyChecksum:(NSString *)checksum digest:(AylaHTTPDownloadDigest *)digest {
+    if (digest == nil || checksum == nil) {
         return false;
     }
-    NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:filePath.path];
-    if (handle == nil) {
+    // The checksum of a local OTA command is an MD5 digest
+    if (checksum.length != 32) {
         return false;
     }
-    
-    CC_MD5_CTX md5;
-    CC_MD5_Init(&md5);
-    
-    BOOL done = NO;
-    while (!done) {
-        @autoreleasepool {
-            NSData *data = [handle readDataOfLength:chunkSize];
-            CC_MD5_Update(&md5, data.bytes, (CC_LONG)data.length);
-            if (data.length == 0) {
-                done = YES;
-            }
-        }
-    }
-    
-    unsigned char digest[CC_MD5_DIGEST_LENGTH];
-    CC_MD5_Final(digest, &md5);
-    
-    NSMutableString *hash = [NSMutableString stringWithCapacity:CC_MD5_DIGEST_LENGTH * 2];
-    for (int i = 0; i < CC_MD5_DIGEST_LENGTH; i++) {
-        [hash appendFormat:@"%02x",digest[i]];
-    }
-    
-    return [hash isEqualToString:checksum];
+    return [digest matchesChecksum:checksum];
 }
 
 - (AylaHTTPTask *)setOTAStatus:(NSInteger)status commandId:(NSInteger)commandId success:(void (^)(void))successBlock failure:(void (^)(NSError * _Nonnull))failureBlock {
@@ -9,6 +9,7 @@
 #import "AylaLocalProperty.h"
 #import "AylaLocalDevice.h"
 #import "AylaDevice+Extensible.h"
+#import "AylaProperty+Internal.h"
 
 @interface AylaLocalProperty ()
 @property(readonly) AylaLocalDevice *localDevice;
@@ -27,6 +28,12 @@
     }
     return self;
 }
+- (void)copyFieldsToSnapshot:(AylaProperty *)snapshot {
+    [super copyFieldsToSnapshot:snapshot];
+    AylaLocalProperty *localSnapshot = (AylaLocalProperty *)snapshot;
+    localSnapshot.originalProperty = self.originalProperty;
+    localSnapshot.readOnly = self.readOnly;
+}
 - (AylaLocalDevice *)localDevice {
     return (AylaLocalDevice *)self.device;
 }
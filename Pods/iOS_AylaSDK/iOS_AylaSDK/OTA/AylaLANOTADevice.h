@@ -38,6 +38,22 @@ typedef NS_ENUM(NSInteger, ImagePushStatus) {
  */
 - (void)lanOTADevice:(AylaLANOTADevice *)device didUpdateImagePushStatus:(ImagePushStatus)status;
 
+@optional
+
+/**
+ * Method called each time a chunk of the image has been served to the device. The device may request the image in
+ * several ranges, e.g. when resuming an interrupted transfer.
+ *
+ * @param device         Cureent LAN OTA device
+ * @param bytesServed    Offset in the image up to which it has been served by the current request
+ * @param totalBytes     Size of the image
+ * @param bytesPerSecond Average throughput of the current request
+ */
+- (void)lanOTADevice:(AylaLANOTADevice *)device
+    didServeImageBytes:(uint64_t)bytesServed
+            totalBytes:(uint64_t)totalBytes
+        bytesPerSecond:(double)bytesPerSecond;
+
 @end
 
 /**
@@ -104,7 +120,9 @@ typedef NS_ENUM(NSInteger, ImagePushStatus) {
 
 /**
  * Fetch OTA image from remote location. If there is already one copy locally, it will be
- * over-written.
+ * over-written. The image is hashed while it is downloaded and checked against the checksum of
+ * `imageInfo` when the service provides one. An image which fails the check is deleted and
+ * reported through `failureBlock`.
  *
  * @param imageInfo    Model that contains all meta data of the image file.
  * @param downloadProgressBlock A block called whith progress updates
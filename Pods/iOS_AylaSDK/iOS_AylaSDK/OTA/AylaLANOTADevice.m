@@ -6,6 +6,7 @@
 
 #import "AylaErrorUtils.h"
 #import "AylaHTTPClient.h"
+#import "AylaHTTPDownloadDigest.h"
 #import "AylaLANOTADevice.h"
 #import "AylaLANOTAHTTPServer.h"
 #import "AylaNetworks+Internal.h"
@@ -15,8 +16,6 @@
 #import "NSData+Base64.h"
 #import "NSObject+Ayla.h"
 
-static NSUInteger const kOTAServerPort   = 8888;
-static NSUInteger const kHeaderSize      = 256;
 static NSString *const kOTAFileSeparator = @"--";
 
 @interface AylaLANOTADevice ()<AylaLANOTAHTTPServerDelegate>
@@ -174,7 +173,7 @@ static NSString *const kOTAFileSeparator = @"--";
         [request setValue:[NSString stringWithFormat:@"auth_token %@", authToken] forHTTPHeaderField:@"Authorization"];
     }
 
-    AylaHTTPTask *task = [httpClient taskWithDownloadRequest:request
+    AylaHTTPTask *task = [httpClient taskWithDigestingDownloadRequest:request
         progress:downloadProgressBlock
         destination:^NSURL *_Nonnull(NSURL *_Nonnull url, NSURLResponse *_Nonnull response) {
             NSString *filePath = [self generateFileNameWithImageInfo:imageInfo];
@@ -184,7 +183,26 @@ static NSString *const kOTAFileSeparator = @"--";
             }
             return [NSURL fileURLWithPath:filePath];
         }
-        success:^(AylaHTTPTask *_Nonnull task, NSURL *_Nonnull filePath) {
+        success:^(AylaHTTPTask *_Nonnull task, NSURL *_Nonnull filePath, AylaHTTPDownloadDigest *_Nonnull digest) {
+            BOOL validLength = digest.length > AylaLANOTAImageHeaderSize;
+            BOOL validChecksum = imageInfo.checksum == nil || [digest matchesChecksum:imageInfo.checksum];
+            if (!validLength || !validChecksum) {
+                AylaLogE([self logTag], 0, @"invalidImage:%@, digest:%@, %@", imageInfo, digest, NSStringFromSelector(_cmd));
+                [[NSFileManager defaultManager] removeItemAtURL:filePath error:nil];
+                NSError *error =
+                    [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                               code:AylaRequestErrorCodeInvalidArguments
+                                           userInfo:@{
+                                               AylaRequestErrorResponseJsonKey :
+                                                   @{ @"checksum" : AylaErrorDescriptionIsInvalid }
+                                           }];
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    failureBlock(error);
+                });
+                [self notifyStatus:NO reason:@"checksum failure"];
+                return;
+            }
+            AylaLogI([self logTag], 0, @"%@:%@, %@", @"digest", digest, NSStringFromSelector(_cmd));
             dispatch_async(dispatch_get_main_queue(), ^{
                 successBlock();
             });
@@ -235,14 +253,14 @@ static NSString *const kOTAFileSeparator = @"--";
         return nil;
     }
 
-    // attempt to start the server with the specified documentRootPath
-    if (self.lanOTAServer.isRunning == NO) {
-        NSError *error = nil;
-        [self.lanOTAServer start:&error];
-        if (error) {
-            failureBlock(error);
-            return nil;
-        }
+    // attempt to start the server with the specified documentRootPath, it may already be serving other devices
+    NSError *error = nil;
+    if (![self.lanOTAServer startServingHost:self.lanIP
+                                documentRoot:self.otaDirectory
+                                    delegate:self
+                                       error:&error]) {
+        failureBlock(error);
+        return nil;
     }
 
     void(^failBlock)(NSError *_Nonnull error) = ^void(NSError *_Nonnull error) {
@@ -268,7 +286,7 @@ static NSString *const kOTAFileSeparator = @"--";
     NSArray *components = [fileName componentsSeparatedByString:kOTAFileSeparator];
 
     NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:filePath];
-    NSData *header = [handle readDataOfLength:kHeaderSize];
+    NSData *header = [handle readDataOfLength:AylaLANOTAImageHeaderSize];
     [handle closeFile];
 
     NSDictionary *otaDict = @{
@@ -292,7 +310,7 @@ static NSString *const kOTAFileSeparator = @"--";
             });
         }
         failure:^(AylaHTTPTask *_Nonnull task, NSError *_Nonnull error) {
-            [self.lanOTAServer stop];
+            [self.lanOTAServer stopServingHost:self.lanIP];
             dispatch_async(dispatch_get_main_queue(), ^{
                 failureBlock(error);
             });
@@ -331,7 +349,7 @@ static NSString *const kOTAFileSeparator = @"--";
     [body appendBytes:&zeroByte length:1];
 
     NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:filePath];
-    NSData *header = [handle readDataOfLength:kHeaderSize];
+    NSData *header = [handle readDataOfLength:AylaLANOTAImageHeaderSize];
     [handle closeFile];
     [body appendData:header];
 
@@ -351,7 +369,7 @@ static NSString *const kOTAFileSeparator = @"--";
             });
         }
         failure:^(AylaHTTPTask *_Nonnull task, NSError *_Nonnull error) {
-            [self.lanOTAServer stop];
+            [self.lanOTAServer stopServingHost:self.lanIP];
             dispatch_async(dispatch_get_main_queue(), ^{
                 failureBlock(error);
             });
@@ -365,7 +383,7 @@ static NSString *const kOTAFileSeparator = @"--";
     AylaLogD([self logTag], 0, @"didReceiveImagePushStatus:%@", @(status));
     if (status == ImagePushStatusDone) {
         [self deleteOTAFile];
-        [self.lanOTAServer stop];
+        [self.lanOTAServer stopServingHost:self.lanIP];
     }
     if (self.delegate) {
         dispatch_async(dispatch_get_main_queue(), ^{
@@ -374,13 +392,23 @@ static NSString *const kOTAFileSeparator = @"--";
     }
 }
 
+- (void)didServeImageBytes:(UInt64)bytesServed totalBytes:(UInt64)totalBytes bytesPerSecond:(double)bytesPerSecond
+{
+    if ([self.delegate respondsToSelector:@selector(lanOTADevice:didServeImageBytes:totalBytes:bytesPerSecond:)]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self.delegate lanOTADevice:self
+                     didServeImageBytes:bytesServed
+                             totalBytes:totalBytes
+                         bytesPerSecond:bytesPerSecond];
+        });
+    }
+}
+
 - (AylaLANOTAHTTPServer *)lanOTAServer
 {
     if (_lanOTAServer == nil) {
-        _lanOTAServer = [AylaLANOTAHTTPServer new];
-        _lanOTAServer.port = kOTAServerPort;
-        _lanOTAServer.documentRoot = [[self getOTAFilePathIfExist] stringByDeletingLastPathComponent];
-        _lanOTAServer.delegate = self;
+        // All devices share one server, so several of them can be updated at the same time
+        _lanOTAServer = [AylaLANOTAHTTPServer sharedServer];
     }
 
     return _lanOTAServer;
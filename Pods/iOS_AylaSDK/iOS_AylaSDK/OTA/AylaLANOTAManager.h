@@ -0,0 +1,148 @@
+//
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AylaLANOTAManager;
+@class AylaSessionManager;
+
+/** Enumerates the states of the LAN OTA update of a device */
+typedef NS_ENUM(NSInteger, AylaLANOTAJobState) {
+    /** Waiting to fetch the image info */
+    AylaLANOTAJobStatePending = 0,
+    /** Fetching the image info from the cloud service */
+    AylaLANOTAJobStateFetchingImageInfo,
+    /** Waiting for the image file to be downloaded, possibly for another device */
+    AylaLANOTAJobStateDownloading,
+    /** Image file is available, waiting for a push slot */
+    AylaLANOTAJobStateQueued,
+    /** Image has been pushed, the device is fetching it */
+    AylaLANOTAJobStatePushing,
+    /** Device has reported the image push as done */
+    AylaLANOTAJobStateDone,
+    /** Update failed, see `error` */
+    AylaLANOTAJobStateFailed,
+    /** Update was cancelled */
+    AylaLANOTAJobStateCancelled,
+};
+
+/**
+ * Snapshot of the LAN OTA update of a device.
+ */
+@interface AylaLANOTAJob : NSObject<NSCopying>
+
+/** Device dsn */
+@property (nonatomic, strong, readonly) NSString *dsn;
+
+/** Device lan ip */
+@property (nonatomic, strong, readonly) NSString *lanIP;
+
+/** Current state of the update */
+@property (nonatomic, assign, readonly) AylaLANOTAJobState state;
+
+/** Version of the image being pushed, nil until the image info has been fetched */
+@property (nonatomic, strong, readonly, nullable) NSString *imageVersion;
+
+/** Error of a failed update */
+@property (nonatomic, strong, readonly, nullable) NSError *error;
+
+/** YES if the update is done, failed or cancelled */
+@property (nonatomic, assign, readonly, getter=isFinished) BOOL finished;
+
+@end
+
+/**
+ * Delegate of `AylaLANOTAManager`. Methods are called on the main queue.
+ */
+@protocol AylaLANOTAManagerDelegate<NSObject>
+
+/**
+ * Method called when the state of the update of a device changes.
+ *
+ * @param manager Current LAN OTA manager
+ * @param job     Snapshot of the update of the device
+ */
+- (void)lanOTAManager:(AylaLANOTAManager *)manager didUpdateJob:(AylaLANOTAJob *)job;
+
+@optional
+
+/**
+ * Method called once every update has finished.
+ *
+ * @param manager Current LAN OTA manager
+ */
+- (void)lanOTAManagerDidFinishAllJobs:(AylaLANOTAManager *)manager;
+
+@end
+
+/**
+ * Updates several devices over LAN at once.
+ *
+ * The image info is fetched for every device, and devices which are given the same image, identified by its checksum
+ * or else by its type, version and size, share a single download of it. Images are pushed to at most
+ * `maxConcurrentPushes` devices at the same time, all of them served by the shared LAN OTA server.
+ *
+ * Jobs are persisted in the OTA directory of the session. A manager created for the same session after the app has
+ * been relaunched restores them, and `resume` carries on with the unfinished ones, reusing already downloaded images.
+ */
+@interface AylaLANOTAManager : NSObject
+
+/** Maximum number of devices the image is pushed to at the same time. Defaults to 4. */
+@property (nonatomic, assign) NSUInteger maxConcurrentPushes;
+
+/** Time a device is given to fetch the image and report its status, in seconds. Defaults to 300. */
+@property (nonatomic, assign) NSTimeInterval pushTimeout;
+
+/** Delegate receiving updates of the jobs */
+@property (nonatomic, weak, nullable) id<AylaLANOTAManagerDelegate> delegate;
+
+/** Snapshots of all jobs, in the order the devices were added */
+@property (nonatomic, readonly) NSArray<AylaLANOTAJob *> *jobs;
+
+/**
+ * Init method. Restores the jobs persisted for the session without resuming them.
+ *
+ * @param sessionManager Session manager
+ */
+- (instancetype)initWithSessionManager:(AylaSessionManager *)sessionManager NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Adds devices to update and starts updating them. A device which already has an unfinished job keeps it, with its
+ * lan ip updated.
+ *
+ * @param lanIPsByDsn Lan ip of each device, keyed by dsn
+ */
+- (void)updateDevicesWithLanIPs:(NSDictionary<NSString *, NSString *> *)lanIPsByDsn;
+
+/**
+ * Resumes the unfinished jobs, e.g. the ones restored after the app has been relaunched.
+ */
+- (void)resume;
+
+/**
+ * Cancels the update of a device.
+ *
+ * @param dsn Device dsn
+ */
+- (void)cancelJobWithDsn:(NSString *)dsn;
+
+/**
+ * Cancels all unfinished updates.
+ */
+- (void)cancelAll;
+
+/**
+ * Removes the finished jobs.
+ */
+- (void)removeFinishedJobs;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,714 @@
+//
+//  iOS_AylaSDK
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDefines_Internal.h"
+#import "AylaErrorUtils.h"
+#import "AylaHTTPTask.h"
+#import "AylaLANOTADevice+Internal.h"
+#import "AylaLANOTADevice.h"
+#import "AylaLANOTAHTTPServer.h"
+#import "AylaLANOTAManager.h"
+#import "AylaOTAImageInfo.h"
+#import "AylaSessionManager.h"
+#import "AylaSystemUtils.h"
+#import "NSObject+Ayla.h"
+
+static NSString *const kAylaLANOTAJobsFileName = @"lanOTAJobs.json";
+static NSString *const kAylaLANOTASharedImagesDirectory = @"shared";
+
+static NSString *const kAylaLANOTAJobAttrNameDsn = @"dsn";
+static NSString *const kAylaLANOTAJobAttrNameLanIP = @"lanIP";
+static NSString *const kAylaLANOTAJobAttrNameState = @"state";
+static NSString *const kAylaLANOTAJobAttrNameImageVersion = @"imageVersion";
+static NSString *const kAylaLANOTAJobAttrNameError = @"error";
+
+static const NSUInteger AylaLANOTAManagerDefaultMaxConcurrentPushes = 4;
+static const NSTimeInterval AylaLANOTAManagerDefaultPushTimeout = 300.;
+
+@interface AylaLANOTAJob ()
+
+@property (nonatomic, strong, readwrite) NSString *dsn;
+@property (nonatomic, strong, readwrite) NSString *lanIP;
+@property (nonatomic, assign, readwrite) AylaLANOTAJobState state;
+@property (nonatomic, strong, readwrite, nullable) NSString *imageVersion;
+@property (nonatomic, strong, readwrite, nullable) NSError *error;
+
+/** Identifies the image of the job, images with the same key are downloaded once */
+@property (nonatomic, strong, nullable) NSString *imageKey;
+
+/** Incremented each time the image is pushed, so a stale push timeout can be told apart */
+@property (nonatomic, assign) NSUInteger pushGeneration;
+
+@end
+
+@implementation AylaLANOTAJob
+
+- (instancetype)initWithDsn:(NSString *)dsn lanIP:(NSString *)lanIP
+{
+    self = [super init];
+    if (!self) return nil;
+
+    _dsn = dsn;
+    _lanIP = lanIP;
+    _state = AylaLANOTAJobStatePending;
+
+    return self;
+}
+
+- (instancetype)initWithJSONDictionary:(NSDictionary *)dictionary
+{
+    NSString *dsn = AYLNilIfNull(dictionary[kAylaLANOTAJobAttrNameDsn]);
+    NSString *lanIP = AYLNilIfNull(dictionary[kAylaLANOTAJobAttrNameLanIP]);
+    if (![dsn isKindOfClass:[NSString class]] || ![lanIP isKindOfClass:[NSString class]]) {
+        return nil;
+    }
+
+    self = [self initWithDsn:dsn lanIP:lanIP];
+    if (!self) return nil;
+
+    _state = [AYLNilIfNull(dictionary[kAylaLANOTAJobAttrNameState]) integerValue];
+    _imageVersion = AYLNilIfNull(dictionary[kAylaLANOTAJobAttrNameImageVersion]);
+    NSString *errorDescription = AYLNilIfNull(dictionary[kAylaLANOTAJobAttrNameError]);
+    if (errorDescription) {
+        _error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                            code:AylaRequestErrorCodeUnknown
+                                        userInfo:@{NSLocalizedDescriptionKey : errorDescription}];
+    }
+
+    return self;
+}
+
+- (NSDictionary *)toJSONDictionary
+{
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
+    dictionary[kAylaLANOTAJobAttrNameDsn] = self.dsn;
+    dictionary[kAylaLANOTAJobAttrNameLanIP] = self.lanIP;
+    dictionary[kAylaLANOTAJobAttrNameState] = @(self.state);
+    dictionary[kAylaLANOTAJobAttrNameImageVersion] = self.imageVersion;
+    dictionary[kAylaLANOTAJobAttrNameError] = self.error.localizedDescription;
+    return dictionary;
+}
+
+- (BOOL)isFinished
+{
+    return self.state == AylaLANOTAJobStateDone || self.state == AylaLANOTAJobStateFailed ||
+           self.state == AylaLANOTAJobStateCancelled;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    AylaLANOTAJob *job = [[[self class] allocWithZone:zone] initWithDsn:self.dsn lanIP:self.lanIP];
+    job.state = self.state;
+    job.imageVersion = self.imageVersion;
+    job.error = self.error;
+    job.imageKey = self.imageKey;
+    job.pushGeneration = self.pushGeneration;
+    return job;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"{dsn:%@, lanIP:%@, state:%@, version:%@, error:%@}",
+                                      self.dsn,
+                                      self.lanIP,
+                                      @(self.state),
+                                      self.imageVersion,
+                                      self.error];
+}
+
+@end
+
+@interface AylaLANOTAManager ()<AylaLANOTADeviceDelegate>
+
+@property (nonatomic, weak) AylaSessionManager *sessionManager;
+@property (nonatomic, strong) dispatch_queue_t processingQueue;
+@property (nonatomic, strong) NSString *otaDirectory;
+
+/** Jobs keyed by dsn, and the order they were added in */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaLANOTAJob *> *jobsByDsn;
+@property (nonatomic, strong) NSMutableArray<NSString *> *dsns;
+
+/** LAN OTA devices of the unfinished jobs keyed by dsn */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaLANOTADevice *> *devices;
+
+/** Running request of each job keyed by dsn */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaHTTPTask *> *tasks;
+
+/** Dsns of the jobs waiting for each image being downloaded, keyed by image key. The first one downloads it. */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *downloadWaiters;
+
+/** Running download of each image keyed by image key, shared by all the waiters of the image */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AylaHTTPTask *> *downloadTasks;
+
+@property (nonatomic, assign) NSUInteger activePushes;
+
+@end
+
+@implementation AylaLANOTAManager
+
+- (instancetype)initWithSessionManager:(AylaSessionManager *)sessionManager
+{
+    AYLAssert(sessionManager, @"Session manager should not be nil");
+
+    self = [super init];
+    if (!self) return nil;
+
+    _sessionManager = sessionManager;
+    _maxConcurrentPushes = AylaLANOTAManagerDefaultMaxConcurrentPushes;
+    _pushTimeout = AylaLANOTAManagerDefaultPushTimeout;
+    _processingQueue = dispatch_queue_create("com.aylanetworks.lanOTAManager.queue.processing", DISPATCH_QUEUE_SERIAL);
+    _otaDirectory = [NSString
+        stringWithFormat:@"%@/ota", [AylaSystemUtils deviceArchivesPathForSession:sessionManager.sessionName]];
+    _jobsByDsn = [NSMutableDictionary dictionary];
+    _dsns = [NSMutableArray array];
+    _devices = [NSMutableDictionary dictionary];
+    _tasks = [NSMutableDictionary dictionary];
+    _downloadWaiters = [NSMutableDictionary dictionary];
+    _downloadTasks = [NSMutableDictionary dictionary];
+
+    [self restoreJobs];
+
+    return self;
+}
+
+#pragma mark - Public
+
+- (NSArray<AylaLANOTAJob *> *)jobs
+{
+    __block NSMutableArray *jobs = [NSMutableArray array];
+    dispatch_sync(self.processingQueue, ^{
+        for (NSString *dsn in self.dsns) {
+            [jobs addObject:[self.jobsByDsn[dsn] copy]];
+        }
+    });
+    return jobs;
+}
+
+- (void)updateDevicesWithLanIPs:(NSDictionary<NSString *, NSString *> *)lanIPsByDsn
+{
+    dispatch_async(self.processingQueue, ^{
+        for (NSString *dsn in lanIPsByDsn) {
+            AylaLANOTAJob *job = self.jobsByDsn[dsn];
+            if (job && !job.finished) {
+                job.lanIP = lanIPsByDsn[dsn];
+                continue;
+            }
+            if (!job) {
+                [self.dsns addObject:dsn];
+            }
+            self.jobsByDsn[dsn] = [[AylaLANOTAJob alloc] initWithDsn:dsn lanIP:lanIPsByDsn[dsn]];
+            [self notifyJobUpdated:self.jobsByDsn[dsn]];
+        }
+        [self persistJobs];
+        [self scheduleJobs];
+    });
+}
+
+- (void)resume
+{
+    dispatch_async(self.processingQueue, ^{
+        [self scheduleJobs];
+    });
+}
+
+- (void)cancelJobWithDsn:(NSString *)dsn
+{
+    dispatch_async(self.processingQueue, ^{
+        [self cancelJob:self.jobsByDsn[dsn]];
+        [self persistJobs];
+        [self scheduleJobs];
+    });
+}
+
+- (void)cancelAll
+{
+    dispatch_async(self.processingQueue, ^{
+        for (NSString *dsn in self.dsns) {
+            [self cancelJob:self.jobsByDsn[dsn]];
+        }
+        [self persistJobs];
+        [self scheduleJobs];
+    });
+}
+
+- (void)removeFinishedJobs
+{
+    dispatch_async(self.processingQueue, ^{
+        for (NSString *dsn in [self.dsns copy]) {
+            if (self.jobsByDsn[dsn].finished) {
+                [self.jobsByDsn removeObjectForKey:dsn];
+                [self.dsns removeObject:dsn];
+            }
+        }
+        [self persistJobs];
+    });
+}
+
+#pragma mark - Scheduling
+
+/**
+ * Starts the jobs which can make progress. Must be called on the processing queue.
+ */
+- (void)scheduleJobs
+{
+    BOOL hasUnfinishedJobs = NO;
+    for (NSString *dsn in self.dsns) {
+        AylaLANOTAJob *job = self.jobsByDsn[dsn];
+        switch (job.state) {
+            case AylaLANOTAJobStatePending:
+                [self fetchImageInfoForJob:job];
+                break;
+            case AylaLANOTAJobStateQueued:
+                if (self.activePushes < MAX(self.maxConcurrentPushes, 1)) {
+                    [self pushImageForJob:job];
+                }
+                break;
+            default:
+                break;
+        }
+        hasUnfinishedJobs = hasUnfinishedJobs || !job.finished;
+    }
+
+    if (!hasUnfinishedJobs && self.dsns.count > 0 && self.devices.count > 0) {
+        [self.devices removeAllObjects];
+        [self removeSharedImages];
+        AylaLogI([self logTag], 0, @"%@, %@", @"allJobsFinished", NSStringFromSelector(_cmd));
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if ([self.delegate respondsToSelector:@selector(lanOTAManagerDidFinishAllJobs:)]) {
+                [self.delegate lanOTAManagerDidFinishAllJobs:self];
+            }
+        });
+    }
+}
+
+- (AylaLANOTADevice *)deviceForJob:(AylaLANOTAJob *)job
+{
+    AylaLANOTADevice *device = self.devices[job.dsn];
+    if (!device || ![device.lanIP isEqualToString:job.lanIP]) {
+        AylaSessionManager *sessionManager = self.sessionManager;
+        if (!sessionManager) {
+            return nil;
+        }
+        device = [[AylaLANOTADevice alloc] initWithSessionManager:sessionManager DSN:job.dsn lanIP:job.lanIP];
+        device.delegate = self;
+        self.devices[job.dsn] = device;
+    }
+    return device;
+}
+
+- (void)fetchImageInfoForJob:(AylaLANOTAJob *)job
+{
+    AylaLANOTADevice *device = [self deviceForJob:job];
+    if (!device) {
+        [self failJob:job error:[self sessionManagerError]];
+        return;
+    }
+
+    [self updateJob:job state:AylaLANOTAJobStateFetchingImageInfo];
+    NSString *dsn = job.dsn;
+    self.tasks[dsn] = [device fetchOTAImageInfoWithSuccess:^(AylaOTAImageInfo *otaInfo) {
+        dispatch_async(self.processingQueue, ^{
+            AylaLANOTAJob *job = self.jobsByDsn[dsn];
+            if (job.state != AylaLANOTAJobStateFetchingImageInfo) {
+                return;
+            }
+            [self.tasks removeObjectForKey:dsn];
+            if (otaInfo.url == nil) {
+                NSError *error = [AylaErrorUtils
+                    errorWithDomain:AylaRequestErrorDomain
+                               code:AylaRequestErrorCodePreconditionFailure
+                           userInfo:@{
+                               AylaRequestErrorResponseJsonKey : @{@"imageInfo" : AylaErrorDescriptionCanNotBeFound}
+                           }];
+                [self failJob:job error:error];
+                [self scheduleJobs];
+                return;
+            }
+            [self prepareImage:otaInfo forJob:job];
+            [self scheduleJobs];
+        });
+    }
+        failure:^(NSError *_Nonnull error) {
+            dispatch_async(self.processingQueue, ^{
+                AylaLANOTAJob *job = self.jobsByDsn[dsn];
+                if (job.state != AylaLANOTAJobStateFetchingImageInfo) {
+                    return;
+                }
+                [self.tasks removeObjectForKey:dsn];
+                [self failJob:job error:error];
+                [self scheduleJobs];
+            });
+        }];
+}
+
+/**
+ * Makes the image available to the device of a job, downloading it only if neither the device already has it nor
+ * another job is downloading it.
+ */
+- (void)prepareImage:(AylaOTAImageInfo *)imageInfo forJob:(AylaLANOTAJob *)job
+{
+    AylaLANOTADevice *device = [self deviceForJob:job];
+    job.imageVersion = imageInfo.version;
+    job.imageKey = [self imageKeyWithImageInfo:imageInfo];
+
+    NSString *devicePath = [device generateFileNameWithImageInfo:imageInfo];
+    if ([[device getOTAFilePathIfExist] isEqualToString:devicePath]) {
+        // Downloaded before the app was relaunched
+        [self updateJob:job state:AylaLANOTAJobStateQueued];
+        return;
+    }
+
+    NSString *sharedPath = [self sharedImagePathForKey:job.imageKey];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:sharedPath]) {
+        [self linkSharedImage:imageInfo toJob:job];
+        return;
+    }
+
+    NSMutableArray<NSString *> *waiters = self.downloadWaiters[job.imageKey];
+    if (waiters) {
+        [waiters addObject:job.dsn];
+        [self updateJob:job state:AylaLANOTAJobStateDownloading];
+        return;
+    }
+
+    NSString *imageKey = job.imageKey;
+    NSString *dsn = job.dsn;
+    NSMutableArray<NSString *> *downloadWaiters = [NSMutableArray arrayWithObject:dsn];
+    self.downloadWaiters[imageKey] = downloadWaiters;
+    [self updateJob:job state:AylaLANOTAJobStateDownloading];
+    AylaLogI([self logTag], 0, @"download:%@, dsn:%@, %@", imageKey, dsn, NSStringFromSelector(_cmd));
+
+    self.downloadTasks[imageKey] = [device fetchOTAImageFile:imageInfo
+        progress:^(NSProgress *downloadProgress) {
+            AylaLogD([self logTag], 0, @"download:%@, progress:%@", imageKey, downloadProgress);
+        }
+        success:^{
+            dispatch_async(self.processingQueue, ^{
+                // The download was cancelled after all its waiters had been cancelled
+                if (self.downloadWaiters[imageKey] != downloadWaiters) {
+                    return;
+                }
+                [self.downloadTasks removeObjectForKey:imageKey];
+                NSArray<NSString *> *waiters = self.downloadWaiters[imageKey];
+                [self.downloadWaiters removeObjectForKey:imageKey];
+
+                NSError *error = nil;
+                NSString *downloadedPath = [device getOTAFilePathIfExist];
+                if (!downloadedPath || ![self linkItemAtPath:downloadedPath
+                                                      toPath:[self sharedImagePathForKey:imageKey]
+                                                       error:&error]) {
+                    AylaLogE([self logTag], 0, @"sharedImage:%@, err:%@", imageKey, error);
+                }
+
+                for (NSString *waiterDsn in waiters) {
+                    AylaLANOTAJob *waiter = self.jobsByDsn[waiterDsn];
+                    if (waiter.state != AylaLANOTAJobStateDownloading) {
+                        continue;
+                    }
+                    if ([waiterDsn isEqualToString:dsn]) {
+                        [self updateJob:waiter state:AylaLANOTAJobStateQueued];
+                    }
+                    else {
+                        [self linkSharedImage:imageInfo toJob:waiter];
+                    }
+                }
+                [self persistJobs];
+                [self scheduleJobs];
+            });
+        }
+        failure:^(NSError *_Nonnull error) {
+            dispatch_async(self.processingQueue, ^{
+                if (self.downloadWaiters[imageKey] != downloadWaiters) {
+                    return;
+                }
+                [self.downloadTasks removeObjectForKey:imageKey];
+                NSArray<NSString *> *waiters = self.downloadWaiters[imageKey];
+                [self.downloadWaiters removeObjectForKey:imageKey];
+                for (NSString *waiterDsn in waiters) {
+                    AylaLANOTAJob *waiter = self.jobsByDsn[waiterDsn];
+                    if (waiter.state == AylaLANOTAJobStateDownloading) {
+                        [self failJob:waiter error:error];
+                    }
+                }
+                [self scheduleJobs];
+            });
+        }];
+}
+
+/**
+ * Gives the device of a job its own link to the shared copy of an image, which is where the device expects it. The
+ * cloud is told whether the device got the image, and that it got it from the shared copy rather than a download.
+ */
+- (void)linkSharedImage:(AylaOTAImageInfo *)imageInfo toJob:(AylaLANOTAJob *)job
+{
+    AylaLANOTADevice *device = [self deviceForJob:job];
+    [device deleteOTAFile];
+
+    NSError *error = nil;
+    if (![self linkItemAtPath:[self sharedImagePathForKey:job.imageKey]
+                       toPath:[device generateFileNameWithImageInfo:imageInfo]
+                        error:&error]) {
+        [device notifyStatus:NO reason:@"shared image link failure"];
+        [self failJob:job error:error];
+        return;
+    }
+    [device notifyStatus:YES reason:@"shared image"];
+    [self updateJob:job state:AylaLANOTAJobStateQueued];
+}
+
+- (void)pushImageForJob:(AylaLANOTAJob *)job
+{
+    AylaLANOTADevice *device = [self deviceForJob:job];
+    if (!device) {
+        [self failJob:job error:[self sessionManagerError]];
+        return;
+    }
+
+    self.activePushes++;
+    job.pushGeneration++;
+    [self updateJob:job state:AylaLANOTAJobStatePushing];
+
+    NSString *dsn = job.dsn;
+    NSUInteger pushGeneration = job.pushGeneration;
+    // The push request has to be sent from the main queue, the queue the device reports to
+    dispatch_async(dispatch_get_main_queue(), ^{
+        AylaHTTPTask *task = [device pushOTAImageToDeviceWithSuccess:^{
+            AylaLogI([self logTag], 0, @"pushed:%@, %@", dsn, NSStringFromSelector(_cmd));
+        }
+            failure:^(NSError *_Nonnull error) {
+                dispatch_async(self.processingQueue, ^{
+                    AylaLANOTAJob *job = self.jobsByDsn[dsn];
+                    if (job.pushGeneration == pushGeneration) {
+                        [self finishPushOfJob:job error:error];
+                    }
+                });
+            }];
+        if (task) {
+            dispatch_async(self.processingQueue, ^{
+                if (self.jobsByDsn[dsn].state == AylaLANOTAJobStatePushing) {
+                    self.tasks[dsn] = task;
+                }
+            });
+        }
+    });
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.pushTimeout * NSEC_PER_SEC)), self.processingQueue, ^{
+        AylaLANOTAJob *job = self.jobsByDsn[dsn];
+        if (job.state == AylaLANOTAJobStatePushing && job.pushGeneration == pushGeneration) {
+            NSError *error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                                        code:AylaRequestErrorCodeTimedOut
+                                                    userInfo:nil];
+            [self finishPushOfJob:job error:error];
+        }
+    });
+}
+
+/**
+ * Frees the push slot of a job and records its outcome.
+ */
+- (void)finishPushOfJob:(AylaLANOTAJob *)job error:(NSError *)error
+{
+    if (job.state != AylaLANOTAJobStatePushing) {
+        return;
+    }
+    self.activePushes--;
+    [self.tasks removeObjectForKey:job.dsn];
+
+    if (error) {
+        [[AylaLANOTAHTTPServer sharedServer] stopServingHost:job.lanIP];
+        [self failJob:job error:error];
+    }
+    else {
+        [self updateJob:job state:AylaLANOTAJobStateDone];
+    }
+    [self scheduleJobs];
+}
+
+- (void)cancelJob:(AylaLANOTAJob *)job
+{
+    if (!job || job.finished) {
+        return;
+    }
+    [self.tasks[job.dsn] cancel];
+    [self.tasks removeObjectForKey:job.dsn];
+
+    if (job.state == AylaLANOTAJobStatePushing) {
+        self.activePushes--;
+        [[AylaLANOTAHTTPServer sharedServer] stopServingHost:job.lanIP];
+    }
+    else if (job.state == AylaLANOTAJobStateDownloading && job.imageKey) {
+        // The download is shared by all the jobs waiting for the image, it is left running if any remains
+        NSMutableArray<NSString *> *waiters = self.downloadWaiters[job.imageKey];
+        [waiters removeObject:job.dsn];
+        if (waiters.count == 0) {
+            [self.downloadWaiters removeObjectForKey:job.imageKey];
+            [self.downloadTasks[job.imageKey] cancel];
+            [self.downloadTasks removeObjectForKey:job.imageKey];
+        }
+    }
+
+    job.error = [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain code:AylaRequestErrorCodeCancelled userInfo:nil];
+    [self updateJob:job state:AylaLANOTAJobStateCancelled];
+}
+
+- (void)failJob:(AylaLANOTAJob *)job error:(NSError *)error
+{
+    AylaLogE([self logTag], 0, @"dsn:%@, err:%@, %@", job.dsn, error, NSStringFromSelector(_cmd));
+    job.error = error;
+    [self updateJob:job state:AylaLANOTAJobStateFailed];
+}
+
+- (void)updateJob:(AylaLANOTAJob *)job state:(AylaLANOTAJobState)state
+{
+    if (state != AylaLANOTAJobStateFailed && state != AylaLANOTAJobStateCancelled) {
+        job.error = nil;
+    }
+    job.state = state;
+    AylaLogD([self logTag], 0, @"job:%@, %@", job, NSStringFromSelector(_cmd));
+    [self persistJobs];
+    [self notifyJobUpdated:job];
+}
+
+- (void)notifyJobUpdated:(AylaLANOTAJob *)job
+{
+    AylaLANOTAJob *snapshot = [job copy];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self.delegate lanOTAManager:self didUpdateJob:snapshot];
+    });
+}
+
+#pragma mark - AylaLANOTADeviceDelegate
+
+- (void)lanOTADevice:(AylaLANOTADevice *)device didUpdateImagePushStatus:(ImagePushStatus)status
+{
+    dispatch_async(self.processingQueue, ^{
+        AylaLANOTAJob *job = self.jobsByDsn[device.dsn];
+        if (self.devices[device.dsn] != device) {
+            return;
+        }
+        switch (status) {
+            case ImagePushStatusInitial:
+                break;
+            case ImagePushStatusDone:
+                [self finishPushOfJob:job error:nil];
+                break;
+            default: {
+                NSError *error = [AylaErrorUtils
+                    errorWithDomain:AylaLanErrorDomain
+                               code:AylaRequestErrorCodeInvalidArguments
+                           userInfo:@{
+                               AylaLanErrorResponseJsonKey : @{@"imagePushStatus" : @(status)}
+                           }];
+                [self finishPushOfJob:job error:error];
+                break;
+            }
+        }
+    });
+}
+
+#pragma mark - Storage
+
+- (NSString *)imageKeyWithImageInfo:(AylaOTAImageInfo *)imageInfo
+{
+    NSString *key = imageInfo.checksum.lowercaseString;
+    if (!key) {
+        key = [NSString stringWithFormat:@"%@-%@-%@", imageInfo.type, imageInfo.version, imageInfo.size];
+    }
+    NSCharacterSet *invalidCharacters = [[NSCharacterSet alphanumericCharacterSet] invertedSet];
+    return [[key componentsSeparatedByCharactersInSet:invalidCharacters] componentsJoinedByString:@"_"];
+}
+
+- (NSString *)sharedImagePathForKey:(NSString *)imageKey
+{
+    return [[self.otaDirectory stringByAppendingPathComponent:kAylaLANOTASharedImagesDirectory]
+        stringByAppendingPathComponent:[imageKey stringByAppendingPathExtension:@"img"]];
+}
+
+/**
+ * Hard links a file, which costs no space and keeps the content when either path is removed. Falls back to a copy.
+ */
+- (BOOL)linkItemAtPath:(NSString *)path toPath:(NSString *)toPath error:(NSError *__autoreleasing *)error
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    [fileManager createDirectoryAtPath:[toPath stringByDeletingLastPathComponent]
+           withIntermediateDirectories:YES
+                            attributes:nil
+                                 error:nil];
+    [fileManager removeItemAtPath:toPath error:nil];
+    return [fileManager linkItemAtPath:path toPath:toPath error:nil] ||
+           [fileManager copyItemAtPath:path toPath:toPath error:error];
+}
+
+- (void)removeSharedImages
+{
+    [[NSFileManager defaultManager]
+        removeItemAtPath:[self.otaDirectory stringByAppendingPathComponent:kAylaLANOTASharedImagesDirectory]
+                   error:nil];
+}
+
+- (NSString *)jobsFilePath
+{
+    return [self.otaDirectory stringByAppendingPathComponent:kAylaLANOTAJobsFileName];
+}
+
+- (void)persistJobs
+{
+    NSMutableArray *jobs = [NSMutableArray array];
+    for (NSString *dsn in self.dsns) {
+        [jobs addObject:[self.jobsByDsn[dsn] toJSONDictionary]];
+    }
+
+    NSError *error = nil;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:jobs options:0 error:&error];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.otaDirectory
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+    if (!data || ![data writeToFile:[self jobsFilePath] options:NSDataWritingAtomic error:&error]) {
+        AylaLogE([self logTag], 0, @"err:%@, %@", error, NSStringFromSelector(_cmd));
+    }
+}
+
+- (void)restoreJobs
+{
+    NSData *data = [NSData dataWithContentsOfFile:[self jobsFilePath]];
+    if (!data) {
+        return;
+    }
+    NSArray *jobs = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (![jobs isKindOfClass:[NSArray class]]) {
+        return;
+    }
+
+    for (NSDictionary *dictionary in jobs) {
+        AylaLANOTAJob *job =
+            [dictionary isKindOfClass:[NSDictionary class]] ? [[AylaLANOTAJob alloc] initWithJSONDictionary:dictionary] : nil;
+        if (!job || self.jobsByDsn[job.dsn]) {
+            continue;
+        }
+        // Requests did not survive the relaunch, unfinished jobs start over and pick up downloaded images
+        if (!job.finished) {
+            job.state = AylaLANOTAJobStatePending;
+        }
+        self.jobsByDsn[job.dsn] = job;
+        [self.dsns addObject:job.dsn];
+    }
+    AylaLogI([self logTag], 0, @"restored:%@, %@", @(self.dsns.count), NSStringFromSelector(_cmd));
+}
+
+- (NSError *)sessionManagerError
+{
+    return [AylaErrorUtils errorWithDomain:AylaRequestErrorDomain
+                                      code:AylaRequestErrorCodePreconditionFailure
+                                  userInfo:@{AylaRequestErrorResponseJsonKey : @{@"sessionManager" : AylaErrorDescriptionCanNotBeFound}}];
+}
+
+- (NSString *)logTag
+{
+    return @"LANOTAManager";
+}
+
+@end
@@ -39,6 +39,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy, readonly) NSNumber *size;
 
+/**
+ * Hex encoded MD5 or SHA-256 checksum of the image file, if provided by the service.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *checksum;
+
 /**
  * Get an new object with given data
  *
@@ -18,6 +18,7 @@ static NSString *const kAylaOTAAttrNameVersion   = @"version";
 static NSString *const kAylaOTAAttrNameLocation  = @"location";
 static NSString *const kAylaOTAAttrNameType      = @"type";
 static NSString *const kAylaOTAAttrNameSize      = @"size";
+static NSString *const kAylaOTAAttrNameChecksum  = @"checksum";
 
 @implementation AylaOTAImageInfo
 
@@ -34,6 +35,7 @@ static NSString *const kAylaOTAAttrNameSize      = @"size";
             _location = AYLNilIfNull(otaDict[kAylaOTAAttrNameLocation]);
             _type = AYLNilIfNull(otaDict[kAylaOTAAttrNameType]);
             _size = AYLNilIfNull(otaDict[kAylaOTAAttrNameSize]);
+            _checksum = AYLNilIfNull(otaDict[kAylaOTAAttrNameChecksum]);
         }
     }
     
@@ -42,6 +44,6 @@ static NSString *const kAylaOTAAttrNameSize      = @"size";
 
 - (NSString *)description
 {
-    return [NSString stringWithFormat:@"{url:%@, version:%@, location:%@, type:%@, size:%@}", self.url, self.version, self.location, self.type, self.size];
+    return [NSString stringWithFormat:@"{url:%@, version:%@, location:%@, type:%@, size:%@, checksum:%@}", self.url, self.version, self.location, self.type, self.size, self.checksum];
 }
 @end
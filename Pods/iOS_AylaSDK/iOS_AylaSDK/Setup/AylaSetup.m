@@ -34,12 +34,6 @@
 typedef void (^ConnectSuccessBlock)(AylaSetupDevice *setupDevice);
 typedef void (^ConnectFailureBlock)(NSError *error);
 
-/** Default public key tag for wifi setup crypto */
-static NSString *const DEFAULT_KEY_CRYPTO_PUBLIC_KEY = @"com.aylanetworks.setup.crypto.publicKey";
-
-/** Default private key tag for wifi setup crypto */
-static NSString *const DEFAULT_KEY_CRYPTO_PRIVATE_KEY = @"com.aylanetworks.setup.crypto.privateKey";
-
 /** Default interval of confirm poll */
 static const NSTimeInterval DEFAULT_CONFIRM_POLL_TIME_INTERVAL = 1.;
 
@@ -315,8 +309,8 @@ static void handleCancelledTask(dispatch_queue_t queue, void (^failureBlock)(NSE
     AylaLanConfig *config = [[AylaLanConfig alloc] initWithJSONDictionary:@{} error:nil];
 
     // Set tags of keys in key pair.
-    config.keyPairPublicKeyTag = DEFAULT_KEY_CRYPTO_PUBLIC_KEY;
-    config.keyPairPrivateKeyTag = DEFAULT_KEY_CRYPTO_PRIVATE_KEY;
+    config.keyPairPublicKeyTag = AylaKeyCryptoSetupPublicKeyTag;
+    config.keyPairPrivateKeyTag = AylaKeyCryptoSetupPrivateKeyTag;
 
     [device startLanSessionOnHttpServer:self.httpServer usingLanConfig:config];
 
@@ -0,0 +1,276 @@
+//
+//  AylaBLEConnectionSchedulerTests.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+@import CoreBluetooth;
+@import iOS_AylaSDK;
+
+/**
+ Central recording the connections the scheduler makes through it
+ */
+@interface AylaFakeBLECentral : NSObject <AylaBLECentral>
+@property (nonatomic, strong) NSMutableArray<CBPeripheral *> *connectedPeripherals;
+@property (nonatomic, strong) NSMutableArray<CBPeripheral *> *cancelledPeripherals;
+@end
+
+@implementation AylaFakeBLECentral
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _connectedPeripherals = [NSMutableArray array];
+        _cancelledPeripherals = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)connectPeripheral:(CBPeripheral *)peripheral options:(NSDictionary<NSString *, id> *)options {
+    [self.connectedPeripherals addObject:peripheral];
+}
+
+- (void)cancelPeripheralConnection:(CBPeripheral *)peripheral {
+    [self.cancelledPeripherals addObject:peripheral];
+}
+
+@end
+
+/**
+ Stands in for a `CBPeripheral`, the scheduler only reads the identifier of peripherals
+ */
+@interface AylaFakeBLEPeripheral : NSObject
+@property (nonatomic, strong) NSUUID *identifier;
+@end
+
+@implementation AylaFakeBLEPeripheral
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _identifier = [NSUUID UUID];
+    }
+    return self;
+}
+
+@end
+
+@interface AylaBLEConnectionSchedulerTests : XCTestCase
+@property (nonatomic, strong) AylaFakeBLECentral *central;
+@property (nonatomic, strong) AylaBLEConnectionScheduler *scheduler;
+@end
+
+@implementation AylaBLEConnectionSchedulerTests
+
+- (void)setUp {
+    [super setUp];
+    self.central = [[AylaFakeBLECentral alloc] init];
+    self.scheduler = [[AylaBLEConnectionScheduler alloc] initWithCentral:self.central];
+    self.scheduler.maxConcurrentConnections = 1;
+}
+
+- (void)tearDown {
+    self.scheduler = nil;
+    self.central = nil;
+    [super tearDown];
+}
+
+- (CBPeripheral *)peripheral {
+    return (CBPeripheral *)[[AylaFakeBLEPeripheral alloc] init];
+}
+
+- (void)waitFor:(NSTimeInterval)delay {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Waited"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:delay + 5 handler:nil];
+}
+
+- (void)testDefaultMaxConcurrentConnections {
+    AylaBLEConnectionScheduler *scheduler = [[AylaBLEConnectionScheduler alloc] initWithCentral:self.central];
+    XCTAssertEqual(scheduler.maxConcurrentConnections, AylaBLEConnectionSchedulerDefaultMaxConcurrentConnections);
+}
+
+- (void)testConnectionsAreCapped {
+    self.scheduler.maxConcurrentConnections = 2;
+    for (NSUInteger i = 0; i < 4; i++) {
+        XCTAssertTrue([self.scheduler scheduleConnectionToPeripheral:[self peripheral] rssi:-50]);
+    }
+
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 2);
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 2);
+    XCTAssertEqual(self.central.connectedPeripherals.count, 2);
+}
+
+- (void)testStrongestSignalIsConnectedFirst {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *weak = [self peripheral];
+    CBPeripheral *strong = [self peripheral];
+    CBPeripheral *medium = [self peripheral];
+
+    // The first peripheral takes the free slot, the others wait
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-90];
+    [self.scheduler scheduleConnectionToPeripheral:weak rssi:-80];
+    [self.scheduler scheduleConnectionToPeripheral:strong rssi:-40];
+    [self.scheduler scheduleConnectionToPeripheral:medium rssi:-60];
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+    [self.scheduler peripheralDidFinishConnecting:strong];
+    [self.scheduler peripheralDidFinishConnecting:medium];
+
+    NSArray *expected = @[ first, strong, medium, weak ];
+    XCTAssertEqualObjects(self.central.connectedPeripherals, expected);
+}
+
+- (void)testUnavailableRSSIIsConnectedLast {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *unavailable = [self peripheral];
+    CBPeripheral *weak = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:unavailable rssi:127];
+    [self.scheduler scheduleConnectionToPeripheral:weak rssi:-100];
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+    [self.scheduler peripheralDidFinishConnecting:weak];
+
+    NSArray *expected = @[ first, weak, unavailable ];
+    XCTAssertEqualObjects(self.central.connectedPeripherals, expected);
+}
+
+- (void)testEqualRSSIsAreConnectedInOrder {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *second = [self peripheral];
+    CBPeripheral *third = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-60];
+    [self.scheduler scheduleConnectionToPeripheral:second rssi:-60];
+    [self.scheduler scheduleConnectionToPeripheral:third rssi:-60];
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+    [self.scheduler peripheralDidFinishConnecting:second];
+
+    NSArray *expected = @[ first, second, third ];
+    XCTAssertEqualObjects(self.central.connectedPeripherals, expected);
+}
+
+- (void)testUpdatedRSSIChangesOrder {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *strong = [self peripheral];
+    CBPeripheral *weak = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:strong rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:weak rssi:-90];
+    [self.scheduler updateRSSI:-30 forPeripheralWithIdentifier:weak.identifier];
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+
+    XCTAssertEqualObjects(self.central.connectedPeripherals.lastObject, weak);
+}
+
+- (void)testRescheduledPendingPeripheralIsUpdated {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *strong = [self peripheral];
+    CBPeripheral *weak = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:strong rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:weak rssi:-90];
+    XCTAssertTrue([self.scheduler scheduleConnectionToPeripheral:weak rssi:-30]);
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 2);
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+
+    XCTAssertEqualObjects(self.central.connectedPeripherals.lastObject, weak);
+}
+
+- (void)testActivePeripheralIsNotRescheduled {
+    CBPeripheral *peripheral = [self peripheral];
+
+    XCTAssertTrue([self.scheduler scheduleConnectionToPeripheral:peripheral rssi:-50]);
+    XCTAssertFalse([self.scheduler scheduleConnectionToPeripheral:peripheral rssi:-50]);
+
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 1);
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 0);
+    XCTAssertEqual(self.central.connectedPeripherals.count, 1);
+}
+
+- (void)testFinishedConnectionFreesItsSlot {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *second = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:second rssi:-50];
+    XCTAssertEqual(self.central.connectedPeripherals.count, 1);
+
+    [self.scheduler peripheralDidFinishConnecting:first];
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 1);
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 0);
+    XCTAssertEqualObjects(self.central.connectedPeripherals.lastObject, second);
+
+    [self.scheduler peripheralDidFinishConnecting:second];
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 0);
+    XCTAssertEqual(self.central.cancelledPeripherals.count, 0);
+}
+
+- (void)testTimedOutConnectionIsCancelled {
+    self.scheduler.connectionTimeout = 0.1;
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *second = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:second rssi:-50];
+
+    // The second attempt starts once the first times out, then times out too
+    [self waitFor:0.5];
+
+    NSArray *expected = @[ first, second ];
+    XCTAssertEqualObjects(self.central.connectedPeripherals, expected);
+    XCTAssertEqualObjects(self.central.cancelledPeripherals, expected);
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 0);
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 0);
+}
+
+- (void)testHandedOverConnectionIsNotCancelled {
+    self.scheduler.connectionTimeout = 0.1;
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *second = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:second rssi:-50];
+    [self.scheduler handOverConnectionWithIdentifier:first.identifier];
+
+    XCTAssertEqualObjects(self.central.connectedPeripherals.lastObject, second);
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 1);
+
+    // Only the attempt still owned by the scheduler times out
+    [self.scheduler peripheralDidFinishConnecting:second];
+    [self waitFor:0.3];
+    XCTAssertEqual(self.central.cancelledPeripherals.count, 0);
+}
+
+- (void)testCancelPendingConnections {
+    CBPeripheral *first = [self peripheral];
+    CBPeripheral *second = [self peripheral];
+    CBPeripheral *third = [self peripheral];
+
+    [self.scheduler scheduleConnectionToPeripheral:first rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:second rssi:-50];
+    [self.scheduler scheduleConnectionToPeripheral:third rssi:-50];
+    [self.scheduler cancelPendingConnectionWithIdentifier:second.identifier];
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 1);
+
+    [self.scheduler cancelPendingConnections];
+    XCTAssertEqual(self.scheduler.numberOfPendingConnections, 0);
+
+    // The attempt in flight is left to complete
+    XCTAssertEqual(self.scheduler.numberOfActiveConnections, 1);
+    [self.scheduler peripheralDidFinishConnecting:first];
+    XCTAssertEqualObjects(self.central.connectedPeripherals, @[ first ]);
+    XCTAssertEqual(self.central.cancelledPeripherals.count, 0);
+}
+
+@end
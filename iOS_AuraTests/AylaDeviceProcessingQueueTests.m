@@ -0,0 +1,158 @@
+//
+//  AylaDeviceProcessingQueueTests.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "AylaDeviceTestFixtures.h"
+
+@import iOS_AylaSDK;
+
+/** Number of property updates processed in each run, whatever the number of devices they are spread over */
+static const NSUInteger AylaProcessingQueueTestsUpdateCount = 400;
+
+/** Number of properties in each update */
+static const NSUInteger AylaProcessingQueueTestsPropertyCount = 50;
+
+/** Time a device waits for the processing of another device to start, in seconds */
+static const NSTimeInterval AylaProcessingQueueTestsOverlapTimeout = 10;
+
+@interface AylaDeviceProcessingQueueTests : XCTestCase
+/** Properties response of a device, as received from the cloud */
+@property (nonatomic, strong) NSData *propertiesResponse;
+@end
+
+@implementation AylaDeviceProcessingQueueTests
+
+- (void)setUp {
+    [super setUp];
+    self.propertiesResponse =
+        [AylaDeviceTestFixtures propertiesResponseWithCount:AylaProcessingQueueTestsPropertyCount];
+}
+
+- (NSArray<AylaDevice *> *)devicesWithCount:(NSUInteger)count {
+    NSMutableArray *devices = [NSMutableArray array];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *dsn = [NSString stringWithFormat:@"AC000W%09lu", (unsigned long)i];
+        NSDictionary *dictionary = [AylaDeviceTestFixtures deviceDictionaryWithDsn:dsn];
+        [devices addObject:[[AylaDevice alloc] initWithDeviceManager:nil JSONDictionary:dictionary error:nil]];
+    }
+    return devices;
+}
+
+/** Parses the properties response and updates the device with it, the way a properties fetch does */
+- (void)processPropertiesResponseForDevice:(AylaDevice *)device {
+    [device updateProperties:[AylaDeviceTestFixtures propertiesFromResponse:self.propertiesResponse]];
+}
+
+/**
+ Processes `AylaProcessingQueueTestsUpdateCount` updates spread evenly over the devices, each on the processing queue
+ of its device, and waits for them to complete.
+ */
+- (void)processUpdatesOnDevices:(NSArray<AylaDevice *> *)devices {
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger i = 0; i < AylaProcessingQueueTestsUpdateCount; i++) {
+        AylaDevice *device = devices[i % devices.count];
+        dispatch_group_async(group, device.processingQueue, ^{
+            @autoreleasepool {
+                [self processPropertiesResponseForDevice:device];
+            }
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+}
+
+- (void)testDevicesHaveTheirOwnQueue {
+    NSArray<AylaDevice *> *devices = [self devicesWithCount:2];
+
+    XCTAssertNotNil(devices[0].processingQueue);
+    XCTAssertEqual(devices[0].processingQueue, devices[0].processingQueue);
+    XCTAssertNotEqual(devices[0].processingQueue, devices[1].processingQueue);
+}
+
+- (void)testNodesShareTheQueueOfTheirGateway {
+    AylaDevice *gateway = [self devicesWithCount:1].firstObject;
+    NSDictionary *nodeDictionary = @{
+        @"dsn" : @"VD000W000000001",
+        @"device_type" : @"Node",
+        @"gateway_dsn" : gateway.dsn
+    };
+    AylaDeviceNode *node = [[AylaDeviceNode alloc] initWithDeviceManager:nil JSONDictionary:nodeDictionary error:nil];
+
+    XCTAssertEqual(node.processingQueue, gateway.processingQueue);
+}
+
+- (void)testUpdatesOfADeviceKeepTheirOrder {
+    NSArray<AylaDevice *> *devices = [self devicesWithCount:8];
+    NSMutableArray<NSMutableArray *> *processedUpdates = [NSMutableArray array];
+    for (NSUInteger i = 0; i < devices.count; i++) {
+        [processedUpdates addObject:[NSMutableArray array]];
+    }
+
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger i = 0; i < AylaProcessingQueueTestsUpdateCount; i++) {
+        NSUInteger deviceIndex = i % devices.count;
+        // Only the queue of the device touches its array
+        NSMutableArray *updatesOfDevice = processedUpdates[deviceIndex];
+        dispatch_group_async(group, devices[deviceIndex].processingQueue, ^{
+            @autoreleasepool {
+                [self processPropertiesResponseForDevice:devices[deviceIndex]];
+            }
+            [updatesOfDevice addObject:@(i)];
+        });
+    }
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 60 * NSEC_PER_SEC)), 0L);
+
+    for (NSUInteger deviceIndex = 0; deviceIndex < devices.count; deviceIndex++) {
+        NSArray *updatesOfDevice = processedUpdates[deviceIndex];
+        XCTAssertEqual(updatesOfDevice.count, AylaProcessingQueueTestsUpdateCount / devices.count);
+        for (NSUInteger i = 1; i < updatesOfDevice.count; i++) {
+            XCTAssertLessThan([updatesOfDevice[i - 1] unsignedIntegerValue], [updatesOfDevice[i] unsignedIntegerValue]);
+        }
+    }
+}
+
+- (void)testDevicesAreProcessedInParallel {
+    NSArray<AylaDevice *> *devices = [self devicesWithCount:2];
+    dispatch_semaphore_t firstStarted = dispatch_semaphore_create(0);
+    dispatch_semaphore_t secondStarted = dispatch_semaphore_create(0);
+    dispatch_time_t (^deadline)(void) = ^{
+        return dispatch_time(DISPATCH_TIME_NOW, (int64_t)(AylaProcessingQueueTestsOverlapTimeout * NSEC_PER_SEC));
+    };
+
+    // Each block waits for the other one to start, which only happens if they run at the same time
+    __block long firstWait = -1;
+    __block long secondWait = -1;
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_async(group, devices[0].processingQueue, ^{
+        dispatch_semaphore_signal(firstStarted);
+        firstWait = dispatch_semaphore_wait(secondStarted, deadline());
+    });
+    dispatch_group_async(group, devices[1].processingQueue, ^{
+        dispatch_semaphore_signal(secondStarted);
+        secondWait = dispatch_semaphore_wait(firstStarted, deadline());
+    });
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    XCTAssertEqual(firstWait, 0L);
+    XCTAssertEqual(secondWait, 0L);
+}
+
+- (void)testPerformanceOfProcessingOnOneDevice {
+    NSArray<AylaDevice *> *devices = [self devicesWithCount:1];
+    [self measureBlock:^{
+        [self processUpdatesOnDevices:devices];
+    }];
+}
+
+- (void)testPerformanceOfProcessingOnOneDevicePerCore {
+    NSArray<AylaDevice *> *devices = [self devicesWithCount:[NSProcessInfo processInfo].activeProcessorCount];
+    [self measureBlock:^{
+        [self processUpdatesOnDevices:devices];
+    }];
+}
+
+@end
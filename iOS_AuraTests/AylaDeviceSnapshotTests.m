@@ -0,0 +1,133 @@
+//
+//  AylaDeviceSnapshotTests.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "AylaDeviceTestFixtures.h"
+
+@import iOS_AylaSDK;
+
+/** Number of properties of the device the snapshots are taken of */
+static const NSUInteger AylaSnapshotTestsPropertyCount = 50;
+
+/** Number of snapshots taken in each measured block */
+static const NSUInteger AylaSnapshotTestsIterations = 200;
+
+@interface AylaDeviceSnapshotTests : XCTestCase
+@property (nonatomic, strong) AylaDevice *device;
+@property (nonatomic, strong) NSArray<NSDictionary *> *propertyDictionaries;
+@end
+
+@implementation AylaDeviceSnapshotTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.propertyDictionaries = [AylaDeviceTestFixtures propertyDictionariesWithCount:AylaSnapshotTestsPropertyCount];
+    self.device = [self deviceFromJSONDictionary:@{
+        @"key" : @42,
+        @"dsn" : @"AC000W000000001",
+        @"product_name" : @"Snapshot test device",
+        @"model" : @"AY001MUX1",
+        @"oem_model" : @"ledevb",
+        @"device_type" : @"Wifi",
+        @"connection_status" : @"Online",
+        @"lan_ip" : @"192.168.0.2",
+        @"mac" : @"aabbccddeeff",
+        @"sw_version" : @"bc 1.9"
+    }];
+}
+
+- (AylaDevice *)deviceFromJSONDictionary:(NSDictionary *)dictionary {
+    return [AylaDeviceTestFixtures deviceWithJSONDictionary:dictionary propertyDictionaries:self.propertyDictionaries];
+}
+
+/** Snapshot the way devices were copied before `snapshot`: a round trip through their JSON representation */
+- (AylaDevice *)JSONRoundTripOfDevice:(AylaDevice *)device {
+    return [self deviceFromJSONDictionary:[device toJSONDictionary]];
+}
+
+- (void)testSnapshotCopiesFieldsAndProperties {
+    AylaDevice *snapshot = [self.device snapshot];
+
+    XCTAssertNotEqual(snapshot, self.device);
+    XCTAssertEqualObjects(snapshot.key, self.device.key);
+    XCTAssertEqualObjects(snapshot.dsn, self.device.dsn);
+    XCTAssertEqualObjects(snapshot.productName, self.device.productName);
+    XCTAssertEqualObjects(snapshot.connectionStatus, self.device.connectionStatus);
+    XCTAssertEqualObjects(snapshot.lanIp, self.device.lanIp);
+    XCTAssertEqual(snapshot.properties.count, AylaSnapshotTestsPropertyCount);
+
+    for (NSString *name in self.device.properties) {
+        AylaProperty *property = self.device.properties[name];
+        AylaProperty *propertySnapshot = snapshot.properties[name];
+        XCTAssertNotEqual(propertySnapshot, property);
+        XCTAssertEqual(propertySnapshot.device, snapshot);
+        XCTAssertEqualObjects(propertySnapshot.name, property.name);
+        XCTAssertEqualObjects(propertySnapshot.baseType, property.baseType);
+        XCTAssertEqualObjects(propertySnapshot.direction, property.direction);
+        XCTAssertEqualObjects(propertySnapshot.dataUpdatedAt, property.dataUpdatedAt);
+        XCTAssertEqualObjects(propertySnapshot.value, property.value);
+    }
+}
+
+- (void)testSnapshotIsNotAffectedByLaterUpdates {
+    AylaDevice *snapshot = [self.device snapshot];
+    NSString *name = self.propertyDictionaries.firstObject[@"name"];
+    AylaProperty *property = self.device.properties[name];
+    AylaProperty *propertySnapshot = snapshot.properties[name];
+    id valueBeforeUpdate = property.value;
+
+    NSMutableDictionary *updatedDictionary = [self.propertyDictionaries.firstObject mutableCopy];
+    updatedDictionary[@"value"] = @12345;
+    updatedDictionary[@"data_updated_at"] = @"2016-11-03T10:20:30Z";
+    [self.device updateProperties:@[ [[AylaProperty alloc] initWithJSONDictionary:updatedDictionary error:nil] ]];
+
+    XCTAssertEqualObjects(property.value, @12345);
+    XCTAssertEqualObjects(propertySnapshot.value, valueBeforeUpdate);
+    XCTAssertNotEqual(snapshot.properties, self.device.properties);
+}
+
+- (void)testPerformanceOfSnapshot {
+    AylaDevice *device = self.device;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < AylaSnapshotTestsIterations; i++) {
+            @autoreleasepool {
+                [device snapshot];
+            }
+        }
+    }];
+}
+
+- (void)testPerformanceOfJSONRoundTrip {
+    AylaDevice *device = self.device;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < AylaSnapshotTestsIterations; i++) {
+            @autoreleasepool {
+                [self JSONRoundTripOfDevice:device];
+            }
+        }
+    }];
+}
+
+- (void)testSnapshotOfNodeKeepsItsClassAndFields {
+    NSDictionary *nodeDictionary = @{
+        @"dsn" : @"VD000W000000001",
+        @"device_type" : @"Node",
+        @"gateway_dsn" : self.device.dsn,
+        @"node_type" : @"Generic"
+    };
+    AylaDeviceNode *node = [[AylaDeviceNode alloc] initWithDeviceManager:nil JSONDictionary:nodeDictionary error:nil];
+    AylaDeviceNode *snapshot = [node snapshot];
+
+    XCTAssertTrue([snapshot isMemberOfClass:[AylaDeviceNode class]]);
+    XCTAssertEqualObjects(snapshot.dsn, node.dsn);
+    XCTAssertEqualObjects(snapshot.gatewayDsn, node.gatewayDsn);
+    XCTAssertEqualObjects(snapshot.nodeType, node.nodeType);
+}
+
+@end
@@ -0,0 +1,80 @@
+//
+//  AylaDeviceTestFixtures.h
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import iOS_AylaSDK;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** Time all fixture datapoints were last updated at */
+FOUNDATION_EXPORT NSString *const AylaDeviceTestFixturesDataUpdatedAt;
+
+// Internal SDK methods tests build and update devices through
+@interface AylaDevice (AylaTestFixtures)
+@property (nonatomic, readonly) dispatch_queue_t processingQueue;
+- (instancetype)initWithDeviceManager:(nullable AylaDeviceManager *)deviceManager
+                       JSONDictionary:(NSDictionary *)dictionary
+                                error:(NSError *__autoreleasing *)error;
+- (instancetype)initWithJSONDictionary:(NSDictionary *)dictionary error:(NSError *__autoreleasing *)error;
+- (NSDictionary *)toJSONDictionary;
+- (NSArray *)updateProperties:(NSArray *)properties;
+@end
+
+@interface AylaProperty (AylaTestFixtures)
+- (instancetype)initWithJSONDictionary:(NSDictionary *)dictionary error:(NSError *__autoreleasing *)error;
+@end
+
+/**
+ Devices and properties, as the cloud describes them, for tests of device processing
+ */
+@interface AylaDeviceTestFixtures : NSObject
+
+/**
+ JSON dictionaries of integer properties named `prop_00`, `prop_01`... whose value is their index
+
+ @param count Number of properties
+ @return The dictionaries of the properties
+ */
++ (NSArray<NSDictionary *> *)propertyDictionariesWithCount:(NSUInteger)count;
+
+/**
+ Body of a `properties.json` response listing the properties of `propertyDictionariesWithCount:`
+
+ @param count Number of properties
+ @return The body of the response
+ */
++ (NSData *)propertiesResponseWithCount:(NSUInteger)count;
+
+/**
+ JSON dictionary of a Wifi device
+
+ @param dsn Dsn of the device
+ @return The dictionary of the device
+ */
++ (NSDictionary *)deviceDictionaryWithDsn:(NSString *)dsn;
+
+/**
+ Parses a `properties.json` response into properties, the way a properties fetch does
+
+ @param response Body of the response
+ @return The parsed properties
+ */
++ (NSArray<AylaProperty *> *)propertiesFromResponse:(NSData *)response;
+
+/**
+ Builds a device, with no device manager, and gives it properties
+
+ @param dictionary JSON dictionary of the device
+ @param propertyDictionaries JSON dictionaries of its properties
+ @return The device
+ */
++ (AylaDevice *)deviceWithJSONDictionary:(NSDictionary *)dictionary
+                    propertyDictionaries:(NSArray<NSDictionary *> *)propertyDictionaries;
+@end
+
+NS_ASSUME_NONNULL_END
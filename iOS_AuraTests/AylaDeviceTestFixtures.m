@@ -0,0 +1,63 @@
+//
+//  AylaDeviceTestFixtures.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaDeviceTestFixtures.h"
+
+NSString *const AylaDeviceTestFixturesDataUpdatedAt = @"2016-11-02T10:20:30Z";
+
+@implementation AylaDeviceTestFixtures
+
++ (NSArray<NSDictionary *> *)propertyDictionariesWithCount:(NSUInteger)count {
+    NSMutableArray *propertyDictionaries = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [propertyDictionaries addObject:@{
+            @"key" : @(1000 + i),
+            @"name" : [NSString stringWithFormat:@"prop_%02lu", (unsigned long)i],
+            @"display_name" : [NSString stringWithFormat:@"Property %lu", (unsigned long)i],
+            @"base_type" : @"integer",
+            @"type" : @"Property",
+            @"direction" : i % 2 ? @"input" : @"output",
+            @"value" : @(i),
+            @"data_updated_at" : AylaDeviceTestFixturesDataUpdatedAt
+        }];
+    }
+    return propertyDictionaries;
+}
+
++ (NSData *)propertiesResponseWithCount:(NSUInteger)count {
+    NSMutableArray *response = [NSMutableArray arrayWithCapacity:count];
+    for (NSDictionary *propertyDictionary in [self propertyDictionariesWithCount:count]) {
+        [response addObject:@{ @"property" : propertyDictionary }];
+    }
+    return [NSJSONSerialization dataWithJSONObject:response options:0 error:nil];
+}
+
++ (NSDictionary *)deviceDictionaryWithDsn:(NSString *)dsn {
+    return @{ @"dsn" : dsn, @"device_type" : @"Wifi" };
+}
+
++ (NSArray<AylaProperty *> *)propertiesFromResponse:(NSData *)response {
+    NSArray *propertiesInJson = [NSJSONSerialization JSONObjectWithData:response options:0 error:nil];
+    NSMutableArray *properties = [NSMutableArray arrayWithCapacity:propertiesInJson.count];
+    for (NSDictionary *propertyInJson in propertiesInJson) {
+        [properties addObject:[[AylaProperty alloc] initWithJSONDictionary:propertyInJson[@"property"] error:nil]];
+    }
+    return properties;
+}
+
++ (AylaDevice *)deviceWithJSONDictionary:(NSDictionary *)dictionary
+                    propertyDictionaries:(NSArray<NSDictionary *> *)propertyDictionaries {
+    AylaDevice *device = [[AylaDevice alloc] initWithJSONDictionary:dictionary error:nil];
+    NSMutableArray *properties = [NSMutableArray arrayWithCapacity:propertyDictionaries.count];
+    for (NSDictionary *propertyDictionary in propertyDictionaries) {
+        [properties addObject:[[AylaProperty alloc] initWithJSONDictionary:propertyDictionary error:nil]];
+    }
+    [device updateProperties:properties];
+    return device;
+}
+
+@end
@@ -0,0 +1,450 @@
+//
+//  AylaLanBenchmarkTests.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "AylaDeviceTestFixtures.h"
+#import "AylaLanDeviceSimulator.h"
+
+@import CocoaHTTPServer;
+@import iOS_AylaSDK;
+
+// Internal LAN classes of the SDK, only the parts used by the tests
+typedef NS_ENUM(NSInteger, AylaLanSessionState) {
+    AylaLanSessionStateReadyToOpen,
+    AylaLanSessionStateOpening,
+    AylaLanSessionStateActive,
+    AylaLanSessionStateClosing,
+    AylaLanSessionStateError,
+    AylaLanSessionStateDisabled
+};
+
+typedef NS_ENUM(NSInteger, AylaLanSessionType) { AylaLanSessionTypeNormal, AylaLanSessionTypeSetup };
+
+@interface AylaLanConfig : AylaObject
+@property (nonatomic) NSNumber *lanipKeyId;
+@property (nonatomic) NSString *lanipKey;
+@property (nonatomic) NSNumber *keepAlive;
+@end
+
+@interface AylaHTTPServer : HTTPServer
+- (instancetype)initWithPort:(UInt16)portNum;
+@end
+
+@interface AylaHTTPServerRequest : NSObject
+- (instancetype)initWithMethod:(NSString *)method
+                           URI:(NSString *)uri
+                  headerFields:(NSDictionary *)headerFields
+                      bodyData:(NSData *)bodyData;
+@end
+
+@interface AylaHTTPServerResponse : NSObject
+@property (nonatomic, readonly) NSInteger httpStatusCode;
+@property (nonatomic, readonly) NSData *bodyData;
+@end
+
+@interface AylaLanModule : NSObject
+@property (nonatomic) AylaLanConfig *config;
+@property (nonatomic, readonly) AylaLanSessionState sessionState;
+- (BOOL)isActive;
+- (BOOL)openSessionWithType:(AylaLanSessionType)type onHTTPServer:(AylaHTTPServer *)httpServer;
+- (void)closeSession;
+- (AylaHTTPServerResponse *)httpServer:(AylaHTTPServer *)server didReceiveRequest:(AylaHTTPServerRequest *)request;
+@end
+
+@interface AylaDevice (AylaLanBenchmarkTests)
+@property (nonatomic, readonly) AylaLanModule *lanModule;
+@end
+
+static NSString *const AylaLanBenchmarkLanipKey = @"ae7c4bbf8b1d2a3e5f60718293a4b5c6";
+static const NSInteger AylaLanBenchmarkLanipKeyId = 4242;
+
+/** Uris of the requests the simulated modules send to the app */
+static NSString *const AylaLanBenchmarkKeyExchangeUri = @"/local_lan/key_exchange.json";
+static NSString *const AylaLanBenchmarkCommandsUri = @"/local_lan/commands.json";
+static NSString *const AylaLanBenchmarkDatapointUri = @"/local_lan/property/datapoint.json";
+
+/** Number of properties of each device */
+static const NSUInteger AylaLanBenchmarkPropertyCount = 10;
+
+/** Number of properties each benchmarked fetch asks for */
+static const NSUInteger AylaLanBenchmarkFetchedPropertyCount = 5;
+
+/** Value of the datapoints the simulated modules answer property requests with */
+static const NSInteger AylaLanBenchmarkDatapointValue = 4242;
+
+/** Time to wait for property fetches, in seconds */
+static const NSTimeInterval AylaLanBenchmarkTimeout = 30;
+
+/**
+ Benchmarks of LAN sessions: simulated modules run key exchanges, command polls and datapoint updates against the
+ `AylaLanModule` of real devices, the way they do through `AylaHTTPServer`.
+
+ Requests are handed to the modules with `httpServer:didReceiveRequest:`, as the connections of the server do once
+ they found the responder of the ip a request came from. They are not sent over sockets: the server tells modules
+ apart by that ip, and every simulated module would post from the loopback address.
+ */
+@interface AylaLanBenchmarkTests : XCTestCase
+@property (nonatomic, strong) AylaHTTPServer *server;
+@end
+
+@implementation AylaLanBenchmarkTests
+
+- (void)setUp {
+    [super setUp];
+    self.server = [[AylaHTTPServer alloc] initWithPort:0];
+}
+
+- (NSArray<AylaLanDeviceSimulator *> *)simulatorsWithCount:(NSUInteger)count {
+    NSMutableArray *simulators = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *dsn = [NSString stringWithFormat:@"AC000L%09lu", (unsigned long)i];
+        [simulators addObject:[[AylaLanDeviceSimulator alloc] initWithDsn:dsn
+                                                                 lanipKey:AylaLanBenchmarkLanipKey
+                                                               lanipKeyId:AylaLanBenchmarkLanipKeyId]];
+    }
+    return simulators;
+}
+
+/**
+ Builds the device of each simulator, with the properties of `AylaDeviceTestFixtures` and the LAN config of the
+ simulators, and opens its LAN session.
+
+ Devices have no lan ip, so their modules do not post `local_reg.json` to a real module and wait for the simulator
+ to start the key exchange.
+ */
+- (NSArray<AylaDevice *> *)devicesOfSimulators:(NSArray<AylaLanDeviceSimulator *> *)simulators {
+    NSArray *propertyDictionaries =
+        [AylaDeviceTestFixtures propertyDictionariesWithCount:AylaLanBenchmarkPropertyCount];
+    NSMutableArray *devices = [NSMutableArray arrayWithCapacity:simulators.count];
+    for (AylaLanDeviceSimulator *simulator in simulators) {
+        AylaDevice *device =
+            [[AylaDevice alloc] initWithDeviceManager:nil
+                                       JSONDictionary:[AylaDeviceTestFixtures deviceDictionaryWithDsn:simulator.dsn]
+                                                error:nil];
+        NSMutableArray *properties = [NSMutableArray arrayWithCapacity:propertyDictionaries.count];
+        for (NSDictionary *propertyDictionary in propertyDictionaries) {
+            [properties addObject:[[AylaProperty alloc] initWithJSONDictionary:propertyDictionary error:nil]];
+        }
+        dispatch_sync(device.processingQueue, ^{
+            [device updateProperties:properties];
+        });
+
+        AylaLanConfig *config = [[AylaLanConfig alloc] init];
+        config.lanipKeyId = @(AylaLanBenchmarkLanipKeyId);
+        config.lanipKey = AylaLanBenchmarkLanipKey;
+        config.keepAlive = @30;
+        device.lanModule.config = config;
+        [device.lanModule openSessionWithType:AylaLanSessionTypeNormal onHTTPServer:self.server];
+        [devices addObject:device];
+    }
+    return devices;
+}
+
+- (void)closeSessionsOfDevices:(NSArray<AylaDevice *> *)devices {
+    for (AylaDevice *device in devices) {
+        [device.lanModule closeSession];
+    }
+}
+
+/**
+ Sends a request of a simulated module to the LAN module of its device.
+
+ @param body Body of the request, nil for none
+ @return The response of the module
+ */
+- (AylaHTTPServerResponse *)sendRequestWithMethod:(NSString *)method
+                                              URI:(NSString *)uri
+                                             body:(NSData *)body
+                                         toDevice:(AylaDevice *)device {
+    AylaHTTPServerRequest *request = [[AylaHTTPServerRequest alloc] initWithMethod:method
+                                                                               URI:uri
+                                                                      headerFields:@{}
+                                                                          bodyData:body ?: [NSData data]];
+    return [device.lanModule httpServer:self.server didReceiveRequest:request];
+}
+
+/**
+ Runs a key exchange between a simulated module and the LAN module of its device.
+
+ @return YES if both ends established the session
+ */
+- (BOOL)exchangeKeysOfSimulator:(AylaLanDeviceSimulator *)simulator withDevice:(AylaDevice *)device {
+    AylaHTTPServerResponse *response = [self sendRequestWithMethod:@"POST"
+                                                               URI:AylaLanBenchmarkKeyExchangeUri
+                                                              body:[simulator keyExchangeRequestBody]
+                                                          toDevice:device];
+    if (response.httpStatusCode != 200) {
+        return NO;
+    }
+    return [simulator completeKeyExchangeWithResponseBody:response.bodyData error:nil] && device.lanModule.isActive;
+}
+
+- (NSData *)datapointBodyWithPropertyName:(NSString *)name
+                                    value:(NSInteger)value
+                                simulator:(AylaLanDeviceSimulator *)simulator {
+    NSString *datapoint = [NSString stringWithFormat:@"{\"data\":{\"name\":\"%@\",\"value\":%ld}}", name, (long)value];
+    return [simulator messageBodyWithPlaintext:datapoint];
+}
+
+/**
+ Polls the commands queued for a simulated module until none is left, and answers each property request with a
+ datapoint of value `AylaLanBenchmarkDatapointValue`.
+
+ @return Number of commands answered, NSNotFound if a command could not be decrypted or an answer was rejected
+ */
+- (NSUInteger)answerCommandsWithSimulator:(AylaLanDeviceSimulator *)simulator device:(AylaDevice *)device {
+    NSUInteger answered = 0;
+    AylaHTTPServerResponse *response = nil;
+    do {
+        response = [self sendRequestWithMethod:@"GET" URI:AylaLanBenchmarkCommandsUri body:nil toDevice:device];
+        NSString *plaintext = [simulator plaintextOfAppMessageBody:response.bodyData error:nil];
+        if (plaintext == nil) {
+            return NSNotFound;
+        }
+        NSDictionary *message =
+            [NSJSONSerialization JSONObjectWithData:[plaintext dataUsingEncoding:NSUTF8StringEncoding]
+                                            options:0
+                                              error:nil];
+        for (NSDictionary *command in message[@"data"][@"cmds"]) {
+            NSNumber *cmdId = command[@"cmd"][@"cmd_id"];
+            NSString *resource = command[@"cmd"][@"resource"];
+            NSString *name = [resource componentsSeparatedByString:@"name="].lastObject;
+            NSString *uri =
+                [NSString stringWithFormat:@"%@?cmd_id=%@&status=200", AylaLanBenchmarkDatapointUri, cmdId];
+            AylaHTTPServerResponse *datapointResponse =
+                [self sendRequestWithMethod:@"POST"
+                                        URI:uri
+                                       body:[self datapointBodyWithPropertyName:name
+                                                                          value:AylaLanBenchmarkDatapointValue
+                                                                      simulator:simulator]
+                                   toDevice:device];
+            if (datapointResponse.httpStatusCode != 200) {
+                return NSNotFound;
+            }
+            answered++;
+        }
+    } while (response.httpStatusCode == 206);
+    return answered;
+}
+
+- (NSArray<NSString *> *)fetchedPropertyNames {
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity:AylaLanBenchmarkFetchedPropertyCount];
+    for (NSDictionary *propertyDictionary in
+         [AylaDeviceTestFixtures propertyDictionariesWithCount:AylaLanBenchmarkFetchedPropertyCount]) {
+        [names addObject:propertyDictionary[@"name"]];
+    }
+    return names;
+}
+
+/**
+ Fetches `fetchedPropertyNames` from every device while the simulators answer the commands, each on its own queue
+ as the connections of `AylaHTTPServer` are, and waits for the fetches to complete.
+
+ @return Number of fetches which failed
+ */
+- (NSUInteger)fetchPropertiesOfDevices:(NSArray<AylaDevice *> *)devices
+                        withSimulators:(NSArray<AylaLanDeviceSimulator *> *)simulators {
+    NSArray *names = [self fetchedPropertyNames];
+    XCTestExpectation *fetched = [self expectationWithDescription:@"Properties fetched"];
+    __block NSUInteger pendingFetches = devices.count;
+    __block NSUInteger failures = 0;
+    void (^fetchDidComplete)(BOOL) = ^(BOOL succeeded) {
+        if (!succeeded) {
+            failures++;
+        }
+        if (--pendingFetches == 0) {
+            [fetched fulfill];
+        }
+    };
+    for (AylaDevice *device in devices) {
+        [device fetchProperties:names
+            success:^(NSArray<AylaProperty *> *properties) {
+                fetchDidComplete(properties.count == names.count);
+            }
+            failure:^(NSError *error) {
+                fetchDidComplete(NO);
+            }];
+    }
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        dispatch_apply(devices.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t index) {
+            [self answerCommandsWithSimulator:simulators[index] device:devices[index]];
+        });
+    });
+    [self waitForExpectationsWithTimeout:AylaLanBenchmarkTimeout handler:nil];
+    return failures;
+}
+
+//-----------------------------------------------------------
+#pragma mark - Correctness
+//-----------------------------------------------------------
+
+- (void)testKeyExchangeActivatesSession {
+    AylaLanDeviceSimulator *simulator = [self simulatorsWithCount:1].firstObject;
+    AylaDevice *device = [self devicesOfSimulators:@[ simulator ]].firstObject;
+    XCTAssertEqual(device.lanModule.sessionState, AylaLanSessionStateOpening);
+
+    XCTAssertTrue([self exchangeKeysOfSimulator:simulator withDevice:device]);
+    XCTAssertTrue(simulator.hasSession);
+    XCTAssertEqual(device.lanModule.sessionState, AylaLanSessionStateActive);
+    [self closeSessionsOfDevices:@[ device ]];
+}
+
+- (void)testPropertiesAreFetchedOverLan {
+    AylaLanDeviceSimulator *simulator = [self simulatorsWithCount:1].firstObject;
+    AylaDevice *device = [self devicesOfSimulators:@[ simulator ]].firstObject;
+    XCTAssertTrue([self exchangeKeysOfSimulator:simulator withDevice:device]);
+
+    // CBC state carries over from one message to the next on both ends
+    for (NSUInteger i = 0; i < 5; i++) {
+        XCTAssertEqual([self fetchPropertiesOfDevices:@[ device ] withSimulators:@[ simulator ]], 0, @"Fetch %lu",
+                       (unsigned long)i);
+    }
+
+    // Datapoints sent by the module update the properties of the device, on its processing queue
+    dispatch_sync(device.processingQueue, ^{
+    });
+    for (NSString *name in [self fetchedPropertyNames]) {
+        AylaProperty *property = device.properties[name];
+        XCTAssertEqualObjects(property.value, @(AylaLanBenchmarkDatapointValue), @"%@", name);
+    }
+    [self closeSessionsOfDevices:@[ device ]];
+}
+
+- (void)testUnknownLanipKeyIdIsRejected {
+    AylaLanDeviceSimulator *simulator = [[AylaLanDeviceSimulator alloc] initWithDsn:@"AC000L000000000"
+                                                                          lanipKey:AylaLanBenchmarkLanipKey
+                                                                        lanipKeyId:AylaLanBenchmarkLanipKeyId + 1];
+    AylaDevice *device = [self devicesOfSimulators:@[ simulator ]].firstObject;
+
+    AylaHTTPServerResponse *response = [self sendRequestWithMethod:@"POST"
+                                                               URI:AylaLanBenchmarkKeyExchangeUri
+                                                              body:[simulator keyExchangeRequestBody]
+                                                          toDevice:device];
+    XCTAssertEqual(response.httpStatusCode, 412);
+    XCTAssertEqual(device.lanModule.sessionState, AylaLanSessionStateError);
+    [self closeSessionsOfDevices:@[ device ]];
+}
+
+- (void)testTamperedMessageIsRejected {
+    AylaLanDeviceSimulator *simulator = [self simulatorsWithCount:1].firstObject;
+    AylaDevice *device = [self devicesOfSimulators:@[ simulator ]].firstObject;
+    XCTAssertTrue([self exchangeKeysOfSimulator:simulator withDevice:device]);
+
+    NSData *body = [self datapointBodyWithPropertyName:@"prop_00" value:1 simulator:simulator];
+    NSMutableDictionary *envelope = [[NSJSONSerialization JSONObjectWithData:body options:0 error:nil] mutableCopy];
+    envelope[@"sign"] = [[NSMutableData dataWithLength:32] base64EncodedStringWithOptions:0];
+    AylaHTTPServerResponse *response =
+        [self sendRequestWithMethod:@"POST"
+                                URI:AylaLanBenchmarkDatapointUri
+                               body:[NSJSONSerialization dataWithJSONObject:envelope options:0 error:nil]
+                           toDevice:device];
+    XCTAssertEqual(response.httpStatusCode, 400);
+    [self closeSessionsOfDevices:@[ device ]];
+}
+
+- (void)testMismatchedLanipKeyFailsVerification {
+    AylaLanDeviceSimulator *simulator = [[AylaLanDeviceSimulator alloc] initWithDsn:@"AC000L000000000"
+                                                                          lanipKey:@"00000000000000000000000000000000"
+                                                                        lanipKeyId:AylaLanBenchmarkLanipKeyId];
+    AylaDevice *device = [self devicesOfSimulators:@[ simulator ]].firstObject;
+
+    // The key id matches, so the module can only tell from the messages that the keys differ
+    XCTAssertTrue([self exchangeKeysOfSimulator:simulator withDevice:device]);
+    XCTAssertEqual([self answerCommandsWithSimulator:simulator device:device], NSNotFound);
+    [self closeSessionsOfDevices:@[ device ]];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Benchmarks
+//-----------------------------------------------------------
+
+/**
+ Measures key exchanges of `deviceCount` devices. Each module answers on the queue of the connection the request
+ came on, so the exchanges of different devices run concurrently.
+ */
+- (void)measureKeyExchangesWithDeviceCount:(NSUInteger)deviceCount {
+    NSArray<AylaLanDeviceSimulator *> *simulators = [self simulatorsWithCount:deviceCount];
+    NSArray<AylaDevice *> *devices = [self devicesOfSimulators:simulators];
+
+    [self measureMetrics:@[ XCTPerformanceMetric_WallClockTime ]
+        automaticallyStartMeasuring:NO
+                           forBlock:^{
+                               __block NSUInteger failures = 0;
+                               NSObject *lock = [[NSObject alloc] init];
+                               [self startMeasuring];
+                               dispatch_apply(deviceCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0),
+                                              ^(size_t index) {
+                                                  if (![self exchangeKeysOfSimulator:simulators[index]
+                                                                          withDevice:devices[index]]) {
+                                                      @synchronized(lock) {
+                                                          failures++;
+                                                      }
+                                                  }
+                                              });
+                               [self stopMeasuring];
+                               XCTAssertEqual(failures, 0);
+                           }];
+    [self closeSessionsOfDevices:devices];
+}
+
+/**
+ Measures the time it takes to fetch `AylaLanBenchmarkFetchedPropertyCount` properties from each of `deviceCount`
+ devices over LAN, from the fetch requests to the last success block.
+ */
+- (void)measurePropertyFetchesWithDeviceCount:(NSUInteger)deviceCount {
+    NSArray<AylaLanDeviceSimulator *> *simulators = [self simulatorsWithCount:deviceCount];
+    NSArray<AylaDevice *> *devices = [self devicesOfSimulators:simulators];
+    for (NSUInteger i = 0; i < deviceCount; i++) {
+        XCTAssertTrue([self exchangeKeysOfSimulator:simulators[i] withDevice:devices[i]]);
+    }
+
+    [self measureMetrics:@[ XCTPerformanceMetric_WallClockTime ]
+        automaticallyStartMeasuring:NO
+                           forBlock:^{
+                               [self startMeasuring];
+                               NSUInteger failures = [self fetchPropertiesOfDevices:devices withSimulators:simulators];
+                               [self stopMeasuring];
+                               XCTAssertEqual(failures, 0);
+                           }];
+    [self closeSessionsOfDevices:devices];
+}
+
+- (void)testPerformanceOfKeyExchangeWith1Device {
+    [self measureKeyExchangesWithDeviceCount:1];
+}
+
+- (void)testPerformanceOfKeyExchangeWith10Devices {
+    [self measureKeyExchangesWithDeviceCount:10];
+}
+
+- (void)testPerformanceOfKeyExchangeWith50Devices {
+    [self measureKeyExchangesWithDeviceCount:50];
+}
+
+- (void)testPerformanceOfKeyExchangeWith200Devices {
+    [self measureKeyExchangesWithDeviceCount:200];
+}
+
+- (void)testPerformanceOfPropertyFetchWith1Device {
+    [self measurePropertyFetchesWithDeviceCount:1];
+}
+
+- (void)testPerformanceOfPropertyFetchWith10Devices {
+    [self measurePropertyFetchesWithDeviceCount:10];
+}
+
+- (void)testPerformanceOfPropertyFetchWith50Devices {
+    [self measurePropertyFetchesWithDeviceCount:50];
+}
+
+- (void)testPerformanceOfPropertyFetchWith200Devices {
+    [self measurePropertyFetchesWithDeviceCount:200];
+}
+
+@end
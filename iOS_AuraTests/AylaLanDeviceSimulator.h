@@ -0,0 +1,89 @@
+//
+//  AylaLanDeviceSimulator.h
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** Domain of the errors of `AylaLanDeviceSimulator` */
+FOUNDATION_EXPORT NSString *const AylaLanDeviceSimulatorErrorDomain;
+
+/**
+ Simulates the module side of a LAN session: the key exchange the module starts, and the encrypted and signed
+ messages it exchanges with the app afterwards.
+
+ Session keys are derived and messages encrypted the way `AylaEncryption` does on the app side, with the roles of the
+ app and device keys swapped: the simulator encrypts and signs with the device keys, and decrypts and verifies with
+ the app keys. It is implemented independently of the SDK, so a mismatch with `AylaEncryption` shows as messages
+ failing to decrypt or verify.
+
+ Not thread safe, a simulator must be used from one queue at a time.
+ */
+@interface AylaLanDeviceSimulator : NSObject
+
+/** Dsn of the simulated device */
+@property (nonatomic, readonly) NSString *dsn;
+
+/** LAN ip key shared with the app through the LAN config of the device */
+@property (nonatomic, readonly) NSString *lanipKey;
+
+/** Id of `lanipKey` */
+@property (nonatomic, readonly) NSInteger lanipKeyId;
+
+/** YES once a key exchange has completed */
+@property (nonatomic, readonly) BOOL hasSession;
+
+/**
+ Init method
+
+ @param dsn Dsn of the simulated device
+ @param lanipKey LAN ip key of the device
+ @param lanipKeyId Id of the LAN ip key
+ @return An initialized simulator
+ */
+- (instancetype)initWithDsn:(NSString *)dsn
+                   lanipKey:(NSString *)lanipKey
+                 lanipKeyId:(NSInteger)lanipKeyId NS_DESIGNATED_INITIALIZER;
+
+/**
+ Starts a key exchange, dropping the current session if any.
+
+ @return Body of the `key_exchange.json` request the module posts to the app
+ */
+- (NSData *)keyExchangeRequestBody;
+
+/**
+ Completes the key exchange started by `keyExchangeRequestBody` and derives the session keys.
+
+ @param responseBody Body of the response of the app to the `key_exchange.json` request
+ @param error Set if the response is invalid
+ @return YES if the session is established
+ */
+- (BOOL)completeKeyExchangeWithResponseBody:(NSData *)responseBody error:(NSError *__autoreleasing *)error;
+
+/**
+ Decrypts a message of the app, e.g. the body of a `commands.json` response, and verifies its signature.
+
+ @param body The `enc` and `sign` envelope sent by the app
+ @param error Set if the message can not be decrypted or its signature does not match
+ @return The plain text of the message, nil on error
+ */
+- (nullable NSString *)plaintextOfAppMessageBody:(NSData *)body error:(NSError *__autoreleasing *)error;
+
+/**
+ Encrypts and signs a message to the app, e.g. the body of a `property/datapoint.json` request.
+
+ @param plaintext Plain text of the message
+ @return The `enc` and `sign` envelope to send to the app
+ */
+- (NSData *)messageBodyWithPlaintext:(NSString *)plaintext;
+
+// Unavailable methods
+- (instancetype)init NS_UNAVAILABLE;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,245 @@
+//
+//  AylaLanDeviceSimulator.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaLanDeviceSimulator.h"
+
+#import <CommonCrypto/CommonCryptor.h>
+#import <CommonCrypto/CommonHMAC.h>
+
+NSString *const AylaLanDeviceSimulatorErrorDomain = @"AylaLanDeviceSimulatorErrorDomain";
+
+/** Length of the random token of a key exchange */
+static const NSUInteger AylaLanDeviceSimulatorRandomLength = 16;
+
+/** Size of the IV seeds, the first bytes of their HMAC */
+static const NSUInteger AylaLanDeviceSimulatorIvLength = 16;
+
+@interface AylaLanDeviceSimulator () {
+    CCCryptorRef _encryptor;
+    CCCryptorRef _decryptor;
+}
+@property (nonatomic, strong) NSString *random1;
+@property (nonatomic, strong) NSString *time1;
+@property (nonatomic, strong) NSData *appSignKey;
+@property (nonatomic, strong) NSData *devSignKey;
+@property (nonatomic, readwrite) BOOL hasSession;
+@end
+
+@implementation AylaLanDeviceSimulator
+
+- (instancetype)initWithDsn:(NSString *)dsn lanipKey:(NSString *)lanipKey lanipKeyId:(NSInteger)lanipKeyId {
+    if (self = [super init]) {
+        _dsn = [dsn copy];
+        _lanipKey = [lanipKey copy];
+        _lanipKeyId = lanipKeyId;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self closeSession];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Key Exchange
+//-----------------------------------------------------------
+
+- (NSData *)keyExchangeRequestBody {
+    [self closeSession];
+
+    self.random1 = [self randomToken];
+    self.time1 = [NSString stringWithFormat:@"%lld", (long long)([NSDate date].timeIntervalSince1970 * 1000000)];
+
+    // Time is sent as a JSON number, the keys are derived from its text
+    NSString *body = [NSString stringWithFormat:@"{\"key_exchange\":{\"ver\":1,\"proto\":1,\"key_id\":%ld,"
+                                                @"\"random_1\":\"%@\",\"time_1\":%@}}",
+                                                (long)self.lanipKeyId, self.random1, self.time1];
+    return [body dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (BOOL)completeKeyExchangeWithResponseBody:(NSData *)responseBody error:(NSError *__autoreleasing *)error {
+    NSString *response = [[NSString alloc] initWithData:responseBody encoding:NSUTF8StringEncoding];
+    NSDictionary *json = [NSJSONSerialization JSONObjectWithData:responseBody options:0 error:nil];
+    NSString *random2 = [json isKindOfClass:[NSDictionary class]] ? json[@"random_2"] : nil;
+    NSString *time2 = [self textOfNumberWithName:@"time_2" inJSON:response];
+    if (self.random1 == nil || ![random2 isKindOfClass:[NSString class]] || time2 == nil) {
+        if (error) {
+            *error = [self errorWithDescription:@"Invalid key exchange response"];
+        }
+        return NO;
+    }
+
+    NSData *lanKey = [self.lanipKey dataUsingEncoding:NSUTF8StringEncoding];
+
+    // App keys:    <random_1> + <random_2> + <time_1> + <time_2> + '0' / '1' / '2'
+    // Device keys: <random_2> + <random_1> + <time_2> + <time_1> + '0' / '1' / '2'
+    NSString *appSeed = [NSString stringWithFormat:@"%@%@%@%@", self.random1, random2, self.time1, time2];
+    NSString *devSeed = [NSString stringWithFormat:@"%@%@%@%@", random2, self.random1, time2, self.time1];
+
+    self.appSignKey = [self keyWithLanKey:lanKey seed:appSeed index:0];
+    NSData *appCryptoKey = [self keyWithLanKey:lanKey seed:appSeed index:1];
+    NSData *appIv = [[self keyWithLanKey:lanKey seed:appSeed index:2]
+        subdataWithRange:NSMakeRange(0, AylaLanDeviceSimulatorIvLength)];
+
+    self.devSignKey = [self keyWithLanKey:lanKey seed:devSeed index:0];
+    NSData *devCryptoKey = [self keyWithLanKey:lanKey seed:devSeed index:1];
+    NSData *devIv = [[self keyWithLanKey:lanKey seed:devSeed index:2]
+        subdataWithRange:NSMakeRange(0, AylaLanDeviceSimulatorIvLength)];
+
+    // The module encrypts what it sends with the device keys and decrypts what it receives with the app keys
+    if (![self createCryptor:&_encryptor operation:kCCEncrypt key:devCryptoKey iv:devIv] ||
+        ![self createCryptor:&_decryptor operation:kCCDecrypt key:appCryptoKey iv:appIv]) {
+        [self closeSession];
+        if (error) {
+            *error = [self errorWithDescription:@"Failed to create cryptors"];
+        }
+        return NO;
+    }
+    self.hasSession = YES;
+    return YES;
+}
+
+/**
+ Derives a session key: HMAC(lanKey, HMAC(lanKey, seed) + seed), where the seed ends with the index as a digit.
+ */
+- (NSData *)keyWithLanKey:(NSData *)lanKey seed:(NSString *)seed index:(NSUInteger)index {
+    NSMutableData *seedData = [[seed dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+    uint8_t digit = '0' + index;
+    [seedData appendBytes:&digit length:1];
+
+    NSMutableData *level2 = [[self hmacWithKey:lanKey data:seedData] mutableCopy];
+    [level2 appendData:seedData];
+    return [self hmacWithKey:lanKey data:level2];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Messages
+//-----------------------------------------------------------
+
+- (NSString *)plaintextOfAppMessageBody:(NSData *)body error:(NSError *__autoreleasing *)error {
+    NSDictionary *envelope = [NSJSONSerialization JSONObjectWithData:body options:0 error:nil];
+    NSData *cipherData = nil;
+    NSData *sign = nil;
+    if ([envelope isKindOfClass:[NSDictionary class]] && [envelope[@"enc"] isKindOfClass:[NSString class]] &&
+        [envelope[@"sign"] isKindOfClass:[NSString class]]) {
+        cipherData = [[NSData alloc] initWithBase64EncodedString:envelope[@"enc"] options:0];
+        sign = [[NSData alloc] initWithBase64EncodedString:envelope[@"sign"] options:0];
+    }
+    if (!self.hasSession || cipherData == nil || sign == nil || cipherData.length % kCCBlockSizeAES128 != 0) {
+        if (error) {
+            *error = [self errorWithDescription:@"Invalid message"];
+        }
+        return nil;
+    }
+
+    NSMutableData *plainData = [NSMutableData dataWithLength:cipherData.length];
+    size_t plainLength = 0;
+    if (CCCryptorUpdate(_decryptor, cipherData.bytes, cipherData.length, plainData.mutableBytes, plainData.length,
+                        &plainLength) != kCCSuccess) {
+        if (error) {
+            *error = [self errorWithDescription:@"Decryption failed"];
+        }
+        return nil;
+    }
+
+    // Drop the terminating zero and the zero padding
+    const uint8_t *bytes = plainData.bytes;
+    while (plainLength > 0 && bytes[plainLength - 1] == 0) {
+        plainLength--;
+    }
+    plainData.length = plainLength;
+
+    if (![[self hmacWithKey:self.appSignKey data:plainData] isEqualToData:sign]) {
+        if (error) {
+            *error = [self errorWithDescription:@"Invalid signature"];
+        }
+        return nil;
+    }
+    return [[NSString alloc] initWithData:plainData encoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)messageBodyWithPlaintext:(NSString *)plaintext {
+    NSAssert(self.hasSession, @"A key exchange must have completed");
+    NSData *plainData = [plaintext dataUsingEncoding:NSUTF8StringEncoding];
+
+    // Zero terminated, then zero padded to the block size
+    NSMutableData *paddedData = [plainData mutableCopy];
+    paddedData.length += 1;
+    if (paddedData.length % kCCBlockSizeAES128 != 0) {
+        paddedData.length += kCCBlockSizeAES128 - paddedData.length % kCCBlockSizeAES128;
+    }
+
+    NSMutableData *cipherData = [NSMutableData dataWithLength:paddedData.length];
+    size_t cipherLength = 0;
+    CCCryptorUpdate(_encryptor, paddedData.bytes, paddedData.length, cipherData.mutableBytes, cipherData.length,
+                    &cipherLength);
+    cipherData.length = cipherLength;
+
+    NSData *sign = [self hmacWithKey:self.devSignKey data:plainData];
+    NSString *envelope = [NSString stringWithFormat:@"{\"enc\":\"%@\",\"sign\":\"%@\"}",
+                                                    [cipherData base64EncodedStringWithOptions:0],
+                                                    [sign base64EncodedStringWithOptions:0]];
+    return [envelope dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Utilities
+//-----------------------------------------------------------
+
+- (BOOL)createCryptor:(CCCryptorRef *)cryptor operation:(CCOperation)operation key:(NSData *)key iv:(NSData *)iv {
+    // AES-256 in CBC mode without padding, the CBC state carries over from one message to the next
+    return CCCryptorCreate(operation, kCCAlgorithmAES128, 0, key.bytes, kCCKeySizeAES256, iv.bytes, cryptor) ==
+           kCCSuccess;
+}
+
+- (void)closeSession {
+    if (_encryptor) {
+        CCCryptorRelease(_encryptor);
+        _encryptor = NULL;
+    }
+    if (_decryptor) {
+        CCCryptorRelease(_decryptor);
+        _decryptor = NULL;
+    }
+    self.appSignKey = nil;
+    self.devSignKey = nil;
+    self.hasSession = NO;
+}
+
+- (NSData *)hmacWithKey:(NSData *)key data:(NSData *)data {
+    unsigned char hmac[CC_SHA256_DIGEST_LENGTH];
+    CCHmac(kCCHmacAlgSHA256, key.bytes, key.length, data.bytes, data.length, hmac);
+    return [NSData dataWithBytes:hmac length:sizeof(hmac)];
+}
+
+- (NSString *)randomToken {
+    static NSString *const characters = @"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    NSMutableString *token = [NSMutableString stringWithCapacity:AylaLanDeviceSimulatorRandomLength];
+    for (NSUInteger i = 0; i < AylaLanDeviceSimulatorRandomLength; i++) {
+        [token appendFormat:@"%C", [characters characterAtIndex:arc4random_uniform((uint32_t)characters.length)]];
+    }
+    return token;
+}
+
+/**
+ Text of a number in a JSON object, exactly as sent. Keys are derived from the text, which a parsed and formatted
+ number would not always give back.
+ */
+- (NSString *)textOfNumberWithName:(NSString *)name inJSON:(NSString *)json {
+    NSString *pattern = [NSString stringWithFormat:@"\"%@\"\\s*:\\s*([-+0-9.eE]+)", name];
+    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern options:0 error:nil];
+    NSTextCheckingResult *match = [regex firstMatchInString:json options:0 range:NSMakeRange(0, json.length)];
+    return match ? [json substringWithRange:[match rangeAtIndex:1]] : nil;
+}
+
+- (NSError *)errorWithDescription:(NSString *)description {
+    return [NSError errorWithDomain:AylaLanDeviceSimulatorErrorDomain
+                               code:0
+                           userInfo:@{ NSLocalizedDescriptionKey : description }];
+}
+
+@end
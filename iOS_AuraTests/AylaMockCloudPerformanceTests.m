@@ -0,0 +1,410 @@
+//
+//  AylaMockCloudPerformanceTests.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <mach/mach.h>
+
+#import "AylaMockCloudService.h"
+
+@import iOS_AylaSDK;
+
+static NSString *const AylaMockCloudTestsSessionName = @"MockCloudPerformanceTests";
+
+/** Time given to the SDK to sign in and initialize the device manager, in seconds */
+static const NSTimeInterval AylaMockCloudTestsInitTimeout = 600;
+
+/** Time given to the SDK to complete a request or receive an event of the data stream, in seconds */
+static const NSTimeInterval AylaMockCloudTestsTimeout = 30;
+
+/**
+ Memory the initialization of a device may take at most, in bytes. Generous, it catches devices holding on to whole
+ responses or copies of the device list rather than small regressions.
+ */
+static const uint64_t AylaMockCloudTestsMemoryPerDevice = 256 * 1024;
+
+/** Poll interval of the devices in the polling tests, in seconds */
+static const NSTimeInterval AylaMockCloudTestsPollInterval = 1;
+
+/**
+ Outcome of the initialization of a device manager against the mock cloud
+ */
+@interface AylaMockCloudInitResult : NSObject
+@property (nonatomic, assign) NSUInteger requestCount;
+@property (nonatomic, assign) NSUInteger failedRequestCount;
+@property (nonatomic, assign) uint64_t peakResidentSizeGrowth;
+@property (nonatomic, assign) NSUInteger deviceCount;
+@property (nonatomic, strong) NSDictionary<NSString *, NSError *> *deviceFailures;
+@end
+
+@implementation AylaMockCloudInitResult
+@end
+
+@interface AylaMockCloudPerformanceTests : XCTestCase <AylaDeviceManagerListener>
+@property (nonatomic, strong) AylaMockCloudService *service;
+@property (nonatomic, strong) AylaSessionManager *sessionManager;
+@property (nonatomic, strong) XCTestExpectation *initExpectation;
+@property (nonatomic, assign) BOOL initFinished;
+@property (nonatomic, strong) NSDictionary<NSString *, NSError *> *deviceFailures;
+@end
+
+@implementation AylaMockCloudPerformanceTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.service = [[AylaMockCloudService alloc] init];
+    NSError *error = nil;
+    XCTAssertTrue([self.service start:&error], @"Mock cloud did not start: %@", error);
+}
+
+- (void)tearDown {
+    if (self.sessionManager) {
+        XCTestExpectation *shutDown = [self expectationWithDescription:@"Session shut down"];
+        [self.sessionManager.deviceManager removeListener:self];
+        [self.sessionManager shutDownWithSuccess:^{
+            [shutDown fulfill];
+        }
+            failure:^(NSError *error) {
+                [shutDown fulfill];
+            }];
+        [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+        self.sessionManager = nil;
+    }
+    [self.service stop];
+    self.service = nil;
+
+    [super tearDown];
+}
+
+/** Largest amount of memory the process has been using so far, in bytes */
+- (uint64_t)peakResidentSize {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size_max;
+}
+
+- (void)waitFor:(NSTimeInterval)delay {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Waited"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:delay + AylaMockCloudTestsTimeout handler:nil];
+}
+
+/**
+ Signs in against the mock cloud and waits for the device manager of the new session to complete its initialization.
+ */
+- (AylaMockCloudInitResult *)initializeWithDeviceCount:(NSUInteger)deviceCount
+                                   propertiesPerDevice:(NSUInteger)propertiesPerDevice
+                                               latency:(NSTimeInterval)latency
+                                             errorRate:(double)errorRate
+                                              allowDSS:(BOOL)allowDSS {
+    self.service.deviceCount = deviceCount;
+    self.service.propertiesPerDevice = propertiesPerDevice;
+    self.service.latency = latency;
+    self.service.errorRate = errorRate;
+
+    AylaSystemSettings *settings = [AylaSystemSettings defaultSystemSettings];
+    settings.appId = @"mock-app-id";
+    settings.appSecret = @"mock-app-secret";
+    settings.serviceBaseUrlOverrides = self.service.serviceBaseUrlOverrides;
+    settings.allowDSS = allowDSS;
+    settings.allowOfflineUse = NO;
+    [AylaNetworks initializeWithSettings:settings];
+
+    [self.service resetRequestCount];
+    self.initExpectation = [self expectationWithDescription:@"Device manager initialized"];
+    self.initFinished = NO;
+    uint64_t initialPeakResidentSize = [self peakResidentSize];
+
+    id<AylaAuthProvider> authProvider = [AylaUsernameAuthProvider providerWithUsername:@"mock@aylanetworks.com"
+                                                                              password:@"password"];
+    [[AylaNetworks shared].loginManager loginWithAuthProvider:authProvider
+        sessionName:AylaMockCloudTestsSessionName
+        success:^(AylaAuthorization *authorization, AylaSessionManager *sessionManager) {
+            self.sessionManager = sessionManager;
+            [sessionManager.deviceManager addListener:self];
+            // Initialization may have completed before the listener was added
+            if (sessionManager.deviceManager.state == AylaDeviceManagerStateReady) {
+                [self finishInit];
+            }
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Sign in failed: %@", error);
+            [self finishInit];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsInitTimeout handler:nil];
+
+    AylaMockCloudInitResult *result = [[AylaMockCloudInitResult alloc] init];
+    result.requestCount = self.service.requestCount;
+    result.failedRequestCount = self.service.failedRequestCount;
+    result.peakResidentSizeGrowth = [self peakResidentSize] - initialPeakResidentSize;
+    result.deviceCount = self.sessionManager.deviceManager.devices.count;
+    result.deviceFailures = self.deviceFailures ?: @{};
+    return result;
+}
+
+/** Fulfills the init expectation once, must be called on the main queue */
+- (void)finishInit {
+    if (!self.initFinished) {
+        self.initFinished = YES;
+        [self.initExpectation fulfill];
+    }
+}
+
+- (void)assertCompleteInit:(AylaMockCloudInitResult *)result deviceCount:(NSUInteger)deviceCount {
+    XCTAssertEqual(result.deviceCount, deviceCount);
+    XCTAssertEqual(result.deviceFailures.count, 0);
+    XCTAssertEqual(result.failedRequestCount, 0);
+    // Sign in, the device list and the properties of each device
+    XCTAssertGreaterThanOrEqual(result.requestCount, deviceCount + 2);
+    XCTAssertLessThanOrEqual(result.peakResidentSizeGrowth, deviceCount * AylaMockCloudTestsMemoryPerDevice);
+}
+
+/**
+ Has the devices polled every `AylaMockCloudTestsPollInterval`, as long as the data stream does not cover them
+ */
+- (void)setShortPollInterval {
+    AylaAdaptivePollPolicy *policy = [[AylaAdaptivePollPolicy alloc] init];
+    policy.baseInterval = AylaMockCloudTestsPollInterval;
+    self.sessionManager.deviceManager.pollPolicy = policy;
+}
+
+/**
+ Resets the request counts of the service, then waits for it to receive a number of property fetches
+ */
+- (void)waitForPropertyFetchCount:(NSUInteger)count {
+    [self.service resetRequestCount];
+    [self keyValueObservingExpectationForObject:self.service
+                                        keyPath:NSStringFromSelector(@selector(propertyFetchCount))
+                                        handler:^BOOL(AylaMockCloudService *service, NSDictionary *change) {
+                                            return service.propertyFetchCount >= count;
+                                        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Initialization
+//-----------------------------------------------------------
+
+- (void)testInitWith500Devices {
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:500 propertiesPerDevice:10 latency:0.02 errorRate:0 allowDSS:NO];
+    [self assertCompleteInit:result deviceCount:500];
+}
+
+- (void)testInitWith2000Devices {
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:2000 propertiesPerDevice:10 latency:0.02 errorRate:0 allowDSS:NO];
+    [self assertCompleteInit:result deviceCount:2000];
+}
+
+- (void)testInitReportsFailedDevices {
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:200 propertiesPerDevice:10 latency:0 errorRate:0.2 allowDSS:NO];
+
+    XCTAssertEqual(result.deviceCount, 200);
+    XCTAssertGreaterThan(result.failedRequestCount, 0);
+    XCTAssertGreaterThan(result.deviceFailures.count, 0);
+    XCTAssertLessThan(result.deviceFailures.count, 200);
+}
+
+//-----------------------------------------------------------
+#pragma mark - Polling
+//-----------------------------------------------------------
+
+/**
+ Measures the time the service takes to receive as many property fetches as there are devices, about one poll of
+ each device. The poll interval sets a floor, the latency of the service and the processing of the responses add to
+ it.
+ */
+- (void)testPollingOf500Devices {
+    NSUInteger deviceCount = 500;
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:deviceCount propertiesPerDevice:10 latency:0.02 errorRate:0 allowDSS:NO];
+    [self assertCompleteInit:result deviceCount:deviceCount];
+    [self setShortPollInterval];
+
+    // Devices only pick the new interval up on their next poll
+    [self waitForPropertyFetchCount:deviceCount];
+
+    [self measureMetrics:@[ XCTPerformanceMetric_WallClockTime ]
+        automaticallyStartMeasuring:NO
+                           forBlock:^{
+                               [self startMeasuring];
+                               [self waitForPropertyFetchCount:deviceCount];
+                               [self stopMeasuring];
+                               XCTAssertEqual(self.service.failedRequestCount, 0);
+                           }];
+}
+
+//-----------------------------------------------------------
+#pragma mark - Data Stream
+//-----------------------------------------------------------
+
+- (void)testDataStreamDeliversDatapointsInsteadOfPolling {
+    NSUInteger deviceCount = 50;
+    self.service.heartbeatInterval = 1;
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:deviceCount propertiesPerDevice:10 latency:0.02 errorRate:0 allowDSS:YES];
+    [self assertCompleteInit:result deviceCount:deviceCount];
+    [self setShortPollInterval];
+
+    AylaSessionManager *sessionManager = self.sessionManager;
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id object, NSDictionary *bindings) {
+        return sessionManager.isDSActive;
+    }]
+              evaluatedWithObject:sessionManager
+                          handler:nil];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+    XCTAssertEqual(self.service.openStreamCount, 1);
+
+    // A datapoint created by the device reaches the app through the stream, without a property fetch
+    NSString *propertyName = [self.service nameOfPropertyAtIndex:3];
+    AylaDevice *device = sessionManager.deviceManager.devices[[self.service dsnOfDeviceAtIndex:7]];
+    AylaProperty *property = device.properties[propertyName];
+    XCTAssertNotNil(property);
+    [self.service resetRequestCount];
+    XCTAssertTrue([self.service createDatapointWithValue:@4242 ofPropertyNamed:propertyName ofDeviceAtIndex:7]);
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"value == 4242"]
+              evaluatedWithObject:property
+                          handler:nil];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    // Devices covered by the stream, kept alive by heart beats, are not polled
+    [self waitFor:AylaMockCloudTestsPollInterval * 3];
+    XCTAssertEqual(self.service.propertyFetchCount, 0);
+    XCTAssertTrue(sessionManager.isDSActive);
+}
+
+//-----------------------------------------------------------
+#pragma mark - Datapoints and Datums
+//-----------------------------------------------------------
+
+- (void)testDatapointsAndDatumsOfADevice {
+    AylaMockCloudInitResult *result =
+        [self initializeWithDeviceCount:5 propertiesPerDevice:10 latency:0 errorRate:0 allowDSS:NO];
+    [self assertCompleteInit:result deviceCount:5];
+    AylaDevice *device = self.sessionManager.deviceManager.devices[[self.service dsnOfDeviceAtIndex:2]];
+    AylaProperty *property = device.properties[[self.service nameOfPropertyAtIndex:1]];
+
+    AylaDatapointParams *params = [[AylaDatapointParams alloc] init];
+    params.value = @77;
+    XCTestExpectation *created = [self expectationWithDescription:@"Datapoint created"];
+    [property createDatapoint:params
+        success:^(AylaDatapoint *createdDatapoint) {
+            XCTAssertEqualObjects(createdDatapoint.value, @77);
+            [created fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datapoint creation failed: %@", error);
+            [created fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    // The generated datapoint and the created one
+    XCTestExpectation *fetched = [self expectationWithDescription:@"Datapoints fetched"];
+    [property fetchDatapointsWithCount:10
+        from:nil
+        to:nil
+        success:^(NSArray<AylaDatapoint *> *datapoints) {
+            XCTAssertEqual(datapoints.count, 2);
+            [fetched fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datapoint fetch failed: %@", error);
+            [fetched fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    XCTestExpectation *datumCreated = [self expectationWithDescription:@"Datum created"];
+    [device createAylaDatumWithKey:@"mock_datum"
+        value:@"first"
+        success:^(AylaDatum *createdDatum) {
+            [datumCreated fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datum creation failed: %@", error);
+            [datumCreated fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    XCTestExpectation *datumUpdated = [self expectationWithDescription:@"Datum updated"];
+    [device updateAylaDatumWithKey:@"mock_datum"
+        toValue:@"second"
+        success:^(AylaDatum *updatedDatum) {
+            [datumUpdated fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datum update failed: %@", error);
+            [datumUpdated fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    XCTestExpectation *datumsFetched = [self expectationWithDescription:@"Datums fetched"];
+    [device fetchAylaDatumsMatching:@"mock_%"
+        success:^(NSArray<AylaDatum *> *datums) {
+            XCTAssertEqual(datums.count, 1);
+            XCTAssertEqualObjects(datums.firstObject.value, @"second");
+            [datumsFetched fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datum fetch failed: %@", error);
+            [datumsFetched fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    XCTestExpectation *datumDeleted = [self expectationWithDescription:@"Datum deleted"];
+    [device deleteAylaDatumWithKey:@"mock_datum"
+        success:^{
+            [datumDeleted fulfill];
+        }
+        failure:^(NSError *error) {
+            XCTFail(@"Datum deletion failed: %@", error);
+            [datumDeleted fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+
+    XCTestExpectation *deletedDatumFetched = [self expectationWithDescription:@"Deleted datum fetched"];
+    [device fetchAylaDatumWithKey:@"mock_datum"
+        success:^(AylaDatum *datum) {
+            XCTFail(@"Deleted datum fetched");
+            [deletedDatumFetched fulfill];
+        }
+        failure:^(NSError *error) {
+            [deletedDatumFetched fulfill];
+        }];
+    [self waitForExpectationsWithTimeout:AylaMockCloudTestsTimeout handler:nil];
+}
+
+//-----------------------------------------------------------
+#pragma mark - AylaDeviceManagerListener
+//-----------------------------------------------------------
+
+- (void)deviceManager:(AylaDeviceManager *)deviceManager
+      didInitComplete:(NSDictionary<NSString *, NSError *> *)deviceFailures {
+    self.deviceFailures = deviceFailures;
+    [self finishInit];
+}
+
+- (void)deviceManager:(AylaDeviceManager *)deviceManager didInitFailure:(NSError *)error {
+    XCTFail(@"Device manager init failed: %@", error);
+    [self finishInit];
+}
+
+- (void)deviceManager:(AylaDeviceManager *)deviceManager didObserveDeviceListChange:(AylaDeviceListChange *)change {
+}
+
+- (void)deviceManager:(AylaDeviceManager *)deviceManager
+    deviceManagerStateChanged:(AylaDeviceManagerState)oldState
+                     newState:(AylaDeviceManagerState)newState {
+}
+
+@end
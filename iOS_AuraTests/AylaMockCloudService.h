@@ -0,0 +1,111 @@
+//
+//  AylaMockCloudService.h
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import CocoaHTTPServer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A local HTTP service standing in for the Ayla user, device and data stream services, serving a generated account of
+ `deviceCount` devices with `propertiesPerDevice` properties each. Point the SDK at it with
+ `serviceBaseUrlOverrides` to load test sign in, device manager initialization, polling and data streams without the
+ cloud.
+
+ Served endpoints are sign in, sign out, token refresh, user profile, device list, device details, device properties,
+ datapoint creation and history, device datums, data stream subscriptions and data streams, web socket connections
+ sending a heart beat every `heartbeatInterval` along with the datapoints created on the devices they cover. Other
+ requests are answered with 404 and counted too.
+
+ Datapoints and datums are kept in memory, until the account is generated again because `deviceCount` or
+ `propertiesPerDevice` changed.
+ */
+@interface AylaMockCloudService : HTTPServer
+
+/** Number of devices of the account, 10 by default */
+@property (nonatomic, assign) NSUInteger deviceCount;
+
+/** Number of properties of each device, 10 by default */
+@property (nonatomic, assign) NSUInteger propertiesPerDevice;
+
+/** Time every response is delayed by, in seconds. 0 by default. */
+@property (nonatomic, assign) NSTimeInterval latency;
+
+/**
+ Fraction of requests about a single device, properties, details, datapoints or datums, answered with a 500 error.
+ Sign in, the device list and data stream subscriptions always succeed. 0 by default.
+ */
+@property (nonatomic, assign) double errorRate;
+
+/** Time between the heart beats sent on data streams, in seconds. 30 by default. */
+@property (nonatomic, assign) NSTimeInterval heartbeatInterval;
+
+/** Number of requests received since the service started or `resetRequestCount` was last called */
+@property (nonatomic, assign, readonly) NSUInteger requestCount;
+
+/** Number of requests answered with an error since the service started or `resetRequestCount` was last called */
+@property (nonatomic, assign, readonly) NSUInteger failedRequestCount;
+
+/**
+ Number of requests for the properties of a device since the service started or `resetRequestCount` was last called,
+ whether they were answered with an error or not
+ */
+@property (nonatomic, assign, readonly) NSUInteger propertyFetchCount;
+
+/** Number of data streams currently open */
+@property (nonatomic, assign, readonly) NSUInteger openStreamCount;
+
+/**
+ Base urls of the services, keyed by `AylaServiceName...`, to set as `serviceBaseUrlOverrides`. Only valid once the
+ service has been started.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *serviceBaseUrlOverrides;
+
+/**
+ Init method, the service listens on a free port of the loopback interface once started.
+
+ @return An initialized service
+ */
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+/**
+ Dsn of a device of the account
+
+ @param index Index of the device, lower than `deviceCount`
+ @return The dsn of the device
+ */
+- (NSString *)dsnOfDeviceAtIndex:(NSUInteger)index;
+
+/**
+ Name of a property of each device of the account
+
+ @param index Index of the property, lower than `propertiesPerDevice`
+ @return The name of the property
+ */
+- (NSString *)nameOfPropertyAtIndex:(NSUInteger)index;
+
+/**
+ Creates a datapoint on a property, as if the device had sent it, and pushes it to the open data streams covering
+ the device.
+
+ @param value Value of the datapoint
+ @param propertyName Name of the property
+ @param index Index of the device, lower than `deviceCount`
+ @return NO if the device has no such property
+ */
+- (BOOL)createDatapointWithValue:(id)value
+                 ofPropertyNamed:(NSString *)propertyName
+                 ofDeviceAtIndex:(NSUInteger)index;
+
+/**
+ Resets `requestCount`, `failedRequestCount` and `propertyFetchCount` to 0
+ */
+- (void)resetRequestCount;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,786 @@
+//
+//  AylaMockCloudService.m
+//  iOS_AuraTests
+//
+//  Copyright © 2016 Ayla Networks. All rights reserved.
+//
+
+#import "AylaMockCloudService.h"
+
+@import iOS_AylaSDK;
+
+/** Path the device service is served under, the way the device service url includes its api version */
+static NSString *const AylaMockCloudDeviceServicePath = @"apiv1/";
+
+/** Prefix of the dsns of the generated devices, followed by the index of the device */
+static NSString *const AylaMockCloudDsnPrefix = @"AC000M";
+
+/** Time all generated datapoints were last updated at */
+static NSString *const AylaMockCloudDataUpdatedAt = @"2016-11-02T10:20:30Z";
+
+/** Heart beat of the data stream service, which clients echo back */
+static NSString *const AylaMockCloudHeartbeat = @"1|Z";
+
+/** Number of datapoints returned by a datapoint history request without limit */
+static const NSUInteger AylaMockCloudDefaultDatapointLimit = 100;
+
+@class AylaMockCloudStream;
+
+@interface AylaMockCloudService ()
+@property (nonatomic, assign, readwrite) NSUInteger requestCount;
+@property (nonatomic, assign, readwrite) NSUInteger failedRequestCount;
+@property (nonatomic, assign, readwrite) NSUInteger propertyFetchCount;
+@property (nonatomic, assign, readwrite) NSUInteger openStreamCount;
+
+// The generated account is created lazily, one device at a time, and is guarded by the service
+
+/** Key given to the next generated property */
+@property (nonatomic, assign) NSUInteger nextPropertyKey;
+
+/** Keys of the properties of the generated devices, by device index */
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSArray<NSNumber *> *> *propertyKeysByDeviceIndex;
+
+/** Index of the device of each generated property, by property key */
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSNumber *> *deviceIndexesByPropertyKey;
+
+/** JSON dictionaries of the generated properties, without their datapoint, by property key */
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSDictionary *> *propertiesByKey;
+
+/** Datapoints of the generated properties, oldest first, by property key */
+@property (nonatomic, strong)
+    NSMutableDictionary<NSNumber *, NSMutableArray<NSDictionary *> *> *datapointsByPropertyKey;
+
+/** Datums of the devices, by datum key, by dsn */
+@property (nonatomic, strong)
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSDictionary *> *> *datumsByDsn;
+
+/** Created data stream subscriptions, by stream key */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *subscriptionsByStreamKey;
+
+/** Open data streams */
+@property (nonatomic, strong) NSMutableArray<AylaMockCloudStream *> *streams;
+
+- (NSObject<HTTPResponse> *)responseForMethod:(NSString *)method
+                                          URI:(NSString *)URI
+                                         body:(NSData *)body
+                                   connection:(HTTPConnection *)connection;
+- (WebSocket *)streamForURI:(NSString *)URI request:(HTTPMessage *)request socket:(GCDAsyncSocket *)socket;
+- (void)streamDidOpen:(AylaMockCloudStream *)stream;
+- (void)streamDidClose:(AylaMockCloudStream *)stream;
+@end
+
+/**
+ A JSON response of the mock cloud, whose headers can be held back to simulate the latency of the service
+ */
+@interface AylaMockCloudResponse : HTTPDataResponse
+
+@property (nonatomic, assign) NSInteger httpStatus;
+
+/** YES while the response is held back */
+@property (atomic, assign) BOOL delayed;
+
+- (instancetype)initWithStatus:(NSInteger)httpStatus JSONObject:(id)object;
+
+/**
+ Holds the response back for a while, then tells the connection it can be sent
+ */
+- (void)delayBy:(NSTimeInterval)delay forConnection:(HTTPConnection *)connection;
+@end
+
+/**
+ Connection of the mock cloud, collects the body of a request and lets the service answer it
+ */
+@interface AylaMockCloudConnection : HTTPConnection
+@property (nonatomic, strong) NSMutableData *bodyBuffer;
+@end
+
+/**
+ A data stream of the mock cloud, sends heart beats and the events of the devices its subscription covers
+ */
+@interface AylaMockCloudStream : WebSocket
+@property (nonatomic, weak) AylaMockCloudService *service;
+
+/** Dsns of the devices covered by the stream, nil if it covers all devices of the account */
+@property (nonatomic, strong) NSSet<NSString *> *dsns;
+
+@property (nonatomic, assign) NSTimeInterval heartbeatInterval;
+@property (nonatomic, strong) dispatch_source_t heartbeatTimer;
+
+/** Sequence number of the last event sent, only used on the queue of the web socket */
+@property (nonatomic, assign) NSUInteger seq;
+
+/**
+ Sends an event as a frame of the stream
+ */
+- (void)sendEvent:(NSDictionary *)event;
+@end
+
+@implementation AylaMockCloudService
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _deviceCount = 10;
+        _propertiesPerDevice = 10;
+        _heartbeatInterval = 30;
+        _subscriptionsByStreamKey = [NSMutableDictionary dictionary];
+        _streams = [NSMutableArray array];
+        [self resetAccount];
+        [self setConnectionClass:[AylaMockCloudConnection class]];
+        [self setInterface:@"localhost"];
+        [self setPort:0];
+    }
+    return self;
+}
+
+- (void)setDeviceCount:(NSUInteger)deviceCount {
+    @synchronized(self) {
+        _deviceCount = deviceCount;
+        [self resetAccount];
+    }
+}
+
+- (void)setPropertiesPerDevice:(NSUInteger)propertiesPerDevice {
+    @synchronized(self) {
+        _propertiesPerDevice = propertiesPerDevice;
+        [self resetAccount];
+    }
+}
+
+- (NSDictionary<NSString *, NSString *> *)serviceBaseUrlOverrides {
+    NSString *baseUrl = [NSString stringWithFormat:@"http://127.0.0.1:%hu/", [self listeningPort]];
+    return @{
+        AylaServiceNameUser : baseUrl,
+        AylaServiceNameDevice : [baseUrl stringByAppendingString:AylaMockCloudDeviceServicePath],
+        AylaServiceNameLog : baseUrl,
+        AylaServiceNameStream : baseUrl,
+        AylaServiceNameStreamSubscription : baseUrl
+    };
+}
+
+- (NSString *)dsnOfDeviceAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"%@%09lu", AylaMockCloudDsnPrefix, (unsigned long)index];
+}
+
+- (NSString *)nameOfPropertyAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"prop_%03lu", (unsigned long)index];
+}
+
+- (BOOL)createDatapointWithValue:(id)value
+                 ofPropertyNamed:(NSString *)propertyName
+                 ofDeviceAtIndex:(NSUInteger)index {
+    @synchronized(self) {
+        if (index >= self.deviceCount) {
+            return NO;
+        }
+        for (NSNumber *key in [self propertyKeysOfDeviceAtIndex:index]) {
+            if ([self.propertiesByKey[key][@"name"] isEqualToString:propertyName]) {
+                [self addDatapointWithValue:value toPropertyWithKey:key];
+                return YES;
+            }
+        }
+        return NO;
+    }
+}
+
+- (void)resetRequestCount {
+    @synchronized(self) {
+        self.requestCount = 0;
+        self.failedRequestCount = 0;
+        self.propertyFetchCount = 0;
+    }
+}
+
+//-----------------------------------------------------------
+#pragma mark - Routing
+//-----------------------------------------------------------
+
+- (NSObject<HTTPResponse> *)responseForMethod:(NSString *)method
+                                          URI:(NSString *)URI
+                                         body:(NSData *)body
+                                   connection:(HTTPConnection *)connection {
+    NSURLComponents *url = [NSURLComponents componentsWithString:URI];
+    NSString *path = url.path ?: URI;
+    if ([path hasPrefix:@"/"]) {
+        path = [path substringFromIndex:1];
+    }
+    NSArray<NSString *> *components = path.pathComponents;
+    NSArray<NSURLQueryItem *> *query = url.queryItems ?: @[];
+
+    NSInteger status = 200;
+    id object = nil;
+    if ([method isEqualToString:@"POST"] &&
+        ([path isEqualToString:@"users/sign_in.json"] || [path isEqualToString:@"users/refresh_token.json"])) {
+        object = [self authorizationJSON];
+    }
+    else if ([method isEqualToString:@"POST"] && [path isEqualToString:@"users/sign_out.json"]) {
+        object = @{};
+    }
+    else if ([method isEqualToString:@"GET"] && [path isEqualToString:@"users/get_user_profile.json"]) {
+        object = @{ @"email" : @"mock@aylanetworks.com", @"firstname" : @"Mock", @"lastname" : @"User" };
+    }
+    else if ([method isEqualToString:@"POST"] && [path isEqualToString:@"api/v1/subscriptions.json"]) {
+        object = [self subscriptionJSONWithBody:body];
+        status = 201;
+    }
+    else if ([method isEqualToString:@"GET"] &&
+             [path isEqualToString:[AylaMockCloudDeviceServicePath stringByAppendingString:@"devices.json"]]) {
+        object = [self deviceListJSON];
+    }
+    else if (components.count >= 3 && [components[0] isEqualToString:@"apiv1"]) {
+        object = [self responseObjectForDeviceRequestWithMethod:method
+                                                     components:components
+                                                          query:query
+                                                           body:body
+                                                         status:&status];
+    }
+
+    if (object == nil && status < 300) {
+        status = 404;
+    }
+    if (status >= 400) {
+        object = @{ @"error" : [NSHTTPURLResponse localizedStringForStatusCode:status] };
+    }
+
+    @synchronized(self) {
+        self.requestCount++;
+        if (status >= 400) {
+            self.failedRequestCount++;
+        }
+    }
+
+    AylaMockCloudResponse *response = [[AylaMockCloudResponse alloc] initWithStatus:status JSONObject:object];
+    if (self.latency > 0) {
+        [response delayBy:self.latency forConnection:connection];
+    }
+    return response;
+}
+
+/**
+ Answers requests about a single device, all under the device service path:
+
+ - `dsns/<dsn>/properties.json`, names of the properties to fetch are ignored and all properties are served
+ - `dsns/<dsn>/data.json` and `dsns/<dsn>/data/<key>.json`
+ - `devices/<key>.json`
+ - `properties/<key>/datapoints.json`, history requests are only limited by their `limit`, dates are ignored
+ */
+- (id)responseObjectForDeviceRequestWithMethod:(NSString *)method
+                                    components:(NSArray<NSString *> *)components
+                                         query:(NSArray<NSURLQueryItem *> *)query
+                                          body:(NSData *)body
+                                        status:(NSInteger *)status {
+    NSString *resource = components[1];
+    BOOL isGet = [method isEqualToString:@"GET"];
+    BOOL isPropertyFetch = NO;
+    NSString *datumKey = nil;
+    NSNumber *propertyKey = nil;
+    NSInteger deviceIndex = -1;
+
+    if ([resource isEqualToString:@"dsns"] && components.count == 4 && isGet &&
+        [components[3] isEqualToString:@"properties.json"]) {
+        isPropertyFetch = YES;
+        deviceIndex = [self indexOfDeviceWithDsn:components[2]];
+    }
+    else if ([resource isEqualToString:@"dsns"] && components.count == 4 &&
+             [components[3] isEqualToString:@"data.json"] && (isGet || [method isEqualToString:@"POST"])) {
+        deviceIndex = [self indexOfDeviceWithDsn:components[2]];
+    }
+    else if ([resource isEqualToString:@"dsns"] && components.count == 5 && [components[3] isEqualToString:@"data"] &&
+             (isGet || [method isEqualToString:@"PUT"] || [method isEqualToString:@"DELETE"])) {
+        datumKey = components[4].stringByDeletingPathExtension;
+        deviceIndex = [self indexOfDeviceWithDsn:components[2]];
+    }
+    else if ([resource isEqualToString:@"devices"] && components.count == 3 && isGet) {
+        deviceIndex = components[2].stringByDeletingPathExtension.integerValue - 1;
+    }
+    else if ([resource isEqualToString:@"properties"] && components.count == 4 &&
+             [components[3] isEqualToString:@"datapoints.json"] && (isGet || [method isEqualToString:@"POST"])) {
+        propertyKey = @(components[2].integerValue);
+        @synchronized(self) {
+            NSNumber *index = self.deviceIndexesByPropertyKey[propertyKey];
+            deviceIndex = index ? index.integerValue : -1;
+        }
+    }
+
+    if (isPropertyFetch) {
+        @synchronized(self) {
+            self.propertyFetchCount++;
+        }
+    }
+    if (deviceIndex < 0 || deviceIndex >= (NSInteger)self.deviceCount) {
+        return nil;
+    }
+    if (self.errorRate > 0 && arc4random_uniform(10000) < self.errorRate * 10000) {
+        *status = 500;
+        return nil;
+    }
+
+    @synchronized(self) {
+        if ([resource isEqualToString:@"dsns"] && isPropertyFetch) {
+            return [self propertiesJSONOfDeviceAtIndex:deviceIndex];
+        }
+        if ([resource isEqualToString:@"dsns"]) {
+            return [self responseObjectForDatumRequestWithMethod:method
+                                                             dsn:components[2]
+                                                             key:datumKey
+                                                           query:query
+                                                            body:body
+                                                          status:status];
+        }
+        if ([resource isEqualToString:@"devices"]) {
+            return @{ @"device" : [self JSONOfDeviceAtIndex:deviceIndex] };
+        }
+        return [self responseObjectForDatapointRequestWithMethod:method
+                                                     propertyKey:propertyKey
+                                                           query:query
+                                                            body:body
+                                                          status:status];
+    }
+}
+
+/**
+ Creates a datapoint, echoing it back, or lists the latest datapoints of a property. Must be called while
+ synchronized on the service.
+ */
+- (id)responseObjectForDatapointRequestWithMethod:(NSString *)method
+                                      propertyKey:(NSNumber *)propertyKey
+                                            query:(NSArray<NSURLQueryItem *> *)query
+                                             body:(NSData *)body
+                                           status:(NSInteger *)status {
+    if ([method isEqualToString:@"GET"]) {
+        NSArray<NSDictionary *> *datapoints = self.datapointsByPropertyKey[propertyKey];
+        NSString *limitValue = [self valuesOfQueryItemsNamed:@"limit" inQuery:query].firstObject;
+        NSUInteger limit = limitValue.integerValue > 0 ? (NSUInteger)limitValue.integerValue
+                                                       : AylaMockCloudDefaultDatapointLimit;
+        NSUInteger count = MIN(limit, datapoints.count);
+        NSMutableArray *response = [NSMutableArray arrayWithCapacity:count];
+        for (NSDictionary *datapoint in
+             [datapoints subarrayWithRange:NSMakeRange(datapoints.count - count, count)]) {
+            [response addObject:@{ @"datapoint" : datapoint }];
+        }
+        return response;
+    }
+
+    NSDictionary *request = [self JSONDictionaryWithBody:body];
+    id value = [request[@"datapoint"] isKindOfClass:[NSDictionary class]] ? request[@"datapoint"][@"value"] : nil;
+    if (value == nil) {
+        *status = 422;
+        return nil;
+    }
+    *status = 201;
+    return @{ @"datapoint" : [self addDatapointWithValue:value toPropertyWithKey:propertyKey] };
+}
+
+/**
+ Serves the datums of a device. Without a key, lists the datums named by the `keys` query, all datums if there is no
+ such query, or creates a datum. Must be called while synchronized on the service.
+ */
+- (id)responseObjectForDatumRequestWithMethod:(NSString *)method
+                                          dsn:(NSString *)dsn
+                                          key:(NSString *)key
+                                        query:(NSArray<NSURLQueryItem *> *)query
+                                         body:(NSData *)body
+                                       status:(NSInteger *)status {
+    NSMutableDictionary<NSString *, NSDictionary *> *datums = self.datumsByDsn[dsn];
+    if (!datums) {
+        datums = [NSMutableDictionary dictionary];
+        self.datumsByDsn[dsn] = datums;
+    }
+    NSString *now = [[AylaSystemUtils defaultDateFormatter] stringFromDate:[NSDate date]];
+    NSDictionary *request = [self JSONDictionaryWithBody:body];
+    NSDictionary *requestDatum = [request[@"datum"] isKindOfClass:[NSDictionary class]] ? request[@"datum"] : nil;
+
+    if (key == nil && [method isEqualToString:@"GET"]) {
+        NSArray<NSString *> *keys = [self valuesOfQueryItemsNamed:@"keys[]" inQuery:query];
+        NSString *pattern = [self valuesOfQueryItemsNamed:@"keys" inQuery:query].firstObject;
+        NSArray<NSString *> *matchingKeys = datums.allKeys;
+        if (keys.count > 0) {
+            matchingKeys =
+                [keys filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF IN %@", datums.allKeys]];
+        }
+        else if (pattern) {
+            // Datum wildcards are SQL like, '%' matches any sequence of characters
+            NSString *like = [pattern stringByReplacingOccurrencesOfString:@"%" withString:@"*"];
+            matchingKeys =
+                [matchingKeys filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF LIKE %@", like]];
+        }
+        NSMutableArray *response = [NSMutableArray arrayWithCapacity:matchingKeys.count];
+        for (NSString *matchingKey in [matchingKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            [response addObject:@{ @"datum" : datums[matchingKey] }];
+        }
+        return response;
+    }
+
+    if (key == nil) {
+        NSString *newKey = requestDatum[@"key"];
+        id value = requestDatum[@"value"];
+        if (![newKey isKindOfClass:[NSString class]] || newKey.length == 0 || value == nil || datums[newKey]) {
+            *status = 422;
+            return nil;
+        }
+        datums[newKey] = @{ @"key" : newKey, @"value" : value, @"created_at" : now, @"updated_at" : now };
+        *status = 201;
+        return @{ @"datum" : datums[newKey] };
+    }
+
+    NSDictionary *datum = datums[key];
+    if (datum == nil) {
+        *status = 404;
+        return nil;
+    }
+    if ([method isEqualToString:@"PUT"]) {
+        id value = requestDatum[@"value"];
+        if (value == nil) {
+            *status = 422;
+            return nil;
+        }
+        NSMutableDictionary *updatedDatum = [datum mutableCopy];
+        updatedDatum[@"value"] = value;
+        updatedDatum[@"updated_at"] = now;
+        datums[key] = updatedDatum;
+        return @{ @"datum" : updatedDatum };
+    }
+    if ([method isEqualToString:@"DELETE"]) {
+        [datums removeObjectForKey:key];
+        return @{};
+    }
+    return @{ @"datum" : datum };
+}
+
+- (NSInteger)indexOfDeviceWithDsn:(NSString *)dsn {
+    if (![dsn hasPrefix:AylaMockCloudDsnPrefix]) {
+        return -1;
+    }
+    return [dsn substringFromIndex:AylaMockCloudDsnPrefix.length].integerValue;
+}
+
+- (NSArray<NSString *> *)valuesOfQueryItemsNamed:(NSString *)name inQuery:(NSArray<NSURLQueryItem *> *)query {
+    NSMutableArray *values = [NSMutableArray array];
+    for (NSURLQueryItem *item in query) {
+        if ([item.name isEqualToString:name] && item.value) {
+            [values addObject:item.value];
+        }
+    }
+    return values;
+}
+
+- (NSDictionary *)JSONDictionaryWithBody:(NSData *)body {
+    id object = body.length ? [NSJSONSerialization JSONObjectWithData:body options:0 error:nil] : nil;
+    return [object isKindOfClass:[NSDictionary class]] ? object : @{};
+}
+
+//-----------------------------------------------------------
+#pragma mark - Data Streams
+//-----------------------------------------------------------
+
+/**
+ Creates a subscription from the body of a subscription request. Subscriptions without dsns cover all devices.
+ */
+- (NSDictionary *)subscriptionJSONWithBody:(NSData *)body {
+    NSMutableDictionary *subscription = [NSMutableDictionary dictionary];
+    [[self JSONDictionaryWithBody:body] enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if (obj != [NSNull null]) {
+            subscription[key] = obj;
+        }
+    }];
+    if (![subscription[@"dsn"] isKindOfClass:[NSString class]] || [subscription[@"dsn"] length] == 0) {
+        subscription[@"dsn"] = @"*";
+    }
+    NSString *now = [[AylaSystemUtils defaultDateFormatter] stringFromDate:[NSDate date]];
+    subscription[@"stream_key"] = [NSUUID UUID].UUIDString;
+    subscription[@"created_at"] = now;
+    subscription[@"updated_at"] = now;
+
+    @synchronized(self) {
+        subscription[@"id"] = @(self.subscriptionsByStreamKey.count + 1);
+        self.subscriptionsByStreamKey[subscription[@"stream_key"]] = subscription;
+    }
+    return @{ @"subscription" : subscription };
+}
+
+- (WebSocket *)streamForURI:(NSString *)URI request:(HTTPMessage *)request socket:(GCDAsyncSocket *)socket {
+    NSURLComponents *url = [NSURLComponents componentsWithString:URI];
+    NSString *streamKey = [self valuesOfQueryItemsNamed:@"stream_key" inQuery:url.queryItems ?: @[]].firstObject;
+
+    NSDictionary *subscription = nil;
+    @synchronized(self) {
+        self.requestCount++;
+        subscription = streamKey ? self.subscriptionsByStreamKey[streamKey] : nil;
+        if (![url.path isEqualToString:@"/stream"] || subscription == nil) {
+            self.failedRequestCount++;
+            return nil;
+        }
+    }
+
+    AylaMockCloudStream *stream = [[AylaMockCloudStream alloc] initWithRequest:request socket:socket];
+    stream.service = self;
+    stream.heartbeatInterval = self.heartbeatInterval;
+    if (![subscription[@"dsn"] isEqualToString:@"*"]) {
+        stream.dsns = [NSSet setWithArray:[subscription[@"dsn"] componentsSeparatedByString:@","]];
+    }
+    return stream;
+}
+
+- (void)streamDidOpen:(AylaMockCloudStream *)stream {
+    @synchronized(self) {
+        [self.streams addObject:stream];
+        self.openStreamCount = self.streams.count;
+    }
+}
+
+- (void)streamDidClose:(AylaMockCloudStream *)stream {
+    @synchronized(self) {
+        [self.streams removeObject:stream];
+        self.openStreamCount = self.streams.count;
+    }
+}
+
+/**
+ Sends a datapoint event to the open streams covering the device of the property. Must be called while synchronized
+ on the service.
+ */
+- (void)publishDatapoint:(NSDictionary *)datapoint ofPropertyWithKey:(NSNumber *)propertyKey {
+    NSDictionary *property = self.propertiesByKey[propertyKey];
+    NSString *dsn = [self dsnOfDeviceAtIndex:self.deviceIndexesByPropertyKey[propertyKey].unsignedIntegerValue];
+    NSDictionary *event = @{
+        @"metadata" : @{
+            @"dsn" : dsn,
+            @"property_name" : property[@"name"],
+            @"display_name" : property[@"display_name"],
+            @"base_type" : property[@"base_type"],
+            @"event_type" : @"datapoint",
+            @"oem_model" : @"mockoem"
+        },
+        @"datapoint" : datapoint
+    };
+    for (AylaMockCloudStream *stream in self.streams) {
+        if (stream.dsns == nil || [stream.dsns containsObject:dsn]) {
+            [stream sendEvent:event];
+        }
+    }
+}
+
+//-----------------------------------------------------------
+#pragma mark - Generated Account
+//-----------------------------------------------------------
+
+/**
+ Forgets the generated devices, their datapoints and datums. Must be called while synchronized on the service.
+ */
+- (void)resetAccount {
+    self.nextPropertyKey = 1;
+    self.propertyKeysByDeviceIndex = [NSMutableDictionary dictionary];
+    self.deviceIndexesByPropertyKey = [NSMutableDictionary dictionary];
+    self.propertiesByKey = [NSMutableDictionary dictionary];
+    self.datapointsByPropertyKey = [NSMutableDictionary dictionary];
+    self.datumsByDsn = [NSMutableDictionary dictionary];
+}
+
+- (NSDictionary *)authorizationJSON {
+    return @{
+        @"access_token" : [NSUUID UUID].UUIDString,
+        @"refresh_token" : [NSUUID UUID].UUIDString,
+        @"expires_in" : @86400,
+        @"role" : @"EndUser"
+    };
+}
+
+- (NSArray *)deviceListJSON {
+    NSUInteger deviceCount = self.deviceCount;
+    NSMutableArray *devices = [NSMutableArray arrayWithCapacity:deviceCount];
+    for (NSUInteger i = 0; i < deviceCount; i++) {
+        [devices addObject:@{ @"device" : [self JSONOfDeviceAtIndex:i] }];
+    }
+    return devices;
+}
+
+- (NSDictionary *)JSONOfDeviceAtIndex:(NSUInteger)index {
+    return @{
+        @"key" : @(index + 1),
+        @"dsn" : [self dsnOfDeviceAtIndex:index],
+        @"product_name" : [NSString stringWithFormat:@"Mock device %lu", (unsigned long)index],
+        @"model" : @"AY001MUX1",
+        @"oem_model" : @"mockoem",
+        @"device_type" : @"Wifi",
+        @"connection_status" : @"Online",
+        @"connected_at" : AylaMockCloudDataUpdatedAt,
+        @"mac" : [NSString stringWithFormat:@"%012lx", (unsigned long)index],
+        @"sw_version" : @"mock 1.0"
+    };
+}
+
+/**
+ Keys of the properties of a device, generating them on first use. Keys are handed out in the order devices are
+ first asked about, so they do not tell which device they belong to. Must be called while synchronized on the
+ service.
+ */
+- (NSArray<NSNumber *> *)propertyKeysOfDeviceAtIndex:(NSUInteger)index {
+    NSArray<NSNumber *> *keys = self.propertyKeysByDeviceIndex[@(index)];
+    if (keys) {
+        return keys;
+    }
+
+    NSUInteger propertiesPerDevice = self.propertiesPerDevice;
+    NSMutableArray<NSNumber *> *newKeys = [NSMutableArray arrayWithCapacity:propertiesPerDevice];
+    for (NSUInteger i = 0; i < propertiesPerDevice; i++) {
+        NSNumber *key = @(self.nextPropertyKey++);
+        self.deviceIndexesByPropertyKey[key] = @(index);
+        self.propertiesByKey[key] = @{
+            @"key" : key,
+            @"name" : [self nameOfPropertyAtIndex:i],
+            @"display_name" : [NSString stringWithFormat:@"Property %lu", (unsigned long)i],
+            @"base_type" : @"integer",
+            @"type" : @"Property",
+            @"direction" : i % 2 ? @"input" : @"output"
+        };
+        self.datapointsByPropertyKey[key] = [NSMutableArray arrayWithObject:@{
+            @"value" : @(i),
+            @"created_at" : AylaMockCloudDataUpdatedAt,
+            @"updated_at" : AylaMockCloudDataUpdatedAt,
+            @"echo" : @NO
+        }];
+        [newKeys addObject:key];
+    }
+    self.propertyKeysByDeviceIndex[@(index)] = newKeys;
+    return newKeys;
+}
+
+/**
+ Must be called while synchronized on the service.
+ */
+- (NSArray *)propertiesJSONOfDeviceAtIndex:(NSUInteger)index {
+    NSArray<NSNumber *> *keys = [self propertyKeysOfDeviceAtIndex:index];
+    NSMutableArray *properties = [NSMutableArray arrayWithCapacity:keys.count];
+    for (NSNumber *key in keys) {
+        NSMutableDictionary *property = [self.propertiesByKey[key] mutableCopy];
+        NSDictionary *datapoint = self.datapointsByPropertyKey[key].lastObject;
+        property[@"value"] = datapoint[@"value"];
+        property[@"data_updated_at"] = datapoint[@"updated_at"];
+        [properties addObject:@{ @"property" : property }];
+    }
+    return properties;
+}
+
+/**
+ Adds a datapoint to a property and publishes it to the data streams. Must be called while synchronized on the
+ service.
+
+ @return The JSON dictionary of the datapoint
+ */
+- (NSDictionary *)addDatapointWithValue:(id)value toPropertyWithKey:(NSNumber *)propertyKey {
+    NSString *now = [[AylaSystemUtils defaultDateFormatter] stringFromDate:[NSDate date]];
+    NSDictionary *datapoint = @{ @"value" : value, @"created_at" : now, @"updated_at" : now, @"echo" : @NO };
+    [self.datapointsByPropertyKey[propertyKey] addObject:datapoint];
+    [self publishDatapoint:datapoint ofPropertyWithKey:propertyKey];
+    return datapoint;
+}
+
+@end
+
+@implementation AylaMockCloudResponse
+
+- (instancetype)initWithStatus:(NSInteger)httpStatus JSONObject:(id)object {
+    NSData *data = object ? [NSJSONSerialization dataWithJSONObject:object options:0 error:nil] : [NSData data];
+    if (self = [super initWithData:data]) {
+        _httpStatus = httpStatus;
+    }
+    return self;
+}
+
+- (void)delayBy:(NSTimeInterval)delay forConnection:(HTTPConnection *)connection {
+    self.delayed = YES;
+    __weak HTTPConnection *weakConnection = connection;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
+                   dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        self.delayed = NO;
+        [weakConnection responseHasAvailableData:self];
+    });
+}
+
+- (BOOL)delayResponseHeaders {
+    return self.delayed;
+}
+
+- (NSInteger)status {
+    return self.httpStatus;
+}
+
+- (NSDictionary *)httpHeaders {
+    return @{ @"Content-Type" : @"application/json" };
+}
+
+@end
+
+@implementation AylaMockCloudConnection
+
+- (BOOL)supportsMethod:(NSString *)method atPath:(NSString *)path {
+    if ([method isEqualToString:@"POST"] || [method isEqualToString:@"PUT"] || [method isEqualToString:@"DELETE"]) {
+        return YES;
+    }
+    return [super supportsMethod:method atPath:path];
+}
+
+- (void)prepareForBodyWithSize:(UInt64)contentLength {
+    self.bodyBuffer = [NSMutableData data];
+}
+
+- (void)processBodyData:(NSData *)postDataChunk {
+    [self.bodyBuffer appendData:postDataChunk];
+}
+
+- (NSObject<HTTPResponse> *)httpResponseForMethod:(NSString *)method URI:(NSString *)path {
+    AylaMockCloudService *service = (AylaMockCloudService *)config.server;
+    NSData *body = self.bodyBuffer;
+    self.bodyBuffer = nil;
+    return [service responseForMethod:method URI:path body:body connection:self];
+}
+
+- (WebSocket *)webSocketForURI:(NSString *)path {
+    AylaMockCloudService *service = (AylaMockCloudService *)config.server;
+    return [service streamForURI:path request:request socket:asyncSocket];
+}
+
+@end
+
+@implementation AylaMockCloudStream
+
+- (void)didOpen {
+    [super didOpen];
+    [self.service streamDidOpen:self];
+
+    if (self.heartbeatInterval <= 0) {
+        return;
+    }
+    uint64_t interval = (uint64_t)(self.heartbeatInterval * NSEC_PER_SEC);
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.websocketQueue);
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(timer, ^{
+        [weakSelf sendMessage:AylaMockCloudHeartbeat];
+    });
+    dispatch_resume(timer);
+    self.heartbeatTimer = timer;
+}
+
+- (void)didClose {
+    if (self.heartbeatTimer) {
+        dispatch_source_cancel(self.heartbeatTimer);
+        self.heartbeatTimer = nil;
+    }
+    [self.service streamDidClose:self];
+    [super didClose];
+}
+
+- (void)sendEvent:(NSDictionary *)event {
+    dispatch_async(self.websocketQueue, ^{
+        self.seq++;
+        NSMutableDictionary *frame = [event mutableCopy];
+        frame[@"seq"] = @(self.seq);
+        NSData *data = [NSJSONSerialization dataWithJSONObject:frame options:0 error:nil];
+        NSString *json = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+
+        // Frames are the length of their JSON, a separator, then the JSON
+        [self sendMessage:[NSString stringWithFormat:@"%lu|%@", (unsigned long)json.length, json]];
+    });
+}
+
+@end